@@ -0,0 +1,120 @@
+/*
+* @file emitterBench.c
+* @brief Microbenchmark of the emitter path
+* @details Writes the assembly of a large synthetic translation unit, a label every few instructions like the blocks of the functions codegen emits, four ways: with one fprintf per line straight to the FILE, with append_formatted_text into one BufferType written out at the end as before the Emitter existed, through emit_formatted, and through the emit_string/emit_integer fast paths codegen uses for operands. Prints the time each way took. Run with `make bench`, an optional argument sets the number of lines.
+*/
+
+#include "emitter.h"
+#include "buffer.h"
+#include <stdlib.h>
+#include <time.h>
+
+#define EMITTER_BENCH_DEFAULT_LINES 2000000
+#define EMITTER_BENCH_LINES_PER_LABEL 8
+
+typedef void (*EMITTER_BENCH_WRITER)(FILE* file, int line_count);
+
+int main(int argc, char** argv);
+
+static void emitter_bench_run(const char* name, EMITTER_BENCH_WRITER writer, int line_count);
+
+static void emitter_bench_fprintf(FILE* file, int line_count);
+
+static void emitter_bench_buffer(FILE* file, int line_count);
+
+static void emitter_bench_formatted(FILE* file, int line_count);
+
+static void emitter_bench_fast_paths(FILE* file, int line_count);
+
+
+
+int main(int argc, char** argv){
+    int line_count = argc > 1 ? atoi(argv[1]) : EMITTER_BENCH_DEFAULT_LINES;
+    if(line_count <= 0){
+        fprintf(stderr, "usage: %s [line count]\n", argv[0]);
+        return 1;
+    }
+    printf("emitting %d lines\n", line_count);
+    emitter_bench_run("fprintf per line", emitter_bench_fprintf, line_count);
+    emitter_bench_run("BufferType append", emitter_bench_buffer, line_count);
+    emitter_bench_run("emit_formatted", emitter_bench_formatted, line_count);
+    emitter_bench_run("emit_string/emit_integer", emitter_bench_fast_paths, line_count);
+    return 0;
+}
+
+// Times one writer into a temporary file, so the cost of the writes to the file is included.
+static void emitter_bench_run(const char* name, EMITTER_BENCH_WRITER writer, int line_count){
+    FILE* file = tmpfile();
+    if(!file){
+        perror("tmpfile");
+        exit(1);
+    }
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    writer(file, line_count);
+    fflush(file);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long bytes = ftell(file);
+    fclose(file);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("    %-26s %8.3fs %8.1f MB/s\n", name, seconds, bytes / seconds / 1e6);
+}
+
+static void emitter_bench_fprintf(FILE* file, int line_count){
+    for(int i = 0; i < line_count; i++){
+        if(i % EMITTER_BENCH_LINES_PER_LABEL == 0){
+            fprintf(file, ".L%d:\n", i / EMITTER_BENCH_LINES_PER_LABEL);
+        }
+        else{
+            fprintf(file, "\tmovq %%r%d, %lld(%%rbp)\n", 8 + i % 8, -8LL * (i % 64));
+        }
+    }
+}
+
+// The whole unit is formatted into one growing buffer and written with a single fwrite.
+static void emitter_bench_buffer(FILE* file, int line_count){
+    BufferType* buffer = create_buffer();
+    for(int i = 0; i < line_count; i++){
+        if(i % EMITTER_BENCH_LINES_PER_LABEL == 0){
+            append_formatted_text(buffer, ".L%d:\n", i / EMITTER_BENCH_LINES_PER_LABEL);
+        }
+        else{
+            append_formatted_text(buffer, "\tmovq %%r%d, %lld(%%rbp)\n", 8 + i % 8, -8LL * (i % 64));
+        }
+    }
+    fwrite(buffer->allocated_memory, 1, buffer->current_length, file);
+    free_buffer(buffer);
+}
+
+static void emitter_bench_formatted(FILE* file, int line_count){
+    Emitter* emitter = create_emitter(file);
+    for(int i = 0; i < line_count; i++){
+        if(i % EMITTER_BENCH_LINES_PER_LABEL == 0){
+            emit_formatted(emitter, ".L%d:\n", i / EMITTER_BENCH_LINES_PER_LABEL);
+        }
+        else{
+            emit_formatted(emitter, "\tmovq %%r%d, %lld(%%rbp)\n", 8 + i % 8, -8LL * (i % 64));
+        }
+    }
+    free_emitter(emitter);
+}
+
+static void emitter_bench_fast_paths(FILE* file, int line_count){
+    Emitter* emitter = create_emitter(file);
+    for(int i = 0; i < line_count; i++){
+        if(i % EMITTER_BENCH_LINES_PER_LABEL == 0){
+            emit_string(emitter, ".L");
+            emit_integer(emitter, i / EMITTER_BENCH_LINES_PER_LABEL);
+            emit_string(emitter, ":\n");
+        }
+        else{
+            emit_string(emitter, "\tmovq %r");
+            emit_integer(emitter, 8 + i % 8);
+            emit_string(emitter, ", ");
+            emit_integer(emitter, -8LL * (i % 64));
+            emit_string(emitter, "(%rbp)\n");
+        }
+    }
+    free_emitter(emitter);
+}
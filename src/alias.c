@@ -0,0 +1,142 @@
+/*
+* @file alias.c
+* @brief Alias analysis of the intermediate representation
+* @details Addresses are traced back through pointer arithmetic to the stack slot or global they point into. Two addresses can't overlap when they are based on different stack slots or globals, or on the same one at constant offsets whose ranges are disjoint. A stack slot whose address never escapes can't be reached through any other pointer or by a call.
+*/
+
+#include "compiler.h"
+
+IrAddress ir_resolve_address(IrFunction* function, int vreg);
+
+bool* ir_find_escaped_slots(IrFunction* function);
+
+bool is_ir_private_slot(bool* escaped_slots, IrInstruction* base);
+
+bool ir_may_alias(IrFunction* function, bool* escaped_slots, int first, size_t first_size, int second, size_t second_size);
+
+static IrAddress alias_offset_address(IrFunction* function, IrInstruction* definition);
+
+static bool is_alias_same_global(IrInstruction* first, IrInstruction* second);
+
+static bool is_alias_escaping(IrFunction* function, int address);
+
+
+
+IrAddress ir_resolve_address(IrFunction* function, int vreg){
+    IrAddress address = {.is_offset_known = true};
+    IrInstruction* definition = vector_IrInstructionPtr_at(function->definitions, vreg);
+    if(!definition){
+        address.is_offset_known = false;
+        return address;
+    }
+    switch(definition->opcode){
+        case IR_OP_SLOT_ADDRESS:
+        case IR_OP_GLOBAL_ADDRESS:
+            address.base = definition;
+            return address;
+        case IR_OP_ADD:
+        case IR_OP_SUB:
+            return alias_offset_address(function, definition);
+    }
+    address.is_offset_known = false;
+    return address;
+}
+
+// The pointer of an addition may be either operand, the offset is only known when the other one is a constant.
+static IrAddress alias_offset_address(IrFunction* function, IrInstruction* definition){
+    IrAddress address = ir_resolve_address(function, definition->operands[0]);
+    int offset_vreg = definition->operands[1];
+    if(!address.base && definition->opcode == IR_OP_ADD){
+        address = ir_resolve_address(function, definition->operands[1]);
+        offset_vreg = definition->operands[0];
+    }
+    IrInstruction* offset = vector_IrInstructionPtr_at(function->definitions, offset_vreg);
+    if(offset && offset->opcode == IR_OP_CONST){
+        address.offset += definition->opcode == IR_OP_ADD ? offset->immediate : -offset->immediate;
+    }
+    else{
+        address.is_offset_known = false;
+    }
+    return address;
+}
+
+bool* ir_find_escaped_slots(IrFunction* function){
+    bool* escaped_slots = calloc(get_element_count(function->slots) + 1, sizeof(bool));
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode == IR_OP_SLOT_ADDRESS && is_alias_escaping(function, (*instruction)->result)){
+                escaped_slots[(*instruction)->slot] = true;
+            }
+        }
+    }
+    return escaped_slots;
+}
+
+// An address escapes unless every register derived from it is only used to address loads, stores and memory copies.
+static bool is_alias_escaping(IrFunction* function, int address){
+    DynamicVector* users = vector_VoidPtr_at(function->uses, address);
+    if(!users){
+        return false;
+    }
+    vector_for_each(IrInstruction*, user_pointer, users){
+        IrInstruction* user = *user_pointer;
+        switch(user->opcode){
+            case IR_OP_LOAD:
+            case IR_OP_MEMCOPY:
+                break;
+            case IR_OP_STORE:
+                if(user->operands[1] == address){
+                    return true;
+                }
+                break;
+            case IR_OP_ADD:
+            case IR_OP_SUB:
+            case IR_OP_COPY:
+                if(is_alias_escaping(function, user->result)){
+                    return true;
+                }
+                break;
+            default:
+                return true;
+        }
+    }
+    return false;
+}
+
+bool is_ir_private_slot(bool* escaped_slots, IrInstruction* base){
+    return base && base->opcode == IR_OP_SLOT_ADDRESS && !escaped_slots[base->slot];
+}
+
+bool ir_may_alias(IrFunction* function, bool* escaped_slots, int first, size_t first_size, int second, size_t second_size){
+    IrAddress first_address = ir_resolve_address(function, first);
+    IrAddress second_address = ir_resolve_address(function, second);
+    if(!first_address.base || !second_address.base){
+        //an unknown pointer can point anywhere but into a slot whose address never escaped
+        return !is_ir_private_slot(escaped_slots, first_address.base) && !is_ir_private_slot(escaped_slots, second_address.base);
+    }
+    IrInstruction* first_base = first_address.base;
+    IrInstruction* second_base = second_address.base;
+    if(first_base->opcode != second_base->opcode){
+        return false;
+    }
+    if(first_base->opcode == IR_OP_SLOT_ADDRESS && first_base->slot != second_base->slot){
+        return false;
+    }
+    if(first_base->opcode == IR_OP_GLOBAL_ADDRESS && !is_alias_same_global(first_base, second_base)){
+        return false;
+    }
+    if(!first_address.is_offset_known || !second_address.is_offset_known){
+        return true;
+    }
+    long long first_offset = first_address.offset + (first_base->opcode == IR_OP_GLOBAL_ADDRESS ? first_base->immediate : 0);
+    long long second_offset = second_address.offset + (second_base->opcode == IR_OP_GLOBAL_ADDRESS ? second_base->immediate : 0);
+    return first_offset < second_offset + (long long)second_size && second_offset < first_offset + (long long)first_size;
+}
+
+// Equal string literals may share storage, globals are told apart by name.
+static bool is_alias_same_global(IrInstruction* first, IrInstruction* second){
+    if((first->flags ^ second->flags) & IR_INSTRUCTION_FLAG_STRING_LITERAL){
+        return false;
+    }
+    return ARE_STRINGS_EQUAL(first->symbol, second->symbol);
+}
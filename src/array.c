@@ -15,35 +15,28 @@ void free_array_brackets(ArrayBrackets* array_brackets) {
 
 void add_array_bracket(ArrayBrackets* array_brackets, Node* bracket_node) {
     assert(bracket_node->type == NODE_TYPE_BRACKET);
-    push_element(array_brackets->n_brackets, &bracket_node);
+    vector_NodePtr_push(array_brackets->n_brackets, bracket_node);
 }
 
 DynamicVector* get_array_brackets_node_vector(ArrayBrackets* array_brackets) {
     return array_brackets->n_brackets;
 }
 
-size_t array_brackets_calculate_size_from_index(DataType* datatype, ArrayBrackets* array_brackets, int index) {
+size_t array_brackets_calculate_size_from_index(CompileProcess* process, DataType* datatype, ArrayBrackets* array_brackets, int index) {
     DynamicVector* array_vector = get_array_brackets_node_vector(array_brackets);
-    size_t size = datatype->size;
+    size_t size = get_datatype_element_size(process, datatype);
     if(index >= get_element_count(array_vector)) {
         return size;
     }
-    set_peek_index(array_vector, index);
-    Node* bracket_node = peek_pointer(array_vector);
-    if(!bracket_node) {
-        return size;
-    }
-    while(bracket_node) {
-        assert(bracket_node->data.bracket.inner->type == NODE_TYPE_NUMBER);
-        int number = bracket_node->data.bracket.inner->literal_value.long_long_num;
+    vector_for_each_from(Node*, bracket_node, array_vector, index) {
+        long long number = get_node_constant_value((*bracket_node)->data.bracket.inner);
         size *= number;
-        bracket_node = peek_pointer(array_vector);
     }
     return size;
 }
 
-size_t array_brackets_calculate_size(DataType* datatype, ArrayBrackets* array_brackets) {
-    return array_brackets_calculate_size_from_index(datatype, array_brackets, 0);
+size_t array_brackets_calculate_size(CompileProcess* process, DataType* datatype, ArrayBrackets* array_brackets) {
+    return array_brackets_calculate_size_from_index(process, datatype, array_brackets, 0);
 }
 
 int array_brackets_get_total_indices(DataType* datatype) {
@@ -0,0 +1,1364 @@
+/*
+* @file codegen.c
+* @brief x86-64 code generator
+* @details Walks node_tree_vector and emits GNU assembly for the System V ABI. Every function is lowered to the intermediate representation, taken through SSA form, where constants are propagated, arithmetic by constants and array indexing in loops strength reduced, redundant computations numbered away, loop invariants hoisted, dead code deleted and small callees inlined, and back. Static functions no call or address reachable from a global symbol refers to are dropped, the instructions of the others are selected one by one into a vector of AsmInstruction, which the peephole optimizer rewrites and which is written to the output file once the function is complete. Virtual registers live where allocate_registers put them, the spilled ones in a home in the stack frame, constants and addresses are rematerialized where they are used instead. rax, rcx and rdx are left to instruction selection as scratch registers. Global variables go to .data and .bss and string literals to .rodata.
+*/
+
+#include "compiler.h"
+#include "helpers/emitter.h"
+#include <assert.h>
+#include <stdint.h>
+#include <limits.h>
+
+#define CODEGEN_ARGUMENT_REGISTER_COUNT 6
+#define CODEGEN_STACK_SLOT_SIZE 8
+#define CODEGEN_STACK_ALIGNMENT 16
+
+typedef struct CodegenFunction{
+    IrFunction* ir;
+    DynamicVector* instructions;
+    long long* slot_offsets; //the frame offset of every stack slot that is still used
+    long long* vreg_offsets; //the frame offset of the home of every spilled virtual register, 0 for the others
+    long long saved_register_offsets[ASM_REGISTER_COUNT]; //where the prologue saves the callee saved registers the allocation uses, 0 for the others
+    RegisterAllocation* allocation;
+    int first_block_label; //the label of a block is first_block_label + its id
+    int return_label;
+    IrInstruction* fused_compare; //a compare whose flags the branch ending the block tests directly
+    bool are_parameters_moved;
+} CodegenFunction;
+
+typedef struct CodegenMove{
+    int source_vreg;
+    AsmOperand source; //ASM_OPERAND_NONE for a rematerialized source
+    AsmOperand destination;
+} CodegenMove;
+
+typedef struct CodegenStringLiteral{
+    const char* value;
+    int label;
+} CodegenStringLiteral;
+
+
+static CompileProcess* current_process;
+static CodegenFunction* current_function;
+static Emitter* codegen_emitter;
+static DynamicVector* codegen_string_literals;
+static HashTable* codegen_string_literal_labels; //maps the contents of a string literal to its label, equal literals share one
+static DynamicVector* codegen_static_locals;
+static DynamicVector* codegen_functions; //the IrFunction of every function with a body, in source order
+static HashTable* codegen_function_names; //maps the name of a function with a body to its IrFunction
+static HashTable* codegen_reachable_functions; //the functions that are emitted, reachable from a global symbol
+static DynamicVector* codegen_reachable_worklist;
+static int codegen_label_count;
+static int codegen_peephole_counts[ASM_PEEPHOLE_RULE_COUNT]; //how often every peephole rule fired in the file
+
+static const int codegen_argument_registers[CODEGEN_ARGUMENT_REGISTER_COUNT] = {ASM_REGISTER_RDI, ASM_REGISTER_RSI, ASM_REGISTER_RDX, ASM_REGISTER_RCX, ASM_REGISTER_R8, ASM_REGISTER_R9};
+
+static const int codegen_callee_saved_registers[] = {ASM_REGISTER_RBX, ASM_REGISTER_R12, ASM_REGISTER_R13, ASM_REGISTER_R14, ASM_REGISTER_R15};
+
+static const int codegen_conditions[] = {
+    [IR_CONDITION_EQ] = ASM_CONDITION_E, [IR_CONDITION_NE] = ASM_CONDITION_NE,
+    [IR_CONDITION_SLT] = ASM_CONDITION_L, [IR_CONDITION_SLE] = ASM_CONDITION_LE, [IR_CONDITION_SGT] = ASM_CONDITION_G, [IR_CONDITION_SGE] = ASM_CONDITION_GE,
+    [IR_CONDITION_ULT] = ASM_CONDITION_B, [IR_CONDITION_ULE] = ASM_CONDITION_BE, [IR_CONDITION_UGT] = ASM_CONDITION_A, [IR_CONDITION_UGE] = ASM_CONDITION_AE
+};
+
+int codegen(CompileProcess* process);
+
+const char* get_asm_register_name(int reg, int size);
+
+static void codegen_lower_top_level_node(Node* node);
+
+static IrFunction* codegen_lower_function(Node* function_node);
+
+static void codegen_reach_symbol(const char* symbol);
+
+static void codegen_reach_initializer(Node* variable_node);
+
+static void codegen_reach_references(IrFunction* ir);
+
+static void codegen_top_level_node(Node* node);
+
+static void codegen_function(Node* function_node, IrFunction* ir);
+
+static size_t codegen_layout_frame();
+
+static void codegen_block(IrBlock* block, IrBlock* next_block);
+
+static IrInstruction* codegen_find_fused_compare(IrBlock* block);
+
+static void codegen_ir_instruction(IrInstruction* instruction, IrBlock* next_block);
+
+static void codegen_parameters(IrBlock* entry);
+
+static void codegen_store_instruction(IrInstruction* instruction);
+
+static void codegen_arithmetic(IrInstruction* instruction);
+
+static void codegen_division(IrInstruction* instruction);
+
+static void codegen_shift(IrInstruction* instruction);
+
+static void codegen_compare(IrInstruction* instruction);
+
+static void codegen_extension(IrInstruction* instruction);
+
+static void codegen_call(IrInstruction* instruction);
+
+static void codegen_branch(IrInstruction* instruction, IrBlock* next_block);
+
+static void codegen_add_move(DynamicVector* moves, int vreg, AsmOperand destination);
+
+static void codegen_parallel_move(DynamicVector* moves);
+
+static void codegen_move_operand(AsmOperand source, AsmOperand destination);
+
+static IrInstruction* codegen_definition(int vreg);
+
+static bool is_codegen_rematerialized(int vreg);
+
+static int codegen_vreg_size(int vreg);
+
+static int codegen_vreg_register(int vreg);
+
+static AsmOperand codegen_vreg_location(int vreg);
+
+static int codegen_result_register(IrInstruction* instruction);
+
+static void codegen_load_vreg(int vreg, int reg);
+
+static void codegen_store_vreg(int reg, int vreg);
+
+static AsmOperand codegen_source_operand(int vreg, int scratch, int size);
+
+static AsmOperand codegen_address_operand(int vreg, int scratch, int size);
+
+static AsmOperand codegen_global_operand(IrInstruction* definition, int size);
+
+static int codegen_block_label(IrBlock* block);
+
+static int codegen_invert_condition(int condition);
+
+static void codegen_global_variable(Node* variable_node, const char* symbol, bool is_static);
+
+static void codegen_static_initializer(DataType* datatype, Node* value_node, size_t size);
+
+static bool codegen_static_address(Node* node, const char** symbol_out, long long* offset_out);
+
+static void codegen_string_literals_section();
+
+static void codegen_static_locals_section();
+
+static bool is_codegen_pointer(DataType* datatype);
+
+static bool is_codegen_aggregate(DataType* datatype);
+
+static size_t codegen_value_size(DataType* datatype);
+
+static size_t codegen_element_size(DataType* datatype);
+
+static void codegen_reject_floating_point(DataType* datatype);
+
+static int codegen_new_label();
+
+static int codegen_register_string_literal(const char* value);
+
+static void codegen_emit_escaped_string(const char* value, size_t length);
+
+static AsmOperand asm_register(int reg, int size);
+
+static AsmOperand asm_immediate(long long value);
+
+static AsmOperand asm_memory(int base, long long displacement, int size);
+
+static AsmOperand asm_symbol_memory(const char* symbol, int size);
+
+static AsmOperand asm_label(int label);
+
+static AsmOperand asm_symbol(const char* symbol);
+
+static bool is_asm_immediate_32(long long value);
+
+static void codegen_instruction(int opcode, int size, AsmOperand source, AsmOperand destination);
+
+static void codegen_condition_instruction(int opcode, int condition, AsmOperand destination);
+
+static void codegen_place_label(int label);
+
+static void codegen_push(int reg);
+
+static void codegen_adjust_stack(long long bytes);
+
+static void codegen_print_function_instructions(DynamicVector* instructions);
+
+static void codegen_print_instruction(AsmInstruction* instruction);
+
+static void codegen_print_operand(AsmOperand* operand);
+
+static const char* asm_size_suffix(int size);
+
+
+
+int codegen(CompileProcess* process){
+    current_process = process;
+    if(process->target->pointer_size != CODEGEN_STACK_SLOT_SIZE){
+        compiler_error(process, "the x86-64 backend needs the LP64 data model, got %s", process->target->name);
+    }
+    codegen_emitter = create_emitter(process->output_file);
+    codegen_string_literals = create_vector(sizeof(CodegenStringLiteral));
+    codegen_string_literal_labels = create_hash_table(0);
+    codegen_static_locals = create_vector(sizeof(IrStaticLocal));
+    codegen_functions = create_vector(sizeof(IrFunction*));
+    codegen_function_names = create_hash_table(0);
+    codegen_reachable_functions = create_hash_table(0);
+    codegen_reachable_worklist = create_vector(sizeof(IrFunction*));
+    codegen_label_count = 0;
+    memset(codegen_peephole_counts, 0, sizeof(codegen_peephole_counts));
+    vector_for_each(Node*, node, process->node_tree_vector){
+        codegen_lower_top_level_node(*node);
+    }
+    if(!(process->flags & COMPILE_PROCESS_FLAG_NO_INLINE)){
+        ir_inline_functions(codegen_functions);
+    }
+    //a static function nothing outside of the unreachable ones refers to is never called
+    vector_for_each(IrFunction*, ir, codegen_functions){
+        if(!((*ir)->function_node->data.function.return_type->flags & DATATYPE_FLAG_IS_STATIC)){
+            codegen_reach_symbol((*ir)->name);
+        }
+    }
+    while(!is_vector_empty(codegen_reachable_worklist)){
+        codegen_reach_references(vector_IrFunctionPtr_pop(codegen_reachable_worklist));
+    }
+    vector_for_each(Node*, node, process->node_tree_vector){
+        codegen_top_level_node(*node);
+    }
+    codegen_static_locals_section();
+    codegen_string_literals_section();
+    emit_string(codegen_emitter, "\t.section .note.GNU-stack,\"\",@progbits\n");
+    if(process->flags & COMPILE_PROCESS_FLAG_DUMP_PEEPHOLE){
+        asm_dump_peephole_counts(codegen_peephole_counts, stdout);
+    }
+    int result = flush_emitter(codegen_emitter);
+    free_emitter(codegen_emitter);
+    destroy_vector(codegen_string_literals);
+    destroy_hash_table(codegen_string_literal_labels);
+    destroy_vector(codegen_static_locals);
+    vector_for_each(IrFunction*, ir, codegen_functions){
+        ir_free_function(*ir);
+    }
+    destroy_vector(codegen_functions);
+    destroy_hash_table(codegen_function_names);
+    destroy_hash_table(codegen_reachable_functions);
+    destroy_vector(codegen_reachable_worklist);
+    return result == 0 ? CODEGEN_ALL_OK : CODEGEN_GENERAL_ERROR;
+}
+
+const char* get_asm_register_name(int reg, int size){
+    static const char* names[ASM_REGISTER_COUNT][4] = {
+        {"al", "ax", "eax", "rax"}, {"cl", "cx", "ecx", "rcx"}, {"dl", "dx", "edx", "rdx"}, {"bl", "bx", "ebx", "rbx"},
+        {"spl", "sp", "esp", "rsp"}, {"bpl", "bp", "ebp", "rbp"}, {"sil", "si", "esi", "rsi"}, {"dil", "di", "edi", "rdi"},
+        {"r8b", "r8w", "r8d", "r8"}, {"r9b", "r9w", "r9d", "r9"}, {"r10b", "r10w", "r10d", "r10"}, {"r11b", "r11w", "r11d", "r11"},
+        {"r12b", "r12w", "r12d", "r12"}, {"r13b", "r13w", "r13d", "r13"}, {"r14b", "r14w", "r14d", "r14"}, {"r15b", "r15w", "r15d", "r15"},
+        {"rip", "rip", "rip", "rip"}
+    };
+    assert(reg >= 0 && reg < ASM_REGISTER_COUNT);
+    switch(size){
+        case 1:
+            return names[reg][0];
+        case 2:
+            return names[reg][1];
+        case 4:
+            return names[reg][2];
+    }
+    return names[reg][3];
+}
+
+// Lowers every function ahead of emitting anything, so it is known which static functions are called. The initializers of global variables are references from outside of any function.
+static void codegen_lower_top_level_node(Node* node){
+    switch(node->type){
+        case NODE_TYPE_FUNCTION:
+            if(node->data.function.body_node){
+                IrFunction* ir = codegen_lower_function(node);
+                vector_IrFunctionPtr_push(codegen_functions, ir);
+                hash_table_put(codegen_function_names, ir->name, ir);
+            }
+            break;
+        case NODE_TYPE_VARIABLE:
+            codegen_reach_initializer(node);
+            break;
+        case NODE_TYPE_VARIABLE_LIST:
+            vector_for_each(Node*, variable_node, node->data.variable_list.variables){
+                codegen_lower_top_level_node(*variable_node);
+            }
+            break;
+        case NODE_TYPE_STRUCT:
+            if(node->flags & NODE_FLAG_HAS_VARIABLE_COMBINED){
+                codegen_lower_top_level_node(node->data.structure.variable);
+            }
+            break;
+        case NODE_TYPE_UNION:
+            if(node->flags & NODE_FLAG_HAS_VARIABLE_COMBINED){
+                codegen_lower_top_level_node(node->data.Union.variable);
+            }
+            break;
+    }
+}
+
+// Lowers the function to SSA form and optimizes it. It stays in SSA form for the inliner.
+static IrFunction* codegen_lower_function(Node* function_node){
+    IrFunction* ir = ir_build_function(current_process, function_node);
+    ir_construct_ssa(ir);
+    ir_optimize_function(ir);
+    return ir;
+}
+
+// Marks the function named symbol as emitted, symbols of globals and external functions are ignored.
+static void codegen_reach_symbol(const char* symbol){
+    IrFunction* ir = hash_table_get(codegen_function_names, symbol);
+    if(!ir || hash_table_contains(codegen_reachable_functions, symbol)){
+        return;
+    }
+    hash_table_put(codegen_reachable_functions, symbol, ir);
+    vector_IrFunctionPtr_push(codegen_reachable_worklist, ir);
+}
+
+static void codegen_reach_initializer(Node* variable_node){
+    Node* value_node = variable_node->data.var.value;
+    while(value_node && value_node->type == NODE_TYPE_EXPRESSION_PARENTHESES){
+        value_node = value_node->data.parentheses.expression;
+    }
+    const char* symbol = NULL;
+    long long offset = 0;
+    if(value_node && codegen_static_address(value_node, &symbol, &offset)){
+        codegen_reach_symbol(symbol);
+    }
+}
+
+// The functions a reachable function calls or takes the address of, directly or in the initializer of one of its static locals, are reachable too.
+static void codegen_reach_references(IrFunction* ir){
+    vector_for_each(IrBlock*, block, ir->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            bool is_reference = (*instruction)->opcode == IR_OP_CALL || ((*instruction)->opcode == IR_OP_GLOBAL_ADDRESS && !((*instruction)->flags & IR_INSTRUCTION_FLAG_STRING_LITERAL));
+            if(is_reference){
+                codegen_reach_symbol((*instruction)->symbol);
+            }
+        }
+    }
+    vector_for_each(IrStaticLocal, local, ir->static_locals){
+        codegen_reach_initializer(local->variable_node);
+    }
+}
+
+// Only reachable functions, variables and the variables declared together with a struct or union produce output.
+static void codegen_top_level_node(Node* node){
+    IrFunction* ir = NULL;
+    switch(node->type){
+        case NODE_TYPE_FUNCTION:
+            ir = node->data.function.body_node ? hash_table_get(codegen_reachable_functions, node->data.function.name) : NULL;
+            if(ir){
+                codegen_function(node, ir);
+            }
+            break;
+        case NODE_TYPE_VARIABLE:
+            codegen_global_variable(node, node->data.var.name, node->data.var.data_type->flags & DATATYPE_FLAG_IS_STATIC);
+            break;
+        case NODE_TYPE_VARIABLE_LIST:
+            vector_for_each(Node*, variable_node, node->data.variable_list.variables){
+                codegen_top_level_node(*variable_node);
+            }
+            break;
+        case NODE_TYPE_STRUCT:
+            if(node->flags & NODE_FLAG_HAS_VARIABLE_COMBINED){
+                codegen_top_level_node(node->data.structure.variable);
+            }
+            break;
+        case NODE_TYPE_UNION:
+            if(node->flags & NODE_FLAG_HAS_VARIABLE_COMBINED){
+                codegen_top_level_node(node->data.Union.variable);
+            }
+            break;
+    }
+}
+
+// Takes the optimized function out of SSA form, allocates registers, selects its instructions block by block, cleans them up with the peephole optimizer and writes them out.
+static void codegen_function(Node* function_node, IrFunction* ir){
+    ir_verify_function(current_process, ir);
+    if(current_process->flags & COMPILE_PROCESS_FLAG_DUMP_IR){
+        ir_dump_function(ir, stdout);
+    }
+    ir_destruct_ssa(ir);
+    vector_for_each(IrStaticLocal, local, ir->static_locals){
+        push_element(codegen_static_locals, local);
+    }
+
+    CodegenFunction function = {};
+    function.ir = ir;
+    function.instructions = create_vector(sizeof(AsmInstruction));
+    function.first_block_label = codegen_label_count + 1;
+    codegen_label_count += ir->next_block_id;
+    function.return_label = codegen_new_label();
+    current_function = &function;
+    function.allocation = allocate_registers(ir);
+    size_t frame_size = codegen_layout_frame();
+    function_node->data.function.stack_size = frame_size;
+
+    codegen_instruction(ASM_OPCODE_PUSH, 8, (AsmOperand){}, asm_register(ASM_REGISTER_RBP, 8));
+    codegen_instruction(ASM_OPCODE_MOV, 8, asm_register(ASM_REGISTER_RSP, 8), asm_register(ASM_REGISTER_RBP, 8));
+    if(frame_size){
+        codegen_instruction(ASM_OPCODE_SUB, 8, asm_immediate(frame_size), asm_register(ASM_REGISTER_RSP, 8));
+    }
+    for(int reg = 0; reg < ASM_REGISTER_COUNT; reg++){
+        if(function.saved_register_offsets[reg]){
+            codegen_instruction(ASM_OPCODE_MOV, 8, asm_register(reg, 8), asm_memory(ASM_REGISTER_RBP, function.saved_register_offsets[reg], 8));
+        }
+    }
+    int block_count = get_element_count(ir->blocks);
+    for(int i = 0; i < block_count; i++){
+        codegen_block(vector_IrBlockPtr_at(ir->blocks, i), i + 1 < block_count ? vector_IrBlockPtr_at(ir->blocks, i + 1) : NULL);
+    }
+    codegen_place_label(function.return_label);
+    for(int reg = 0; reg < ASM_REGISTER_COUNT; reg++){
+        if(function.saved_register_offsets[reg]){
+            codegen_instruction(ASM_OPCODE_MOV, 8, asm_memory(ASM_REGISTER_RBP, function.saved_register_offsets[reg], 8), asm_register(reg, 8));
+        }
+    }
+    codegen_instruction(ASM_OPCODE_LEAVE, 8, (AsmOperand){}, (AsmOperand){});
+    codegen_instruction(ASM_OPCODE_RET, 8, (AsmOperand){}, (AsmOperand){});
+    asm_optimize_peephole(function.instructions, codegen_peephole_counts);
+
+    const char* name = function_node->data.function.name;
+    emit_string(codegen_emitter, "\t.text\n");
+    if(!(function_node->data.function.return_type->flags & DATATYPE_FLAG_IS_STATIC)){
+        emit_formatted(codegen_emitter, "\t.globl %s\n", name);
+    }
+    emit_formatted(codegen_emitter, "\t.type %s, @function\n%s:\n", name, name);
+    codegen_print_function_instructions(function.instructions);
+    emit_formatted(codegen_emitter, "\t.size %s, .-%s\n", name, name);
+
+    destroy_vector(function.instructions);
+    free(function.slot_offsets);
+    free(function.vreg_offsets);
+    free_register_allocation(function.allocation);
+    current_function = NULL;
+}
+
+// Places the stack slots that are still used below rbp, then the callee saved registers the allocation uses and an 8 byte home for every spilled virtual register.
+static size_t codegen_layout_frame(){
+    IrFunction* ir = current_function->ir;
+    int slot_count = get_element_count(ir->slots);
+    int vreg_count = ir_get_vreg_count(ir);
+    current_function->slot_offsets = calloc(slot_count + 1, sizeof(long long));
+    current_function->vreg_offsets = calloc(vreg_count + 1, sizeof(long long));
+    long long offset = 0;
+    for(int i = 0; i < slot_count; i++){
+        IrStackSlot* slot = get_element_at(ir->slots, i);
+        if(slot->flags & (IR_STACK_SLOT_FLAG_PROMOTED | IR_STACK_SLOT_FLAG_UNUSED)){
+            continue;
+        }
+        offset = get_align_value(offset + slot->size, slot->alignment);
+        current_function->slot_offsets[i] = -offset;
+    }
+    offset = get_align_value(offset, CODEGEN_STACK_SLOT_SIZE);
+    for(int i = 0; i < (int)(sizeof(codegen_callee_saved_registers) / sizeof(int)); i++){
+        int reg = codegen_callee_saved_registers[i];
+        if(current_function->allocation->used_registers & (1 << reg)){
+            offset += CODEGEN_STACK_SLOT_SIZE;
+            current_function->saved_register_offsets[reg] = -offset;
+        }
+    }
+    for(int vreg = 0; vreg < vreg_count; vreg++){
+        if(!codegen_definition(vreg) || is_codegen_rematerialized(vreg) || codegen_vreg_register(vreg) != ASM_REGISTER_NONE){
+            continue;
+        }
+        offset += CODEGEN_STACK_SLOT_SIZE;
+        current_function->vreg_offsets[vreg] = -offset;
+    }
+    return get_align_value(offset, CODEGEN_STACK_ALIGNMENT);
+}
+
+static void codegen_block(IrBlock* block, IrBlock* next_block){
+    codegen_place_label(codegen_block_label(block));
+    current_function->fused_compare = codegen_find_fused_compare(block);
+    vector_for_each(IrInstruction*, instruction, block->instructions){
+        codegen_ir_instruction(*instruction, next_block);
+    }
+}
+
+// A compare only feeding the branch at the end of its block leaves its result in the flags, if nothing between the two changes them. Copies and rematerialized values are only moves.
+static IrInstruction* codegen_find_fused_compare(IrBlock* block){
+    IrInstruction* terminator = ir_get_terminator(block);
+    if(!terminator || terminator->opcode != IR_OP_BRANCH){
+        return NULL;
+    }
+    IrInstruction* compare = codegen_definition(terminator->operands[0]);
+    DynamicVector* users = vector_VoidPtr_at(current_function->ir->uses, terminator->operands[0]);
+    if(!compare || compare->opcode != IR_OP_CMP || compare->block != block || get_element_count(users) != 1){
+        return NULL;
+    }
+    for(int i = get_element_count(block->instructions) - 2; i >= 0; i--){
+        IrInstruction* instruction = vector_IrInstructionPtr_at(block->instructions, i);
+        if(instruction == compare){
+            return compare;
+        }
+        if(instruction->opcode != IR_OP_COPY && !is_codegen_rematerialized(instruction->result)){
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static void codegen_ir_instruction(IrInstruction* instruction, IrBlock* next_block){
+    switch(instruction->opcode){
+        case IR_OP_CONST:
+        case IR_OP_SLOT_ADDRESS:
+        case IR_OP_GLOBAL_ADDRESS:
+        case IR_OP_UNDEF:
+            //rematerialized where they are used, an undefined value is whatever the register it is read into holds
+            break;
+        case IR_OP_COPY:
+        case IR_OP_TRUNC:{
+            //the low bytes of the source are the truncated value
+            int reg = codegen_result_register(instruction);
+            codegen_load_vreg(instruction->operands[0], reg);
+            codegen_store_vreg(reg, instruction->result);
+            break;
+        }
+        case IR_OP_PARAM:
+            if(!current_function->are_parameters_moved){
+                codegen_parameters(instruction->block);
+            }
+            break;
+        case IR_OP_LOAD:{
+            int size = ir_type_size(instruction->type);
+            int reg = codegen_result_register(instruction);
+            codegen_instruction(ASM_OPCODE_MOV, size, codegen_address_operand(instruction->operands[0], ASM_REGISTER_RCX, size), asm_register(reg, size));
+            codegen_store_vreg(reg, instruction->result);
+            break;
+        }
+        case IR_OP_STORE:
+            codegen_store_instruction(instruction);
+            break;
+        case IR_OP_MEMCOPY:{
+            DynamicVector* moves = create_vector(sizeof(CodegenMove));
+            codegen_add_move(moves, instruction->operands[0], asm_register(ASM_REGISTER_RDI, 8));
+            codegen_add_move(moves, instruction->operands[1], asm_register(ASM_REGISTER_RSI, 8));
+            codegen_parallel_move(moves);
+            destroy_vector(moves);
+            codegen_instruction(ASM_OPCODE_MOV, 8, asm_immediate(instruction->immediate), asm_register(ASM_REGISTER_RCX, 8));
+            codegen_instruction(ASM_OPCODE_REP_MOVSB, 1, (AsmOperand){}, (AsmOperand){});
+            break;
+        }
+        case IR_OP_ADD:
+        case IR_OP_SUB:
+        case IR_OP_MUL:
+        case IR_OP_AND:
+        case IR_OP_OR:
+        case IR_OP_XOR:
+        case IR_OP_NEG:
+        case IR_OP_NOT:
+            codegen_arithmetic(instruction);
+            break;
+        case IR_OP_SDIV:
+        case IR_OP_UDIV:
+        case IR_OP_SREM:
+        case IR_OP_UREM:
+            codegen_division(instruction);
+            break;
+        case IR_OP_SHL:
+        case IR_OP_SAR:
+        case IR_OP_SHR:
+            codegen_shift(instruction);
+            break;
+        case IR_OP_CMP:
+            codegen_compare(instruction);
+            break;
+        case IR_OP_SEXT:
+        case IR_OP_ZEXT:
+            codegen_extension(instruction);
+            break;
+        case IR_OP_CALL:
+            codegen_call(instruction);
+            break;
+        case IR_OP_RETURN:
+            if(instruction->operands[0] != IR_VREG_NONE){
+                codegen_load_vreg(instruction->operands[0], ASM_REGISTER_RAX);
+            }
+            if(next_block){
+                codegen_instruction(ASM_OPCODE_JMP, 8, (AsmOperand){}, asm_label(current_function->return_label));
+            }
+            break;
+        case IR_OP_JUMP:
+            if(instruction->targets[0] != next_block){
+                codegen_instruction(ASM_OPCODE_JMP, 8, (AsmOperand){}, asm_label(codegen_block_label(instruction->targets[0])));
+            }
+            break;
+        case IR_OP_BRANCH:
+            codegen_branch(instruction, next_block);
+            break;
+        default:
+            compiler_error(current_process, "BUG: the x86-64 backend can't select IR opcode %i", instruction->opcode);
+    }
+}
+
+// Moves every parameter of the entry block to its location at once, the first six arrive in registers the allocation may have given to other parameters, the rest above the return address.
+static void codegen_parameters(IrBlock* entry){
+    DynamicVector* moves = create_vector(sizeof(CodegenMove));
+    vector_for_each(IrInstruction*, instruction, entry->instructions){
+        if((*instruction)->opcode != IR_OP_PARAM){
+            continue;
+        }
+        int index = (*instruction)->immediate;
+        int size = ir_type_size((*instruction)->type);
+        CodegenMove move = {.source_vreg = IR_VREG_NONE, .destination = codegen_vreg_location((*instruction)->result)};
+        if(index < CODEGEN_ARGUMENT_REGISTER_COUNT){
+            move.source = asm_register(codegen_argument_registers[index], size);
+        }
+        else{
+            move.source = asm_memory(ASM_REGISTER_RBP, 2 * CODEGEN_STACK_SLOT_SIZE + (index - CODEGEN_ARGUMENT_REGISTER_COUNT) * CODEGEN_STACK_SLOT_SIZE, size);
+        }
+        push_element(moves, &move);
+    }
+    codegen_parallel_move(moves);
+    destroy_vector(moves);
+    current_function->are_parameters_moved = true;
+}
+
+static void codegen_store_instruction(IrInstruction* instruction){
+    int size = ir_type_size(instruction->type);
+    AsmOperand destination = codegen_address_operand(instruction->operands[0], ASM_REGISTER_RCX, size);
+    IrInstruction* value = codegen_definition(instruction->operands[1]);
+    if(value && value->opcode == IR_OP_CONST && is_asm_immediate_32(value->immediate)){
+        codegen_instruction(ASM_OPCODE_MOV, size, asm_immediate(value->immediate), destination);
+        return;
+    }
+    int reg = codegen_vreg_register(instruction->operands[1]);
+    if(reg == ASM_REGISTER_NONE){
+        reg = ASM_REGISTER_RAX;
+        codegen_load_vreg(instruction->operands[1], reg);
+    }
+    codegen_instruction(ASM_OPCODE_MOV, size, asm_register(reg, size), destination);
+}
+
+// Two operand arithmetic computed in the register of the result, or in rax. 8 and 16 bit values are computed 32 bits wide since only their low bits are defined.
+static void codegen_arithmetic(IrInstruction* instruction){
+    static const int opcodes[IR_OP_COUNT] = {
+        [IR_OP_ADD] = ASM_OPCODE_ADD, [IR_OP_SUB] = ASM_OPCODE_SUB, [IR_OP_MUL] = ASM_OPCODE_IMUL, [IR_OP_AND] = ASM_OPCODE_AND,
+        [IR_OP_OR] = ASM_OPCODE_OR, [IR_OP_XOR] = ASM_OPCODE_XOR, [IR_OP_NEG] = ASM_OPCODE_NEG, [IR_OP_NOT] = ASM_OPCODE_NOT
+    };
+    int size = ir_type_size(instruction->type) < 4 ? 4 : ir_type_size(instruction->type);
+    int reg = codegen_result_register(instruction);
+    if(instruction->operands[1] != IR_VREG_NONE && reg == codegen_vreg_register(instruction->operands[1])){
+        //loading the left operand would overwrite the right one
+        reg = ASM_REGISTER_RAX;
+    }
+    codegen_load_vreg(instruction->operands[0], reg);
+    if(instruction->operands[1] == IR_VREG_NONE){
+        codegen_instruction(opcodes[instruction->opcode], size, (AsmOperand){}, asm_register(reg, size));
+    }
+    else{
+        codegen_instruction(opcodes[instruction->opcode], size, codegen_source_operand(instruction->operands[1], ASM_REGISTER_RCX, size), asm_register(reg, size));
+    }
+    codegen_store_vreg(reg, instruction->result);
+}
+
+// Divides rdx:rax by rcx, the quotient ends up in rax and the remainder in rdx.
+static void codegen_division(IrInstruction* instruction){
+    int size = ir_type_size(instruction->type);
+    codegen_load_vreg(instruction->operands[0], ASM_REGISTER_RAX);
+    codegen_load_vreg(instruction->operands[1], ASM_REGISTER_RCX);
+    if(instruction->opcode == IR_OP_UDIV || instruction->opcode == IR_OP_UREM){
+        codegen_instruction(ASM_OPCODE_XOR, 4, asm_register(ASM_REGISTER_RDX, 4), asm_register(ASM_REGISTER_RDX, 4));
+        codegen_instruction(ASM_OPCODE_DIV, size, (AsmOperand){}, asm_register(ASM_REGISTER_RCX, size));
+    }
+    else{
+        codegen_instruction(ASM_OPCODE_CQO, size, (AsmOperand){}, (AsmOperand){});
+        codegen_instruction(ASM_OPCODE_IDIV, size, (AsmOperand){}, asm_register(ASM_REGISTER_RCX, size));
+    }
+    bool is_remainder = instruction->opcode == IR_OP_SREM || instruction->opcode == IR_OP_UREM;
+    codegen_store_vreg(is_remainder ? ASM_REGISTER_RDX : ASM_REGISTER_RAX, instruction->result);
+}
+
+// Shift counts that are not constant have to be in cl.
+static void codegen_shift(IrInstruction* instruction){
+    static const int opcodes[IR_OP_COUNT] = {[IR_OP_SHL] = ASM_OPCODE_SHL, [IR_OP_SAR] = ASM_OPCODE_SAR, [IR_OP_SHR] = ASM_OPCODE_SHR};
+    int size = ir_type_size(instruction->type) < 4 ? 4 : ir_type_size(instruction->type);
+    int reg = codegen_result_register(instruction);
+    if(reg == codegen_vreg_register(instruction->operands[1])){
+        reg = ASM_REGISTER_RAX;
+    }
+    codegen_load_vreg(instruction->operands[0], reg);
+    IrInstruction* count = codegen_definition(instruction->operands[1]);
+    if(count && count->opcode == IR_OP_CONST){
+        codegen_instruction(opcodes[instruction->opcode], size, asm_immediate(count->immediate & (size * 8 - 1)), asm_register(reg, size));
+    }
+    else{
+        codegen_load_vreg(instruction->operands[1], ASM_REGISTER_RCX);
+        codegen_instruction(opcodes[instruction->opcode], size, asm_register(ASM_REGISTER_RCX, 1), asm_register(reg, size));
+    }
+    codegen_store_vreg(reg, instruction->result);
+}
+
+// Compares in the width of the operands, a fused compare leaves its result in the flags for the branch.
+static void codegen_compare(IrInstruction* instruction){
+    int size = codegen_vreg_size(instruction->operands[0]);
+    int left = codegen_vreg_register(instruction->operands[0]);
+    if(left == ASM_REGISTER_NONE){
+        left = ASM_REGISTER_RAX;
+        codegen_load_vreg(instruction->operands[0], left);
+    }
+    codegen_instruction(ASM_OPCODE_CMP, size, codegen_source_operand(instruction->operands[1], ASM_REGISTER_RCX, size), asm_register(left, size));
+    if(instruction == current_function->fused_compare){
+        return;
+    }
+    int reg = codegen_result_register(instruction);
+    codegen_condition_instruction(ASM_OPCODE_SETCC, codegen_conditions[instruction->condition], asm_register(reg, 1));
+    codegen_instruction(ASM_OPCODE_MOVZX, 4, asm_register(reg, 1), asm_register(reg, 4));
+    codegen_store_vreg(reg, instruction->result);
+}
+
+// Extends from the width of the operand to the width of the result, writing a 32 bit register clears the upper half.
+static void codegen_extension(IrInstruction* instruction){
+    int from = codegen_vreg_size(instruction->operands[0]);
+    int to = ir_type_size(instruction->type);
+    int reg = codegen_result_register(instruction);
+    AsmOperand source = asm_register(ASM_REGISTER_RAX, from);
+    if(is_codegen_rematerialized(instruction->operands[0])){
+        codegen_load_vreg(instruction->operands[0], ASM_REGISTER_RAX);
+    }
+    else{
+        source = codegen_vreg_location(instruction->operands[0]);
+    }
+    if(instruction->opcode == IR_OP_SEXT){
+        codegen_instruction(ASM_OPCODE_MOVSX, to, source, asm_register(reg, to));
+    }
+    else if(from == 4){
+        codegen_instruction(ASM_OPCODE_MOV, 4, source, asm_register(reg, 4));
+    }
+    else{
+        codegen_instruction(ASM_OPCODE_MOVZX, 4, source, asm_register(reg, 4));
+    }
+    codegen_store_vreg(reg, instruction->result);
+}
+
+// Arguments past the sixth are pushed right to left, padded so rsp stays 16 byte aligned at the call, the first six are moved into the argument registers together.
+static void codegen_call(IrInstruction* instruction){
+    DynamicVector* arguments = instruction->arguments;
+    int argument_count = get_element_count(arguments);
+    int stack_argument_count = argument_count > CODEGEN_ARGUMENT_REGISTER_COUNT ? argument_count - CODEGEN_ARGUMENT_REGISTER_COUNT : 0;
+    int padding = (stack_argument_count * CODEGEN_STACK_SLOT_SIZE) % CODEGEN_STACK_ALIGNMENT;
+    if(padding){
+        codegen_adjust_stack(-padding);
+    }
+    for(int i = argument_count - 1; i >= CODEGEN_ARGUMENT_REGISTER_COUNT; i--){
+        int reg = codegen_vreg_register(vector_Int_at(arguments, i));
+        if(reg == ASM_REGISTER_NONE){
+            reg = ASM_REGISTER_RAX;
+            codegen_load_vreg(vector_Int_at(arguments, i), reg);
+        }
+        codegen_push(reg);
+    }
+    DynamicVector* moves = create_vector(sizeof(CodegenMove));
+    for(int i = 0; i < argument_count && i < CODEGEN_ARGUMENT_REGISTER_COUNT; i++){
+        codegen_add_move(moves, vector_Int_at(arguments, i), asm_register(codegen_argument_registers[i], 8));
+    }
+    codegen_parallel_move(moves);
+    destroy_vector(moves);
+    if(instruction->flags & IR_INSTRUCTION_FLAG_VARIADIC_CALL){
+        //al holds the number of vector registers used by a variadic call
+        codegen_instruction(ASM_OPCODE_MOV, 4, asm_immediate(0), asm_register(ASM_REGISTER_RAX, 4));
+    }
+    codegen_instruction(ASM_OPCODE_CALL, 8, (AsmOperand){}, asm_symbol(instruction->symbol));
+    if(stack_argument_count * CODEGEN_STACK_SLOT_SIZE + padding){
+        codegen_adjust_stack(stack_argument_count * CODEGEN_STACK_SLOT_SIZE + padding);
+    }
+    if(instruction->result != IR_VREG_NONE){
+        codegen_store_vreg(ASM_REGISTER_RAX, instruction->result);
+    }
+}
+
+// Jumps to the true target when the condition holds, the target laid out next is reached by falling through.
+static void codegen_branch(IrInstruction* instruction, IrBlock* next_block){
+    int condition = ASM_CONDITION_NE;
+    if(current_function->fused_compare){
+        condition = codegen_conditions[current_function->fused_compare->condition];
+    }
+    else{
+        int size = codegen_vreg_size(instruction->operands[0]);
+        int reg = codegen_vreg_register(instruction->operands[0]);
+        if(reg == ASM_REGISTER_NONE){
+            reg = ASM_REGISTER_RAX;
+            codegen_load_vreg(instruction->operands[0], reg);
+        }
+        codegen_instruction(ASM_OPCODE_TEST, size, asm_register(reg, size), asm_register(reg, size));
+    }
+    IrBlock* true_block = instruction->targets[0];
+    IrBlock* false_block = instruction->targets[1];
+    if(true_block == next_block){
+        codegen_condition_instruction(ASM_OPCODE_JCC, codegen_invert_condition(condition), asm_label(codegen_block_label(false_block)));
+        return;
+    }
+    codegen_condition_instruction(ASM_OPCODE_JCC, condition, asm_label(codegen_block_label(true_block)));
+    if(false_block != next_block){
+        codegen_instruction(ASM_OPCODE_JMP, 8, (AsmOperand){}, asm_label(codegen_block_label(false_block)));
+    }
+}
+
+static void codegen_add_move(DynamicVector* moves, int vreg, AsmOperand destination){
+    CodegenMove move = {.source_vreg = vreg, .destination = destination};
+    if(!is_codegen_rematerialized(vreg)){
+        move.source = codegen_vreg_location(vreg);
+    }
+    push_element(moves, &move);
+}
+
+// Performs the moves as if they happened at the same time. Register sources go first, a move may only overwrite a register no other pending move still reads, cycles are broken through rax. Memory and rematerialized sources can't be overwritten and follow.
+static void codegen_parallel_move(DynamicVector* moves){
+    DynamicVector* pending = create_vector(sizeof(CodegenMove));
+    vector_for_each(CodegenMove, move, moves){
+        bool is_in_place = move->destination.type == ASM_OPERAND_REGISTER && move->source.type == ASM_OPERAND_REGISTER && move->source.reg == move->destination.reg;
+        if(move->source.type == ASM_OPERAND_REGISTER && !is_in_place){
+            push_element(pending, move);
+        }
+    }
+    while(!is_vector_empty(pending)){
+        int ready = -1;
+        for(int i = 0; i < get_element_count(pending) && ready < 0; i++){
+            CodegenMove* move = get_element_at(pending, i);
+            ready = i;
+            vector_for_each(CodegenMove, other, pending){
+                if(other != move && move->destination.type == ASM_OPERAND_REGISTER && other->source.reg == move->destination.reg){
+                    ready = -1;
+                    break;
+                }
+            }
+        }
+        if(ready < 0){
+            //every destination is still read by another move, park one source in rax
+            int parked = ((CodegenMove*)get_element_at(pending, 0))->source.reg;
+            codegen_instruction(ASM_OPCODE_MOV, 8, asm_register(parked, 8), asm_register(ASM_REGISTER_RAX, 8));
+            vector_for_each(CodegenMove, move, pending){
+                if(move->source.reg == parked){
+                    move->source.reg = ASM_REGISTER_RAX;
+                }
+            }
+            continue;
+        }
+        CodegenMove* move = get_element_at(pending, ready);
+        codegen_move_operand(move->source, move->destination);
+        remove_element_at(pending, ready);
+    }
+    destroy_vector(pending);
+    vector_for_each(CodegenMove, move, moves){
+        if(move->source.type == ASM_OPERAND_NONE){
+            codegen_load_vreg(move->source_vreg, move->destination.reg);
+        }
+        else if(move->source.type != ASM_OPERAND_REGISTER){
+            codegen_move_operand(move->source, move->destination);
+        }
+    }
+}
+
+// A move between registers and memory, memory to memory goes through rax. Registers are moved whole, the width of a memory operand decides the others.
+static void codegen_move_operand(AsmOperand source, AsmOperand destination){
+    if(source.type == ASM_OPERAND_REGISTER && destination.type == ASM_OPERAND_REGISTER){
+        codegen_instruction(ASM_OPCODE_MOV, 8, asm_register(source.reg, 8), asm_register(destination.reg, 8));
+    }
+    else if(source.type == ASM_OPERAND_REGISTER){
+        codegen_instruction(ASM_OPCODE_MOV, destination.size, asm_register(source.reg, destination.size), destination);
+    }
+    else if(destination.type == ASM_OPERAND_REGISTER){
+        codegen_instruction(ASM_OPCODE_MOV, source.size, source, asm_register(destination.reg, source.size));
+    }
+    else{
+        codegen_instruction(ASM_OPCODE_MOV, source.size, source, asm_register(ASM_REGISTER_RAX, source.size));
+        codegen_instruction(ASM_OPCODE_MOV, destination.size, asm_register(ASM_REGISTER_RAX, destination.size), destination);
+    }
+}
+
+static IrInstruction* codegen_definition(int vreg){
+    if(vreg == IR_VREG_NONE){
+        return NULL;
+    }
+    return vector_IrInstructionPtr_at(current_function->ir->definitions, vreg);
+}
+
+// Constants and addresses are recomputed at every use instead of taking a register or a home in the frame.
+static bool is_codegen_rematerialized(int vreg){
+    IrInstruction* definition = codegen_definition(vreg);
+    return definition && is_ir_rematerializable(definition);
+}
+
+static int codegen_vreg_size(int vreg){
+    return ir_type_size(ir_get_vreg_type(current_function->ir, vreg));
+}
+
+// The register allocated to a virtual register, ASM_REGISTER_NONE if it lives in its home or is rematerialized.
+static int codegen_vreg_register(int vreg){
+    if(vreg == IR_VREG_NONE){
+        return ASM_REGISTER_NONE;
+    }
+    return current_function->allocation->registers[vreg];
+}
+
+// The register or frame home of a virtual register that is not rematerialized, in the width of its type.
+static AsmOperand codegen_vreg_location(int vreg){
+    int reg = codegen_vreg_register(vreg);
+    if(reg != ASM_REGISTER_NONE){
+        return asm_register(reg, codegen_vreg_size(vreg));
+    }
+    assert(current_function->vreg_offsets[vreg]);
+    return asm_memory(ASM_REGISTER_RBP, current_function->vreg_offsets[vreg], codegen_vreg_size(vreg));
+}
+
+// The register an instruction computes its result in, the allocated one or rax for spilled results.
+static int codegen_result_register(IrInstruction* instruction){
+    int reg = codegen_vreg_register(instruction->result);
+    return reg == ASM_REGISTER_NONE ? ASM_REGISTER_RAX : reg;
+}
+
+// Moves the value of a virtual register into the low bytes of reg, what is above them is unspecified.
+static void codegen_load_vreg(int vreg, int reg){
+    IrInstruction* definition = codegen_definition(vreg);
+    int size = codegen_vreg_size(vreg);
+    if(definition && definition->opcode == IR_OP_CONST){
+        codegen_instruction(ASM_OPCODE_MOV, size < 4 ? 4 : size, asm_immediate(definition->immediate), asm_register(reg, size < 4 ? 4 : size));
+        return;
+    }
+    if(definition && definition->opcode == IR_OP_SLOT_ADDRESS){
+        codegen_instruction(ASM_OPCODE_LEA, 8, asm_memory(ASM_REGISTER_RBP, current_function->slot_offsets[definition->slot], 8), asm_register(reg, 8));
+        return;
+    }
+    if(definition && definition->opcode == IR_OP_GLOBAL_ADDRESS){
+        codegen_instruction(ASM_OPCODE_LEA, 8, codegen_global_operand(definition, 8), asm_register(reg, 8));
+        return;
+    }
+    if(definition && definition->opcode == IR_OP_UNDEF){
+        return;
+    }
+    if(codegen_vreg_register(vreg) != reg){
+        codegen_move_operand(codegen_vreg_location(vreg), asm_register(reg, size));
+    }
+}
+
+static void codegen_store_vreg(int reg, int vreg){
+    if(codegen_vreg_register(vreg) != reg){
+        codegen_move_operand(asm_register(reg, codegen_vreg_size(vreg)), codegen_vreg_location(vreg));
+    }
+}
+
+// The right operand of a two operand instruction of the given width, small constants are immediates and locations of the same width are used in place.
+static AsmOperand codegen_source_operand(int vreg, int scratch, int size){
+    IrInstruction* definition = codegen_definition(vreg);
+    if(definition && definition->opcode == IR_OP_CONST && is_asm_immediate_32(definition->immediate)){
+        return asm_immediate(definition->immediate);
+    }
+    if(!is_codegen_rematerialized(vreg) && codegen_vreg_size(vreg) == size){
+        return codegen_vreg_location(vreg);
+    }
+    if(codegen_vreg_register(vreg) != ASM_REGISTER_NONE){
+        return asm_register(codegen_vreg_register(vreg), size);
+    }
+    codegen_load_vreg(vreg, scratch);
+    return asm_register(scratch, size);
+}
+
+// The memory an address register points to, slot and global addresses are folded into the operand.
+static AsmOperand codegen_address_operand(int vreg, int scratch, int size){
+    IrInstruction* definition = codegen_definition(vreg);
+    if(definition && definition->opcode == IR_OP_SLOT_ADDRESS){
+        return asm_memory(ASM_REGISTER_RBP, current_function->slot_offsets[definition->slot], size);
+    }
+    if(definition && definition->opcode == IR_OP_GLOBAL_ADDRESS){
+        return codegen_global_operand(definition, size);
+    }
+    int reg = codegen_vreg_register(vreg);
+    if(reg == ASM_REGISTER_NONE){
+        reg = scratch;
+        codegen_load_vreg(vreg, reg);
+    }
+    return asm_memory(reg, 0, size);
+}
+
+// A rip relative operand for the global or string literal of an IR_OP_GLOBAL_ADDRESS.
+static AsmOperand codegen_global_operand(IrInstruction* definition, int size){
+    if(definition->flags & IR_INSTRUCTION_FLAG_STRING_LITERAL){
+        AsmOperand operand = asm_symbol_memory(NULL, size);
+        operand.label = codegen_register_string_literal(definition->symbol);
+        return operand;
+    }
+    AsmOperand operand = asm_symbol_memory(definition->symbol, size);
+    operand.value = definition->immediate;
+    return operand;
+}
+
+static int codegen_block_label(IrBlock* block){
+    return current_function->first_block_label + block->id;
+}
+
+static int codegen_invert_condition(int condition){
+    static const int inverted[] = {
+        [ASM_CONDITION_E] = ASM_CONDITION_NE, [ASM_CONDITION_NE] = ASM_CONDITION_E, [ASM_CONDITION_L] = ASM_CONDITION_GE, [ASM_CONDITION_LE] = ASM_CONDITION_G,
+        [ASM_CONDITION_G] = ASM_CONDITION_LE, [ASM_CONDITION_GE] = ASM_CONDITION_L, [ASM_CONDITION_B] = ASM_CONDITION_AE, [ASM_CONDITION_BE] = ASM_CONDITION_A,
+        [ASM_CONDITION_A] = ASM_CONDITION_BE, [ASM_CONDITION_AE] = ASM_CONDITION_B
+    };
+    return inverted[condition];
+}
+
+static void codegen_global_variable(Node* variable_node, const char* symbol, bool is_static){
+    DataType* datatype = variable_node->data.var.data_type;
+    if(datatype->flags & DATATYPE_FLAG_IS_EXTERN){
+        return;
+    }
+    codegen_reject_floating_point(datatype);
+    size_t size = get_datatype_size(current_process, datatype);
+    size_t alignment = get_datatype_alignment(current_process, datatype);
+    Node* value_node = variable_node->data.var.value;
+    emit_string(codegen_emitter, value_node ? "\t.data\n" : "\t.bss\n");
+    if(!is_static){
+        emit_formatted(codegen_emitter, "\t.globl %s\n", symbol);
+    }
+    emit_formatted(codegen_emitter, "\t.align %zu\n\t.type %s, @object\n\t.size %s, %zu\n%s:\n", alignment ? alignment : 1, symbol, symbol, size, symbol);
+    if(!value_node){
+        emit_formatted(codegen_emitter, "\t.zero %zu\n", size ? size : 1);
+        return;
+    }
+    codegen_static_initializer(datatype, value_node, size);
+}
+
+// Writes the data directives for the initializer of a variable with static storage.
+static void codegen_static_initializer(DataType* datatype, Node* value_node, size_t size){
+    while(value_node->type == NODE_TYPE_EXPRESSION_PARENTHESES){
+        value_node = value_node->data.parentheses.expression;
+    }
+    if(datatype->flags & DATATYPE_FLAG_IS_ARRAY && value_node->type == NODE_TYPE_STRING && codegen_element_size(datatype) == 1){
+        size_t length = strlen(value_node->literal_value.string_val);
+        size_t written = length < size ? length : size;
+        emit_string(codegen_emitter, "\t.ascii ");
+        codegen_emit_escaped_string(value_node->literal_value.string_val, written);
+        emit_character(codegen_emitter, '\n');
+        if(size > written){
+            emit_formatted(codegen_emitter, "\t.zero %zu\n", size - written);
+        }
+        return;
+    }
+    if(is_codegen_aggregate(datatype)){
+        compiler_error(current_process, "aggregate initializers are not supported");
+    }
+    if(is_codegen_pointer(datatype) && value_node->type == NODE_TYPE_STRING){
+        emit_formatted(codegen_emitter, "\t.quad .LC%d\n", codegen_register_string_literal(value_node->literal_value.string_val));
+        return;
+    }
+    const char* symbol = NULL;
+    long long offset = 0;
+    if(codegen_static_address(value_node, &symbol, &offset)){
+        emit_formatted(codegen_emitter, offset ? "\t.quad %s%+lld\n" : "\t.quad %s\n", symbol, offset);
+        return;
+    }
+    long long value = 0;
+    if(!evaluate_constant_expression(current_process, value_node, &value)){
+        compiler_error(current_process, "initializer element is not a compile-time constant");
+    }
+    switch(codegen_value_size(datatype)){
+        case 1:
+            emit_formatted(codegen_emitter, "\t.byte %lld\n", value & 0xff);
+            break;
+        case 2:
+            emit_formatted(codegen_emitter, "\t.short %lld\n", value & 0xffff);
+            break;
+        case 4:
+            emit_formatted(codegen_emitter, "\t.long %lld\n", value & 0xffffffffLL);
+            break;
+        default:
+            emit_formatted(codegen_emitter, "\t.quad %lld\n", value);
+    }
+}
+
+// Matches the address constants a static initializer can use, &x, &x[c] and an array or function name, as a symbol plus a byte offset.
+static bool codegen_static_address(Node* node, const char** symbol_out, long long* offset_out){
+    bool is_address_of = node->type == NODE_TYPE_UNARY && ARE_STRINGS_EQUAL(node->data.unary.operator, "&");
+    if(is_address_of){
+        node = node->data.unary.operand;
+    }
+    long long offset = 0;
+    if(is_address_of && node->type == NODE_TYPE_EXPRESSION && ARE_STRINGS_EQUAL(node->data.expression.operator, "[]")){
+        long long index = 0;
+        Node* base_node = node->data.expression.left;
+        if(base_node->type != NODE_TYPE_IDENTIFIER || !base_node->data.identifier.declaration || base_node->data.identifier.declaration->type != NODE_TYPE_VARIABLE || !evaluate_constant_expression(current_process, node->data.expression.right->data.bracket.inner, &index)){
+            return false;
+        }
+        offset = index * get_datatype_size(current_process, get_datatype_element(current_process, base_node->data.identifier.declaration->data.var.data_type));
+        node = base_node;
+        is_address_of = true;
+    }
+    if(node->type != NODE_TYPE_IDENTIFIER || !node->data.identifier.declaration){
+        return false;
+    }
+    Node* declaration = node->data.identifier.declaration;
+    if(declaration->type == NODE_TYPE_VARIABLE){
+        if(declaration->BindedTo.function || (!is_address_of && !(declaration->data.var.data_type->flags & DATATYPE_FLAG_IS_ARRAY))){
+            return false;
+        }
+    }
+    else if(declaration->type != NODE_TYPE_FUNCTION){
+        return false;
+    }
+    *symbol_out = node->literal_value.string_val;
+    *offset_out = offset;
+    return true;
+}
+
+static void codegen_string_literals_section(){
+    if(is_vector_empty(codegen_string_literals)){
+        return;
+    }
+    emit_string(codegen_emitter, "\t.section .rodata\n");
+    vector_for_each(CodegenStringLiteral, literal, codegen_string_literals){
+        emit_formatted(codegen_emitter, ".LC%d:\n\t.string ", literal->label);
+        codegen_emit_escaped_string(literal->value, strlen(literal->value));
+        emit_character(codegen_emitter, '\n');
+    }
+}
+
+static void codegen_static_locals_section(){
+    vector_for_each(IrStaticLocal, local, codegen_static_locals){
+        codegen_global_variable(local->variable_node, local->symbol, true);
+    }
+}
+
+static bool is_codegen_pointer(DataType* datatype){
+    return datatype->flags & DATATYPE_FLAG_IS_ARRAY || (datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0);
+}
+
+// Values of these types are represented by their address.
+static bool is_codegen_aggregate(DataType* datatype){
+    return datatype->flags & DATATYPE_FLAG_IS_ARRAY || (is_datatype_struct_or_union(datatype) && !(datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0));
+}
+
+// The number of bytes a value of the datatype takes in a register, arrays decay to a pointer.
+static size_t codegen_value_size(DataType* datatype){
+    if(is_codegen_pointer(datatype)){
+        return current_process->target->pointer_size;
+    }
+    return get_datatype_size(current_process, datatype);
+}
+
+// The size of the object a pointer or array points to, void pointers step by one byte.
+static size_t codegen_element_size(DataType* datatype){
+    size_t size = get_datatype_size(current_process, get_datatype_element(current_process, datatype));
+    return size ? size : 1;
+}
+
+static void codegen_reject_floating_point(DataType* datatype){
+    if((datatype->type == DATA_TYPE_FLOAT || datatype->type == DATA_TYPE_DOUBLE) && !is_codegen_pointer(datatype)){
+        compiler_error(current_process, "floating point types are not supported by the x86-64 backend yet");
+    }
+}
+
+static int codegen_new_label(){
+    return ++codegen_label_count;
+}
+
+static int codegen_register_string_literal(const char* value){
+    int label = (int)(intptr_t)hash_table_get(codegen_string_literal_labels, value);
+    if(label){
+        return label;
+    }
+    CodegenStringLiteral literal = {.value = value, .label = codegen_new_label()};
+    push_element(codegen_string_literals, &literal);
+    hash_table_put(codegen_string_literal_labels, value, (void*)(intptr_t)literal.label);
+    return literal.label;
+}
+
+static void codegen_emit_escaped_string(const char* value, size_t length){
+    emit_character(codegen_emitter, '"');
+    for(size_t i = 0; i < length; i++){
+        unsigned char character = value[i];
+        switch(character){
+            case '"':
+                emit_string(codegen_emitter, "\\\"");
+                break;
+            case '\\':
+                emit_string(codegen_emitter, "\\\\");
+                break;
+            case '\n':
+                emit_string(codegen_emitter, "\\n");
+                break;
+            case '\t':
+                emit_string(codegen_emitter, "\\t");
+                break;
+            case '\r':
+                emit_string(codegen_emitter, "\\r");
+                break;
+            default:
+                if(character < 0x20 || character >= 0x7f){
+                    emit_formatted(codegen_emitter, "\\%03o", character);
+                }
+                else{
+                    emit_character(codegen_emitter, character);
+                }
+        }
+    }
+    emit_character(codegen_emitter, '"');
+}
+
+static AsmOperand asm_register(int reg, int size){
+    return (AsmOperand){.type = ASM_OPERAND_REGISTER, .reg = reg, .size = size};
+}
+
+static AsmOperand asm_immediate(long long value){
+    return (AsmOperand){.type = ASM_OPERAND_IMMEDIATE, .value = value, .size = 8};
+}
+
+static AsmOperand asm_memory(int base, long long displacement, int size){
+    return (AsmOperand){.type = ASM_OPERAND_MEMORY, .reg = base, .index = ASM_REGISTER_NONE, .value = displacement, .size = size};
+}
+
+// A rip relative operand, a NULL symbol refers to the string literal in label.
+static AsmOperand asm_symbol_memory(const char* symbol, int size){
+    return (AsmOperand){.type = ASM_OPERAND_MEMORY, .reg = ASM_REGISTER_RIP, .index = ASM_REGISTER_NONE, .symbol = symbol, .size = size};
+}
+
+static AsmOperand asm_label(int label){
+    return (AsmOperand){.type = ASM_OPERAND_LABEL, .label = label};
+}
+
+static AsmOperand asm_symbol(const char* symbol){
+    return (AsmOperand){.type = ASM_OPERAND_SYMBOL, .symbol = symbol};
+}
+
+static bool is_asm_immediate_32(long long value){
+    return value >= INT_MIN && value <= INT_MAX;
+}
+
+static void codegen_instruction(int opcode, int size, AsmOperand source, AsmOperand destination){
+    AsmInstruction instruction = {.opcode = opcode, .size = size, .source = source, .destination = destination};
+    vector_AsmInstruction_push(current_function->instructions, instruction);
+}
+
+static void codegen_condition_instruction(int opcode, int condition, AsmOperand destination){
+    AsmInstruction instruction = {.opcode = opcode, .size = 1, .condition = condition, .destination = destination};
+    vector_AsmInstruction_push(current_function->instructions, instruction);
+}
+
+static void codegen_place_label(int label){
+    codegen_instruction(ASM_OPCODE_LABEL, 0, (AsmOperand){}, asm_label(label));
+}
+
+static void codegen_push(int reg){
+    codegen_instruction(ASM_OPCODE_PUSH, 8, (AsmOperand){}, asm_register(reg, 8));
+}
+
+// Moves rsp by the given number of bytes, negative values allocate.
+static void codegen_adjust_stack(long long bytes){
+    codegen_instruction(bytes < 0 ? ASM_OPCODE_SUB : ASM_OPCODE_ADD, 8, asm_immediate(bytes < 0 ? -bytes : bytes), asm_register(ASM_REGISTER_RSP, 8));
+}
+
+static void codegen_print_function_instructions(DynamicVector* instructions){
+    vector_for_each(AsmInstruction, instruction, instructions){
+        codegen_print_instruction(instruction);
+    }
+}
+
+static void codegen_print_instruction(AsmInstruction* instruction){
+    static const char* mnemonics[ASM_OPCODE_COUNT] = {
+        [ASM_OPCODE_MOV] = "mov", [ASM_OPCODE_MOVSX] = "movs", [ASM_OPCODE_MOVZX] = "movz", [ASM_OPCODE_LEA] = "lea",
+        [ASM_OPCODE_ADD] = "add", [ASM_OPCODE_SUB] = "sub", [ASM_OPCODE_IMUL] = "imul", [ASM_OPCODE_IDIV] = "idiv",
+        [ASM_OPCODE_DIV] = "div", [ASM_OPCODE_CQO] = "cqto", [ASM_OPCODE_NEG] = "neg", [ASM_OPCODE_NOT] = "not",
+        [ASM_OPCODE_AND] = "and", [ASM_OPCODE_OR] = "or", [ASM_OPCODE_XOR] = "xor", [ASM_OPCODE_SHL] = "shl",
+        [ASM_OPCODE_SAR] = "sar", [ASM_OPCODE_SHR] = "shr", [ASM_OPCODE_CMP] = "cmp", [ASM_OPCODE_TEST] = "test",
+        [ASM_OPCODE_SETCC] = "set", [ASM_OPCODE_JMP] = "jmp", [ASM_OPCODE_JCC] = "j", [ASM_OPCODE_CALL] = "call",
+        [ASM_OPCODE_RET] = "ret", [ASM_OPCODE_PUSH] = "push", [ASM_OPCODE_POP] = "pop", [ASM_OPCODE_LEAVE] = "leave",
+        [ASM_OPCODE_REP_MOVSB] = "rep movsb"
+    };
+    static const char* conditions[] = {"", "e", "ne", "l", "le", "g", "ge", "b", "be", "a", "ae"};
+    switch(instruction->opcode){
+        case ASM_OPCODE_LABEL:
+            emit_formatted(codegen_emitter, ".L%d:\n", instruction->destination.label);
+            return;
+        case ASM_OPCODE_CQO:
+            emit_string(codegen_emitter, instruction->size == 4 ? "\tcltd\n" : "\tcqto\n");
+            return;
+        case ASM_OPCODE_RET:
+        case ASM_OPCODE_LEAVE:
+        case ASM_OPCODE_REP_MOVSB:
+            emit_formatted(codegen_emitter, "\t%s\n", mnemonics[instruction->opcode]);
+            return;
+        case ASM_OPCODE_JMP:
+        case ASM_OPCODE_CALL:
+            emit_formatted(codegen_emitter, "\t%s ", mnemonics[instruction->opcode]);
+            break;
+        case ASM_OPCODE_SETCC:
+        case ASM_OPCODE_JCC:
+            emit_formatted(codegen_emitter, "\t%s%s ", mnemonics[instruction->opcode], conditions[instruction->condition]);
+            break;
+        case ASM_OPCODE_MOVSX:
+        case ASM_OPCODE_MOVZX:
+            emit_formatted(codegen_emitter, "\t%s%s%s ", mnemonics[instruction->opcode], asm_size_suffix(instruction->source.size), asm_size_suffix(instruction->destination.size));
+            break;
+        case ASM_OPCODE_MOV:
+            if(instruction->source.type == ASM_OPERAND_IMMEDIATE && !is_asm_immediate_32(instruction->source.value)){
+                emit_string(codegen_emitter, "\tmovabsq ");
+                break;
+            }
+            //fall through
+        default:
+            emit_formatted(codegen_emitter, "\t%s%s ", mnemonics[instruction->opcode], asm_size_suffix(instruction->size));
+    }
+    if(instruction->source.type != ASM_OPERAND_NONE){
+        codegen_print_operand(&instruction->source);
+        emit_string(codegen_emitter, ", ");
+    }
+    codegen_print_operand(&instruction->destination);
+    emit_character(codegen_emitter, '\n');
+}
+
+static void codegen_print_operand(AsmOperand* operand){
+    switch(operand->type){
+        case ASM_OPERAND_REGISTER:
+            emit_formatted(codegen_emitter, "%%%s", get_asm_register_name(operand->reg, operand->size));
+            break;
+        case ASM_OPERAND_IMMEDIATE:
+            emit_formatted(codegen_emitter, "$%lld", operand->value);
+            break;
+        case ASM_OPERAND_MEMORY:
+            if(operand->reg == ASM_REGISTER_RIP){
+                if(operand->symbol){
+                    emit_string(codegen_emitter, operand->symbol);
+                }
+                else{
+                    emit_formatted(codegen_emitter, ".LC%d", operand->label);
+                }
+                if(operand->value){
+                    emit_formatted(codegen_emitter, "%+lld", operand->value);
+                }
+                emit_string(codegen_emitter, "(%rip)");
+                break;
+            }
+            if(operand->value){
+                emit_integer(codegen_emitter, operand->value);
+            }
+            emit_formatted(codegen_emitter, "(%%%s", get_asm_register_name(operand->reg, 8));
+            if(operand->index != ASM_REGISTER_NONE && operand->scale){
+                emit_formatted(codegen_emitter, ",%%%s,%d", get_asm_register_name(operand->index, 8), operand->scale);
+            }
+            emit_character(codegen_emitter, ')');
+            break;
+        case ASM_OPERAND_LABEL:
+            emit_formatted(codegen_emitter, ".L%d", operand->label);
+            break;
+        case ASM_OPERAND_SYMBOL:
+            emit_string(codegen_emitter, operand->symbol);
+            break;
+    }
+}
+
+static const char* asm_size_suffix(int size){
+    switch(size){
+        case 1:
+            return "b";
+        case 2:
+            return "w";
+        case 4:
+            return "l";
+    }
+    return "q";
+}
@@ -40,6 +40,7 @@ CompileProcess* create_compile_process(const char* in_file_name, const char* out
 
     CompileProcess* ptr_to_process = calloc(1, sizeof(CompileProcess));
     ptr_to_process->flags = flags;
+    ptr_to_process->target = get_target_data_model(flags & COMPILE_PROCESS_FLAG_TARGET_ILP32 ? TARGET_DATA_MODEL_ILP32 : TARGET_DATA_MODEL_LP64);
     ptr_to_process->input_file.file_ptr = in_file;
     ptr_to_process->input_file.absolute_path = in_file_name;
     ptr_to_process->output_file = out_file;
@@ -47,10 +48,32 @@ CompileProcess* create_compile_process(const char* in_file_name, const char* out
     ptr_to_process->node_tree_vector = create_vector(sizeof(Node* ));
     initialize_symbol_resolver(ptr_to_process);
     symbol_resolver_new_table(ptr_to_process);
+    ptr_to_process->fixup_system = create_new_fixup_system();
+    ptr_to_process->datatypes.table = create_hash_table(COMPILE_PROCESS_EXPECTED_DATATYPE_COUNT);
+    ptr_to_process->datatypes.signatures = create_string_pool();
+    ptr_to_process->datatypes.scratch = create_buffer_with_capacity(BUFFER_FORMAT_FIRST_PASS_SIZE);
 
     return ptr_to_process;
 }
 
+/*
+* @fn size_t get_compile_process_input_file_size(CompileProcess* process)
+* @brief Gets the size of the input file
+* @details Measures the input file in bytes by seeking to its end, then restores the original read position so lexing is unaffected.
+* @param process The compile process
+* @return The size of the input file in bytes, 0 if it can't be determined
+*/
+size_t get_compile_process_input_file_size(CompileProcess* process){
+    FILE* file = process->input_file.file_ptr;
+    long current_position = ftell(file);
+    if(current_position < 0 || fseek(file, 0, SEEK_END) != 0){
+        return 0;
+    }
+    long size = ftell(file);
+    fseek(file, current_position, SEEK_SET);
+    return size > 0 ? size : 0;
+}
+
 /*
 * @fn char compile_process_next_char(LexProcess* lex_process)
 * @brief Gets the next character from the file
@@ -15,6 +15,12 @@ LexProcessFunctions lex_functions = {
     .push_char = compile_process_push_char
 };
 
+// Matches newline, comment and line continuation tokens which the parser never looks at.
+static bool is_trivia_token(void* element, void* private_data){
+    (void)private_data;
+    return parser_ignore_nl_or_comment_or_nl_seperator_tokens((Token*)element);
+}
+
 /*
 * @fn int compile_file(const char* in_file_name, const char* out_file_name, int flags)
 * @brief Compiles a file
@@ -35,11 +41,15 @@ int compile_file(const char* in_file_name, const char* out_file_name, int flags)
     if(!lex_process){
         return COMPILER_FAILED_WITH_ERRORS;
     }
+    reserve_vector(lex_process->token_vector, get_compile_process_input_file_size(process) / LEXER_ESTIMATED_BYTES_PER_TOKEN);
     if(lex(lex_process)!=LEXICAL_ANALYSIS_SUCCESS){
         return COMPILER_FAILED_WITH_ERRORS;
     }
     process->token_vector = lex_process->token_vector;
     print_token_vector(process->token_vector);
+    //drop trivia once so the parser never has to skip over it
+    remove_vector_elements_if(process->token_vector, is_trivia_token, NULL);
+    shrink_vector_to_fit(process->token_vector);
 
     //perform parsing
     if(parse(process)!=PARSER_SUCCESS){
@@ -47,8 +57,12 @@ int compile_file(const char* in_file_name, const char* out_file_name, int flags)
     }
     print_node_vector(process->node_vector);
     print_node_vector(process->node_tree_vector);
+    //drop the statements that can never run before they are lowered
+    prune_unreachable_code(process);
     //perfoem code generation
-    
+    if(codegen(process)!=CODEGEN_ALL_OK){
+        return COMPILER_FAILED_WITH_ERRORS;
+    }
     return COMPILER_SUCCESS;
 }
 
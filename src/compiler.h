@@ -10,12 +10,17 @@
 #include "stdio.h"
 #include "stdbool.h"
 #include "helpers/vector.h"
+#include "helpers/typedVector.h"
 #include "helpers/buffer.h"
+#include "helpers/stringPool.h"
+#include "helpers/hashTable.h"
 #include "string.h"
 
 
 //declarations for compiler beign here
 
+VEC_DEFINE(VoidPtr, void*)
+
 /*
 * @enum
 * @brief Flags for the compiler
@@ -44,11 +49,34 @@ struct PositionInFile{
 
 typedef struct Scope {
     int flags;
-    DynamicVector* entities;
+    int entity_start; //index of the scope's first entity in the process entity stack
+    int iterate_index; //index of the next entity returned by scope_iterate_back
     size_t size; //total number of bytes scope is using, aligned to 16 bytes, so stack is aligned to 16 bytes
     struct Scope* parent;
+    struct Scope* active_child; //open child scope, its entity_start is where this scope's entities end
+    int binding_mark; //length of the binding log when the scope was opened, bindings past it are undone when the scope finishes
 } Scope;
 
+/*
+* @struct ScopeBinding
+* @brief A name declared in a scope
+* @details Bindings of the same name form a stack through shadowed, the innermost declaration is the one stored in the bindings table
+* @var ScopeBinding::name
+* Member 'name' contains the declared name
+* @var ScopeBinding::node
+* Member 'node' contains the variable or function node declaring the name
+* @var ScopeBinding::scope
+* Member 'scope' contains the scope the name was declared in
+* @var ScopeBinding::shadowed
+* Member 'shadowed' contains the binding of the same name in an enclosing scope, NULL if there is none
+*/
+typedef struct ScopeBinding {
+    const char* name;
+    struct Node* node;
+    Scope* scope;
+    struct ScopeBinding* shadowed;
+} ScopeBinding;
+
 typedef struct Symbol {
     const char* name;
     int type;
@@ -82,11 +110,67 @@ enum{
 * Member 'node_vector' contains the nodes for push & pop operations for the parser
 * @var CompileProcess::node_tree_vector
 * Member 'node_tree_vector' contains the root of the parse tree
+* @var CompileProcess::fixup_system
+* Member 'fixup_system' contains the fixups waiting for symbols declared later in the file
+*/
+/*
+* @enum
+* @brief Flags for the compile process
+* @var COMPILE_PROCESS_FLAG_TARGET_ILP32
+* Member 'COMPILE_PROCESS_FLAG_TARGET_ILP32' selects the 32 bit ILP32 data model instead of the default LP64 one
+* @var COMPILE_PROCESS_FLAG_DUMP_IR
+* Member 'COMPILE_PROCESS_FLAG_DUMP_IR' prints the SSA form of every function to stdout before code is generated for it
+* @var COMPILE_PROCESS_FLAG_NO_INLINE
+* Member 'COMPILE_PROCESS_FLAG_NO_INLINE' keeps every call a call
+* @var COMPILE_PROCESS_FLAG_DUMP_PEEPHOLE
+* Member 'COMPILE_PROCESS_FLAG_DUMP_PEEPHOLE' prints how often every peephole rule fired in the file to stdout once code is generated
+*/
+enum{
+    COMPILE_PROCESS_FLAG_TARGET_ILP32 = 1 << 0,
+    COMPILE_PROCESS_FLAG_DUMP_IR = 1 << 1,
+    COMPILE_PROCESS_FLAG_NO_INLINE = 1 << 2,
+    COMPILE_PROCESS_FLAG_DUMP_PEEPHOLE = 1 << 3,
+};
+
+/*
+* @enum
+* @brief The data models the compiler can target
+*/
+enum{
+    TARGET_DATA_MODEL_ILP32,
+    TARGET_DATA_MODEL_LP64,
+    TARGET_DATA_MODEL_COUNT
+};
+
+/*
+* @struct TargetDataModel
+* @brief Sizes and alignments of the primitive datatypes on a target
+* @details Every size and alignment the parser, the struct layouts and the datatype helpers use comes from the data model of the compile process, so layouts match the ABI of the target.
+* @var TargetDataModel::name
+* Member 'name' contains the name of the data model, eg: "LP64"
+* @var TargetDataModel::max_scalar_alignment
+* Member 'max_scalar_alignment' caps the alignment of primitives, primitives are otherwise aligned to their size. The i386 ABI aligns 8 byte members to 4 bytes
 */
+typedef struct TargetDataModel{
+    const char* name;
+    size_t char_size;
+    size_t short_size;
+    size_t int_size;
+    size_t long_size;
+    size_t long_long_size;
+    size_t float_size;
+    size_t double_size;
+    size_t long_double_size;
+    size_t pointer_size;
+    size_t max_scalar_alignment;
+} TargetDataModel;
+
+#define COMPILE_PROCESS_EXPECTED_DATATYPE_COUNT 64
 typedef struct CompileProcess CompileProcess;
 struct CompileProcess{
     int flags; // the flags in regards to how this file should be compiled
     PositionInFile position;
+    const TargetDataModel* target; //sizes and alignments of the datatypes, selected by the flags
     struct CompileProcessInputFile{
         FILE* file_ptr;
         const char* absolute_path;
@@ -99,12 +183,24 @@ struct CompileProcess{
     struct{
         Scope* root;
         Scope* current;
+        DynamicVector* entities; //entities of every open scope, outermost first, each scope owns the run starting at its entity_start
+        DynamicVector* free_scopes; //finished scopes kept for reuse by allocate_scope
+        HashTable* bindings; //maps a name to its innermost visible ScopeBinding
+        DynamicVector* binding_log; //every ScopeBinding in declaration order, popped back to the scope's binding_mark by finish_scope
     } scope;
 
     struct{
-        DynamicVector* current_active_symbol_table; //holds struct sybmol pointers
-        DynamicVector* tables; //holds struct dynamic vectors, each dynamic vector holds struct symbol pointers
+        HashTable* current_active_symbol_table; //maps symbol names to struct symbol pointers
+        DynamicVector* tables; //holds the hash tables of the enclosing symbol tables, innermost last
     } symbols;
+
+    struct FixupSystem* fixup_system; //fixups waiting for symbols declared later in the file
+
+    struct{
+        HashTable* table; //maps a type signature to its canonical DataType
+        StringPool* signatures; //owns the signature keys of table
+        BufferType* scratch; //the signature being built by intern_datatype
+    } datatypes;
 };
 /*
 * @fn int compile_file(const char* in_file_name, const char* out_file_name, int flags)
@@ -126,6 +222,14 @@ int compile_file(const char* in_file_name, const char* out_file_name, int flags)
 * @return The result of the compilation
 */
 CompileProcess* create_compile_process(const char* in_file_name, const char* out_file_name, int flags);
+/*
+* @fn size_t get_compile_process_input_file_size(CompileProcess* process)
+* @brief Gets the size of the input file
+* @details This function returns the size of the input file in bytes without moving the read position
+* @param process The compile process
+* @return The size of the input file in bytes
+*/
+size_t get_compile_process_input_file_size(CompileProcess* process);
 
 //declarations for tokens begin here
 
@@ -143,12 +247,20 @@ typedef struct Token Token;
 * Member 'NUMBER_TYPE_FLOAT' represents a float
 * @var NUMBER_TYPE_DOUBLE
 * Member 'NUMBER_TYPE_DOUBLE' represents a double
+* @var NUMBER_TYPE_LONG_LONG
+* Member 'NUMBER_TYPE_LONG_LONG' represents a long long integer
 */
 enum{
     NUMBER_TYPE_NORMAL_INT,
     NUMBER_TYPE_LONG,
     NUMBER_TYPE_FLOAT,
     NUMBER_TYPE_DOUBLE,
+    NUMBER_TYPE_LONG_LONG,
+};
+
+enum{
+    NUMBER_FLAG_IS_UNSIGNED = 1 << 0, //u or U suffix
+    NUMBER_FLAG_IS_NOT_DECIMAL = 1 << 1, //hexadecimal, octal or binary, these may take an unsigned type without a suffix
 };
 /*
 * @struct Token
@@ -178,6 +290,8 @@ enum{
 * Member 'Number' contains the number of the token
 * @var Token::Number::type
 * Member 'type' contains the type of the number
+* @var Token::Number::flags
+* Member 'flags' contains the NUMBER_FLAG_* of the number
 * @var Token::is_whitespace
 * Member 'is_whitespace' contains the whitespace of the token
 * @var Token::whats_between_brackets
@@ -198,6 +312,7 @@ struct Token{
 
     struct TokenNumber{
         int type;
+        int flags;
     } Number;
 
     bool is_whitespace; // true if there's a whitespace character between this token and previous token, eg: * a for operator token * would mean there's a whitespace between * and a, and is_whitespace would be true for the token "a"
@@ -206,6 +321,7 @@ struct Token{
 
 
 };
+VEC_DEFINE(Token, Token)
 /*
 * @enum
 * @brief The type of the token
@@ -272,6 +388,10 @@ enum{
 * Member 'functions' contains the functions of the lex process
 * @var LexProcess::private_data
 * Member 'private_data' contains the private data of the lex process
+* @var LexProcess::scratch_buffer
+* Member 'scratch_buffer' contains the buffer reused to read the text of every token
+* @var LexProcess::string_pool
+* Member 'string_pool' contains the pool holding the text of identifiers, keywords, operators, strings and comments
 */
 typedef struct LexProcess LexProcess;
 /* 
@@ -320,6 +440,9 @@ struct LexProcess{
     LexProcessFunctions* functions;
 
     void* private_data; // private data that the lexer don't understand but the one using lexer does
+
+    BufferType* scratch_buffer; // token text is read here and then copied into string_pool at its exact length
+    StringPool* string_pool;
 };
 /*
 * @fn char compile_process_next_char(LexProcess* lex_process)
@@ -398,6 +521,11 @@ int lex(LexProcess* lex_process);
 * @var LEXICAL_ANALYSIS_FAILED_WITH_ERRORS
 * Member 'LEXICAL_ANALYSIS_FAILED_WITH_ERRORS' represents a failed lexical analysis with errors
 */
+/*
+* @def LEXER_ESTIMATED_BYTES_PER_TOKEN
+* @brief Average number of source bytes per token, used to presize the token vector from the input file size
+*/
+#define LEXER_ESTIMATED_BYTES_PER_TOKEN 4
 enum{
     LEXICAL_ANALYSIS_SUCCESS,
     LEXICAL_ANALYSIS_FAILED_WITH_ERRORS
@@ -528,10 +656,59 @@ yyleng should return the length of the last matched text (yytext).
 int yyleng();
 
 typedef struct ParsedSwitchCase{
-    int index;
+    long long index; //the folded value of the case label
 }ParsedSwitchCase;
 
 typedef struct Node Node;
+
+/*
+* @struct StructLayoutMember
+* @brief A member of a completed struct or union
+* @var StructLayoutMember::name
+* Member 'name' contains the name of the member
+* @var StructLayoutMember::variable_node
+* Member 'variable_node' contains the variable node declaring the member
+* @var StructLayoutMember::data_type
+* Member 'data_type' contains the datatype of the member
+* @var StructLayoutMember::offset
+* Member 'offset' contains the byte offset of the member from the start of the struct, always 0 for unions
+* @var StructLayoutMember::size
+* Member 'size' contains the size of the member in bytes
+*/
+typedef struct StructLayoutMember{
+    const char* name;
+    Node* variable_node;
+    struct DataType* data_type;
+    size_t offset;
+    size_t size;
+} StructLayoutMember;
+
+/*
+* @struct StructLayout
+* @brief The frozen layout of a completed struct or union
+* @details Built once when the struct or union body has been parsed, every size, alignment and offset query afterwards is a lookup
+* @var StructLayout::is_union
+* Member 'is_union' is true for unions, every member of a union is at offset 0
+* @var StructLayout::size
+* Member 'size' contains the total size in bytes including trailing padding
+* @var StructLayout::alignment
+* Member 'alignment' contains the alignment of the struct, the largest alignment of its members
+* @var StructLayout::members
+* Member 'members' contains the members in declaration order
+* @var StructLayout::member_count
+* Member 'member_count' contains the number of members
+* @var StructLayout::member_index
+* Member 'member_index' maps a member name to its StructLayoutMember
+*/
+typedef struct StructLayout{
+    bool is_union;
+    size_t size;
+    size_t alignment;
+    StructLayoutMember* members;
+    int member_count;
+    HashTable* member_index;
+} StructLayout;
+
 enum{
 
 
@@ -566,6 +743,7 @@ enum{
     NODE_TYPE_UNION,
     NODE_TYPE_BRACKET,
     NODE_TYPE_CAST,
+    NODE_TYPE_SIZEOF,
     NODE_TYPE_BLANK,
 };
 typedef struct ArrayBrackets{
@@ -589,7 +767,19 @@ typedef struct DataType{
 }DataType;
 enum{
     FUNCTION_NODE_FLAG_IS_NATIVE = 1 << 2,
+    FUNCTION_NODE_FLAG_IS_VARIADIC = 1 << 3, //the parameter list ends with ...
 };
+/*
+* @struct ConstantValue
+* @brief A folded integer constant together with its C type
+* @details The value is kept truncated to the size of its type and extended according to its signedness, so an unsigned long long keeps its bit pattern in the long long.
+*/
+typedef struct ConstantValue{
+    long long value;
+    bool is_unsigned;
+    size_t size; //in bytes, the size of the C type of the value
+}ConstantValue;
+
 struct Node{
     union{
         char char_val;
@@ -607,8 +797,13 @@ struct Node{
         struct parentheses{
             Node* expression;
         } parentheses;
+        struct unary{
+            const char* operator;
+            Node* operand;
+            int flags;
+        } unary;
         struct var{
-            struct DataType data_type;
+            struct DataType* data_type; //canonical, shared with every other node of the same type
             const char* name;
             Node* value;
             int padding;
@@ -620,10 +815,14 @@ struct Node{
         struct bracket{
             Node* inner;
         } bracket;
+        struct identifier{
+            Node* declaration; //variable or function node the identifier refers to, NULL if it could not be resolved while parsing
+        } identifier;
         struct structure{
             const char* name;
             Node* body_node;
             Node* variable;
+            StructLayout* layout; //NULL for forward declarations
         } structure;
         struct body{
             DynamicVector* statements;
@@ -689,17 +888,27 @@ struct Node{
             Node* false_expression;
         } tenary;
         struct cast{
-            DataType data_type;
+            DataType* data_type; //canonical, shared with every other node of the same type
             Node* operand_node;
         } cast;
+        struct size_of{
+            DataType* data_type; //set for sizeof(type), NULL for sizeof expression
+            Node* expression_node;
+        } size_of;
+        struct number{
+            int type; //NUMBER_TYPE_* of the suffix
+            int flags; //NUMBER_FLAG_*
+        } number;
         struct Union{
             const char* name;
             Node* body_node;
             Node* variable;
+            StructLayout* layout; //NULL for forward declarations
         } Union;
     } data;
     int type;
     int flags;
+    ConstantValue constant; //cached by evaluate_constant_expression, valid when NODE_FLAG_IS_CONSTANT is set
     PositionInFile position;
     struct BindedTo{
         //pointer to body node the node is in
@@ -708,6 +917,7 @@ struct Node{
         Node* function;
     } BindedTo;
 }; 
+VEC_DEFINE(NodePtr, Node*)
 
 enum{
     PARSER_SUCCESS,
@@ -738,6 +948,12 @@ enum{
     NODE_FLAG_INSIDE_EXPRESSION = 1 << 3,
     NODE_FLAG_IS_FORWARD_DECLARATION = 1 << 4,
     NODE_FLAG_HAS_VARIABLE_COMBINED = 1 << 5,
+    NODE_FLAG_CONSTANT_EVALUATED = 1 << 6, //evaluate_constant_expression already ran on this node
+    NODE_FLAG_IS_CONSTANT = 1 << 7, //the node folded to constant
+};
+
+enum{
+    UNARY_FLAG_IS_POSTFIX = 1 << 0, //i++ and i--, the operand's old value is the result
 };
 
 Node* peek_node_expressionable_or_null();
@@ -806,6 +1022,27 @@ enum{
     DATA_SIZE_DDWORD = 8,
 };
 
+/*
+* @fn const TargetDataModel* get_target_data_model(int data_model)
+* @brief Returns the description of a data model
+* @param data_model One of TARGET_DATA_MODEL_ILP32 or TARGET_DATA_MODEL_LP64
+* @return The data model
+*/
+const TargetDataModel* get_target_data_model(int data_model);
+
+/*
+* @fn size_t get_target_primitive_size(const TargetDataModel* target, int type, int secondary_type)
+* @brief Returns the size of a primitive datatype on the target
+* @details Combines the secondary datatype the way C does, eg: long long is long_long_size and long int is long_size.
+* @param target The data model
+* @param type The primitive type, one of DATA_TYPE_*
+* @param secondary_type The secondary primitive type, DATA_TYPE_UNKNOWN if there is none
+* @return The size in bytes
+*/
+size_t get_target_primitive_size(const TargetDataModel* target, int type, int secondary_type);
+
+size_t get_target_scalar_alignment(const TargetDataModel* target, size_t size);
+
 ArrayBrackets* array_brackets_new(int size);
 
 void free_array_brackets(ArrayBrackets* array_brackets);
@@ -814,9 +1051,9 @@ void add_array_bracket(ArrayBrackets* array_brackets, Node* bracket_node);
 
 DynamicVector* get_array_brackets_node_vector(ArrayBrackets* array_brackets);
 
-size_t array_brackets_calculate_size_from_index(DataType* datatype, ArrayBrackets* array_brackets, int index);
+size_t array_brackets_calculate_size_from_index(CompileProcess* process, DataType* datatype, ArrayBrackets* array_brackets, int index);
 
-size_t array_brackets_calculate_size(DataType* datatype, ArrayBrackets* array_brackets);
+size_t array_brackets_calculate_size(CompileProcess* process, DataType* datatype, ArrayBrackets* array_brackets);
 
 int array_brackets_get_total_indices(DataType* datatype);
 
@@ -824,25 +1061,25 @@ bool is_datatype_struct_or_union(DataType* datatype);
 
 bool is_datatype_struct_or_union_given_name(const char* name);
 
-Scope* allocate_scope();
+Scope* allocate_scope(CompileProcess* process);
 
 Scope* create_root_scope(CompileProcess* process);
 
-Scope* deallocate_scope(Scope* scope);
+void deallocate_scope(CompileProcess* process, Scope* scope);
 
 void free_root_scope(CompileProcess* process);
 
 Scope* new_scope(CompileProcess* process, int flags);
 
-void scope_iteration_start(Scope* scope);
+void scope_iteration_start(CompileProcess* process, Scope* scope);
 
 void scope_iteration_end(Scope* scope);
 
-void* scope_iterate_back(Scope* scope);
+void* scope_iterate_back(CompileProcess* process, Scope* scope);
 
-void* get_last_entity_of_scope(Scope* scope);
+void* get_last_entity_of_scope(CompileProcess* process, Scope* scope);
 
-void* get_last_entity_from_scope_stop_at(Scope* scope, Scope* stop_scope);
+void* get_last_entity_from_scope_stop_at(CompileProcess* process, Scope* scope, Scope* stop_scope);
 
 void* get_scope_last_entity_stop_at(CompileProcess *process, Scope* stop_scope);
 
@@ -854,16 +1091,56 @@ void finish_scope(CompileProcess* process);
 
 Scope* get_current_scope(CompileProcess* process);
 
+ScopeBinding* scope_bind(CompileProcess* process, const char* name, Node* node);
+
+ScopeBinding* scope_lookup_binding(CompileProcess* process, const char* name);
+
+Node* scope_lookup(CompileProcess* process, const char* name);
 
-size_t get_datatype_size(DataType* datatype);
+ScopeBinding* scope_lookup_binding_in_current_scope(CompileProcess* process, const char* name);
+
+
+/*
+* @fn DataType* intern_datatype(CompileProcess* process, DataType* datatype)
+* @brief Returns the canonical record for a datatype
+* @details Datatypes are hash-consed per compile process on their primitive type, flags, size, name, pointer level, struct or union identity, secondary datatype and array dimensions. The first time a type is seen it is copied into the table, afterwards the same record is returned, so two interned datatypes are equal exactly when their pointers are equal. Canonical records are shared and must never be modified, intern a modified copy instead.
+* @param process The compile process owning the table
+* @param datatype The datatype to intern, it is only read
+* @return The canonical datatype
+*/
+DataType* intern_datatype(CompileProcess* process, DataType* datatype);
+
+size_t get_interned_datatype_count(CompileProcess* process);
+
+/*
+* @fn DataType* get_datatype_pointer_to(CompileProcess* process, DataType* datatype)
+* @brief The interned type of &x for an x of the datatype, the address of an array points to its first element
+*/
+DataType* get_datatype_pointer_to(CompileProcess* process, DataType* datatype);
+
+/*
+* @fn DataType* get_datatype_element(CompileProcess* process, DataType* datatype)
+* @brief The interned type of x[0], an array loses its first dimension and a pointer one level of indirection
+* @details Raises a compiler error for types that are neither arrays nor pointers
+*/
+DataType* get_datatype_element(CompileProcess* process, DataType* datatype);
+
+/*
+* @fn DataType* get_number_literal_datatype(CompileProcess* process, Node* number_node)
+* @brief The interned type of an integer literal, the first type of the C11 6.4.4.1 list for its suffix and base that can represent its value
+* @details Decimal literals without a u suffix only take signed types, hexadecimal, octal and binary ones may also take the unsigned type of each rank, eg: 0xFFFFFFFF is an unsigned int and 4294967295 a long.
+*/
+DataType* get_number_literal_datatype(CompileProcess* process, Node* number_node);
+
+size_t get_datatype_size(CompileProcess* process, DataType* datatype);
 size_t get_datatype_size_no_pointer(DataType* datatype);
 
-size_t get_datatype_size_for_array_access(DataType* datatype);
-size_t get_datatype_element_size(DataType* datatype);
+size_t get_datatype_size_for_array_access(CompileProcess* process, DataType* datatype);
+size_t get_datatype_element_size(CompileProcess* process, DataType* datatype);
 
-size_t get_variable_size(Node* variable_node);
+size_t get_variable_size(CompileProcess* process, Node* variable_node);
 
-size_t get_variable_size_for_list(Node* variable_list_node);
+size_t get_variable_size_for_list(CompileProcess* process, Node* variable_list_node);
 
 
 int get_padding(int value, int to);
@@ -906,9 +1183,13 @@ static void symbol_resolver_push_symbol(CompileProcess* process, Symbol* symbol)
 
 void symbol_resolver_new_table(CompileProcess* process);
 
+void symbol_resolver_for_variable_node(CompileProcess* process, Node* node);
+
+void symbol_resolver_for_function_node(CompileProcess* process, Node* node);
+
 bool is_token_identifier(Token* token);
 
-void make_function_node(DataType* return_type, const char* name, DynamicVector* parameters, Node* body_node);
+void make_function_node(CompileProcess* process, DataType* return_type, const char* name, DynamicVector* parameters, Node* body_node);
 
 Symbol* symbol_resolver_get_symbol_for_native_function(CompileProcess* process, const char* name);
 
@@ -945,10 +1226,16 @@ void make_goto_node(Node* label_name_node);
 
 void make_switch_case_node(Node* expression_node);
 
+void make_switch_default_node();
+
 void make_tenary_node(Node* true_expression, Node* false_expression);
 
 void make_cast_node(DataType* data_type, Node* operand_node);
 
+void make_unary_node(const char* operator, Node* operand, int flags);
+
+void make_sizeof_node(DataType* data_type, Node* expression_node);
+
 typedef struct Fixup Fixup;
 
 typedef struct FixupSystem FixupSystem;
@@ -974,10 +1261,12 @@ typedef struct Fixup {
     int flags;
     FixupSystem* system;
     FixupConfig config;
+    const char* waiting_on; //name of the symbol whose registration can resolve the fixup, NULL if it is only resolved by the final sweep
 }Fixup;
 
 typedef struct FixupSystem {
     DynamicVector* fixups;
+    HashTable* waiting; //maps a symbol name to a vector of the Fixup* waiting on it
 }FixupSystem;
 
 
@@ -994,16 +1283,16 @@ void free_fixup(Fixup* fixup);
 
 void free_fixups(FixupSystem* system);
 
-void start_iterating_fixups(FixupSystem* system);
-
-Fixup* next_fixup(FixupSystem* system);
-
 void free_fixup_system(FixupSystem* system);
 
 int get_count_of_unresolved_fixups(FixupSystem* system);
 
 Fixup* register_fixup(FixupSystem* system, FixupConfig* config);
 
+Fixup* register_fixup_waiting_on(FixupSystem* system, const char* name, FixupConfig* config);
+
+int resolve_fixups_waiting_on(FixupSystem* system, const char* name);
+
 bool is_fixup_resolved(Fixup* fixup);
 
 void* return_fixup_private_data(Fixup* fixup);
@@ -1019,4 +1308,785 @@ bool is_node_expression(Node* node, const char* operator);
 
 bool is_assignment_node(Node* node);
 
+StructLayout* build_struct_layout(CompileProcess* process, Node* struct_or_union_node);
+
+StructLayout* get_struct_layout(CompileProcess* process, Node* struct_or_union_node);
+
+StructLayout* get_struct_layout_for_name(CompileProcess* process, const char* name);
+
+StructLayout* get_struct_layout_for_datatype(CompileProcess* process, DataType* datatype);
+
+StructLayoutMember* struct_layout_get_member(StructLayout* layout, const char* member_name);
+
+long struct_layout_offset_of(StructLayout* layout, const char* member_name);
+
+size_t get_datatype_alignment(CompileProcess* process, DataType* datatype);
+
+/*
+* @fn bool evaluate_constant_expression(CompileProcess* process, Node* node, long long* value_out)
+* @brief Folds an integer constant expression
+* @details Handles numbers, parentheses, the arithmetic, shift, relational, bitwise and logical operators, the ternary operator, casts to integer types, sizeof and identifiers declared as const variables with a constant initializer. Every node is evaluated once, the result is cached on the node in constant and reused by later queries.
+* @param process The compile process
+* @param node The root of the expression
+* @param value_out Receives the value when the expression is constant, may be NULL
+* @return true if the expression is an integer constant expression
+*/
+bool evaluate_constant_expression(CompileProcess* process, Node* node, long long* value_out);
+
+/*
+* @fn bool evaluate_typed_constant_expression(CompileProcess* process, Node* node, ConstantValue* constant_out)
+* @brief Folds an integer constant expression and reports the C type of the result
+* @details Operands go through the integer promotions and the usual arithmetic conversions, so -1 < 0u folds to 0 and 0xFFFFFFFF is an unsigned int.
+* @param process The compile process
+* @param node The root of the expression
+* @param constant_out Receives the value and its type when the expression is constant, may be NULL
+* @return true if the expression is an integer constant expression
+*/
+bool evaluate_typed_constant_expression(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+/*
+* @fn long long expect_constant_expression(CompileProcess* process, Node* node, const char* context)
+* @brief Folds an integer constant expression, failing compilation when it isn't one
+* @param process The compile process
+* @param node The root of the expression
+* @param context What the expression is used for, reported in the error, eg: "array size"
+* @return The value of the expression
+*/
+long long expect_constant_expression(CompileProcess* process, Node* node, const char* context);
+
+long long get_node_constant_value(Node* node);
+
+/*
+* @fn void prune_unreachable_code(CompileProcess* process)
+* @brief Deletes the statements of every function that can never run
+* @details Statements after a return, break, continue or goto are deleted up to the next label or case, ifs and whiles on a constant condition are replaced by the branch taken. Body sizes and function stack sizes shrink by the variables deleted with them
+* @param process The compile process, after parsing
+*/
+void prune_unreachable_code(CompileProcess* process);
+
+//declarations for the intermediate representation begin here
+
+VEC_DEFINE(Int, int)
+
+/*
+* @enum
+* @brief The types of virtual registers
+* @details Pointers are I64. A value only defines the low bits of its type, signedness is a property of the operations, not of the type
+*/
+enum{
+    IR_TYPE_VOID,
+    IR_TYPE_I8,
+    IR_TYPE_I16,
+    IR_TYPE_I32,
+    IR_TYPE_I64
+};
+
+/*
+* @enum
+* @brief The operations of the intermediate representation
+* @details JUMP, BRANCH and RETURN are the terminators and end every block. PHIs come first in their block
+*/
+enum{
+    IR_OP_CONST, //result = immediate
+    IR_OP_UNDEF, //result = whatever is in the register, the value of an uninitialized variable
+    IR_OP_COPY, //result = operands[0]
+    IR_OP_PARAM, //result = the incoming argument number immediate
+    IR_OP_SLOT_ADDRESS, //result = the address of the stack slot
+    IR_OP_GLOBAL_ADDRESS, //result = the address of symbol + immediate, or of the string literal symbol with IR_INSTRUCTION_FLAG_STRING_LITERAL
+    IR_OP_LOAD, //result = the value of type at operands[0]
+    IR_OP_STORE, //stores operands[1], whose type is type, at operands[0]
+    IR_OP_MEMCOPY, //copies immediate bytes from operands[1] to operands[0]
+    IR_OP_ADD,
+    IR_OP_SUB,
+    IR_OP_MUL,
+    IR_OP_SDIV,
+    IR_OP_UDIV,
+    IR_OP_SREM,
+    IR_OP_UREM,
+    IR_OP_AND,
+    IR_OP_OR,
+    IR_OP_XOR,
+    IR_OP_SHL,
+    IR_OP_SAR,
+    IR_OP_SHR,
+    IR_OP_NEG,
+    IR_OP_NOT,
+    IR_OP_CMP, //result, an I32 0 or 1 = operands[0] condition operands[1], compared with the type of the operands
+    IR_OP_SEXT,
+    IR_OP_ZEXT,
+    IR_OP_TRUNC,
+    IR_OP_CALL, //result = symbol(arguments), result is IR_VREG_NONE for void functions
+    IR_OP_PHI, //result = the incoming value of the predecessor control came from
+    IR_OP_JUMP, //continues at targets[0]
+    IR_OP_BRANCH, //continues at targets[0] if operands[0] is not 0, at targets[1] otherwise
+    IR_OP_RETURN, //returns operands[0], or nothing if it is IR_VREG_NONE
+    IR_OP_COUNT
+};
+
+/*
+* @enum
+* @brief Conditions of IR_OP_CMP
+*/
+enum{
+    IR_CONDITION_EQ,
+    IR_CONDITION_NE,
+    IR_CONDITION_SLT,
+    IR_CONDITION_SLE,
+    IR_CONDITION_SGT,
+    IR_CONDITION_SGE,
+    IR_CONDITION_ULT,
+    IR_CONDITION_ULE,
+    IR_CONDITION_UGT,
+    IR_CONDITION_UGE
+};
+
+enum{
+    IR_INSTRUCTION_FLAG_STRING_LITERAL = 0b00000001,
+    IR_INSTRUCTION_FLAG_VARIADIC_CALL = 0b00000010
+};
+
+enum{
+    IR_STACK_SLOT_FLAG_PROMOTED = 0b00000001, //every access was rewritten to virtual registers, the slot takes no space
+    IR_STACK_SLOT_FLAG_IS_ARGUMENT = 0b00000010,
+    IR_STACK_SLOT_FLAG_UNUSED = 0b00000100 //dead code elimination removed every access, the slot takes no space
+};
+
+#define IR_VREG_NONE -1
+#define IR_MAX_OPERANDS 2
+#define IR_INLINE_SMALL_SIZE 12 //a callee costing at most this many instructions is inlined at every call
+#define IR_INLINE_STATIC_SIZE 60 //the limit for static callees, whose out of line copy disappears once every call is inlined
+#define IR_INLINE_CONSTANT_ARGUMENT_BONUS 4 //taken off the cost of a call for every constant argument, which lets the copy fold
+#define IR_INLINE_CALLER_LIMIT 2000 //a caller that has grown to this many instructions gets nothing inlined anymore
+
+typedef struct IrBlock IrBlock;
+
+/*
+* @struct IrPhiIncoming
+* @brief The value a phi takes when control comes from block
+*/
+typedef struct IrPhiIncoming{
+    IrBlock* block;
+    int vreg;
+} IrPhiIncoming;
+
+/*
+* @struct IrInstruction
+* @brief One instruction of a basic block
+* @var IrInstruction::opcode
+* Member 'opcode' is one of the IR_OP values
+* @var IrInstruction::type
+* Member 'type' is the type of result, or of the stored value for stores
+* @var IrInstruction::result
+* Member 'result' is the virtual register defined, IR_VREG_NONE if there is none
+* @var IrInstruction::operands
+* Member 'operands' are the virtual registers read, unused ones are IR_VREG_NONE
+* @var IrInstruction::immediate
+* Member 'immediate' is the constant, parameter index, byte count or symbol offset, depending on the opcode
+* @var IrInstruction::condition
+* Member 'condition' is the IR_CONDITION of a compare
+* @var IrInstruction::symbol
+* Member 'symbol' is the callee of a call or the global of an address, or the contents of a string literal
+* @var IrInstruction::slot
+* Member 'slot' is the index of the stack slot of IR_OP_SLOT_ADDRESS
+* @var IrInstruction::targets
+* Member 'targets' are the successors of JUMP and BRANCH
+* @var IrInstruction::arguments
+* Member 'arguments' holds the int argument registers of a call or the IrPhiIncoming of a phi
+* @var IrInstruction::block
+* Member 'block' is the block the instruction belongs to
+*/
+typedef struct IrInstruction{
+    int opcode;
+    int type;
+    int result;
+    int operands[IR_MAX_OPERANDS];
+    long long immediate;
+    int condition;
+    int flags;
+    const char* symbol;
+    int slot;
+    IrBlock* targets[2];
+    DynamicVector* arguments;
+    IrBlock* block;
+} IrInstruction;
+VEC_DEFINE(IrInstructionPtr, IrInstruction*)
+
+/*
+* @struct IrBlock
+* @brief A basic block
+* @details The control flow edges and dominator information are derived data, ir_compute_cfg and ir_compute_dominators rebuild them after a pass changed the terminators
+* @var IrBlock::id
+* Member 'id' is unique in the function and names the block in dumps
+* @var IrBlock::instructions
+* Member 'instructions' holds IrInstruction pointers, the last one is the terminator
+* @var IrBlock::immediate_dominator
+* Member 'immediate_dominator' is NULL for the entry block
+* @var IrBlock::dominated
+* Member 'dominated' are the children of the block in the dominator tree
+* @var IrBlock::dominance_frontier
+* Member 'dominance_frontier' are the blocks where the dominance of this block ends
+* @var IrBlock::order
+* Member 'order' is the position of the block in reverse postorder
+* @var IrBlock::dominator_tree_number
+* Member 'dominator_tree_number' is the preorder number of the block in the dominator tree, -1 for unreachable blocks
+* @var IrBlock::last_dominated_number
+* Member 'last_dominated_number' is the highest preorder number of the blocks it dominates, making dominance queries constant time
+*/
+struct IrBlock{
+    int id;
+    DynamicVector* instructions;
+    DynamicVector* predecessors;
+    DynamicVector* successors;
+    IrBlock* immediate_dominator;
+    DynamicVector* dominated;
+    DynamicVector* dominance_frontier;
+    int order;
+    int dominator_tree_number;
+    int last_dominated_number;
+};
+VEC_DEFINE(IrBlockPtr, IrBlock*)
+
+/*
+* @struct IrStackSlot
+* @brief Memory in the stack frame of a function
+* @var IrStackSlot::variable_node
+* Member 'variable_node' is the local or argument the slot holds, NULL for temporaries of the lowering
+* @var IrStackSlot::type
+* Member 'type' is the IR type of a scalar slot, IR_TYPE_VOID for arrays, structs and unions which can't be promoted
+*/
+typedef struct IrStackSlot{
+    Node* variable_node;
+    size_t size;
+    size_t alignment;
+    int type;
+    int flags;
+} IrStackSlot;
+
+/*
+* @struct IrStaticLocal
+* @brief A static local of a function, emitted with the globals under symbol
+*/
+typedef struct IrStaticLocal{
+    Node* variable_node;
+    const char* symbol;
+} IrStaticLocal;
+
+/*
+* @struct IrFunction
+* @brief The control flow graph of one function
+* @var IrFunction::blocks
+* Member 'blocks' are the IrBlock pointers in layout order, the entry block first
+* @var IrFunction::reverse_postorder
+* Member 'reverse_postorder' are the reachable blocks in reverse postorder, filled by ir_compute_cfg
+* @var IrFunction::vreg_types
+* Member 'vreg_types' holds the IR type of every virtual register, indexed by register number
+* @var IrFunction::definitions
+* Member 'definitions' maps a virtual register to the IrInstruction defining it, filled by ir_compute_def_use
+* @var IrFunction::uses
+* Member 'uses' maps a virtual register to a vector of the IrInstruction pointers reading it, filled by ir_compute_def_use
+*/
+typedef struct IrFunction{
+    Node* function_node;
+    const char* name;
+    int parameter_count;
+    DynamicVector* blocks;
+    DynamicVector* reverse_postorder;
+    DynamicVector* vreg_types;
+    DynamicVector* slots;
+    DynamicVector* static_locals;
+    DynamicVector* definitions;
+    DynamicVector* uses;
+    int next_block_id;
+} IrFunction;
+VEC_DEFINE(IrFunctionPtr, IrFunction*)
+
+/*
+* @fn IrFunction* ir_build_function(CompileProcess* process, Node* function_node)
+* @brief Lowers a function to the intermediate representation
+* @details Every local and argument gets a stack slot and is accessed with explicit loads and stores, the result is not in SSA form yet. C conversions become explicit extensions and truncations, pointer arithmetic explicit multiplications and short circuit operators, ternaries and switches control flow.
+* @param process The compile process
+* @param function_node A NODE_TYPE_FUNCTION with a body
+* @return The function, unreachable blocks are already removed
+*/
+IrFunction* ir_build_function(CompileProcess* process, Node* function_node);
+
+/*
+* @fn void ir_construct_ssa(IrFunction* function)
+* @brief Promotes stack slots to virtual registers
+* @details Scalar slots whose address is only used by loads and stores of their own type are rewritten to SSA values, phis are placed on the iterated dominance frontier of the stores
+* @param function The function, its CFG and dominators are recomputed
+*/
+void ir_construct_ssa(IrFunction* function);
+
+/*
+* @fn void ir_destruct_ssa(IrFunction* function)
+* @brief Replaces the phis by copies
+* @details Every phi gets a fresh register which each predecessor copies its incoming value to before its terminator. The phi itself becomes a copy of that register, so the copies of one edge act in parallel. The function is no longer in SSA form afterwards
+* @param function The function
+*/
+void ir_destruct_ssa(IrFunction* function);
+
+/*
+* @fn void ir_propagate_constants(IrFunction* function)
+* @brief Sparse conditional constant propagation
+* @details Finds the registers that hold the same constant on every path that can execute, assuming branches on constants only go one way. Those registers become IR_OP_CONST, branches on constants become jumps and the blocks that can't execute are deleted
+* @param function The function in SSA form, its CFG, dominators and def-use maps are recomputed
+*/
+void ir_propagate_constants(IrFunction* function);
+
+/*
+* @fn void ir_number_values(IrFunction* function)
+* @brief Global value numbering
+* @details Replaces every pure computation, and every load no store in between may have changed, by an equal one dominating it. Copies are propagated into their uses. The redundant instructions are deleted
+* @param function The function in SSA form with current dominators and def-use maps, which are recomputed
+*/
+void ir_number_values(IrFunction* function);
+
+/*
+* @fn void ir_eliminate_dead_code(IrFunction* function)
+* @brief Deletes the instructions whose result is never needed
+* @details Stores, memory copies, calls and terminators are kept together with everything they depend on, except for stores to stack slots that are never read. Slots no instruction addresses anymore are flagged IR_STACK_SLOT_FLAG_UNUSED
+* @param function The function in SSA form with current def-use maps, which are recomputed
+*/
+void ir_eliminate_dead_code(IrFunction* function);
+
+/*
+* @fn void ir_hoist_loop_invariants(IrFunction* function)
+* @brief Loop invariant code motion
+* @details Finds the natural loops of the back edges and gives every loop a preheader, a block outside the loop that jumps to its header and that every entry into the loop goes through. Innermost loops first, the pure computations whose operands are defined outside the loop move to the preheader, and so do loads of stack slots and globals nothing in the loop may write to. Divisions are only moved when their divisor is a constant that can't trap
+* @param function The function in SSA form with current CFG, dominators and def-use maps, which are recomputed
+*/
+void ir_hoist_loop_invariants(IrFunction* function);
+
+/*
+* @fn void ir_reduce_strength(IrFunction* function)
+* @brief Replaces multiplications, divisions and remainders by constants with cheaper instructions
+* @details Multiplications and unsigned divisions and remainders by powers of two become shifts and masks, signed divisions and remainders by powers of two shifts with a rounding correction. 32 bit divisions and remainders by other constants become a multiplication by a reciprocal whose upper half is the quotient
+* @param function The function in SSA form with current def-use maps, which are recomputed
+*/
+void ir_reduce_strength(IrFunction* function);
+
+/*
+* @fn void ir_reduce_induction_variables(IrFunction* function)
+* @brief Turns addresses indexed by a loop counter into pointers advanced with the counter
+* @details An address computed in a loop as an invariant base plus a basic induction variable times a constant becomes a header phi, which starts at the address of the first iteration and is advanced by the step times the constant next to the increment of the variable
+* @param function The function in SSA form with current CFG, dominators and def-use maps, which are recomputed
+*/
+void ir_reduce_induction_variables(IrFunction* function);
+
+/*
+* @fn void ir_optimize_function(IrFunction* function)
+* @brief Runs the scalar optimizations over a function
+* @details Propagates constants, reduces the strength of arithmetic by constants, numbers values, hoists loop invariants, reduces induction variables and eliminates dead code, in that order
+* @param function The function in SSA form with current CFG, dominators and def-use maps, which are recomputed
+*/
+void ir_optimize_function(IrFunction* function);
+
+/*
+* @fn void ir_inline_functions(DynamicVector* functions)
+* @brief Inlines calls between the functions of a translation unit
+* @details Callees are processed before their callers. A call is inlined when the size of the callee, less the call overhead and IR_INLINE_CONSTANT_ARGUMENT_BONUS for every constant argument, is at most IR_INLINE_SMALL_SIZE, or IR_INLINE_STATIC_SIZE for static callees, and the caller stays below IR_INLINE_CALLER_LIMIT. Recursive and variadic functions and functions with static locals are not inlined. Callers that changed are optimized again
+* @param functions The IrFunction pointers of the translation unit in SSA form
+*/
+void ir_inline_functions(DynamicVector* functions);
+
+/*
+* @fn void ir_verify_function(CompileProcess* process, IrFunction* function)
+* @brief Checks the structural and SSA invariants of a function
+* @details Raises a compiler error naming the first broken invariant: terminators, phi placement and incoming blocks, single definitions, definitions dominating their uses and operand types
+* @param process The compile process the error is reported to
+* @param function The function in SSA form
+*/
+void ir_verify_function(CompileProcess* process, IrFunction* function);
+
+/*
+* @fn void ir_dump_function(IrFunction* function, FILE* file)
+* @brief Writes a textual form of the function
+* @param function The function
+* @param file The file written to
+*/
+void ir_dump_function(IrFunction* function, FILE* file);
+
+IrBlock* ir_new_block(IrFunction* function);
+
+int ir_new_vreg(IrFunction* function, int type);
+
+int ir_get_vreg_type(IrFunction* function, int vreg);
+
+int ir_get_vreg_count(IrFunction* function);
+
+IrInstruction* ir_new_instruction(int opcode, int type, int result);
+
+void ir_append_instruction(IrBlock* block, IrInstruction* instruction);
+
+void ir_insert_instruction(IrBlock* block, int index, IrInstruction* instruction);
+
+void ir_free_instruction(IrInstruction* instruction);
+
+IrInstruction* ir_get_terminator(IrBlock* block);
+
+bool is_ir_terminator(IrInstruction* instruction);
+
+/*
+* @fn bool is_ir_rematerializable(IrInstruction* instruction)
+* @brief Whether the value defined by instruction is cheaper to recompute at every use than to keep in a register, true for constants, addresses and undefined values, which need no computation at all
+*/
+bool is_ir_rematerializable(IrInstruction* instruction);
+
+int ir_type_size(int type);
+
+int ir_type_for_size(size_t size);
+
+/*
+* @fn long long ir_truncate_constant(int type, long long value)
+* @brief Wraps the value to the width of the IR type and sign extends it back, the canonical immediate of a constant of that type
+*/
+long long ir_truncate_constant(int type, long long value);
+
+/*
+* @fn bool ir_fold_instruction(IrFunction* function, IrInstruction* instruction, long long left, long long right, long long* value_out)
+* @brief Computes what an instruction yields when its operands hold the constants left and right
+* @details Folds constants, copies, conversions, arithmetic, shifts and compares with the wrapping and the shift count masking of the generated code. Loads, calls, phis and divisions that would trap at run time are not folded
+* @param function The function, for the types of the operands
+* @param instruction The instruction, only its opcode, type and condition are read
+* @param left The value of operands[0]
+* @param right The value of operands[1], ignored by unary operations
+* @param value_out Receives the result, truncated to the type of the instruction
+* @return true if the instruction could be folded
+*/
+bool ir_fold_instruction(IrFunction* function, IrInstruction* instruction, long long left, long long right, long long* value_out);
+
+/*
+* @fn void ir_make_constant(IrInstruction* instruction, long long value)
+* @brief Turns an instruction without side effects into an IR_OP_CONST of value, keeping its result register
+*/
+void ir_make_constant(IrInstruction* instruction, long long value);
+
+/*
+* @fn void ir_compute_cfg(IrFunction* function)
+* @brief Rebuilds predecessors, successors and the reverse postorder from the terminators
+*/
+void ir_compute_cfg(IrFunction* function);
+
+/*
+* @fn void ir_remove_unreachable_blocks(IrFunction* function)
+* @brief Deletes the blocks the entry block can't reach and drops their phi incomings
+* @details Recomputes the CFG before and after
+*/
+void ir_remove_unreachable_blocks(IrFunction* function);
+
+/*
+* @fn void ir_compute_dominators(IrFunction* function)
+* @brief Computes immediate dominators, the dominator tree and dominance frontiers
+* @details Uses the iterative algorithm of Cooper, Harvey and Kennedy over the reverse postorder, ir_compute_cfg must be current
+*/
+void ir_compute_dominators(IrFunction* function);
+
+bool ir_block_dominates(IrBlock* dominator, IrBlock* block);
+
+/*
+* @fn void ir_compute_def_use(IrFunction* function)
+* @brief Rebuilds the definitions and uses maps of every virtual register
+*/
+void ir_compute_def_use(IrFunction* function);
+
+void ir_replace_vreg_uses(IrFunction* function, int vreg, int replacement);
+
+void ir_free_function(IrFunction* function);
+
+/*
+* @fn DynamicVector* ir_find_loop_headers(IrFunction* function)
+* @brief Finds the headers of the natural loops, blocks that dominate one of their predecessors
+* @details Loops back to the entry block are left out, they have no place for a preheader. CFG and dominators must be current
+* @return The IrBlock pointers ordered by the size of their loop, so inner loops come before the loops containing them
+*/
+DynamicVector* ir_find_loop_headers(IrFunction* function);
+
+/*
+* @fn int ir_find_loop_body(IrBlock* header, bool* body)
+* @brief Marks the blocks of the natural loop of header in body, which is indexed by block id
+* @return The number of blocks of the loop
+*/
+int ir_find_loop_body(IrBlock* header, bool* body);
+
+/*
+* @fn IrBlock* ir_make_preheader(IrFunction* function, IrBlock* header, bool* body)
+* @brief Returns the block every edge entering the loop from outside goes through, creating it in front of the header if there is none
+* @details A new preheader takes over the edges from outside and the header phis merging their values. CFG, dominators and def-use maps are recomputed then. body must have room for the id of the new block
+* @return The preheader, NULL if nothing outside the loop reaches the header
+*/
+IrBlock* ir_make_preheader(IrFunction* function, IrBlock* header, bool* body);
+
+/*
+* @struct IrAddress
+* @brief Where an address points, as far as pointer arithmetic can be traced back
+* @var IrAddress::base
+* Member 'base' is the IR_OP_SLOT_ADDRESS or IR_OP_GLOBAL_ADDRESS the address is derived from, NULL if unknown
+* @var IrAddress::offset
+* Member 'offset' is the distance from base in bytes, valid when is_offset_known is set
+*/
+typedef struct IrAddress{
+    IrInstruction* base;
+    long long offset;
+    bool is_offset_known;
+} IrAddress;
+
+IrAddress ir_resolve_address(IrFunction* function, int vreg);
+
+/*
+* @fn bool* ir_find_escaped_slots(IrFunction* function)
+* @brief Finds the stack slots whose address is stored, passed or returned, so that other pointers and calls may reach them
+* @return A bool per slot the caller frees, def-use maps must be current
+*/
+bool* ir_find_escaped_slots(IrFunction* function);
+
+bool is_ir_private_slot(bool* escaped_slots, IrInstruction* base);
+
+/*
+* @fn bool ir_may_alias(IrFunction* function, bool* escaped_slots, int first, size_t first_size, int second, size_t second_size)
+* @brief Whether first_size bytes at the address in register first can overlap second_size bytes at the address in register second
+* @details Addresses based on different slots or globals never overlap, neither do constant offsets from the same one whose ranges are disjoint. An unknown pointer may point anywhere but into a slot that didn't escape
+*/
+bool ir_may_alias(IrFunction* function, bool* escaped_slots, int first, size_t first_size, int second, size_t second_size);
+
+//declarations for the x86-64 backend begin here
+
+enum{
+    CODEGEN_ALL_OK,
+    CODEGEN_GENERAL_ERROR
+};
+
+/*
+* @enum
+* @brief The x86-64 general purpose registers, in hardware encoding order
+*/
+enum{
+    ASM_REGISTER_RAX,
+    ASM_REGISTER_RCX,
+    ASM_REGISTER_RDX,
+    ASM_REGISTER_RBX,
+    ASM_REGISTER_RSP,
+    ASM_REGISTER_RBP,
+    ASM_REGISTER_RSI,
+    ASM_REGISTER_RDI,
+    ASM_REGISTER_R8,
+    ASM_REGISTER_R9,
+    ASM_REGISTER_R10,
+    ASM_REGISTER_R11,
+    ASM_REGISTER_R12,
+    ASM_REGISTER_R13,
+    ASM_REGISTER_R14,
+    ASM_REGISTER_R15,
+    ASM_REGISTER_RIP,
+    ASM_REGISTER_COUNT,
+    ASM_REGISTER_NONE = -1
+};
+
+/*
+* @enum
+* @brief The kinds of instruction operands
+*/
+enum{
+    ASM_OPERAND_NONE,
+    ASM_OPERAND_REGISTER,
+    ASM_OPERAND_IMMEDIATE,
+    ASM_OPERAND_MEMORY, //displacement(base, index, scale), or symbol+displacement(%rip) when symbol is set
+    ASM_OPERAND_LABEL, //a local label, the target of a jump
+    ASM_OPERAND_SYMBOL //a global symbol, the target of a call
+};
+
+/*
+* @enum
+* @brief The instructions the backend emits
+* @details Extensions take their widths from the operand sizes, every other instruction from AsmInstruction::size
+*/
+enum{
+    ASM_OPCODE_LABEL, //not an instruction, places the label of destination
+    ASM_OPCODE_MOV,
+    ASM_OPCODE_MOVSX,
+    ASM_OPCODE_MOVZX,
+    ASM_OPCODE_LEA,
+    ASM_OPCODE_ADD,
+    ASM_OPCODE_SUB,
+    ASM_OPCODE_IMUL,
+    ASM_OPCODE_IDIV,
+    ASM_OPCODE_DIV,
+    ASM_OPCODE_CQO,
+    ASM_OPCODE_NEG,
+    ASM_OPCODE_NOT,
+    ASM_OPCODE_AND,
+    ASM_OPCODE_OR,
+    ASM_OPCODE_XOR,
+    ASM_OPCODE_SHL,
+    ASM_OPCODE_SAR,
+    ASM_OPCODE_SHR,
+    ASM_OPCODE_CMP,
+    ASM_OPCODE_TEST,
+    ASM_OPCODE_SETCC,
+    ASM_OPCODE_JMP,
+    ASM_OPCODE_JCC,
+    ASM_OPCODE_CALL,
+    ASM_OPCODE_RET,
+    ASM_OPCODE_PUSH,
+    ASM_OPCODE_POP,
+    ASM_OPCODE_LEAVE,
+    ASM_OPCODE_REP_MOVSB,
+    ASM_OPCODE_COUNT
+};
+
+/*
+* @enum
+* @brief Condition codes of jcc and setcc, B/BE/A/AE are the unsigned comparisons
+*/
+enum{
+    ASM_CONDITION_NONE,
+    ASM_CONDITION_E,
+    ASM_CONDITION_NE,
+    ASM_CONDITION_L,
+    ASM_CONDITION_LE,
+    ASM_CONDITION_G,
+    ASM_CONDITION_GE,
+    ASM_CONDITION_B,
+    ASM_CONDITION_BE,
+    ASM_CONDITION_A,
+    ASM_CONDITION_AE
+};
+
+/*
+* @struct AsmOperand
+* @brief An operand of an instruction
+* @var AsmOperand::type
+* Member 'type' is one of the ASM_OPERAND kinds
+* @var AsmOperand::size
+* Member 'size' is the width in bytes the operand is accessed with, selects the register name
+* @var AsmOperand::reg
+* Member 'reg' is the register of a register operand or the base of a memory operand
+* @var AsmOperand::index
+* Member 'index' is the index register of a memory operand, ASM_REGISTER_NONE if there is none
+* @var AsmOperand::scale
+* Member 'scale' multiplies the index register, the index is only used when it is not 0
+* @var AsmOperand::value
+* Member 'value' is the immediate, or the displacement of a memory operand
+* @var AsmOperand::symbol
+* Member 'symbol' names a global for rip relative memory operands and calls
+* @var AsmOperand::label
+* Member 'label' is the id of a local label, or of the string literal a rip relative operand without a symbol refers to
+*/
+typedef struct AsmOperand{
+    int type;
+    int size;
+    int reg;
+    int index;
+    int scale;
+    long long value;
+    const char* symbol;
+    int label;
+} AsmOperand;
+
+/*
+* @struct AsmInstruction
+* @brief One instruction of the backend's instruction list
+* @details Functions are generated into a vector of these and only turned into text once the whole function is known, so passes can rewrite the list in between
+* @var AsmInstruction::opcode
+* Member 'opcode' is one of the ASM_OPCODE values
+* @var AsmInstruction::size
+* Member 'size' is the operation width in bytes, it selects the b/w/l/q suffix
+* @var AsmInstruction::condition
+* Member 'condition' is the condition code of jcc and setcc
+* @var AsmInstruction::source
+* Member 'source' is the first operand in AT&T order
+* @var AsmInstruction::destination
+* Member 'destination' is the operand written, single operand instructions only use destination
+*/
+typedef struct AsmInstruction{
+    int opcode;
+    int size;
+    int condition;
+    AsmOperand source;
+    AsmOperand destination;
+} AsmInstruction;
+VEC_DEFINE(AsmInstruction, AsmInstruction)
+
+/*
+* @enum
+* @brief The rewrite rules of the peephole optimizer, they index its fire counts
+*/
+enum{
+    ASM_PEEPHOLE_MOVE_TO_SELF,
+    ASM_PEEPHOLE_PUSH_POP,
+    ASM_PEEPHOLE_STORE_LOAD,
+    ASM_PEEPHOLE_LOAD_STORE,
+    ASM_PEEPHOLE_IDENTITY_ARITHMETIC,
+    ASM_PEEPHOLE_LEA_OFFSET,
+    ASM_PEEPHOLE_LEA_MOVE,
+    ASM_PEEPHOLE_LEA_ADDRESS,
+    ASM_PEEPHOLE_COMPARE_ZERO,
+    ASM_PEEPHOLE_JUMP_THREADING,
+    ASM_PEEPHOLE_JUMP_TO_NEXT,
+    ASM_PEEPHOLE_UNREACHABLE,
+    ASM_PEEPHOLE_RULE_COUNT
+};
+
+/*
+* @fn void asm_optimize_peephole(DynamicVector* instructions, int* fire_counts)
+* @brief Cleans up the instructions selected for a function through a window of consecutive instructions
+* @details Every rule is tried at every position until none fires anymore. Moves of a register to itself and push/pop pairs become nothing or a move, a load of what was just stored takes the stored register and storing back what was just loaded is dropped. Adding, subtracting, or-ing, xor-ing and shifting by 0 goes away when the flags are not read, constants added to an address computed by lea and the move or memory access that follows it fold into the lea, and compares with 0 become test. Jumps to jumps are threaded to their final target, jumps to the next instruction and instructions no label leads to after a jump or return are deleted.
+* @param instructions The AsmInstruction vector of a whole function, with its prologue and epilogue
+* @param fire_counts ASM_PEEPHOLE_RULE_COUNT counters, every rewrite adds 1 to the one of its rule
+*/
+void asm_optimize_peephole(DynamicVector* instructions, int* fire_counts);
+
+/*
+* @fn void asm_dump_peephole_counts(int* fire_counts, FILE* file)
+* @brief Prints how often every peephole rule fired
+* @param fire_counts The counters asm_optimize_peephole added to
+* @param file The file to print to
+*/
+void asm_dump_peephole_counts(int* fire_counts, FILE* file);
+
+/*
+* @fn int codegen(CompileProcess* process)
+* @brief Generates x86-64 assembly for the parsed file
+* @details Walks node_tree_vector and writes GNU assembler text for the System V ABI to the output file of the process. Global variables go to .data or .bss, string literals to .rodata and every function with a body to .text. Functions are lowered with ir_build_function, promoted to SSA form, optimized by ir_propagate_constants and verified, then given registers by allocate_registers and selected instruction by instruction after ir_destruct_ssa, the selected instructions are cleaned up by asm_optimize_peephole. Stack slots that were not promoted, spilled virtual registers and the callee saved registers in use live in the frame. Floating point types are not supported yet.
+* @param process The compile process, parse must have succeeded
+* @return CODEGEN_ALL_OK on success
+*/
+int codegen(CompileProcess* process);
+
+/*
+* @fn const char* get_asm_register_name(int reg, int size)
+* @brief Gets the AT&T name of a register viewed with the given width
+* @param reg One of the ASM_REGISTER values
+* @param size The width in bytes, 1, 2, 4 or 8
+* @return The register name without the % prefix
+*/
+const char* get_asm_register_name(int reg, int size);
+
+/*
+* @struct RegisterAllocation
+* @brief Where the virtual registers of a function live
+* @var RegisterAllocation::registers
+* Member 'registers' holds the ASM_REGISTER of every virtual register, ASM_REGISTER_NONE for the spilled ones, which need a home in the frame, and for rematerializable ones
+* @var RegisterAllocation::used_registers
+* Member 'used_registers' has bit 1 << reg set for every register assigned to a virtual register, the callee saved ones among them have to be preserved
+* @var RegisterAllocation::spill_count
+* Member 'spill_count' is the number of virtual registers that did not get a register
+*/
+typedef struct RegisterAllocation{
+    int* registers;
+    int used_registers;
+    int spill_count;
+} RegisterAllocation;
+
+/*
+* @fn RegisterAllocation* allocate_registers(IrFunction* function)
+* @brief Maps the virtual registers of a function onto x86-64 general purpose registers
+* @details A linear scan over live intervals in block layout order. Intervals crossing a call only get callee saved registers, when no register is free the interval with the lowest spill weight, its uses and definitions weighted by loop depth per instruction of its length, is spilled. rax, rcx and rdx are never assigned, instruction selection uses them as scratch registers.
+* @param function The function after ir_destruct_ssa, with current CFG and def-use maps
+* @return The allocation, freed with free_register_allocation
+*/
+RegisterAllocation* allocate_registers(IrFunction* function);
+
+void free_register_allocation(RegisterAllocation* allocation);
+
 #endif
\ No newline at end of file
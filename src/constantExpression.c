@@ -0,0 +1,475 @@
+/*
+* @file constantExpression.c
+* @brief Integer constant expression evaluator
+* @details Folds expression nodes to integers at parse time for array sizes, sizeof and case labels. Every folded value carries its C type, operands are promoted and converted the way C does before an operator is applied. The result of every node is cached on the node, so an expression is evaluated at most once however often it is queried.
+*/
+
+#include "compiler.h"
+#include <assert.h>
+#include <limits.h>
+
+bool evaluate_constant_expression(CompileProcess* process, Node* node, long long* value_out);
+
+bool evaluate_typed_constant_expression(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+long long expect_constant_expression(CompileProcess* process, Node* node, const char* context);
+
+long long get_node_constant_value(Node* node);
+
+static bool evaluate_constant_node(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+static bool evaluate_constant_binary_expression(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+static bool evaluate_constant_unary_expression(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+static bool evaluate_constant_operator(CompileProcess* process, const char* operator, ConstantValue left, ConstantValue right, ConstantValue* constant_out);
+
+static bool evaluate_constant_cast(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+static bool evaluate_constant_sizeof(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+static bool evaluate_constant_identifier(CompileProcess* process, Node* node, ConstantValue* constant_out);
+
+static bool get_constant_expression_type(CompileProcess* process, Node* node, ConstantValue* type_out);
+
+static bool is_datatype_constant_integer(DataType* datatype);
+
+static ConstantValue make_constant_value(long long value, size_t size, bool is_unsigned);
+
+static ConstantValue make_constant_int(CompileProcess* process, long long value);
+
+static ConstantValue convert_constant_to_datatype(ConstantValue constant, DataType* datatype);
+
+static ConstantValue promote_constant(CompileProcess* process, ConstantValue constant);
+
+static void convert_constants_to_common_type(CompileProcess* process, ConstantValue* left, ConstantValue* right);
+
+
+
+bool evaluate_constant_expression(CompileProcess* process, Node* node, long long* value_out){
+    ConstantValue constant;
+    if(!evaluate_typed_constant_expression(process, node, &constant)){
+        return false;
+    }
+    if(value_out){
+        *value_out = constant.value;
+    }
+    return true;
+}
+
+bool evaluate_typed_constant_expression(CompileProcess* process, Node* node, ConstantValue* constant_out){
+    if(!node){
+        return false;
+    }
+    if(!(node->flags & NODE_FLAG_CONSTANT_EVALUATED)){
+        ConstantValue constant;
+        //marked before evaluating so a const variable initialized with itself terminates
+        node->flags |= NODE_FLAG_CONSTANT_EVALUATED;
+        if(evaluate_constant_node(process, node, &constant)){
+            node->flags |= NODE_FLAG_IS_CONSTANT;
+            node->constant = constant;
+        }
+    }
+    if(!(node->flags & NODE_FLAG_IS_CONSTANT)){
+        return false;
+    }
+    if(constant_out){
+        *constant_out = node->constant;
+    }
+    return true;
+}
+
+long long expect_constant_expression(CompileProcess* process, Node* node, const char* context){
+    long long value = 0;
+    if(!evaluate_constant_expression(process, node, &value)){
+        compiler_error(process, "%s must be an integer constant expression", context);
+    }
+    return value;
+}
+
+long long get_node_constant_value(Node* node){
+    assert(node->flags & NODE_FLAG_IS_CONSTANT);
+    return node->constant.value;
+}
+
+// Dispatches on the node type, children go through evaluate_typed_constant_expression so their results are cached too.
+static bool evaluate_constant_node(CompileProcess* process, Node* node, ConstantValue* constant_out){
+    switch(node->type){
+        case NODE_TYPE_NUMBER:
+            *constant_out = convert_constant_to_datatype(make_constant_value(node->literal_value.long_long_num, sizeof(long long), true), get_number_literal_datatype(process, node));
+            return true;
+        case NODE_TYPE_EXPRESSION_PARENTHESES:
+            return evaluate_typed_constant_expression(process, node->data.parentheses.expression, constant_out);
+        case NODE_TYPE_EXPRESSION:
+            return evaluate_constant_binary_expression(process, node, constant_out);
+        case NODE_TYPE_UNARY:
+            return evaluate_constant_unary_expression(process, node, constant_out);
+        case NODE_TYPE_CAST:
+            return evaluate_constant_cast(process, node, constant_out);
+        case NODE_TYPE_SIZEOF:
+            return evaluate_constant_sizeof(process, node, constant_out);
+        case NODE_TYPE_IDENTIFIER:
+            return evaluate_constant_identifier(process, node, constant_out);
+    }
+    return false;
+}
+
+// Folds a binary expression, the ternary operator is stored as EXP(condition ? TERNARY(true, false)).
+static bool evaluate_constant_binary_expression(CompileProcess* process, Node* node, ConstantValue* constant_out){
+    const char* operator = node->data.expression.operator;
+    ConstantValue left;
+    if(!evaluate_typed_constant_expression(process, node->data.expression.left, &left)){
+        return false;
+    }
+    Node* right_node = node->data.expression.right;
+    if(ARE_STRINGS_EQUAL(operator, "?")){
+        if(!right_node || right_node->type != NODE_TYPE_TERNARY){
+            return false;
+        }
+        //only the selected operand is evaluated, eg: 1 ? 2 : 1/0 is 2, the other one just contributes its type
+        Node* selected_node = left.value ? right_node->data.tenary.true_expression : right_node->data.tenary.false_expression;
+        Node* other_node = left.value ? right_node->data.tenary.false_expression : right_node->data.tenary.true_expression;
+        ConstantValue selected;
+        ConstantValue other;
+        if(!evaluate_typed_constant_expression(process, selected_node, &selected) || !get_constant_expression_type(process, other_node, &other)){
+            return false;
+        }
+        //the result has the common type of both operands, eg: 1 ? -1 : 0u is an unsigned int
+        convert_constants_to_common_type(process, &selected, &other);
+        *constant_out = selected;
+        return true;
+    }
+    //the right side of a short circuit operator is not evaluated, eg: 0 && x is constant
+    if(ARE_STRINGS_EQUAL(operator, "&&") && !left.value){
+        *constant_out = make_constant_int(process, 0);
+        return true;
+    }
+    if(ARE_STRINGS_EQUAL(operator, "||") && left.value){
+        *constant_out = make_constant_int(process, 1);
+        return true;
+    }
+    ConstantValue right;
+    if(!evaluate_typed_constant_expression(process, right_node, &right)){
+        return false;
+    }
+    return evaluate_constant_operator(process, operator, left, right, constant_out);
+}
+
+// Folds the arithmetic unary operators, increments, dereferences and address-of are never constant.
+static bool evaluate_constant_unary_expression(CompileProcess* process, Node* node, ConstantValue* constant_out){
+    const char* operator = node->data.unary.operator;
+    if(node->data.unary.flags & UNARY_FLAG_IS_POSTFIX){
+        return false;
+    }
+    if(!ARE_STRINGS_EQUAL(operator, "-") && !ARE_STRINGS_EQUAL(operator, "+") && !ARE_STRINGS_EQUAL(operator, "~") && !ARE_STRINGS_EQUAL(operator, "!")){
+        return false;
+    }
+    ConstantValue operand;
+    if(!evaluate_typed_constant_expression(process, node->data.unary.operand, &operand)){
+        return false;
+    }
+    if(ARE_STRINGS_EQUAL(operator, "!")){
+        *constant_out = make_constant_int(process, !operand.value);
+        return true;
+    }
+    operand = promote_constant(process, operand);
+    long long value = operand.value;
+    if(ARE_STRINGS_EQUAL(operator, "-")){
+        value = (long long)(0ULL - (unsigned long long)operand.value);
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "~")){
+        value = ~operand.value;
+    }
+    *constant_out = make_constant_value(value, operand.size, operand.is_unsigned);
+    return true;
+}
+
+// Applies a binary operator to two folded operands, assignments, the comma operator and calls are never constant.
+static bool evaluate_constant_operator(CompileProcess* process, const char* operator, ConstantValue left, ConstantValue right, ConstantValue* constant_out){
+    if(ARE_STRINGS_EQUAL(operator, "&&")){
+        *constant_out = make_constant_int(process, left.value && right.value);
+        return true;
+    }
+    if(ARE_STRINGS_EQUAL(operator, "||")){
+        *constant_out = make_constant_int(process, left.value || right.value);
+        return true;
+    }
+    if(ARE_STRINGS_EQUAL(operator, "<<") || ARE_STRINGS_EQUAL(operator, ">>")){
+        //the operands of a shift are promoted separately, the result has the type of the left one
+        left = promote_constant(process, left);
+        right = promote_constant(process, right);
+        if((!right.is_unsigned && right.value < 0) || (unsigned long long)right.value >= left.size * CHAR_BIT){
+            compiler_error(process, "invalid shift count %lld in constant expression", right.value);
+        }
+        long long value = 0;
+        if(ARE_STRINGS_EQUAL(operator, "<<")){
+            value = (long long)((unsigned long long)left.value << right.value);
+        }
+        else{
+            //unsigned values are stored zero extended, so the logical shift only has to be asked for
+            value = left.is_unsigned ? (long long)((unsigned long long)left.value >> right.value) : left.value >> right.value;
+        }
+        *constant_out = make_constant_value(value, left.size, left.is_unsigned);
+        return true;
+    }
+    convert_constants_to_common_type(process, &left, &right);
+    unsigned long long unsigned_left = left.value;
+    unsigned long long unsigned_right = right.value;
+    bool is_unsigned = left.is_unsigned;
+    if(ARE_STRINGS_EQUAL(operator, "/") || ARE_STRINGS_EQUAL(operator, "%")){
+        if(right.value == 0){
+            compiler_error(process, "division by zero in constant expression");
+        }
+        bool is_division = ARE_STRINGS_EQUAL(operator, "/");
+        if(is_unsigned){
+            *constant_out = make_constant_value((long long)(is_division ? unsigned_left / unsigned_right : unsigned_left % unsigned_right), left.size, true);
+            return true;
+        }
+        long long minimum = left.size >= sizeof(long long) ? LLONG_MIN : -(1LL << (left.size * CHAR_BIT - 1));
+        if(left.value == minimum && right.value == -1){
+            compiler_error(process, "overflow in constant expression");
+        }
+        *constant_out = make_constant_value(is_division ? left.value / right.value : left.value % right.value, left.size, false);
+        return true;
+    }
+    //wrapping arithmetic, matches what the generated code computes
+    unsigned long long result = 0;
+    if(ARE_STRINGS_EQUAL(operator, "+")){
+        result = unsigned_left + unsigned_right;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "-")){
+        result = unsigned_left - unsigned_right;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "*")){
+        result = unsigned_left * unsigned_right;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "&")){
+        result = unsigned_left & unsigned_right;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "|")){
+        result = unsigned_left | unsigned_right;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "^")){
+        result = unsigned_left ^ unsigned_right;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "==")){
+        *constant_out = make_constant_int(process, left.value == right.value);
+        return true;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "!=")){
+        *constant_out = make_constant_int(process, left.value != right.value);
+        return true;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "<")){
+        *constant_out = make_constant_int(process, is_unsigned ? unsigned_left < unsigned_right : left.value < right.value);
+        return true;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, ">")){
+        *constant_out = make_constant_int(process, is_unsigned ? unsigned_left > unsigned_right : left.value > right.value);
+        return true;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "<=")){
+        *constant_out = make_constant_int(process, is_unsigned ? unsigned_left <= unsigned_right : left.value <= right.value);
+        return true;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, ">=")){
+        *constant_out = make_constant_int(process, is_unsigned ? unsigned_left >= unsigned_right : left.value >= right.value);
+        return true;
+    }
+    else{
+        return false;
+    }
+    *constant_out = make_constant_value((long long)result, left.size, is_unsigned);
+    return true;
+}
+
+// Folds a cast to an integer type by converting the operand to the type.
+static bool evaluate_constant_cast(CompileProcess* process, Node* node, ConstantValue* constant_out){
+    DataType* datatype = node->data.cast.data_type;
+    if(!is_datatype_constant_integer(datatype)){
+        return false;
+    }
+    ConstantValue operand;
+    if(!evaluate_typed_constant_expression(process, node->data.cast.operand_node, &operand)){
+        return false;
+    }
+    *constant_out = convert_constant_to_datatype(operand, datatype);
+    return true;
+}
+
+// Returns the size of the type, or of the declared type of a variable, string or number operand, as a size_t. Other operands are not constant here.
+static bool evaluate_constant_sizeof(CompileProcess* process, Node* node, ConstantValue* constant_out){
+    size_t size = 0;
+    Node* expression_node = node->data.size_of.expression_node;
+    while(expression_node && expression_node->type == NODE_TYPE_EXPRESSION_PARENTHESES){
+        expression_node = expression_node->data.parentheses.expression;
+    }
+    if(node->data.size_of.data_type){
+        size = get_datatype_size(process, node->data.size_of.data_type);
+    }
+    else if(!expression_node){
+        return false;
+    }
+    else if(expression_node->type == NODE_TYPE_NUMBER){
+        size = get_datatype_size(process, get_number_literal_datatype(process, expression_node));
+    }
+    else if(expression_node->type == NODE_TYPE_STRING){
+        size = strlen(expression_node->literal_value.string_val) + 1;
+    }
+    else if(expression_node->type == NODE_TYPE_IDENTIFIER && expression_node->data.identifier.declaration && expression_node->data.identifier.declaration->type == NODE_TYPE_VARIABLE){
+        size = get_datatype_size(process, expression_node->data.identifier.declaration->data.var.data_type);
+    }
+    else if(expression_node->type == NODE_TYPE_CAST){
+        size = get_datatype_size(process, expression_node->data.cast.data_type);
+    }
+    else{
+        //member accesses, dereferences and calls are typed by the code generator instead
+        return false;
+    }
+    *constant_out = make_constant_value(size, process->target->long_size, true);
+    return true;
+}
+
+// A const integer variable whose initializer is itself constant folds to that initializer.
+static bool evaluate_constant_identifier(CompileProcess* process, Node* node, ConstantValue* constant_out){
+    Node* declaration = node->data.identifier.declaration;
+    if(!declaration || declaration->type != NODE_TYPE_VARIABLE){
+        return false;
+    }
+    DataType* datatype = declaration->data.var.data_type;
+    if(!(datatype->flags & DATATYPE_FLAG_IS_CONST) || !is_datatype_constant_integer(datatype)){
+        return false;
+    }
+    ConstantValue initializer;
+    if(!evaluate_typed_constant_expression(process, declaration->data.var.value, &initializer)){
+        return false;
+    }
+    *constant_out = convert_constant_to_datatype(initializer, datatype);
+    return true;
+}
+
+// Works out the type an expression would fold to without evaluating it, for the operand of ?: that is not selected. The value is left at 0.
+static bool get_constant_expression_type(CompileProcess* process, Node* node, ConstantValue* type_out){
+    if(!node){
+        return false;
+    }
+    ConstantValue left;
+    ConstantValue right;
+    switch(node->type){
+        case NODE_TYPE_NUMBER:
+            *type_out = convert_constant_to_datatype(make_constant_value(0, sizeof(long long), true), get_number_literal_datatype(process, node));
+            return true;
+        case NODE_TYPE_EXPRESSION_PARENTHESES:
+            return get_constant_expression_type(process, node->data.parentheses.expression, type_out);
+        case NODE_TYPE_EXPRESSION:{
+            const char* operator = node->data.expression.operator;
+            if(ARE_STRINGS_EQUAL(operator, "?")){
+                Node* right_node = node->data.expression.right;
+                if(!right_node || right_node->type != NODE_TYPE_TERNARY || !get_constant_expression_type(process, right_node->data.tenary.true_expression, &left) || !get_constant_expression_type(process, right_node->data.tenary.false_expression, &right)){
+                    return false;
+                }
+                convert_constants_to_common_type(process, &left, &right);
+                *type_out = left;
+                return true;
+            }
+            if(!get_constant_expression_type(process, node->data.expression.left, &left) || !get_constant_expression_type(process, node->data.expression.right, &right)){
+                return false;
+            }
+            if(ARE_STRINGS_EQUAL(operator, "&&") || ARE_STRINGS_EQUAL(operator, "||") || ARE_STRINGS_EQUAL(operator, "==") || ARE_STRINGS_EQUAL(operator, "!=") || ARE_STRINGS_EQUAL(operator, "<") || ARE_STRINGS_EQUAL(operator, ">") || ARE_STRINGS_EQUAL(operator, "<=") || ARE_STRINGS_EQUAL(operator, ">=")){
+                *type_out = make_constant_int(process, 0);
+                return true;
+            }
+            if(ARE_STRINGS_EQUAL(operator, "<<") || ARE_STRINGS_EQUAL(operator, ">>")){
+                *type_out = promote_constant(process, left);
+                return true;
+            }
+            if(!ARE_STRINGS_EQUAL(operator, "+") && !ARE_STRINGS_EQUAL(operator, "-") && !ARE_STRINGS_EQUAL(operator, "*") && !ARE_STRINGS_EQUAL(operator, "/") && !ARE_STRINGS_EQUAL(operator, "%") && !ARE_STRINGS_EQUAL(operator, "&") && !ARE_STRINGS_EQUAL(operator, "|") && !ARE_STRINGS_EQUAL(operator, "^")){
+                return false;
+            }
+            convert_constants_to_common_type(process, &left, &right);
+            *type_out = left;
+            return true;
+        }
+        case NODE_TYPE_UNARY:{
+            const char* operator = node->data.unary.operator;
+            if(node->data.unary.flags & UNARY_FLAG_IS_POSTFIX || (!ARE_STRINGS_EQUAL(operator, "-") && !ARE_STRINGS_EQUAL(operator, "+") && !ARE_STRINGS_EQUAL(operator, "~") && !ARE_STRINGS_EQUAL(operator, "!"))){
+                return false;
+            }
+            if(!get_constant_expression_type(process, node->data.unary.operand, &left)){
+                return false;
+            }
+            *type_out = ARE_STRINGS_EQUAL(operator, "!") ? make_constant_int(process, 0) : promote_constant(process, left);
+            return true;
+        }
+        case NODE_TYPE_CAST:
+            if(!is_datatype_constant_integer(node->data.cast.data_type) || !get_constant_expression_type(process, node->data.cast.operand_node, &left)){
+                return false;
+            }
+            *type_out = convert_constant_to_datatype(left, node->data.cast.data_type);
+            return true;
+        case NODE_TYPE_SIZEOF:
+            *type_out = make_constant_value(0, process->target->long_size, true);
+            return true;
+        case NODE_TYPE_IDENTIFIER:{
+            //gcc accepts any integer variable in the operand that is not evaluated
+            Node* declaration = node->data.identifier.declaration;
+            if(!declaration || declaration->type != NODE_TYPE_VARIABLE || !is_datatype_constant_integer(declaration->data.var.data_type)){
+                return false;
+            }
+            *type_out = convert_constant_to_datatype(make_constant_value(0, sizeof(long long), true), declaration->data.var.data_type);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Integer types are the only ones constant expressions fold, pointers, arrays, floating point, void and aggregates are not.
+static bool is_datatype_constant_integer(DataType* datatype){
+    if(datatype->flags & (DATATYPE_FLAG_IS_POINTER | DATATYPE_FLAG_IS_ARRAY) || !is_datatype_primitive(datatype)){
+        return false;
+    }
+    return datatype->type != DATA_TYPE_FLOAT && datatype->type != DATA_TYPE_DOUBLE && datatype->type != DATA_TYPE_VOID;
+}
+
+// Wraps the value to the size, sign extending signed types and zero extending unsigned ones.
+static ConstantValue make_constant_value(long long value, size_t size, bool is_unsigned){
+    ConstantValue constant = {.value = value, .is_unsigned = is_unsigned, .size = size};
+    if(size == 0 || size >= sizeof(long long)){
+        return constant;
+    }
+    unsigned long long bits = size * CHAR_BIT;
+    unsigned long long mask = (1ULL << bits) - 1;
+    unsigned long long truncated = (unsigned long long)value & mask;
+    if(!is_unsigned && truncated & (1ULL << (bits - 1))){
+        truncated |= ~mask;
+    }
+    constant.value = (long long)truncated;
+    return constant;
+}
+
+// The int results of the relational, equality and logical operators.
+static ConstantValue make_constant_int(CompileProcess* process, long long value){
+    return make_constant_value(value, process->target->int_size, false);
+}
+
+static ConstantValue convert_constant_to_datatype(ConstantValue constant, DataType* datatype){
+    return make_constant_value(constant.value, datatype->size, !(datatype->flags & DATATYPE_FLAG_IS_SIGNED));
+}
+
+// Integer promotion, every value of a type narrower than int fits an int.
+static ConstantValue promote_constant(CompileProcess* process, ConstantValue constant){
+    if(constant.size >= process->target->int_size){
+        return constant;
+    }
+    return make_constant_int(process, constant.value);
+}
+
+// The usual arithmetic conversions, both operands take the wider of the promoted types, unsigned if the wider one is.
+static void convert_constants_to_common_type(CompileProcess* process, ConstantValue* left, ConstantValue* right){
+    *left = promote_constant(process, *left);
+    *right = promote_constant(process, *right);
+    size_t size = left->size > right->size ? left->size : right->size;
+    bool is_unsigned = (left->is_unsigned && left->size == size) || (right->is_unsigned && right->size == size);
+    *left = make_constant_value(left->value, size, is_unsigned);
+    *right = make_constant_value(right->value, size, is_unsigned);
+}
@@ -1,4 +1,7 @@
 #include "compiler.h"
+#include <stdlib.h>
+#include <limits.h>
+#include "helpers/vector.h"
 
 bool is_datatype_struct_or_union(DataType* datatype){
     return datatype->type == DATA_TYPE_STRUCT || datatype->type == DATA_TYPE_UNION;
@@ -8,13 +11,14 @@ bool is_datatype_struct_or_union_given_name(const char* name){
     return ARE_STRINGS_EQUAL(name, "struct") || ARE_STRINGS_EQUAL(name, "union");
 }
 
-size_t get_datatype_size(DataType* datatype){
-    if(datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0){
-        return DATA_SIZE_DWORD;
-    }
+size_t get_datatype_size(CompileProcess* process, DataType* datatype){
+    //an array of pointers is sized by its elements, array.size already accounts for the pointer size
     if(datatype->flags & DATATYPE_FLAG_IS_ARRAY){
         return datatype->array.size;
     }
+    if(datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0){
+        return process->target->pointer_size;
+    }
     return datatype->size;
 }
 
@@ -25,20 +29,126 @@ size_t get_datatype_size_no_pointer(DataType* datatype){
     return datatype->size;
 }
 
-size_t get_datatype_size_for_array_access(DataType* datatype){
+size_t get_datatype_size_for_array_access(CompileProcess* process, DataType* datatype){
     if(is_datatype_struct_or_union(datatype) && datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level == 1){
         return datatype->size;
     }
-    return get_datatype_size(datatype);
+    return get_datatype_size(process, datatype);
 }
 
-size_t get_datatype_element_size(DataType* datatype){
+size_t get_datatype_element_size(CompileProcess* process, DataType* datatype){
     if(datatype->flags & DATATYPE_FLAG_IS_POINTER){
-        return DATA_SIZE_DWORD;
+        return process->target->pointer_size;
     }
     return datatype->size;
 }
 
 bool is_datatype_primitive(DataType* datatype){
     return !is_datatype_struct_or_union(datatype);
-}
\ No newline at end of file
+}
+// Writes the identity of the datatype into the scratch buffer, array dimensions that were not folded keep their bracket node as identity.
+static void build_datatype_signature(BufferType* signature, DataType* datatype){
+    reset_buffer(signature);
+    append_formatted_text(signature, "%d:%x:%zu:%d:%s:%p:%p", datatype->type, datatype->flags, datatype->size, datatype->pointer_level, datatype->name ? datatype->name : "", (void*)datatype->data.struct_node, (void*)datatype->secondary_data_type);
+    if(datatype->flags & DATATYPE_FLAG_IS_ARRAY && datatype->array.array_bracket){
+        vector_for_each(Node*, bracket_node, datatype->array.array_bracket->n_brackets){
+            Node* inner = (*bracket_node)->data.bracket.inner;
+            if(inner->flags & NODE_FLAG_IS_CONSTANT){
+                append_formatted_text(signature, "[%lld]", get_node_constant_value(inner));
+            }
+            else{
+                append_formatted_text(signature, "[@%p]", (void*)*bracket_node);
+            }
+        }
+    }
+    append_character_to_buffer(signature, 0x00);
+}
+
+DataType* intern_datatype(CompileProcess* process, DataType* datatype){
+    BufferType* signature = process->datatypes.scratch;
+    build_datatype_signature(signature, datatype);
+    DataType* canonical = hash_table_get(process->datatypes.table, signature->allocated_memory);
+    if(canonical){
+        return canonical;
+    }
+    canonical = malloc(sizeof(DataType));
+    *canonical = *datatype;
+    const char* key = string_pool_copy(process->datatypes.signatures, signature->allocated_memory, signature->current_length - 1);
+    hash_table_put(process->datatypes.table, key, canonical);
+    return canonical;
+}
+
+size_t get_interned_datatype_count(CompileProcess* process){
+    return process->datatypes.table->count;
+}
+
+DataType* get_datatype_pointer_to(CompileProcess* process, DataType* datatype){
+    DataType pointer = *datatype;
+    if(pointer.flags & DATATYPE_FLAG_IS_ARRAY){
+        return get_datatype_pointer_to(process, get_datatype_element(process, datatype));
+    }
+    pointer.flags |= DATATYPE_FLAG_IS_POINTER;
+    pointer.flags &= ~(DATATYPE_FLAG_IS_STATIC | DATATYPE_FLAG_IS_EXTERN | DATATYPE_FLAG_IS_CONST);
+    pointer.pointer_level++;
+    return intern_datatype(process, &pointer);
+}
+
+DataType* get_datatype_element(CompileProcess* process, DataType* datatype){
+    DataType element = *datatype;
+    element.flags &= ~(DATATYPE_FLAG_IS_STATIC | DATATYPE_FLAG_IS_EXTERN);
+    if(datatype->flags & DATATYPE_FLAG_IS_ARRAY){
+        DynamicVector* brackets = datatype->array.array_bracket->n_brackets;
+        if(get_element_count(brackets) <= 1){
+            element.flags &= ~DATATYPE_FLAG_IS_ARRAY;
+            element.array.array_bracket = NULL;
+            element.array.size = 0;
+            return intern_datatype(process, &element);
+        }
+        ArrayBrackets* inner_brackets = array_brackets_new(1);
+        vector_for_each_from(Node*, bracket_node, brackets, 1){
+            add_array_bracket(inner_brackets, *bracket_node);
+        }
+        element.array.array_bracket = inner_brackets;
+        element.array.size = array_brackets_calculate_size(process, &element, inner_brackets);
+        DataType* canonical = intern_datatype(process, &element);
+        if(canonical->array.array_bracket != inner_brackets){
+            free_array_brackets(inner_brackets);
+        }
+        return canonical;
+    }
+    if(!(datatype->flags & DATATYPE_FLAG_IS_POINTER) || datatype->pointer_level <= 0){
+        compiler_error(process, "dereferencing something that is not a pointer");
+    }
+    element.pointer_level--;
+    if(element.pointer_level == 0){
+        element.flags &= ~DATATYPE_FLAG_IS_POINTER;
+    }
+    return intern_datatype(process, &element);
+}
+
+DataType* get_number_literal_datatype(CompileProcess* process, Node* number_node){
+    unsigned long long value = number_node->literal_value.long_long_num;
+    int number_type = number_node->data.number.type;
+    int number_flags = number_node->data.number.flags;
+    bool is_signed_allowed = !(number_flags & NUMBER_FLAG_IS_UNSIGNED);
+    bool is_unsigned_allowed = number_flags & (NUMBER_FLAG_IS_UNSIGNED | NUMBER_FLAG_IS_NOT_DECIMAL);
+    const TargetDataModel* target = process->target;
+    size_t rank_sizes[] = {target->int_size, target->long_size, target->long_long_size};
+    int first_rank = number_type == NUMBER_TYPE_LONG_LONG ? 2 : number_type == NUMBER_TYPE_LONG ? 1 : 0;
+    //a literal too large for every candidate is an unsigned long long, like gcc does
+    DataType literal = {.type = DATA_TYPE_LONG, .size = target->long_long_size};
+    for(int rank = first_rank; rank < (int)(sizeof(rank_sizes) / sizeof(rank_sizes[0])); rank++){
+        size_t size = rank_sizes[rank];
+        unsigned long long unsigned_maximum = size >= sizeof(long long) ? ULLONG_MAX : (1ULL << (size * CHAR_BIT)) - 1;
+        int type = rank == 0 ? DATA_TYPE_INT : DATA_TYPE_LONG;
+        if(is_signed_allowed && value <= unsigned_maximum >> 1){
+            literal = (DataType){.type = type, .size = size, .flags = DATATYPE_FLAG_IS_SIGNED};
+            break;
+        }
+        if(is_unsigned_allowed && value <= unsigned_maximum){
+            literal = (DataType){.type = type, .size = size};
+            break;
+        }
+    }
+    return intern_datatype(process, &literal);
+}
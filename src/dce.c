@@ -0,0 +1,190 @@
+/*
+* @file dce.c
+* @brief Dead code elimination
+* @details A mark and sweep over the SSA form. Instructions with an effect beyond their result, stores, copies of memory, calls and terminators, are live, and so is every instruction defining a register a live instruction reads. Everything else is deleted. A stack slot whose address only ever reaches the destination of stores is never read, so those stores don't count as effects either, and a slot left without any address takes no space in the frame.
+*/
+
+#include "compiler.h"
+
+typedef struct Dce{
+    IrFunction* function;
+    bool* live; //indexed by register, whether the instruction defining it is live
+    bool* write_only_addresses; //indexed by register, addresses of stack slots that are never read
+    DynamicVector* worklist;
+} Dce;
+
+void ir_eliminate_dead_code(IrFunction* function);
+
+static void dce_find_write_only_addresses(Dce* dce);
+
+static bool is_dce_write_only(Dce* dce, int address, DynamicVector* derived);
+
+static bool is_dce_root(Dce* dce, IrInstruction* instruction);
+
+static void dce_mark_instruction(Dce* dce, IrInstruction* instruction);
+
+static void dce_mark_vreg(Dce* dce, int vreg);
+
+static void dce_mark_unused_slots(IrFunction* function);
+
+
+
+void ir_eliminate_dead_code(IrFunction* function){
+    int vreg_count = ir_get_vreg_count(function);
+    Dce dce = {.function = function};
+    dce.live = calloc(vreg_count + 1, sizeof(bool));
+    dce.write_only_addresses = calloc(vreg_count + 1, sizeof(bool));
+    dce.worklist = create_vector(sizeof(IrInstruction*));
+    dce_find_write_only_addresses(&dce);
+
+    DynamicVector* roots = create_vector(sizeof(IrInstruction*));
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if(is_dce_root(&dce, *instruction)){
+                vector_IrInstructionPtr_push(roots, *instruction);
+            }
+        }
+    }
+    vector_for_each(IrInstruction*, root, roots){
+        dce_mark_instruction(&dce, *root);
+    }
+    while(!is_vector_empty(dce.worklist)){
+        dce_mark_instruction(&dce, vector_IrInstructionPtr_pop(dce.worklist));
+    }
+
+    vector_for_each(IrBlock*, block, function->blocks){
+        DynamicVector* instructions = (*block)->instructions;
+        for(int i = get_element_count(instructions) - 1; i >= 0; i--){
+            IrInstruction* instruction = vector_IrInstructionPtr_at(instructions, i);
+            bool is_live = instruction->result == IR_VREG_NONE ? is_dce_root(&dce, instruction) : dce.live[instruction->result] || is_dce_root(&dce, instruction);
+            if(!is_live){
+                remove_element_at(instructions, i);
+                ir_free_instruction(instruction);
+            }
+        }
+    }
+    destroy_vector(roots);
+    destroy_vector(dce.worklist);
+    free(dce.live);
+    free(dce.write_only_addresses);
+    dce_mark_unused_slots(function);
+    ir_compute_def_use(function);
+}
+
+// Finds the addresses of the stack slots none of whose addresses is ever read through, passed on or kept in memory.
+static void dce_find_write_only_addresses(Dce* dce){
+    IrFunction* function = dce->function;
+    int slot_count = get_element_count(function->slots);
+    bool* is_read = calloc(slot_count + 1, sizeof(bool));
+    DynamicVector* derived = create_vector(sizeof(int));
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode == IR_OP_SLOT_ADDRESS && !is_dce_write_only(dce, (*instruction)->result, derived)){
+                is_read[(*instruction)->slot] = true;
+            }
+        }
+    }
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode != IR_OP_SLOT_ADDRESS || is_read[(*instruction)->slot]){
+                continue;
+            }
+            clear_vector(derived);
+            is_dce_write_only(dce, (*instruction)->result, derived);
+            vector_for_each(int, address, derived){
+                dce->write_only_addresses[*address] = true;
+            }
+        }
+    }
+    destroy_vector(derived);
+    free(is_read);
+}
+
+// Follows the address through pointer arithmetic and collects the registers derived from it, false as soon as one of them is used for anything but the destination of a store.
+static bool is_dce_write_only(Dce* dce, int address, DynamicVector* derived){
+    vector_Int_push(derived, address);
+    DynamicVector* users = vector_VoidPtr_at(dce->function->uses, address);
+    if(!users){
+        return true;
+    }
+    vector_for_each(IrInstruction*, user_pointer, users){
+        IrInstruction* user = *user_pointer;
+        switch(user->opcode){
+            case IR_OP_STORE:
+            case IR_OP_MEMCOPY:
+                if(user->operands[1] == address){
+                    return false;
+                }
+                break;
+            case IR_OP_ADD:
+            case IR_OP_SUB:
+            case IR_OP_COPY:
+                if(!is_dce_write_only(dce, user->result, derived)){
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool is_dce_root(Dce* dce, IrInstruction* instruction){
+    switch(instruction->opcode){
+        case IR_OP_STORE:
+        case IR_OP_MEMCOPY:
+            return !dce->write_only_addresses[instruction->operands[0]];
+        case IR_OP_CALL:
+            return true;
+    }
+    return is_ir_terminator(instruction);
+}
+
+// Marks the definitions of the registers the live instruction reads.
+static void dce_mark_instruction(Dce* dce, IrInstruction* instruction){
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        dce_mark_vreg(dce, instruction->operands[i]);
+    }
+    if(instruction->opcode == IR_OP_PHI){
+        vector_for_each(IrPhiIncoming, incoming, instruction->arguments){
+            dce_mark_vreg(dce, incoming->vreg);
+        }
+    }
+    else if(instruction->opcode == IR_OP_CALL){
+        vector_for_each(int, argument, instruction->arguments){
+            dce_mark_vreg(dce, *argument);
+        }
+    }
+}
+
+static void dce_mark_vreg(Dce* dce, int vreg){
+    if(vreg == IR_VREG_NONE || dce->live[vreg]){
+        return;
+    }
+    dce->live[vreg] = true;
+    IrInstruction* definition = vector_IrInstructionPtr_at(dce->function->definitions, vreg);
+    if(definition){
+        vector_IrInstructionPtr_push(dce->worklist, definition);
+    }
+}
+
+// A slot that wasn't promoted and whose address no instruction takes anymore needs no space in the frame.
+static void dce_mark_unused_slots(IrFunction* function){
+    int slot_count = get_element_count(function->slots);
+    bool* is_addressed = calloc(slot_count + 1, sizeof(bool));
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode == IR_OP_SLOT_ADDRESS){
+                is_addressed[(*instruction)->slot] = true;
+            }
+        }
+    }
+    for(int i = 0; i < slot_count; i++){
+        IrStackSlot* slot = get_element_at(function->slots, i);
+        if(!is_addressed[i] && !(slot->flags & IR_STACK_SLOT_FLAG_PROMOTED)){
+            slot->flags |= IR_STACK_SLOT_FLAG_UNUSED;
+        }
+    }
+    free(is_addressed);
+}
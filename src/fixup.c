@@ -10,16 +10,20 @@ void free_fixup(Fixup* fixup);
 
 void free_fixups(FixupSystem* system);
 
-void start_iterating_fixups(FixupSystem* system);
-
-Fixup* next_fixup(FixupSystem* system);
-
 void free_fixup_system(FixupSystem* system);
 
 int get_count_of_unresolved_fixups(FixupSystem* system);
 
 Fixup* register_fixup(FixupSystem* system, FixupConfig* config);
 
+Fixup* register_fixup_waiting_on(FixupSystem* system, const char* name, FixupConfig* config);
+
+int resolve_fixups_waiting_on(FixupSystem* system, const char* name);
+
+static bool is_fixup_done_waiting(void* element, void* private_data);
+
+static void destroy_waiting_fixups(const char* name, void* waiting_fixups, void* private_data);
+
 bool is_fixup_resolved(Fixup* fixup);
 
 void* return_fixup_private_data(Fixup* fixup);
@@ -28,7 +32,8 @@ bool is_fixup_system_resolved(FixupSystem* system);
 
 FixupSystem* create_new_fixup_system(){
     FixupSystem* system = calloc(1, sizeof(FixupSystem));
-    system->fixups = create_vector(sizeof(Fixup));
+    system->fixups = create_vector(sizeof(Fixup*));
+    system->waiting = create_hash_table(0);
     return system;
 }
 
@@ -42,37 +47,25 @@ void free_fixup(Fixup* fixup){
 }
 
 void free_fixups(FixupSystem* system){
-    start_iterating_fixups(system);
-    Fixup* fixup = next_fixup(system);
-    while(fixup){
-        free_fixup(fixup);
-        fixup = next_fixup(system);
+    vector_for_each(Fixup*, fixup, system->fixups){
+        free_fixup(*fixup);
     }
 }
 
-void start_iterating_fixups(FixupSystem* system){
-    set_peek_index(system->fixups, 0);
-}
-
-Fixup* next_fixup(FixupSystem* system){
-    return peek_pointer(system->fixups);
-}
-
 void free_fixup_system(FixupSystem* system){
     free_fixups(system);
     destroy_vector(system->fixups);
+    hash_table_for_each(system->waiting, destroy_waiting_fixups, NULL);
+    destroy_hash_table(system->waiting);
     free(system);
 }
 
 int get_count_of_unresolved_fixups(FixupSystem* system){
     int count = 0;
-    start_iterating_fixups(system);
-    Fixup* fixup = next_fixup(system);
-    while(fixup){
-        if(!(fixup->flags & FIXUP_FLAG_RESOLVED)){
+    vector_for_each(Fixup*, fixup, system->fixups){
+        if(!((*fixup)->flags & FIXUP_FLAG_RESOLVED)){
             count++;
         }
-        fixup = next_fixup(system);
     }
     return count;
 }
@@ -81,10 +74,59 @@ Fixup* register_fixup(FixupSystem* system, FixupConfig* config){
     Fixup* fixup = calloc(1, sizeof(Fixup));
     memcpy(&fixup->config, config, sizeof(FixupConfig));
     fixup->system = system;
-    push_element(system->fixups, fixup);
+    push_element(system->fixups, &fixup);
+    return fixup;
+}
+
+Fixup* register_fixup_waiting_on(FixupSystem* system, const char* name, FixupConfig* config){
+    Fixup* fixup = register_fixup(system, config);
+    if(!name){
+        return fixup;
+    }
+    fixup->waiting_on = name;
+    DynamicVector* waiting_fixups = hash_table_get(system->waiting, name);
+    if(!waiting_fixups){
+        waiting_fixups = create_vector(sizeof(Fixup*));
+        hash_table_put(system->waiting, name, waiting_fixups);
+    }
+    vector_VoidPtr_push(waiting_fixups, fixup);
     return fixup;
 }
 
+int resolve_fixups_waiting_on(FixupSystem* system, const char* name){
+    DynamicVector* waiting_fixups = hash_table_get(system->waiting, name);
+    if(!waiting_fixups){
+        return 0;
+    }
+    int resolved_count = 0;
+    remove_vector_elements_if(waiting_fixups, is_fixup_done_waiting, &resolved_count);
+    if(is_vector_empty(waiting_fixups)){
+        hash_table_remove(system->waiting, name);
+        destroy_vector(waiting_fixups);
+    }
+    return resolved_count;
+}
+
+// Resolved fixups leave the vector of the name they wait on, whether they resolve now or were resolved before by the final sweep.
+static bool is_fixup_done_waiting(void* element, void* private_data){
+    Fixup* fixup = *(Fixup**)element;
+    if(fixup->flags & FIXUP_FLAG_RESOLVED){
+        return true;
+    }
+    if(is_fixup_resolved(fixup)){
+        (*(int*)private_data)++;
+        return true;
+    }
+    return false;
+}
+
+// Frees the vector of fixups waiting on a name, the fixups themselves are freed with the fixup vector.
+static void destroy_waiting_fixups(const char* name, void* waiting_fixups, void* private_data){
+    (void)name;
+    (void)private_data;
+    destroy_vector(waiting_fixups);
+}
+
 bool is_fixup_resolved(Fixup* fixup){
     if(get_fixup_config(fixup)->fix(fixup)){
         fixup->flags |= FIXUP_FLAG_RESOLVED;
@@ -98,14 +140,12 @@ void* return_fixup_private_data(Fixup* fixup){
 }
 
 bool is_fixup_system_resolved(FixupSystem* system){
-    start_iterating_fixups(system);
-    Fixup* fixup = next_fixup(system);
-    while(fixup){
-        if(fixup->flags & FIXUP_FLAG_RESOLVED){
+    //fixups waiting on a name were already tried when it was registered, this sweep catches the ones that could not be
+    vector_for_each(Fixup*, fixup, system->fixups){
+        if((*fixup)->flags & FIXUP_FLAG_RESOLVED){
             continue;
         }
-        is_fixup_system_resolved(system);
-        fixup = next_fixup(system);
+        is_fixup_resolved(*fixup);
     }
     return get_count_of_unresolved_fixups(system) == 0;
 }
\ No newline at end of file
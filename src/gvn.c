@@ -0,0 +1,258 @@
+/*
+* @file gvn.c
+* @brief Global value numbering
+* @details A walk over the dominator tree keeps a scoped table of the pure computations available in the current block, keyed by opcode, type, operands and immediates. A computation the table already holds is redundant and its result is replaced by the one that dominates it. Loads are numbered the same way along chains of blocks with a single predecessor, a store forwards its value to later loads of the same address and kills the loads it may overwrite. Whether a store may overwrite a load is up to the alias analysis of alias.c.
+*/
+
+#include "compiler.h"
+
+typedef struct GvnLoad{
+    int address;
+    int type;
+    int value; //the register holding what is at address
+} GvnLoad;
+
+typedef struct Gvn{
+    IrFunction* function;
+    HashTable* values; //maps the key of an available computation to its register plus one
+    int* leaders; //indexed by register, the register it was replaced by, itself for the others
+    bool* escaped_slots; //indexed by slot, whether the address of the slot is stored, passed or returned
+} Gvn;
+
+void ir_number_values(IrFunction* function);
+
+static void gvn_visit_block(Gvn* gvn, IrBlock* block, DynamicVector* dominator_loads);
+
+static bool gvn_number_instruction(Gvn* gvn, IrInstruction* instruction, DynamicVector* scope_keys);
+
+static bool gvn_number_load(Gvn* gvn, IrInstruction* instruction, DynamicVector* loads);
+
+static void gvn_number_store(Gvn* gvn, IrInstruction* instruction, DynamicVector* loads);
+
+static void gvn_kill_loads(Gvn* gvn, DynamicVector* loads, int address, size_t size);
+
+static void gvn_kill_loads_for_call(Gvn* gvn, DynamicVector* loads);
+
+static bool is_gvn_pure(IrInstruction* instruction);
+
+static bool is_gvn_commutative(IrInstruction* instruction);
+
+static char* gvn_make_key(IrInstruction* instruction);
+
+static int gvn_leader(Gvn* gvn, int vreg);
+
+
+
+void ir_number_values(IrFunction* function){
+    int vreg_count = ir_get_vreg_count(function);
+    Gvn gvn = {.function = function};
+    gvn.values = create_hash_table(0);
+    gvn.leaders = malloc((vreg_count + 1) * sizeof(int));
+    for(int i = 0; i < vreg_count; i++){
+        gvn.leaders[i] = i;
+    }
+    gvn.escaped_slots = ir_find_escaped_slots(function);
+    gvn_visit_block(&gvn, vector_IrBlockPtr_at(function->blocks, 0), NULL);
+
+    //phis read values of blocks that may come later in the dominator tree
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode != IR_OP_PHI){
+                break;
+            }
+            vector_for_each(IrPhiIncoming, incoming, (*instruction)->arguments){
+                incoming->vreg = gvn_leader(&gvn, incoming->vreg);
+            }
+        }
+    }
+    destroy_hash_table(gvn.values);
+    free(gvn.leaders);
+    free(gvn.escaped_slots);
+    ir_compute_def_use(function);
+}
+
+// Numbers the instructions of the block and then those of the blocks it dominates. The loads available at the end of the immediate dominator are still valid when it is the only predecessor.
+static void gvn_visit_block(Gvn* gvn, IrBlock* block, DynamicVector* dominator_loads){
+    DynamicVector* loads = create_vector(sizeof(GvnLoad));
+    bool is_only_predecessor = get_element_count(block->predecessors) == 1 && vector_IrBlockPtr_at(block->predecessors, 0) == block->immediate_dominator;
+    if(dominator_loads && is_only_predecessor){
+        vector_for_each(GvnLoad, load, dominator_loads){
+            push_element(loads, load);
+        }
+    }
+    DynamicVector* scope_keys = create_vector(sizeof(char*));
+    DynamicVector* instructions = block->instructions;
+    int kept = 0;
+    for(int i = 0; i < get_element_count(instructions); i++){
+        IrInstruction* instruction = vector_IrInstructionPtr_at(instructions, i);
+        if(instruction->opcode != IR_OP_PHI){
+            for(int j = 0; j < IR_MAX_OPERANDS; j++){
+                instruction->operands[j] = gvn_leader(gvn, instruction->operands[j]);
+            }
+            if(instruction->opcode == IR_OP_CALL){
+                vector_for_each(int, argument, instruction->arguments){
+                    *argument = gvn_leader(gvn, *argument);
+                }
+            }
+        }
+        bool is_redundant = false;
+        switch(instruction->opcode){
+            case IR_OP_COPY:
+                gvn->leaders[instruction->result] = instruction->operands[0];
+                is_redundant = true;
+                break;
+            case IR_OP_LOAD:
+                is_redundant = gvn_number_load(gvn, instruction, loads);
+                break;
+            case IR_OP_STORE:
+                gvn_number_store(gvn, instruction, loads);
+                break;
+            case IR_OP_MEMCOPY:
+                gvn_kill_loads(gvn, loads, instruction->operands[0], instruction->immediate);
+                break;
+            case IR_OP_CALL:
+                gvn_kill_loads_for_call(gvn, loads);
+                break;
+            default:
+                is_redundant = gvn_number_instruction(gvn, instruction, scope_keys);
+        }
+        if(is_redundant){
+            ir_free_instruction(instruction);
+            continue;
+        }
+        *vector_IrInstructionPtr_at_pointer(instructions, kept++) = instruction;
+    }
+    while(get_element_count(instructions) > kept){
+        remove_last_element(instructions);
+    }
+
+    vector_for_each(IrBlock*, dominated, block->dominated){
+        gvn_visit_block(gvn, *dominated, loads);
+    }
+    vector_for_each(char*, key, scope_keys){
+        hash_table_remove(gvn->values, *key);
+        free(*key);
+    }
+    destroy_vector(scope_keys);
+    destroy_vector(loads);
+}
+
+// Looks the computation up in the table, adding it when it isn't available yet. Returns true if the instruction is redundant.
+static bool gvn_number_instruction(Gvn* gvn, IrInstruction* instruction, DynamicVector* scope_keys){
+    if(!is_gvn_pure(instruction)){
+        return false;
+    }
+    char* key = gvn_make_key(instruction);
+    int value = (int)(intptr_t)hash_table_get(gvn->values, key);
+    if(value){
+        gvn->leaders[instruction->result] = value - 1;
+        free(key);
+        return true;
+    }
+    hash_table_put(gvn->values, key, (void*)(intptr_t)(instruction->result + 1));
+    vector_VoidPtr_push(scope_keys, key);
+    return false;
+}
+
+static bool gvn_number_load(Gvn* gvn, IrInstruction* instruction, DynamicVector* loads){
+    vector_for_each(GvnLoad, load, loads){
+        if(load->address == instruction->operands[0] && load->type == instruction->type){
+            gvn->leaders[instruction->result] = load->value;
+            return true;
+        }
+    }
+    GvnLoad load = {.address = instruction->operands[0], .type = instruction->type, .value = instruction->result};
+    push_element(loads, &load);
+    return false;
+}
+
+// The stored value is what a later load of the same address and type reads.
+static void gvn_number_store(Gvn* gvn, IrInstruction* instruction, DynamicVector* loads){
+    gvn_kill_loads(gvn, loads, instruction->operands[0], ir_type_size(instruction->type));
+    GvnLoad load = {.address = instruction->operands[0], .type = instruction->type, .value = instruction->operands[1]};
+    push_element(loads, &load);
+}
+
+// Forgets the loads a write of size bytes at address may change.
+static void gvn_kill_loads(Gvn* gvn, DynamicVector* loads, int address, size_t size){
+    for(int i = get_element_count(loads) - 1; i >= 0; i--){
+        GvnLoad* load = get_element_at(loads, i);
+        if(ir_may_alias(gvn->function, gvn->escaped_slots, load->address, ir_type_size(load->type), address, size)){
+            remove_element_at(loads, i);
+        }
+    }
+}
+
+// A call may write to any memory it can reach, which is everything but the stack slots whose address never escaped.
+static void gvn_kill_loads_for_call(Gvn* gvn, DynamicVector* loads){
+    for(int i = get_element_count(loads) - 1; i >= 0; i--){
+        GvnLoad* load = get_element_at(loads, i);
+        if(!is_ir_private_slot(gvn->escaped_slots, ir_resolve_address(gvn->function, load->address).base)){
+            remove_element_at(loads, i);
+        }
+    }
+}
+
+// Computations that only depend on their operands, a division that would trap is redundant after one that didn't.
+static bool is_gvn_pure(IrInstruction* instruction){
+    switch(instruction->opcode){
+        case IR_OP_CONST:
+        case IR_OP_SLOT_ADDRESS:
+        case IR_OP_GLOBAL_ADDRESS:
+        case IR_OP_ADD:
+        case IR_OP_SUB:
+        case IR_OP_MUL:
+        case IR_OP_SDIV:
+        case IR_OP_UDIV:
+        case IR_OP_SREM:
+        case IR_OP_UREM:
+        case IR_OP_AND:
+        case IR_OP_OR:
+        case IR_OP_XOR:
+        case IR_OP_SHL:
+        case IR_OP_SAR:
+        case IR_OP_SHR:
+        case IR_OP_NEG:
+        case IR_OP_NOT:
+        case IR_OP_CMP:
+        case IR_OP_SEXT:
+        case IR_OP_ZEXT:
+        case IR_OP_TRUNC:
+            return true;
+    }
+    return false;
+}
+
+static bool is_gvn_commutative(IrInstruction* instruction){
+    switch(instruction->opcode){
+        case IR_OP_ADD:
+        case IR_OP_MUL:
+        case IR_OP_AND:
+        case IR_OP_OR:
+        case IR_OP_XOR:
+            return true;
+        case IR_OP_CMP:
+            return instruction->condition == IR_CONDITION_EQ || instruction->condition == IR_CONDITION_NE;
+    }
+    return false;
+}
+
+// Operands of commutative operations are ordered, so a + b and b + a get the same key. The symbol comes last, the contents of a string literal may contain anything.
+static char* gvn_make_key(IrInstruction* instruction){
+    int first = instruction->operands[0];
+    int second = instruction->operands[1];
+    if(is_gvn_commutative(instruction) && first > second){
+        first = instruction->operands[1];
+        second = instruction->operands[0];
+    }
+    const char* format = "%i:%i:%i:%i:%lld:%i:%i:%i:%s";
+    const char* symbol = instruction->symbol ? instruction->symbol : "";
+    int length = snprintf(NULL, 0, format, instruction->opcode, instruction->type, first, second, instruction->immediate, instruction->condition, instruction->slot, instruction->flags, symbol);
+    char* key = malloc(length + 1);
+    snprintf(key, length + 1, format, instruction->opcode, instruction->type, first, second, instruction->immediate, instruction->condition, instruction->slot, instruction->flags, symbol);
+    return key;
+}
+
+static int gvn_leader(Gvn* gvn, int vreg){
+    return vreg == IR_VREG_NONE ? vreg : gvn->leaders[vreg];
+}
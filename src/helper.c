@@ -2,19 +2,16 @@
 #include <assert.h>
 #include "helpers/vector.h"
 
-size_t get_variable_size(Node* variable_node) {
+size_t get_variable_size(CompileProcess* process, Node* variable_node) {
     assert(variable_node->type == NODE_TYPE_VARIABLE);
-    return get_datatype_size(&variable_node->data.var.data_type);
+    return get_datatype_size(process, variable_node->data.var.data_type);
 }
 
-size_t get_variable_size_for_list(Node* variable_list_node) {
+size_t get_variable_size_for_list(CompileProcess* process, Node* variable_list_node) {
     assert(variable_list_node->type == NODE_TYPE_VARIABLE_LIST);
     size_t size = 0;
-    set_peek_index(variable_list_node->data.variable_list.variables, 0);
-    Node* variable_node = peek_pointer(variable_list_node->data.variable_list.variables);
-    while(variable_node != NULL) {
-        size += get_variable_size(variable_node);
-        variable_node = peek_pointer(variable_list_node->data.variable_list.variables);
+    vector_for_each(Node*, variable_node, variable_list_node->data.variable_list.variables) {
+        size += get_variable_size(process, *variable_node);
     }
     return size;
 }
@@ -48,30 +45,28 @@ int get_compute_sum_padding(DynamicVector* vector){
     int padding = 0;
     int last_type = -1;
     bool mixed_types = false;
-    set_peek_index(vector, 0);
-    Node* current_node = peek_pointer(vector);
     Node* last_node = NULL;
-    while(current_node){
-        if(current_node->type != NODE_TYPE_VARIABLE){
-            current_node = peek_pointer(vector);
+    vector_for_each(Node*, node_pointer, vector){
+        Node* current_node = *node_pointer;
+        if(!current_node || current_node->type != NODE_TYPE_VARIABLE){
             continue;
         }
         padding += current_node->data.var.padding;
-        last_type = current_node->data.var.data_type.type;
+        last_type = current_node->data.var.data_type->type;
         last_node = current_node;
-        current_node = peek_pointer(vector);
     }
+    return padding;
 }
 
 Node* get_variable_struct_or_union_body_node(Node* node){
     if(!is_node_struct_or_union_variable(node)){
         return NULL;
     }
-    if(node->data.var.data_type.type == DATA_TYPE_STRUCT){
-        return node->data.var.data_type.data.struct_node->data.structure.body_node;
+    if(node->data.var.data_type->type == DATA_TYPE_STRUCT){
+        return node->data.var.data_type->data.struct_node->data.structure.body_node;
     }
-    if(node->data.var.data_type.type == DATA_TYPE_UNION){
-        return node->data.var.data_type.data.union_node->data.Union.body_node;
+    if(node->data.var.data_type->type == DATA_TYPE_UNION){
+        return node->data.var.data_type->data.union_node->data.Union.body_node;
     }
     return NULL;
 }
\ No newline at end of file
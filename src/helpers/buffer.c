@@ -3,9 +3,14 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <string.h>
 
 BufferType* create_buffer();
 
+BufferType* create_buffer_with_capacity(size_t capacity);
+
+void reset_buffer(BufferType* buffer);
+
 char read_character_from_buffer(BufferType* buffer);
 
 char peek_character_in_buffer(BufferType* buffer);
@@ -18,8 +23,18 @@ void append_formatted_text_without_null_terminator(BufferType* buffer, const cha
 
 void append_character_to_buffer(BufferType* buffer, char character);
 
+void append_string_to_buffer(BufferType* buffer, const char* string);
+
+void append_string_with_length_to_buffer(BufferType* buffer, const char* string, size_t length);
+
+void append_integer_to_buffer(BufferType* buffer, long long number);
+
 void buffer_need_space(BufferType* buffer, size_t size);
 
+static int format_text_into_buffer(BufferType* buffer, const char* format, va_list args);
+
+void append_formatted_text_from_list(BufferType* buffer, const char* format, va_list args);
+
 void* get_buffer_memory_pointer(BufferType* buffer);
 
 void free_buffer(BufferType* buffer);
@@ -27,13 +42,26 @@ void free_buffer(BufferType* buffer);
 
 
 BufferType* create_buffer(){
+    return create_buffer_with_capacity(BUFFER_REALLOCATION_INCREMENT);
+}
+
+BufferType* create_buffer_with_capacity(size_t capacity){
+    if(capacity < 1){
+        capacity = 1;
+    }
     BufferType* buffer = calloc(sizeof(BufferType), 1);
-    buffer->allocated_memory = calloc(BUFFER_REALLOCATION_INCREMENT, 1);
+    buffer->allocated_memory = calloc(capacity, 1);
     buffer->current_length = 0;
-    buffer->allocated_size = BUFFER_REALLOCATION_INCREMENT;
+    buffer->allocated_size = capacity;
     return buffer;
 }
 
+void reset_buffer(BufferType* buffer){
+    buffer->current_length = 0;
+    buffer->read_index = 0;
+    buffer->allocated_memory[0] = 0x00;
+}
+
 char read_character_from_buffer(BufferType* buffer){
     if(buffer->read_index >= buffer->current_length){
         return -1;
@@ -55,24 +83,37 @@ void expand_buffer(BufferType* buffer, size_t additional_size){
     buffer->allocated_size += additional_size;
 }
 
+// Formats into the free space of the buffer, retrying once with the exact size when the first pass did not fit, and returns the formatted length.
+static int format_text_into_buffer(BufferType* buffer, const char* format, va_list args){
+    va_list retry_args;
+    va_copy(retry_args, args);
+    buffer_need_space(buffer, BUFFER_FORMAT_FIRST_PASS_SIZE);
+    int index = buffer->current_length;
+    size_t available = buffer->allocated_size - index;
+    int actual_length = vsnprintf(&buffer->allocated_memory[index], available, format, args);
+    if(actual_length >= 0 && (size_t)actual_length >= available){
+        buffer_need_space(buffer, actual_length);
+        vsnprintf(&buffer->allocated_memory[index], actual_length + 1, format, retry_args);
+    }
+    va_end(retry_args);
+    return actual_length < 0 ? 0 : actual_length;
+}
+
+void append_formatted_text_from_list(BufferType* buffer, const char* format, va_list args){
+    buffer->current_length += format_text_into_buffer(buffer, format, args);
+}
+
 void append_formatted_text(BufferType* buffer, const char* format, ...){
     va_list args;
     va_start(args, format);
-    int index = buffer->current_length;
-    int length = 2048;
-    expand_buffer(buffer, length);
-    int actual_length = vsnprintf(&buffer->allocated_memory[index], length, format, args);
-    buffer->current_length += actual_length;
+    append_formatted_text_from_list(buffer, format, args);
     va_end(args);
 }
 
 void append_formatted_text_without_null_terminator(BufferType* buffer, const char* format, ...){
     va_list args;
     va_start(args, format);
-    int index = buffer->current_length;
-    int length = 2048;
-    expand_buffer(buffer, length);
-    int actual_length = vsnprintf(&buffer->allocated_memory[index], length, format, args);
+    int actual_length = format_text_into_buffer(buffer, format, args);
     buffer->current_length += actual_length - 1;
     va_end(args);
 }
@@ -83,10 +124,41 @@ void append_character_to_buffer(BufferType* buffer, char character){
     buffer->current_length++;
 }
 
+void append_string_to_buffer(BufferType* buffer, const char* string){
+    append_string_with_length_to_buffer(buffer, string, strlen(string));
+}
+
+void append_string_with_length_to_buffer(BufferType* buffer, const char* string, size_t length){
+    buffer_need_space(buffer, length);
+    memcpy(&buffer->allocated_memory[buffer->current_length], string, length);
+    buffer->current_length += length;
+    buffer->allocated_memory[buffer->current_length] = 0x00;
+}
+
+void append_integer_to_buffer(BufferType* buffer, long long number){
+    char digits[24];
+    int index = sizeof(digits);
+    unsigned long long magnitude = number < 0 ? -(unsigned long long)number : (unsigned long long)number;
+    do{
+        digits[--index] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    }while(magnitude);
+    if(number < 0){
+        digits[--index] = '-';
+    }
+    append_string_with_length_to_buffer(buffer, &digits[index], sizeof(digits) - index);
+}
+
 void buffer_need_space(BufferType* buffer, size_t size){
-    if(buffer->allocated_size<=buffer->current_length+size){
-        expand_buffer(buffer, size + BUFFER_REALLOCATION_INCREMENT);
+    size_t required_size = buffer->current_length + size + 1;
+    if(buffer->allocated_size >= required_size){
+        return;
+    }
+    size_t new_size = buffer->allocated_size * BUFFER_GROWTH_FACTOR;
+    if(new_size < required_size){
+        new_size = required_size;
     }
+    expand_buffer(buffer, new_size - buffer->allocated_size);
 }
 
 void* get_buffer_memory_pointer(BufferType* buffer){
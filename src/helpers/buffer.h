@@ -9,12 +9,28 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdarg.h>
 
 /*
 * @def BUFFER_REALLOCATION_INCREMENT
 * @brief Amount by which the buffer expands when it needs more space
 */
 #define BUFFER_REALLOCATION_INCREMENT 2000
+/*
+* @def BUFFER_SMALL_INITIAL_SIZE
+* @brief Initial allocation of buffers expected to hold a short string such as a single token
+*/
+#define BUFFER_SMALL_INITIAL_SIZE 16
+/*
+* @def BUFFER_GROWTH_FACTOR
+* @brief Factor by which the allocated size is multiplied when the buffer runs out of space
+*/
+#define BUFFER_GROWTH_FACTOR 2
+/*
+* @def BUFFER_FORMAT_FIRST_PASS_SIZE
+* @brief Minimum free space reserved before the first vsnprintf pass of a formatted append
+*/
+#define BUFFER_FORMAT_FIRST_PASS_SIZE 128
 
 /*
 * @struct BufferType
@@ -47,6 +63,22 @@ typedef struct BufferType
 */
 BufferType* create_buffer();
 /*
+* @fn create_buffer_with_capacity
+* @brief Function to create a buffer with a given initial size
+* @details Allocates a buffer with room for capacity bytes, later growth is geometric so small buffers stay small.
+* @param capacity Initial allocation size in bytes
+* @return Pointer to the buffer
+*/
+BufferType* create_buffer_with_capacity(size_t capacity);
+/*
+* @fn reset_buffer
+* @brief Function to empty a buffer for reuse
+* @details Sets the length and read index back to zero while keeping the allocation.
+* @param buffer Pointer to the buffer
+* @return void
+*/
+void reset_buffer(BufferType* buffer);
+/*
 * @fn read_character_from_buffer
 * @brief Function to read a character from the buffer
 * @details Reads a character from the buffer if available, updates the read index, and returns -1 if out of bounds. 
@@ -72,15 +104,34 @@ char peek_character_in_buffer(BufferType* buffer);
 */
 void expand_buffer(BufferType* buffer, size_t additional_size);
 /*
+* @fn buffer_need_space
+* @brief Function to make room for more data in the buffer
+* @details Ensures size more bytes plus a null terminator fit after the current length, growing the allocation geometrically so repeated appends cost amortized O(1) per byte.
+* @param buffer Pointer to the buffer
+* @param size Number of bytes about to be appended
+* @return void
+*/
+void buffer_need_space(BufferType* buffer, size_t size);
+/*
 * @fn append_formatted_text
 * @brief Function to append formatted text to the buffer
-* @details Appends formatted text to the buffer by expanding memory, formatting the string, and updating the current length.
+* @details Formats straight into the free space of the buffer. If the text does not fit, the buffer is grown to the exact length vsnprintf reported and the text is formatted again, so output is never truncated.
 * @param buffer Pointer to the buffer
 * @param format Format string for the text to be appended
 * @return void
 */
 void append_formatted_text(BufferType* buffer, const char* format, ...);
 /*
+* @fn append_formatted_text_from_list
+* @brief Function to append formatted text to the buffer from a va_list
+* @details Same as append_formatted_text for callers which already hold a va_list.
+* @param buffer Pointer to the buffer
+* @param format Format string for the text to be appended
+* @param args Arguments for the format string
+* @return void
+*/
+void append_formatted_text_from_list(BufferType* buffer, const char* format, va_list args);
+/*
 * @fn append_formatted_text_without_null_terminator
 * @brief Function to append formatted text to the buffer without null terminator
 * @details Appends formatted text to the buffer without counting the null terminator, expands memory, and updates length accordingly.
@@ -99,6 +150,34 @@ void append_formatted_text_without_null_terminator(BufferType* buffer, const cha
 */
 void append_character_to_buffer(BufferType* buffer, char character);
 /*
+* @fn append_string_to_buffer
+* @brief Function to append a string to the buffer
+* @details Copies a null terminated string into the buffer without going through printf.
+* @param buffer Pointer to the buffer
+* @param string String to be appended
+* @return void
+*/
+void append_string_to_buffer(BufferType* buffer, const char* string);
+/*
+* @fn append_string_with_length_to_buffer
+* @brief Function to append a run of bytes to the buffer
+* @details Copies length bytes into the buffer with a single memcpy and keeps the content null terminated.
+* @param buffer Pointer to the buffer
+* @param string Bytes to be appended
+* @param length Number of bytes to append
+* @return void
+*/
+void append_string_with_length_to_buffer(BufferType* buffer, const char* string, size_t length);
+/*
+* @fn append_integer_to_buffer
+* @brief Function to append an integer to the buffer
+* @details Converts the integer to decimal digits by hand, without going through printf.
+* @param buffer Pointer to the buffer
+* @param number Integer to be appended
+* @return void
+*/
+void append_integer_to_buffer(BufferType* buffer, long long number);
+/*
 * @fn get_buffer_memory_pointer
 * @brief Function to get the memory pointer of the buffer
 * @details Returns a pointer to the allocated memory of the buffer for direct access to its contents.
@@ -0,0 +1,80 @@
+#include "emitter.h"
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+Emitter* create_emitter(FILE* output_file);
+
+static void emitter_flush_if_needed(Emitter* emitter);
+
+void emit_string(Emitter* emitter, const char* string);
+
+void emit_formatted(Emitter* emitter, const char* format, ...);
+
+void emit_integer(Emitter* emitter, long long number);
+
+void emit_character(Emitter* emitter, char character);
+
+int flush_emitter(Emitter* emitter);
+
+void free_emitter(Emitter* emitter);
+
+
+
+Emitter* create_emitter(FILE* output_file){
+    Emitter* emitter = calloc(1, sizeof(Emitter));
+    emitter->output_file = output_file;
+    emitter->pending = create_buffer();
+    emitter->flush_threshold = EMITTER_FLUSH_THRESHOLD;
+    buffer_need_space(emitter->pending, emitter->flush_threshold);
+    return emitter;
+}
+
+// Writes the pending text out once it has grown past the flush threshold.
+static void emitter_flush_if_needed(Emitter* emitter){
+    if((size_t)emitter->pending->current_length >= emitter->flush_threshold){
+        flush_emitter(emitter);
+    }
+}
+
+void emit_string(Emitter* emitter, const char* string){
+    append_string_to_buffer(emitter->pending, string);
+    emitter_flush_if_needed(emitter);
+}
+
+void emit_formatted(Emitter* emitter, const char* format, ...){
+    va_list args;
+    va_start(args, format);
+    append_formatted_text_from_list(emitter->pending, format, args);
+    va_end(args);
+    emitter_flush_if_needed(emitter);
+}
+
+void emit_integer(Emitter* emitter, long long number){
+    append_integer_to_buffer(emitter->pending, number);
+    emitter_flush_if_needed(emitter);
+}
+
+void emit_character(Emitter* emitter, char character){
+    append_character_to_buffer(emitter->pending, character);
+    emitter_flush_if_needed(emitter);
+}
+
+int flush_emitter(Emitter* emitter){
+    BufferType* pending = emitter->pending;
+    if(pending->current_length == 0 || !emitter->output_file){
+        pending->current_length = 0;
+        return 0;
+    }
+    size_t written = fwrite(pending->allocated_memory, 1, pending->current_length, emitter->output_file);
+    emitter->total_bytes_written += written;
+    int result = written == (size_t)pending->current_length ? 0 : -1;
+    pending->current_length = 0;
+    return result;
+}
+
+void free_emitter(Emitter* emitter){
+    flush_emitter(emitter);
+    free_buffer(emitter->pending);
+    free(emitter);
+}
@@ -0,0 +1,102 @@
+/*
+* @file emitter.h
+* @brief Header file for emitter.c
+* @details Contains the Emitter, a BufferType that collects generated output and writes it to a FILE in large blocks
+*/
+
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "buffer.h"
+
+/*
+* @def EMITTER_FLUSH_THRESHOLD
+* @brief Number of pending bytes after which the emitter writes its buffer to the output file
+*/
+#define EMITTER_FLUSH_THRESHOLD (64 * 1024)
+
+/*
+* @struct Emitter
+* @brief Structure to store the emitter information
+* @details Text is appended to the pending buffer and written to the output file with one fwrite once flush_threshold bytes have piled up
+* @var FILE* output_file
+* File the emitted text is written to
+* @var BufferType* pending
+* Text emitted since the last flush
+* @var size_t flush_threshold
+* Number of pending bytes which triggers a flush
+* @var size_t total_bytes_written
+* Number of bytes written to the output file so far
+*/
+typedef struct Emitter
+{
+    FILE* output_file;
+    BufferType* pending;
+    size_t flush_threshold;
+    size_t total_bytes_written;
+} Emitter;
+
+/*
+* @fn create_emitter
+* @brief Function to create an emitter
+* @details Allocates an emitter writing to output_file with a pending buffer sized for EMITTER_FLUSH_THRESHOLD bytes.
+* @param output_file File the emitted text is written to
+* @return Pointer to the emitter
+*/
+Emitter* create_emitter(FILE* output_file);
+/*
+* @fn emit_string
+* @brief Function to emit a string
+* @details Appends a null terminated string without going through printf.
+* @param emitter Pointer to the emitter
+* @param string String to be emitted
+* @return void
+*/
+void emit_string(Emitter* emitter, const char* string);
+/*
+* @fn emit_formatted
+* @brief Function to emit formatted text
+* @details Appends printf style formatted text of any length.
+* @param emitter Pointer to the emitter
+* @param format Format string for the text to be emitted
+* @return void
+*/
+void emit_formatted(Emitter* emitter, const char* format, ...);
+/*
+* @fn emit_integer
+* @brief Function to emit an integer
+* @details Appends the decimal digits of number without going through printf.
+* @param emitter Pointer to the emitter
+* @param number Integer to be emitted
+* @return void
+*/
+void emit_integer(Emitter* emitter, long long number);
+/*
+* @fn emit_character
+* @brief Function to emit a character
+* @details Appends a single character.
+* @param emitter Pointer to the emitter
+* @param character Character to be emitted
+* @return void
+*/
+void emit_character(Emitter* emitter, char character);
+/*
+* @fn flush_emitter
+* @brief Function to flush the emitter
+* @details Writes all pending text to the output file with a single fwrite and empties the pending buffer.
+* @param emitter Pointer to the emitter
+* @return 0 if successful, -1 if the write failed
+*/
+int flush_emitter(Emitter* emitter);
+/*
+* @fn free_emitter
+* @brief Function to free the emitter
+* @details Flushes pending text and frees the emitter, the output file is left open.
+* @param emitter Pointer to the emitter
+* @return void
+*/
+void free_emitter(Emitter* emitter);
+
+#endif // EMITTER_H
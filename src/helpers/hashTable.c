@@ -0,0 +1,152 @@
+#include "hashTable.h"
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t hash_string(const char* string);
+
+HashTable* create_hash_table(int expected_count);
+
+void destroy_hash_table(HashTable* table);
+
+static HashTableEntry* hash_table_find_slot(HashTable* table, const char* key, uint32_t hash);
+
+static void hash_table_resize(HashTable* table, int new_capacity);
+
+void* hash_table_get(HashTable* table, const char* key);
+
+bool hash_table_contains(HashTable* table, const char* key);
+
+void* hash_table_put(HashTable* table, const char* key, void* value);
+
+void* hash_table_remove(HashTable* table, const char* key);
+
+void clear_hash_table(HashTable* table);
+
+void hash_table_for_each(HashTable* table, HASH_TABLE_VISITOR visitor, void* private_data);
+
+
+
+uint32_t hash_string(const char* string){
+    uint32_t hash = 2166136261u;
+    for(const unsigned char* character = (const unsigned char*)string; *character; character++){
+        hash ^= *character;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+HashTable* create_hash_table(int expected_count){
+    int capacity = HASH_TABLE_MINIMUM_CAPACITY;
+    while(capacity < expected_count * 2){
+        capacity *= 2;
+    }
+    HashTable* table = calloc(1, sizeof(HashTable));
+    table->entries = calloc(capacity, sizeof(HashTableEntry));
+    table->capacity = capacity;
+    return table;
+}
+
+void destroy_hash_table(HashTable* table){
+    if(!table){
+        return;
+    }
+    free(table->entries);
+    free(table);
+}
+
+// Returns the slot holding the key, or the free slot where it would be inserted.
+static HashTableEntry* hash_table_find_slot(HashTable* table, const char* key, uint32_t hash){
+    int mask = table->capacity - 1;
+    int index = hash & mask;
+    while(true){
+        HashTableEntry* entry = &table->entries[index];
+        if(!entry->key || (entry->hash == hash && strcmp(entry->key, key) == 0)){
+            return entry;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+// Rehashes every entry into a table of new_capacity slots.
+static void hash_table_resize(HashTable* table, int new_capacity){
+    HashTableEntry* old_entries = table->entries;
+    int old_capacity = table->capacity;
+    table->entries = calloc(new_capacity, sizeof(HashTableEntry));
+    table->capacity = new_capacity;
+    for(int i = 0; i < old_capacity; i++){
+        if(old_entries[i].key){
+            *hash_table_find_slot(table, old_entries[i].key, old_entries[i].hash) = old_entries[i];
+        }
+    }
+    free(old_entries);
+}
+
+void* hash_table_get(HashTable* table, const char* key){
+    HashTableEntry* entry = hash_table_find_slot(table, key, hash_string(key));
+    return entry->key ? entry->value : NULL;
+}
+
+bool hash_table_contains(HashTable* table, const char* key){
+    return hash_table_find_slot(table, key, hash_string(key))->key != NULL;
+}
+
+void* hash_table_put(HashTable* table, const char* key, void* value){
+    if((table->count + 1) * 2 > table->capacity){
+        hash_table_resize(table, table->capacity * 2);
+    }
+    uint32_t hash = hash_string(key);
+    HashTableEntry* entry = hash_table_find_slot(table, key, hash);
+    void* old_value = NULL;
+    if(entry->key){
+        old_value = entry->value;
+    }
+    else{
+        entry->key = key;
+        entry->hash = hash;
+        table->count++;
+    }
+    entry->value = value;
+    return old_value;
+}
+
+void* hash_table_remove(HashTable* table, const char* key){
+    HashTableEntry* entry = hash_table_find_slot(table, key, hash_string(key));
+    if(!entry->key){
+        return NULL;
+    }
+    void* old_value = entry->value;
+    int mask = table->capacity - 1;
+    int hole = entry - table->entries;
+    int index = hole;
+    //shift back every later entry of the probe run which would no longer be reachable across the hole
+    while(true){
+        index = (index + 1) & mask;
+        HashTableEntry* next = &table->entries[index];
+        if(!next->key){
+            break;
+        }
+        int home = next->hash & mask;
+        bool home_is_after_hole = hole <= index ? (home > hole && home <= index) : (home > hole || home <= index);
+        if(home_is_after_hole){
+            continue;
+        }
+        table->entries[hole] = *next;
+        hole = index;
+    }
+    table->entries[hole] = (HashTableEntry){0};
+    table->count--;
+    return old_value;
+}
+
+void clear_hash_table(HashTable* table){
+    memset(table->entries, 0, table->capacity * sizeof(HashTableEntry));
+    table->count = 0;
+}
+
+void hash_table_for_each(HashTable* table, HASH_TABLE_VISITOR visitor, void* private_data){
+    for(int i = 0; i < table->capacity; i++){
+        if(table->entries[i].key){
+            visitor(table->entries[i].key, table->entries[i].value, private_data);
+        }
+    }
+}
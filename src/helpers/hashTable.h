@@ -0,0 +1,138 @@
+/*
+* @file hashTable.h
+* @brief Header file for hashTable.c
+* @details Contains the HashTable, an open-addressing table mapping null terminated string keys to pointers
+*/
+
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+* @def HASH_TABLE_MINIMUM_CAPACITY
+* @brief Smallest number of slots a hash table is created with
+*/
+#define HASH_TABLE_MINIMUM_CAPACITY 16
+
+/*
+* @struct HashTableEntry
+* @brief A slot of the hash table
+* @var const char* key
+* The key of the entry, NULL if the slot is free. The string is not copied so it has to outlive the entry
+* @var uint32_t hash
+* The cached hash of the key, compared before the key itself
+* @var void* value
+* The value stored for the key
+*/
+typedef struct HashTableEntry
+{
+    const char* key;
+    uint32_t hash;
+    void* value;
+} HashTableEntry;
+
+/*
+* @struct HashTable
+* @brief An open-addressing hash table with linear probing
+* @details The number of slots is always a power of two and the table is grown once it is half full, so lookups, inserts and removals are O(1) on average
+* @var HashTableEntry* entries
+* The slots of the table
+* @var int capacity
+* The number of slots
+* @var int count
+* The number of used slots
+*/
+typedef struct HashTable
+{
+    HashTableEntry* entries;
+    int capacity;
+    int count;
+} HashTable;
+
+/*
+* @typedef HASH_TABLE_VISITOR
+* @brief Called by hash_table_for_each for every entry
+*/
+typedef void (*HASH_TABLE_VISITOR)(const char* key, void* value, void* private_data);
+
+/*
+* @fn hash_string
+* @brief Hashes a string
+* @details Computes the 32 bit FNV-1a hash of a null terminated string.
+* @param string The string to hash
+* @return The hash of the string
+*/
+uint32_t hash_string(const char* string);
+/*
+* @fn create_hash_table
+* @brief Creates a hash table
+* @details Allocates a table with room for at least expected_count entries before it has to grow.
+* @param expected_count The number of entries the table is expected to hold
+* @return A pointer to the hash table
+*/
+HashTable* create_hash_table(int expected_count);
+/*
+* @fn destroy_hash_table
+* @brief Destroys a hash table
+* @details Frees the slots and the table, keys and values are owned by the caller and are not freed.
+* @param table The hash table to destroy
+* @return void
+*/
+void destroy_hash_table(HashTable* table);
+/*
+* @fn hash_table_get
+* @brief Looks up a key
+* @param table The hash table to search
+* @param key The key to look up
+* @return The value stored for the key, NULL if the key is not present
+*/
+void* hash_table_get(HashTable* table, const char* key);
+/*
+* @fn hash_table_contains
+* @brief Checks whether a key is present
+* @param table The hash table to search
+* @param key The key to look up
+* @return true if the key is present, false otherwise
+*/
+bool hash_table_contains(HashTable* table, const char* key);
+/*
+* @fn hash_table_put
+* @brief Stores a value for a key
+* @details Inserts the key or overwrites the value already stored for it, growing the table when it gets half full.
+* @param table The hash table to store into
+* @param key The key to store the value for
+* @param value The value to store
+* @return The value previously stored for the key, NULL if the key was not present
+*/
+void* hash_table_put(HashTable* table, const char* key, void* value);
+/*
+* @fn hash_table_remove
+* @brief Removes a key
+* @details Removes the key and shifts later entries of its probe run back, so no tombstones are left behind.
+* @param table The hash table to remove from
+* @param key The key to remove
+* @return The value that was stored for the key, NULL if the key was not present
+*/
+void* hash_table_remove(HashTable* table, const char* key);
+/*
+* @fn clear_hash_table
+* @brief Removes every entry
+* @param table The hash table to clear
+* @return void
+*/
+void clear_hash_table(HashTable* table);
+/*
+* @fn hash_table_for_each
+* @brief Calls the visitor for every entry
+* @details Entries are visited in slot order, which is unrelated to the order they were put in. The visitor must not put into or remove from the table.
+* @param table The hash table to walk
+* @param visitor Called with the key, the value and private_data of each entry
+* @param private_data Passed to the visitor unchanged
+* @return void
+*/
+void hash_table_for_each(HashTable* table, HASH_TABLE_VISITOR visitor, void* private_data);
+
+#endif // HASH_TABLE_H
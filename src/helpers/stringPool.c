@@ -0,0 +1,55 @@
+#include "stringPool.h"
+#include <stdlib.h>
+#include <string.h>
+
+StringPool* create_string_pool();
+
+static char* string_pool_allocate_chunk(StringPool* pool, size_t size);
+
+char* string_pool_copy(StringPool* pool, const char* string, size_t length);
+
+void free_string_pool(StringPool* pool);
+
+
+
+StringPool* create_string_pool(){
+    StringPool* pool = calloc(1, sizeof(StringPool));
+    pool->chunks = create_vector(sizeof(char*));
+    return pool;
+}
+
+// Allocates a chunk of at least size bytes and remembers it so it is freed with the pool.
+static char* string_pool_allocate_chunk(StringPool* pool, size_t size){
+    char* chunk = malloc(size);
+    push_element(pool->chunks, &chunk);
+    return chunk;
+}
+
+char* string_pool_copy(StringPool* pool, const char* string, size_t length){
+    size_t needed = length + 1;
+    char* destination = NULL;
+    if(needed > STRING_POOL_CHUNK_SIZE / 4){
+        //large strings get their own chunk so they do not waste the tail of the current one
+        destination = string_pool_allocate_chunk(pool, needed);
+    }
+    else{
+        if(!pool->current_chunk || pool->used + needed > pool->capacity){
+            pool->current_chunk = string_pool_allocate_chunk(pool, STRING_POOL_CHUNK_SIZE);
+            pool->used = 0;
+            pool->capacity = STRING_POOL_CHUNK_SIZE;
+        }
+        destination = pool->current_chunk + pool->used;
+        pool->used += needed;
+    }
+    memcpy(destination, string, length);
+    destination[length] = 0x00;
+    return destination;
+}
+
+void free_string_pool(StringPool* pool){
+    vector_for_each(char*, chunk, pool->chunks){
+        free(*chunk);
+    }
+    destroy_vector(pool->chunks);
+    free(pool);
+}
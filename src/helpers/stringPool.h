@@ -0,0 +1,66 @@
+/*
+* @file stringPool.h
+* @brief Header file for stringPool.c
+* @details Contains the StringPool, a chunked arena which hands out null terminated copies of short strings
+*/
+
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <stddef.h>
+#include "vector.h"
+
+/*
+* @def STRING_POOL_CHUNK_SIZE
+* @brief Size in bytes of each chunk the pool carves strings from
+*/
+#define STRING_POOL_CHUNK_SIZE 4096
+
+/*
+* @struct StringPool
+* @brief Structure to store the string pool information
+* @details Strings are copied back to back into the current chunk; a new chunk is started when the current one is full. Strings longer than a chunk get a chunk of their own.
+* @var DynamicVector* chunks
+* Vector of char* holding every chunk allocated by the pool
+* @var char* current_chunk
+* Chunk new strings are carved from
+* @var size_t used
+* Number of bytes used in the current chunk
+* @var size_t capacity
+* Size of the current chunk
+*/
+typedef struct StringPool
+{
+    DynamicVector* chunks;
+    char* current_chunk;
+    size_t used;
+    size_t capacity;
+} StringPool;
+
+/*
+* @fn create_string_pool
+* @brief Function to create a string pool
+* @details Allocates an empty pool, the first chunk is allocated on the first copy.
+* @return Pointer to the string pool
+*/
+StringPool* create_string_pool();
+/*
+* @fn string_pool_copy
+* @brief Function to copy a string into the pool
+* @details Copies length bytes followed by a null terminator into the pool. The copy lives until the pool is freed.
+* @param pool Pointer to the string pool
+* @param string Bytes to be copied
+* @param length Number of bytes to copy
+* @return Pointer to the pooled copy
+*/
+char* string_pool_copy(StringPool* pool, const char* string, size_t length);
+/*
+* @fn free_string_pool
+* @brief Function to free a string pool
+* @details Frees every chunk and the pool itself, invalidating all strings handed out by it.
+* @param pool Pointer to the string pool
+* @return void
+*/
+void free_string_pool(StringPool* pool);
+
+#endif // STRING_POOL_H
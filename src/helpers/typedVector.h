@@ -0,0 +1,61 @@
+/*
+* @file typedVector.h
+* @brief Type-specialized inline accessors for DynamicVector
+* @details Contains the VEC_DEFINE macro which generates static inline push/get/pop functions for one element type. The generated functions work on a regular DynamicVector whose element_size is sizeof(type), so they can be mixed freely with the generic vector.c API.
+*/
+
+#ifndef TYPED_VECTOR_H
+#define TYPED_VECTOR_H
+
+#include <assert.h>
+#include "vector.h"
+
+/*
+* @def VEC_DEFINE
+* @brief Generates a type-specialized family of vector functions
+* @details VEC_DEFINE(NodePtr, Node*) generates vector_NodePtr_push, vector_NodePtr_at, vector_NodePtr_at_pointer, vector_NodePtr_last, vector_NodePtr_last_or, vector_NodePtr_pop and vector_NodePtr_data. Elements are read and written through a typed pointer into data_buffer, so every access is a plain array index with no element_size multiplication, memcpy or double indirection. Like push_element, push leaves the vector unchanged when the buffer can't grow.
+* @param name The suffix used in the generated function names
+* @param type The element type stored in the vector
+*/
+#define VEC_DEFINE(name, type) \
+    static inline type* vector_##name##_data(DynamicVector* vector){ \
+        assert(vector->element_size == sizeof(type)); \
+        return (type*)vector->data_buffer; \
+    } \
+    static inline void vector_##name##_push(DynamicVector* vector, type element){ \
+        ensure_vector_capacity(vector, vector->element_count + 1); \
+        if(vector->element_count >= vector->max_index){ \
+            return; \
+        } \
+        vector_##name##_data(vector)[vector->element_count] = element; \
+        vector->element_count++; \
+        vector->read_index++; \
+        vector->peek_index++; \
+    } \
+    static inline type vector_##name##_at(DynamicVector* vector, int index){ \
+        assert(index >= 0 && index < vector->element_count); \
+        return vector_##name##_data(vector)[index]; \
+    } \
+    static inline type* vector_##name##_at_pointer(DynamicVector* vector, int index){ \
+        if(index < 0 || index >= vector->element_count){ \
+            return NULL; \
+        } \
+        return &vector_##name##_data(vector)[index]; \
+    } \
+    static inline type vector_##name##_last(DynamicVector* vector){ \
+        return vector_##name##_at(vector, vector->element_count - 1); \
+    } \
+    static inline type vector_##name##_last_or(DynamicVector* vector, type fallback){ \
+        if(vector->element_count == 0){ \
+            return fallback; \
+        } \
+        return vector_##name##_data(vector)[vector->element_count - 1]; \
+    } \
+    static inline type vector_##name##_pop(DynamicVector* vector){ \
+        type element = vector_##name##_last(vector); \
+        vector->element_count--; \
+        vector->read_index--; \
+        return element; \
+    }
+
+#endif
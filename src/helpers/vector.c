@@ -22,11 +22,20 @@ void* peek_pointer(DynamicVector* vector);
 void set_peek_index(DynamicVector* vector, int index);
 void set_peek_index_to_end(DynamicVector* vector);
 void push_element(DynamicVector* vector, void* element);
+static bool resize_vector(DynamicVector* vector, int new_capacity);
+static void grow_vector_for(DynamicVector* vector, int total_elements);
+void ensure_vector_capacity(DynamicVector* vector, int total_elements);
+void reserve_vector(DynamicVector* vector, int total_elements);
+void shrink_vector_to_fit(DynamicVector* vector);
 void insert_element_at(DynamicVector* vector, int index, void* element);
+static void move_vector_elements(DynamicVector* vector, int destination_index, int source_index, int element_count);
+int splice_vector_elements(DynamicVector* vector, int index, const void* elements, int element_count);
+int append_vector_elements(DynamicVector* vector, const void* elements, int element_count);
+int remove_vector_range(DynamicVector* vector, int index, int element_count);
+int remove_vector_elements_if(DynamicVector* vector, VECTOR_ELEMENT_PREDICATE predicate, void* private_data);
 void remove_last_element(DynamicVector* vector);
 void remove_last_peeked_element(DynamicVector* vector);
 void remove_element_at(DynamicVector* vector, int index);
-static void* get_vector_data_end_pointer(DynamicVector* vector);
 void* get_last_element(DynamicVector* vector);
 static void assert_bounds_for_pop(DynamicVector* vector, int index);
 void* get_last_element_or_null(DynamicVector* vector);
@@ -40,13 +49,14 @@ int get_element_count(DynamicVector* vector);
 int read_vector_from_file(DynamicVector* vector, int element_count, FILE* file_pointer);
 void* get_vector_data_pointer(DynamicVector* vector);
 int insert_vector_at(DynamicVector* destination_vector, DynamicVector* source_vector, int destination_index);
+int append_vector(DynamicVector* destination_vector, DynamicVector* source_vector);
 int remove_element_by_data_address(DynamicVector* vector, void* element_address);
 int remove_element_by_value(DynamicVector* vector, void* value);
 void remove_element_by_index(DynamicVector* vector, int index);
 void* get_vector_data_end(DynamicVector* vector);
 void move_peek_pointer_backward(DynamicVector* vector);
 int get_next_insert_index(DynamicVector* vector);
-void save_vector_state(DynamicVector* vector);
+int save_vector_state(DynamicVector* vector);
 void restore_vector_state(DynamicVector* vector);
 void discard_last_saved_state(DynamicVector* vector);
 size_t get_vector_element_size(DynamicVector* vector);
@@ -57,12 +67,10 @@ DynamicVector* clone_vector(DynamicVector* vector);
 
 DynamicVector* create_vector(size_t element_size)
 {
-    DynamicVector* vector = create_vector_no_saved_states(element_size);
-    vector->saved_states = create_vector_no_saved_states(sizeof(DynamicVector));
-    return vector;
+    return create_vector_no_saved_states(element_size);
 }
 
-// Creates a dynamic vector without saved states, allocating memory for storage and initializing its metadata.
+// Creates a dynamic vector with an empty saved states stack, allocating memory for storage and initializing its metadata.
 DynamicVector* create_vector_no_saved_states(size_t element_size)
 {
     DynamicVector* vector = calloc(sizeof(DynamicVector), 1);
@@ -168,14 +176,8 @@ void set_peek_index_to_end(DynamicVector* vector){
 
 void push_element(DynamicVector* vector, void* element)
 {
-    if (vector->element_count >= vector->max_index)
-    {
-        int new_capacity = vector->max_index + VECTOR_MINIMUM_EXTRA_CAPACITY;
-        void* new_memory = realloc(vector->data_buffer, new_capacity * vector->element_size);
-        if (!new_memory) return;
-        vector->data_buffer = new_memory;
-        vector->max_index = new_capacity;
-    }
+    ensure_vector_capacity(vector, vector->element_count + 1);
+    if (vector->element_count >= vector->max_index) return;
 
     void* destination = (char*)vector->data_buffer + (vector->element_count * vector->element_size);
     memcpy(destination, element, vector->element_size);
@@ -184,16 +186,132 @@ void push_element(DynamicVector* vector, void* element)
     vector->peek_index++;
 }
 
+// Reallocates the data buffer to hold exactly new_capacity elements, leaving the vector untouched on failure.
+static bool resize_vector(DynamicVector* vector, int new_capacity)
+{
+    void* new_memory = realloc(vector->data_buffer, new_capacity * vector->element_size);
+    if (!new_memory) return false;
+    vector->data_buffer = new_memory;
+    vector->max_index = new_capacity;
+    return true;
+}
+
+// Grows the capacity geometrically so that pushing N elements costs O(N) copying overall.
+static void grow_vector_for(DynamicVector* vector, int total_elements)
+{
+    int new_capacity = vector->max_index * VECTOR_GROWTH_FACTOR;
+    if (new_capacity < vector->max_index + VECTOR_MINIMUM_EXTRA_CAPACITY)
+    {
+        new_capacity = vector->max_index + VECTOR_MINIMUM_EXTRA_CAPACITY;
+    }
+    if (new_capacity < total_elements)
+    {
+        new_capacity = total_elements;
+    }
+    resize_vector(vector, new_capacity);
+}
+
+void ensure_vector_capacity(DynamicVector* vector, int total_elements)
+{
+    if (total_elements <= vector->max_index) return;
+    grow_vector_for(vector, total_elements);
+}
+
+void reserve_vector(DynamicVector* vector, int total_elements)
+{
+    if (total_elements <= vector->max_index) return;
+    resize_vector(vector, total_elements);
+}
+
+void shrink_vector_to_fit(DynamicVector* vector)
+{
+    int new_capacity = vector->element_count > 0 ? vector->element_count : 1;
+    if (new_capacity >= vector->max_index) return;
+    resize_vector(vector, new_capacity);
+}
+
 void insert_element_at(DynamicVector* vector, int index, void* element)
 {
-    if (index < 0 || index > vector->element_count) return;
+    splice_vector_elements(vector, index, element, 1);
+}
 
-    push_element(vector, NULL); // Expand capacity
-    memmove((char*)vector->data_buffer + ((index + 1) * vector->element_size),
-            (char*)vector->data_buffer + (index * vector->element_size),
-            (vector->element_count - index - 1) * vector->element_size);
-    
-    memcpy(get_element_at(vector, index), element, vector->element_size);
+// Moves a run of elements inside the data buffer, the ranges may overlap.
+static void move_vector_elements(DynamicVector* vector, int destination_index, int source_index, int element_count)
+{
+    if (element_count <= 0 || destination_index == source_index) return;
+    memmove((char*)vector->data_buffer + (destination_index * vector->element_size),
+            (char*)vector->data_buffer + (source_index * vector->element_size),
+            element_count * vector->element_size);
+}
+
+int splice_vector_elements(DynamicVector* vector, int index, const void* elements, int element_count)
+{
+    if (index < 0 || index > vector->element_count || element_count < 0) return -1;
+    if (element_count == 0) return 0;
+
+    ensure_vector_capacity(vector, vector->element_count + element_count);
+    if (vector->element_count + element_count > vector->max_index) return -1;
+
+    move_vector_elements(vector, index + element_count, index, vector->element_count - index);
+    memcpy((char*)vector->data_buffer + (index * vector->element_size), elements, element_count * vector->element_size);
+    vector->element_count += element_count;
+    vector->read_index += element_count;
+    if (vector->peek_index > index)
+    {
+        vector->peek_index += element_count;
+    }
+    return 0;
+}
+
+int append_vector_elements(DynamicVector* vector, const void* elements, int element_count)
+{
+    return splice_vector_elements(vector, vector->element_count, elements, element_count);
+}
+
+int remove_vector_range(DynamicVector* vector, int index, int element_count)
+{
+    if (index < 0 || element_count < 0 || index + element_count > vector->element_count) return -1;
+    if (element_count == 0) return 0;
+
+    int end_index = index + element_count;
+    move_vector_elements(vector, index, end_index, vector->element_count - end_index);
+    vector->element_count -= element_count;
+    vector->read_index -= element_count;
+    if (vector->peek_index >= end_index)
+    {
+        vector->peek_index -= element_count;
+    }
+    else if (vector->peek_index > index)
+    {
+        vector->peek_index = index;
+    }
+    return 0;
+}
+
+int remove_vector_elements_if(DynamicVector* vector, VECTOR_ELEMENT_PREDICATE predicate, void* private_data)
+{
+    int kept_count = 0;
+    int new_peek_index = vector->peek_index;
+    for (int index = 0; index < vector->element_count; index++)
+    {
+        void* element = get_element_at(vector, index);
+        if (predicate(element, private_data))
+        {
+            if (index < vector->peek_index)
+            {
+                new_peek_index--;
+            }
+            continue;
+        }
+        move_vector_elements(vector, kept_count, index, 1);
+        kept_count++;
+    }
+
+    int removed_count = vector->element_count - kept_count;
+    vector->element_count = kept_count;
+    vector->read_index -= removed_count;
+    vector->peek_index = new_peek_index;
+    return removed_count;
 }
 
 void remove_last_element(DynamicVector* vector)
@@ -211,20 +329,8 @@ void remove_last_peeked_element(DynamicVector* vector) {
 }
 
 void remove_element_at(DynamicVector* vector, int index)
-{   
-    void* destination_position = get_element_at(vector, index);
-    void* position_of_next_element = destination_position + vector->element_size;
-    void* end_position = get_vector_data_end_pointer(vector);
-    size_t total_bytes_to_move = (size_t)end_position - (size_t)position_of_next_element;
-    memcpy(destination_position, position_of_next_element, total_bytes_to_move);
-    vector->element_count--;
-    vector->read_index--;
-    vector->peek_index--;
-}
-
-// Returns a pointer to the end of the used data in the vector by calculating the offset based on element count.  
-static void* get_vector_data_end_pointer(DynamicVector* vector){
-    return vector->data_buffer + (vector->element_count * vector->element_size);
+{
+    remove_vector_range(vector, index, 1);
 }
 
 void* get_last_element(DynamicVector* vector)
@@ -319,10 +425,14 @@ int insert_vector_at(DynamicVector* destination_vector, DynamicVector* source_ve
     if (!destination_vector || !source_vector) return -1;
     if (destination_index < 0 || destination_index > destination_vector->element_count) return -1;
 
-    for (int i = 0; i < source_vector->element_count; i++) {
-        insert_element_at(destination_vector, destination_index + i, get_element_at(source_vector, i));
-    }
-    return 0;
+    if (destination_vector->element_size != source_vector->element_size) return -1;
+
+    return splice_vector_elements(destination_vector, destination_index, source_vector->data_buffer, source_vector->element_count);
+}
+
+int append_vector(DynamicVector* destination_vector, DynamicVector* source_vector) {
+    if (!destination_vector || !source_vector) return -1;
+    return insert_vector_at(destination_vector, source_vector, destination_vector->element_count);
 }
 
 int remove_element_by_data_address(DynamicVector* vector, void* element_address) {
@@ -349,11 +459,8 @@ int remove_element_by_value(DynamicVector* vector, void* value)
 }
 
 void remove_element_by_index(DynamicVector* vector, int index){
-    void* destination_position = get_element_at(vector, index);
-    void* position_of_next_element = destination_position + vector->element_size;
-    void* end_position = get_vector_data_end(vector);
-    size_t total_bytes_to_move = (size_t)end_position - (size_t)position_of_next_element;
-    memcpy(destination_position, position_of_next_element, total_bytes_to_move);
+    if (index < 0 || index >= vector->element_count) return;
+    move_vector_elements(vector, index, index + 1, vector->element_count - index - 1);
     vector->element_count--;
     vector->read_index--;
 }
@@ -375,32 +482,40 @@ int get_next_insert_index(DynamicVector* vector) {
     return vector->element_count;
 }
 
-void save_vector_state(DynamicVector* vector)
+int save_vector_state(DynamicVector* vector)
 {
-    if (!vector) return;
-
-    DynamicVector* new_state = (DynamicVector*)malloc(sizeof(DynamicVector));
-    if (!new_state) return;
+    if (!vector) return -1;
+    if (vector->saved_state_count == vector->saved_state_capacity)
+    {
+        int new_capacity = vector->saved_state_capacity ? vector->saved_state_capacity * VECTOR_GROWTH_FACTOR : VECTOR_MINIMUM_SAVED_STATES;
+        VectorSavedState* new_states = realloc(vector->saved_states, new_capacity * sizeof(VectorSavedState));
+        if (!new_states) return -1;
+        vector->saved_states = new_states;
+        vector->saved_state_capacity = new_capacity;
+    }
 
-    *new_state = *vector; // Copy struct values
-    vector->saved_states = new_state;
+    VectorSavedState* state = &vector->saved_states[vector->saved_state_count++];
+    state->peek_index = vector->peek_index;
+    state->element_count = vector->element_count;
+    return 0;
 }
 
 void restore_vector_state(DynamicVector* vector)
 {
-    if (!vector || !vector->saved_states) return;
+    if (!vector || vector->saved_state_count == 0) return;
 
-    *vector = *vector->saved_states;
-    free(vector->saved_states);
-    vector->saved_states = NULL;
+    VectorSavedState* state = &vector->saved_states[--vector->saved_state_count];
+    assert(state->element_count <= vector->element_count);
+    vector->read_index -= vector->element_count - state->element_count;
+    vector->element_count = state->element_count;
+    vector->peek_index = state->peek_index;
 }
 
 void discard_last_saved_state(DynamicVector* vector)
 {
-    if (vector->saved_states)
+    if (vector->saved_state_count > 0)
     {
-        free(vector->saved_states);
-        vector->saved_states = NULL;
+        vector->saved_state_count--;
     }
 }
 
@@ -19,6 +19,16 @@
 * @brief Minimum extra capacity to allocate when resizing the vector
 */
 #define VECTOR_MINIMUM_EXTRA_CAPACITY 20
+/*
+* @def VECTOR_GROWTH_FACTOR
+* @brief Factor by which the vector capacity is multiplied when it runs out of space
+*/
+#define VECTOR_GROWTH_FACTOR 2
+/*
+* @def VECTOR_MINIMUM_SAVED_STATES
+* @brief Capacity of the saved states stack when the first state is saved
+*/
+#define VECTOR_MINIMUM_SAVED_STATES 4
 
 
 /*
@@ -30,10 +40,31 @@ typedef enum
     VECTOR_FLAG_DECREMENT_PEEK = 0b00000001 // @brief Decrement the peek index after peeking an element
 } VectorFlags;
 
+/*
+* @struct VectorSavedState
+* @brief A checkpoint of the vector cursor and element count
+* @var int peek_index: The peek index at the time of saving
+* @var int element_count: The element count at the time of saving
+*/
+/*
+* @typedef VECTOR_ELEMENT_PREDICATE
+* @brief A callback deciding whether an element matches
+* @param element A pointer to the element inside the vector
+* @param private_data Caller supplied data passed through unchanged
+* @return true if the element matches, false otherwise
+*/
+typedef bool (*VECTOR_ELEMENT_PREDICATE)(void* element, void* private_data);
+
+typedef struct VectorSavedState
+{
+    int peek_index;
+    int element_count;
+} VectorSavedState;
+
 /*
 * @struct DynamicVector
 * @brief A dynamic vector struct that can store any type of data
-* @details The struct contains a data buffer, the current peek index, the current read index, the max index, the total element count, the vector flags, the size of one element in bytes, and a vector of saved states
+* @details The struct contains a data buffer, the current peek index, the current read index, the max index, the total element count, the vector flags, the size of one element in bytes, and a stack of saved states
 * @var void* data_buffer: The data buffer of the vector
 * @var int peek_index: The next element index to be read by `peek`
 * @var int read_index: The current read index
@@ -41,7 +72,9 @@ typedef enum
 * @var int element_count: The total elements stored
 * @var int flag_settings: The vector flags
 * @var size_t element_size: The size of one element in bytes
-* @var struct DynamicVector* saved_states: The vector of saved states (struct only, not data)
+* @var VectorSavedState* saved_states: The stack of saved states (cursor and count only, not data), NULL until the first state is saved
+* @var int saved_state_count: The number of states on the saved states stack
+* @var int saved_state_capacity: The number of states the saved states stack has room for
 */
 typedef struct DynamicVector
 {
@@ -52,14 +85,34 @@ typedef struct DynamicVector
     int element_count;
     int flag_settings;
     size_t element_size;
-    struct DynamicVector* saved_states;
+    VectorSavedState* saved_states;
+    int saved_state_count;
+    int saved_state_capacity;
 } DynamicVector;
 
+/*
+* @def vector_for_each
+* @brief Iterates over every element of a vector without touching its peek index
+* @details Declares `type* element` and walks it from the first to the last element as a plain pointer loop. The vector's own cursor is never used, so nested or concurrent read-only iterations of the same vector are safe. For vectors of pointers pass the pointer type, eg: vector_for_each(Node*, node_pointer, vector) yields Node** node_pointer.
+* @param type The element type stored in the vector
+* @param element The name of the loop variable
+* @param vector The DynamicVector to iterate
+*/
+#define vector_for_each(type, element, vector) \
+    for(type* element = (type*)(vector)->data_buffer; element < (type*)(vector)->data_buffer + (vector)->element_count; element++)
+
+/*
+* @def vector_for_each_from
+* @brief Same as vector_for_each but starts at the given index
+*/
+#define vector_for_each_from(type, element, vector, start_index) \
+    for(type* element = (type*)(vector)->data_buffer + (start_index); element < (type*)(vector)->data_buffer + (vector)->element_count; element++)
+
 
 /*
 * @fn create_vector
 * @brief Creates a new DynamicVector struct
-* @details Creates a dynamic vector with a specified element size and initializes a secondary vector for saved states.  
+* @details Creates a dynamic vector with a specified element size and an empty saved states stack.
 * @param element_size The size of one element in bytes
 * @return A pointer to the newly created DynamicVector struct
 */
@@ -67,7 +120,7 @@ DynamicVector* create_vector(size_t element_size);
 /*
 * @fn destroy_vector
 * @brief Destroys a DynamicVector struct
-* @details Safely frees the memory allocated for a dynamic vector, including its data buffer and saved states, before deallocating itself.
+* @details Safely frees the memory allocated for a dynamic vector, including its data buffer, before deallocating itself.
 * @param vector The DynamicVector struct to destroy
 * @return void
 */
@@ -168,6 +221,32 @@ void set_peek_index_to_end(DynamicVector* vector);
 */
 void push_element(DynamicVector* vector, void* element);
 /*
+* @fn reserve_vector
+* @brief Reserves capacity for a number of elements
+* @details Grows the data buffer so that at least total_elements elements fit without any further reallocation; never shrinks the vector.
+* @param vector The DynamicVector struct to reserve capacity in
+* @param total_elements The number of elements the vector should be able to hold
+* @return void
+*/
+void reserve_vector(DynamicVector* vector, int total_elements);
+/*
+* @fn ensure_vector_capacity
+* @brief Makes room for a number of elements using the geometric growth policy
+* @details Grows the data buffer geometrically if total_elements elements would not fit, so repeated calls stay amortized O(1) per element.
+* @param vector The DynamicVector struct to grow
+* @param total_elements The number of elements the vector must be able to hold
+* @return void
+*/
+void ensure_vector_capacity(DynamicVector* vector, int total_elements);
+/*
+* @fn shrink_vector_to_fit
+* @brief Releases unused capacity of the vector
+* @details Reallocates the data buffer down to the current element count, keeping room for at least one element.
+* @param vector The DynamicVector struct to shrink
+* @return void
+*/
+void shrink_vector_to_fit(DynamicVector* vector);
+/*
 * @fn insert_element_at
 * @brief Inserts an element at a specific index
 * @details Inserts an element at the specified index in the vector, shifting existing elements forward and expanding capacity if needed.
@@ -178,6 +257,47 @@ void push_element(DynamicVector* vector, void* element);
 */
 void insert_element_at(DynamicVector* vector, int index, void* element);
 /*
+* @fn splice_vector_elements
+* @brief Inserts a run of elements at a specific index
+* @details Grows the vector once, moves the tail up with a single memmove and copies all elements in, so splicing M elements into N costs O(N + M). A peek index past the insertion point is moved along with its element.
+* @param vector The DynamicVector struct to insert the elements to
+* @param index The index to insert the elements at
+* @param elements A pointer to element_count contiguous elements
+* @param element_count The number of elements to insert
+* @return 0 if successful, -1 otherwise
+*/
+int splice_vector_elements(DynamicVector* vector, int index, const void* elements, int element_count);
+/*
+* @fn append_vector_elements
+* @brief Appends a run of elements to the end of the vector
+* @details Grows the vector once and copies all elements in with a single memcpy.
+* @param vector The DynamicVector struct to append the elements to
+* @param elements A pointer to element_count contiguous elements
+* @param element_count The number of elements to append
+* @return 0 if successful, -1 otherwise
+*/
+int append_vector_elements(DynamicVector* vector, const void* elements, int element_count);
+/*
+* @fn remove_vector_range
+* @brief Removes a run of elements starting at a specific index
+* @details Closes the gap with a single memmove. A peek index inside or past the removed range is moved back so it keeps pointing at the same element, or at the first element after the range.
+* @param vector The DynamicVector struct to remove the elements from
+* @param index The index of the first element to remove
+* @param element_count The number of elements to remove
+* @return 0 if successful, -1 otherwise
+*/
+int remove_vector_range(DynamicVector* vector, int index, int element_count);
+/*
+* @fn remove_vector_elements_if
+* @brief Removes every element matching a predicate
+* @details Compacts the kept elements in one forward pass, so each kept element is moved at most once. The peek index is moved back by the number of removed elements before it.
+* @param vector The DynamicVector struct to remove the elements from
+* @param predicate The callback deciding which elements to remove
+* @param private_data Caller supplied data passed to the predicate
+* @return The number of removed elements
+*/
+int remove_vector_elements_if(DynamicVector* vector, VECTOR_ELEMENT_PREDICATE predicate, void* private_data);
+/*
 * @fn remove_last_element
 * @brief Removes the last element from the vector
 * @details Removes the last element from the vector by decrementing element and read index counts, if not empty.
@@ -287,7 +407,7 @@ void* get_vector_data_pointer(DynamicVector* vector);
 /*
 * @fn insert_vector_at
 * @brief Inserts a vector into another vector at a specific index
-* @details Inserts all elements from source_vector into destination_vector at the specified index.
+* @details Inserts all elements from source_vector into destination_vector at the specified index with a single splice.
 * @param destination_vector The destination vector to insert into
 * @param source_vector The source vector to insert
 * @param destination_index The index to insert the source vector at
@@ -295,6 +415,15 @@ void* get_vector_data_pointer(DynamicVector* vector);
 */
 int insert_vector_at(DynamicVector* destination_vector, DynamicVector* source_vector, int destination_index);
 /*
+* @fn append_vector
+* @brief Appends all elements of one vector to another
+* @details Appends all elements from source_vector to the end of destination_vector in one copy.
+* @param destination_vector The destination vector to append to
+* @param source_vector The source vector to append
+* @return 0 if successful, -1 otherwise
+*/
+int append_vector(DynamicVector* destination_vector, DynamicVector* source_vector);
+/*
 * @fn remove_element_by_data_address
 * @brief Removes an element by its data address
 * @details Removes the element at the specified memory address from the vector and returns its index, or -1 if not found.
@@ -340,15 +469,15 @@ int get_next_insert_index(DynamicVector* vector);
 /*
 * @fn save_vector_state
 * @brief Saves the current state of the vector
-* @details Saves the current state of the vector by creating a copy of its structure.
+* @details Pushes the peek index and element count onto the vector's saved states stack. The stack is only allocated by the first save and grows geometrically, so vectors that are never checkpointed don't pay for it.
 * @param vector The DynamicVector struct to save the state of
-* @return void
+* @return 0 if successful, -1 if the stack could not grow, the vector is left unchanged then
 */
-void save_vector_state(DynamicVector* vector);
+int save_vector_state(DynamicVector* vector);
 /*
 * @fn restore_vector_state
 * @brief Restores the last saved state of the vector
-* @details Restores the vector to its previously saved state and frees the saved state memory.
+* @details Pops the last saved state and rewinds the peek index and element count to it, dropping any elements pushed since it was saved.
 * @param vector The DynamicVector struct to restore the state of
 * @return void
 */
@@ -356,7 +485,7 @@ void restore_vector_state(DynamicVector* vector);
 /*
 * @fn discard_last_saved_state
 * @brief Discards the last saved state of the vector
-* @details Discards the last saved state of the vector and frees its memory.
+* @details Pops the last saved state without restoring it, committing everything done since it was saved.
 * @param vector The DynamicVector struct to discard the state of
 * @return void
 */
@@ -0,0 +1,262 @@
+/*
+* @file induction.c
+* @brief Strength reduction of induction variables
+* @details A basic induction variable is a phi of a loop header that every iteration increases by the same constant, like the counter of a for loop. An address computed in the loop as an invariant base plus the variable times a constant, an array element indexed by the counter, changes by the step times that constant from one iteration to the next. Such an address becomes a phi of its own, a pointer starting at the address of the first iteration in the preheader and advanced next to the increment of the counter, and the sign extension, multiplication and addition computing it in the loop are left to dead code elimination. A 32 bit counter sign extended to 64 bits is treated the same as a 64 bit one, signed overflow of the counter is undefined behavior in C.
+*/
+
+#include "compiler.h"
+
+typedef struct Induction{
+    IrFunction* function;
+    bool* body; //indexed by block id, whether the block belongs to the current loop
+    IrBlock* header;
+    IrBlock* preheader;
+} Induction;
+
+typedef struct InductionVariable{
+    IrInstruction* phi;
+    IrInstruction* increment; //the instruction of the loop adding step to the phi
+    long long step;
+    int initial; //the register the phi starts with, coming in from the preheader
+} InductionVariable;
+
+void ir_reduce_induction_variables(IrFunction* function);
+
+static void induction_reduce_loop(Induction* induction);
+
+static bool induction_find_variable(Induction* induction, IrInstruction* phi, InductionVariable* variable);
+
+static void induction_reduce_uses(Induction* induction, InductionVariable* variable, int vreg);
+
+static void induction_reduce_scaled(Induction* induction, InductionVariable* variable, int scaled, long long scale);
+
+static void induction_reduce_address(Induction* induction, InductionVariable* variable, IrInstruction* address, int base, long long scale);
+
+static int induction_initial_address(Induction* induction, InductionVariable* variable, int base, long long scale);
+
+static int induction_insert(Induction* induction, IrBlock* block, int index, int opcode, int first, int second);
+
+static int induction_insert_constant(Induction* induction, IrBlock* block, int index, long long value);
+
+static long long induction_scale(Induction* induction, IrInstruction* instruction, int vreg);
+
+static IrInstruction* induction_constant_operand(Induction* induction, int vreg);
+
+static bool is_induction_in_loop(Induction* induction, int vreg);
+
+
+
+void ir_reduce_induction_variables(IrFunction* function){
+    DynamicVector* headers = ir_find_loop_headers(function);
+    Induction induction = {.function = function};
+    vector_for_each(IrBlock*, header, headers){
+        ir_compute_cfg(function);
+        ir_compute_dominators(function);
+        ir_compute_def_use(function);
+        induction.body = calloc(function->next_block_id + 1, sizeof(bool));
+        induction.header = *header;
+        ir_find_loop_body(*header, induction.body);
+        induction.preheader = ir_make_preheader(function, *header, induction.body);
+        if(induction.preheader){
+            induction_reduce_loop(&induction);
+        }
+        free(induction.body);
+    }
+    destroy_vector(headers);
+    ir_compute_cfg(function);
+    ir_compute_dominators(function);
+    ir_compute_def_use(function);
+}
+
+static void induction_reduce_loop(Induction* induction){
+    //the new pointers are phis of the header as well
+    DynamicVector* phis = create_vector(sizeof(IrInstruction*));
+    vector_for_each(IrInstruction*, instruction, induction->header->instructions){
+        if((*instruction)->opcode != IR_OP_PHI){
+            break;
+        }
+        vector_IrInstructionPtr_push(phis, *instruction);
+    }
+    vector_for_each(IrInstruction*, phi, phis){
+        InductionVariable variable = {};
+        if(!induction_find_variable(induction, *phi, &variable)){
+            continue;
+        }
+        if(variable.phi->type == IR_TYPE_I64){
+            induction_reduce_uses(induction, &variable, variable.phi->result);
+            continue;
+        }
+        DynamicVector* users = vector_VoidPtr_at(induction->function->uses, variable.phi->result);
+        vector_for_each(IrInstruction*, user, users){
+            if((*user)->opcode == IR_OP_SEXT && (*user)->type == IR_TYPE_I64 && induction->body[(*user)->block->id]){
+                induction_reduce_uses(induction, &variable, (*user)->result);
+            }
+        }
+    }
+    destroy_vector(phis);
+}
+
+// The phi has to get the same register from every block of the loop branching back to the header, the phi plus or minus a constant.
+static bool induction_find_variable(Induction* induction, IrInstruction* phi, InductionVariable* variable){
+    if(phi->type != IR_TYPE_I32 && phi->type != IR_TYPE_I64){
+        return false;
+    }
+    int next = IR_VREG_NONE;
+    variable->phi = phi;
+    variable->initial = IR_VREG_NONE;
+    vector_for_each(IrPhiIncoming, incoming, phi->arguments){
+        if(incoming->block == induction->preheader){
+            variable->initial = incoming->vreg;
+        }
+        else if(next == IR_VREG_NONE || next == incoming->vreg){
+            next = incoming->vreg;
+        }
+        else{
+            return false;
+        }
+    }
+    if(variable->initial == IR_VREG_NONE || next == IR_VREG_NONE){
+        return false;
+    }
+    IrInstruction* increment = vector_IrInstructionPtr_at(induction->function->definitions, next);
+    if(!increment || (increment->opcode != IR_OP_ADD && increment->opcode != IR_OP_SUB)){
+        return false;
+    }
+    int other = increment->operands[0] == phi->result ? increment->operands[1] : increment->operands[0];
+    if(increment->operands[0] != phi->result && (increment->opcode == IR_OP_SUB || increment->operands[1] != phi->result)){
+        return false;
+    }
+    IrInstruction* step = induction_constant_operand(induction, other);
+    if(!step){
+        return false;
+    }
+    variable->increment = increment;
+    variable->step = increment->opcode == IR_OP_SUB ? -step->immediate : step->immediate;
+    return true;
+}
+
+// Looks for invariant base plus the 64 bit value of the variable, itself or scaled by a constant.
+static void induction_reduce_uses(Induction* induction, InductionVariable* variable, int vreg){
+    //adding a 64 bit variable itself costs as much as advancing a pointer
+    if(vreg != variable->phi->result){
+        induction_reduce_scaled(induction, variable, vreg, 1);
+    }
+    DynamicVector* users = vector_VoidPtr_at(induction->function->uses, vreg);
+    if(!users){
+        return;
+    }
+    vector_for_each(IrInstruction*, user, users){
+        long long scale = induction_scale(induction, *user, vreg);
+        if(scale){
+            induction_reduce_scaled(induction, variable, (*user)->result, scale);
+        }
+    }
+}
+
+static void induction_reduce_scaled(Induction* induction, InductionVariable* variable, int scaled, long long scale){
+    DynamicVector* users = vector_VoidPtr_at(induction->function->uses, scaled);
+    if(!users){
+        return;
+    }
+    vector_for_each(IrInstruction*, user, users){
+        IrInstruction* address = *user;
+        if(address->opcode != IR_OP_ADD || address->type != IR_TYPE_I64 || !induction->body[address->block->id]){
+            continue;
+        }
+        int base = address->operands[0] == scaled ? address->operands[1] : address->operands[0];
+        if(base != scaled && !is_induction_in_loop(induction, base)){
+            induction_reduce_address(induction, variable, address, base, scale);
+        }
+    }
+}
+
+// The uses of the address read a new header phi instead, which starts at the address of the first iteration and is advanced right after the increment of the variable.
+static void induction_reduce_address(Induction* induction, InductionVariable* variable, IrInstruction* address, int base, long long scale){
+    IrFunction* function = induction->function;
+    int start = induction_initial_address(induction, variable, base, scale);
+    IrInstruction* phi = ir_new_instruction(IR_OP_PHI, IR_TYPE_I64, ir_new_vreg(function, IR_TYPE_I64));
+    IrBlock* increment_block = variable->increment->block;
+    int increment_index = 0;
+    while(vector_IrInstructionPtr_at(increment_block->instructions, increment_index) != variable->increment){
+        increment_index++;
+    }
+    int stride = induction_insert_constant(induction, increment_block, increment_index + 1, (unsigned long long)variable->step * scale);
+    int next = induction_insert(induction, increment_block, increment_index + 2, IR_OP_ADD, phi->result, stride);
+    vector_for_each(IrPhiIncoming, incoming, variable->phi->arguments){
+        IrPhiIncoming pointer = {.block = incoming->block, .vreg = incoming->block == induction->preheader ? start : next};
+        push_element(phi->arguments, &pointer);
+    }
+    ir_insert_instruction(induction->header, 0, phi);
+    ir_replace_vreg_uses(function, address->result, phi->result);
+    //dead now, as a copy it can't be taken for an address again
+    address->opcode = IR_OP_COPY;
+    address->operands[0] = phi->result;
+    address->operands[1] = IR_VREG_NONE;
+}
+
+// base plus the initial value times scale, computed at the end of the preheader.
+static int induction_initial_address(Induction* induction, InductionVariable* variable, int base, long long scale){
+    IrBlock* preheader = induction->preheader;
+    int index = get_element_count(preheader->instructions) - 1;
+    IrInstruction* initial = induction_constant_operand(induction, variable->initial);
+    int offset = IR_VREG_NONE;
+    if(initial && !initial->immediate){
+        return base;
+    }
+    if(initial){
+        offset = induction_insert_constant(induction, preheader, index, (unsigned long long)initial->immediate * scale);
+    }
+    else{
+        offset = variable->initial;
+        if(variable->phi->type != IR_TYPE_I64){
+            offset = induction_insert(induction, preheader, index++, IR_OP_SEXT, offset, IR_VREG_NONE);
+        }
+        if(scale != 1){
+            int factor = induction_insert_constant(induction, preheader, index++, scale);
+            offset = induction_insert(induction, preheader, index++, IR_OP_MUL, offset, factor);
+        }
+    }
+    index = get_element_count(preheader->instructions) - 1;
+    return induction_insert(induction, preheader, index, IR_OP_ADD, base, offset);
+}
+
+static int induction_insert(Induction* induction, IrBlock* block, int index, int opcode, int first, int second){
+    IrInstruction* instruction = ir_new_instruction(opcode, IR_TYPE_I64, ir_new_vreg(induction->function, IR_TYPE_I64));
+    instruction->operands[0] = first;
+    instruction->operands[1] = second;
+    ir_insert_instruction(block, index, instruction);
+    return instruction->result;
+}
+
+static int induction_insert_constant(Induction* induction, IrBlock* block, int index, long long value){
+    IrInstruction* instruction = ir_new_instruction(IR_OP_CONST, IR_TYPE_I64, ir_new_vreg(induction->function, IR_TYPE_I64));
+    instruction->immediate = value;
+    ir_insert_instruction(block, index, instruction);
+    return instruction->result;
+}
+
+// The constant a loop instruction multiplies vreg by, as a multiplication or a left shift, 0 for other instructions.
+static long long induction_scale(Induction* induction, IrInstruction* instruction, int vreg){
+    if(instruction->type != IR_TYPE_I64 || !induction->body[instruction->block->id]){
+        return 0;
+    }
+    if(instruction->opcode == IR_OP_MUL){
+        IrInstruction* factor = induction_constant_operand(induction, instruction->operands[0] == vreg ? instruction->operands[1] : instruction->operands[0]);
+        return factor ? factor->immediate : 0;
+    }
+    if(instruction->opcode == IR_OP_SHL && instruction->operands[0] == vreg){
+        IrInstruction* count = induction_constant_operand(induction, instruction->operands[1]);
+        return count && count->immediate > 0 && count->immediate < 63 ? 1LL << count->immediate : 0;
+    }
+    return 0;
+}
+
+static IrInstruction* induction_constant_operand(Induction* induction, int vreg){
+    IrInstruction* definition = vector_IrInstructionPtr_at(induction->function->definitions, vreg);
+    return definition && definition->opcode == IR_OP_CONST ? definition : NULL;
+}
+
+static bool is_induction_in_loop(Induction* induction, int vreg){
+    IrInstruction* definition = vector_IrInstructionPtr_at(induction->function->definitions, vreg);
+    return !definition || induction->body[definition->block->id];
+}
@@ -0,0 +1,327 @@
+/*
+* @file inliner.c
+* @brief Inlining of calls to functions of the same translation unit
+* @details Functions are visited callees first, so a callee has already had its own calls inlined when its body is copied. A call is replaced by a copy of the callee's SSA form: the block of the call is split, the parameters become the arguments, the callee's stack slots are appended to the caller's frame and its returns jump to the continuation, where a phi merges the returned values. Whether a call is inlined is decided by the size of the callee, see IR_INLINE_SMALL_SIZE and its neighbours. Calls to recursive functions and to functions calling the caller back are never inlined, so inlining always ends.
+*/
+
+#include "compiler.h"
+
+enum{
+    INLINER_VISITING = 1,
+    INLINER_VISITED
+};
+
+typedef struct Inliner{
+    HashTable* functions; //maps the name of every function to its IrFunction
+    HashTable* states; //maps the name of a function to INLINER_VISITING or INLINER_VISITED
+} Inliner;
+
+typedef struct InlinerCopy{
+    IrFunction* caller;
+    IrFunction* callee;
+    int* vregs; //indexed by callee register, the caller register it became, IR_VREG_NONE until used
+    IrBlock** blocks; //indexed by callee block id, its copy
+    int first_slot; //the caller slot the first callee slot became
+} InlinerCopy;
+
+void ir_inline_functions(DynamicVector* functions);
+
+static void inliner_visit(Inliner* inliner, IrFunction* function);
+
+static bool inliner_inline_calls(Inliner* inliner, IrFunction* caller);
+
+static bool is_inliner_candidate(IrFunction* caller, IrInstruction* call, IrFunction* callee);
+
+static int inliner_size(IrFunction* function);
+
+static bool is_inliner_calling(IrFunction* function, const char* name);
+
+static void inliner_inline_call(IrFunction* caller, IrInstruction* call, IrFunction* callee);
+
+static IrBlock* inliner_split_block(IrFunction* caller, IrBlock* block, int index);
+
+static void inliner_copy_instruction(InlinerCopy* copy, IrInstruction* instruction, IrBlock* block, IrBlock* continuation, DynamicVector* returns);
+
+static int inliner_copy_vreg(InlinerCopy* copy, int vreg);
+
+static void inliner_move_blocks_after(IrFunction* function, IrBlock* block, int first_new_block);
+
+
+
+void ir_inline_functions(DynamicVector* functions){
+    Inliner inliner = {};
+    inliner.functions = create_hash_table(get_element_count(functions));
+    inliner.states = create_hash_table(get_element_count(functions));
+    vector_for_each(IrFunction*, function, functions){
+        hash_table_put(inliner.functions, (*function)->name, *function);
+    }
+    vector_for_each(IrFunction*, function, functions){
+        inliner_visit(&inliner, *function);
+    }
+    destroy_hash_table(inliner.functions);
+    destroy_hash_table(inliner.states);
+}
+
+// Visits the callees before the function itself. The callees of a cycle are visited in the order the walk enters it, the recursion guard keeps them from being inlined into each other endlessly.
+static void inliner_visit(Inliner* inliner, IrFunction* function){
+    if(hash_table_contains(inliner->states, function->name)){
+        return;
+    }
+    hash_table_put(inliner->states, function->name, (void*)INLINER_VISITING);
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            IrFunction* callee = (*instruction)->opcode == IR_OP_CALL ? hash_table_get(inliner->functions, (*instruction)->symbol) : NULL;
+            if(callee){
+                inliner_visit(inliner, callee);
+            }
+        }
+    }
+    if(inliner_inline_calls(inliner, function)){
+        //the arguments of the copies are often constants, and the copies recompute what the caller already has
+        ir_compute_cfg(function);
+        ir_compute_dominators(function);
+        ir_compute_def_use(function);
+        ir_optimize_function(function);
+    }
+    hash_table_put(inliner->states, function->name, (void*)INLINER_VISITED);
+}
+
+// Inlines the calls the function made before inlining started, the calls in the copies were already considered in the callee.
+static bool inliner_inline_calls(Inliner* inliner, IrFunction* caller){
+    //decided up front, inlining invalidates the definitions the cost model looks at
+    DynamicVector* calls = create_vector(sizeof(IrInstruction*));
+    vector_for_each(IrBlock*, block, caller->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            IrFunction* callee = (*instruction)->opcode == IR_OP_CALL ? hash_table_get(inliner->functions, (*instruction)->symbol) : NULL;
+            if(callee && is_inliner_candidate(caller, *instruction, callee)){
+                vector_IrInstructionPtr_push(calls, *instruction);
+            }
+        }
+    }
+    int caller_size = inliner_size(caller);
+    bool is_changed = false;
+    vector_for_each(IrInstruction*, call, calls){
+        IrFunction* callee = hash_table_get(inliner->functions, (*call)->symbol);
+        int callee_size = inliner_size(callee);
+        if(caller_size + callee_size > IR_INLINE_CALLER_LIMIT){
+            continue;
+        }
+        caller_size += callee_size;
+        inliner_inline_call(caller, *call, callee);
+        is_changed = true;
+    }
+    destroy_vector(calls);
+    return is_changed;
+}
+
+// The cost of a call is the size of the callee less what the call itself and folding its constant arguments save.
+static bool is_inliner_candidate(IrFunction* caller, IrInstruction* call, IrFunction* callee){
+    if(callee == caller || call->flags & IR_INSTRUCTION_FLAG_VARIADIC_CALL || callee->function_node->flags & FUNCTION_NODE_FLAG_IS_VARIADIC){
+        return false;
+    }
+    //a static local belongs to the out of line copy, which may not be emitted
+    if(get_element_count(call->arguments) != callee->parameter_count || !is_vector_empty(callee->static_locals)){
+        return false;
+    }
+    if(is_inliner_calling(callee, callee->name) || is_inliner_calling(callee, caller->name)){
+        return false;
+    }
+    int cost = inliner_size(callee) - get_element_count(call->arguments) - 1;
+    IrBlock* entry = vector_IrBlockPtr_at(callee->blocks, 0);
+    vector_for_each(IrInstruction*, instruction, entry->instructions){
+        if((*instruction)->opcode != IR_OP_PARAM){
+            continue;
+        }
+        int argument = vector_Int_at(call->arguments, (*instruction)->immediate);
+        if(ir_get_vreg_type(caller, argument) != (*instruction)->type){
+            return false;
+        }
+        IrInstruction* definition = vector_IrInstructionPtr_at(caller->definitions, argument);
+        if(definition && definition->opcode == IR_OP_CONST){
+            cost -= IR_INLINE_CONSTANT_ARGUMENT_BONUS;
+        }
+    }
+    bool is_static = callee->function_node->data.function.return_type->flags & DATATYPE_FLAG_IS_STATIC;
+    return cost <= IR_INLINE_SMALL_SIZE || (is_static && cost <= IR_INLINE_STATIC_SIZE);
+}
+
+// The number of instructions that turn into machine code, phis and parameters don't.
+static int inliner_size(IrFunction* function){
+    int size = 0;
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode != IR_OP_PHI && (*instruction)->opcode != IR_OP_PARAM && !is_ir_rematerializable(*instruction)){
+                size++;
+            }
+        }
+    }
+    return size;
+}
+
+static bool is_inliner_calling(IrFunction* function, const char* name){
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode == IR_OP_CALL && ARE_STRINGS_EQUAL((*instruction)->symbol, name)){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Replaces the call by a jump to a copy of the callee whose returns jump to the rest of the block, the result of the call is defined there by a phi of the returned values.
+static void inliner_inline_call(IrFunction* caller, IrInstruction* call, IrFunction* callee){
+    IrBlock* block = call->block;
+    int index = 0;
+    while(vector_IrInstructionPtr_at(block->instructions, index) != call){
+        index++;
+    }
+    int first_new_block = get_element_count(caller->blocks);
+    InlinerCopy copy = {.caller = caller, .callee = callee};
+    copy.blocks = calloc(callee->next_block_id + 1, sizeof(IrBlock*));
+    vector_for_each(IrBlock*, callee_block, callee->blocks){
+        copy.blocks[(*callee_block)->id] = ir_new_block(caller);
+    }
+    IrBlock* continuation = inliner_split_block(caller, block, index + 1);
+    remove_last_element(block->instructions);
+
+    int callee_vreg_count = ir_get_vreg_count(callee);
+    copy.vregs = malloc((callee_vreg_count + 1) * sizeof(int));
+    for(int i = 0; i < callee_vreg_count; i++){
+        copy.vregs[i] = IR_VREG_NONE;
+    }
+    copy.first_slot = get_element_count(caller->slots);
+    vector_for_each(IrStackSlot, slot, callee->slots){
+        IrStackSlot caller_slot = *slot;
+        caller_slot.flags &= ~IR_STACK_SLOT_FLAG_IS_ARGUMENT;
+        push_element(caller->slots, &caller_slot);
+    }
+    vector_for_each(IrInstruction*, instruction, vector_IrBlockPtr_at(callee->blocks, 0)->instructions){
+        if((*instruction)->opcode == IR_OP_PARAM){
+            copy.vregs[(*instruction)->result] = vector_Int_at(call->arguments, (*instruction)->immediate);
+        }
+    }
+
+    DynamicVector* returns = create_vector(sizeof(IrPhiIncoming));
+    vector_for_each(IrBlock*, callee_block, callee->blocks){
+        vector_for_each(IrInstruction*, instruction, (*callee_block)->instructions){
+            inliner_copy_instruction(&copy, *instruction, copy.blocks[(*callee_block)->id], continuation, returns);
+        }
+    }
+    IrInstruction* jump = ir_new_instruction(IR_OP_JUMP, IR_TYPE_VOID, IR_VREG_NONE);
+    jump->targets[0] = copy.blocks[vector_IrBlockPtr_at(callee->blocks, 0)->id];
+    ir_append_instruction(block, jump);
+
+    if(call->result != IR_VREG_NONE){
+        //a callee that never returns leaves the continuation unreachable
+        IrInstruction* result = ir_new_instruction(is_vector_empty(returns) ? IR_OP_UNDEF : IR_OP_PHI, call->type, call->result);
+        vector_for_each(IrPhiIncoming, incoming, returns){
+            push_element(result->arguments, incoming);
+        }
+        ir_insert_instruction(continuation, 0, result);
+    }
+    inliner_move_blocks_after(caller, block, first_new_block);
+    destroy_vector(returns);
+    free(copy.vregs);
+    free(copy.blocks);
+    ir_free_instruction(call);
+}
+
+// Moves the instructions from index on to a new block, the successors' phis now see control come from it.
+static IrBlock* inliner_split_block(IrFunction* caller, IrBlock* block, int index){
+    IrBlock* continuation = ir_new_block(caller);
+    while(get_element_count(block->instructions) > index){
+        IrInstruction* instruction = vector_IrInstructionPtr_at(block->instructions, index);
+        remove_element_at(block->instructions, index);
+        ir_append_instruction(continuation, instruction);
+    }
+    IrInstruction* terminator = ir_get_terminator(continuation);
+    for(int i = 0; terminator && i < 2; i++){
+        if(!terminator->targets[i]){
+            continue;
+        }
+        vector_for_each(IrInstruction*, phi, terminator->targets[i]->instructions){
+            if((*phi)->opcode != IR_OP_PHI){
+                break;
+            }
+            vector_for_each(IrPhiIncoming, incoming, (*phi)->arguments){
+                if(incoming->block == block){
+                    incoming->block = continuation;
+                }
+            }
+        }
+        if(terminator->targets[1] == terminator->targets[0]){
+            break;
+        }
+    }
+    return continuation;
+}
+
+// Copies a callee instruction into the caller with its registers, blocks and slots renamed. Parameters are already mapped to the arguments and a return becomes a jump to the continuation.
+static void inliner_copy_instruction(InlinerCopy* copy, IrInstruction* instruction, IrBlock* block, IrBlock* continuation, DynamicVector* returns){
+    if(instruction->opcode == IR_OP_PARAM){
+        return;
+    }
+    if(instruction->opcode == IR_OP_RETURN){
+        if(instruction->operands[0] != IR_VREG_NONE){
+            IrPhiIncoming incoming = {.block = block, .vreg = inliner_copy_vreg(copy, instruction->operands[0])};
+            push_element(returns, &incoming);
+        }
+        IrInstruction* jump = ir_new_instruction(IR_OP_JUMP, IR_TYPE_VOID, IR_VREG_NONE);
+        jump->targets[0] = continuation;
+        ir_append_instruction(block, jump);
+        return;
+    }
+    int result = instruction->result == IR_VREG_NONE ? IR_VREG_NONE : inliner_copy_vreg(copy, instruction->result);
+    IrInstruction* copied = ir_new_instruction(instruction->opcode, instruction->type, result);
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        copied->operands[i] = instruction->operands[i] == IR_VREG_NONE ? IR_VREG_NONE : inliner_copy_vreg(copy, instruction->operands[i]);
+    }
+    copied->immediate = instruction->immediate;
+    copied->condition = instruction->condition;
+    copied->flags = instruction->flags;
+    copied->symbol = instruction->symbol;
+    copied->slot = instruction->opcode == IR_OP_SLOT_ADDRESS ? copy->first_slot + instruction->slot : instruction->slot;
+    for(int i = 0; i < 2; i++){
+        copied->targets[i] = instruction->targets[i] ? copy->blocks[instruction->targets[i]->id] : NULL;
+    }
+    if(instruction->opcode == IR_OP_PHI){
+        vector_for_each(IrPhiIncoming, incoming, instruction->arguments){
+            IrPhiIncoming copied_incoming = {.block = copy->blocks[incoming->block->id], .vreg = inliner_copy_vreg(copy, incoming->vreg)};
+            push_element(copied->arguments, &copied_incoming);
+        }
+    }
+    else if(instruction->opcode == IR_OP_CALL){
+        vector_for_each(int, argument, instruction->arguments){
+            vector_Int_push(copied->arguments, inliner_copy_vreg(copy, *argument));
+        }
+    }
+    ir_append_instruction(block, copied);
+}
+
+static int inliner_copy_vreg(InlinerCopy* copy, int vreg){
+    if(copy->vregs[vreg] == IR_VREG_NONE){
+        copy->vregs[vreg] = ir_new_vreg(copy->caller, ir_get_vreg_type(copy->callee, vreg));
+    }
+    return copy->vregs[vreg];
+}
+
+// ir_new_block appends, the copies and the continuation belong right behind the block of the call so the layout keeps them together.
+static void inliner_move_blocks_after(IrFunction* function, IrBlock* block, int first_new_block){
+    DynamicVector* blocks = create_vector(sizeof(IrBlock*));
+    int block_count = get_element_count(function->blocks);
+    for(int i = 0; i < first_new_block; i++){
+        vector_IrBlockPtr_push(blocks, vector_IrBlockPtr_at(function->blocks, i));
+        if(vector_IrBlockPtr_at(function->blocks, i) != block){
+            continue;
+        }
+        for(int j = first_new_block; j < block_count; j++){
+            vector_IrBlockPtr_push(blocks, vector_IrBlockPtr_at(function->blocks, j));
+        }
+    }
+    clear_vector(function->blocks);
+    vector_for_each(IrBlock*, moved, blocks){
+        vector_IrBlockPtr_push(function->blocks, *moved);
+    }
+    destroy_vector(blocks);
+}
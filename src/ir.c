@@ -0,0 +1,932 @@
+/*
+* @file ir.c
+* @brief The intermediate representation
+* @details Construction helpers, control flow and dominator analysis, the def-use maps, the verifier and the textual dump of IrFunction. Lowering from the AST lives in irBuilder.c and the SSA conversions in ssa.c.
+*/
+
+#include "compiler.h"
+#include <assert.h>
+#include <stdarg.h>
+#include <limits.h>
+
+IrBlock* ir_new_block(IrFunction* function);
+
+int ir_new_vreg(IrFunction* function, int type);
+
+int ir_get_vreg_type(IrFunction* function, int vreg);
+
+int ir_get_vreg_count(IrFunction* function);
+
+IrInstruction* ir_new_instruction(int opcode, int type, int result);
+
+void ir_append_instruction(IrBlock* block, IrInstruction* instruction);
+
+void ir_insert_instruction(IrBlock* block, int index, IrInstruction* instruction);
+
+void ir_free_instruction(IrInstruction* instruction);
+
+IrInstruction* ir_get_terminator(IrBlock* block);
+
+bool is_ir_terminator(IrInstruction* instruction);
+
+bool is_ir_rematerializable(IrInstruction* instruction);
+
+int ir_type_size(int type);
+
+int ir_type_for_size(size_t size);
+
+long long ir_truncate_constant(int type, long long value);
+
+bool ir_fold_instruction(IrFunction* function, IrInstruction* instruction, long long left, long long right, long long* value_out);
+
+void ir_make_constant(IrInstruction* instruction, long long value);
+
+void ir_compute_cfg(IrFunction* function);
+
+void ir_remove_unreachable_blocks(IrFunction* function);
+
+void ir_compute_dominators(IrFunction* function);
+
+bool ir_block_dominates(IrBlock* dominator, IrBlock* block);
+
+void ir_compute_def_use(IrFunction* function);
+
+void ir_replace_vreg_uses(IrFunction* function, int vreg, int replacement);
+
+void ir_free_function(IrFunction* function);
+
+void ir_optimize_function(IrFunction* function);
+
+void ir_verify_function(CompileProcess* process, IrFunction* function);
+
+void ir_dump_function(IrFunction* function, FILE* file);
+
+static unsigned long long ir_unsigned_constant(int type, long long value);
+
+static bool ir_compare_constants(int condition, int type, long long left, long long right);
+
+static void ir_postorder_visit(IrBlock* block, bool* visited, DynamicVector* postorder);
+
+static IrBlock* ir_intersect_dominators(IrBlock* first, IrBlock* second);
+
+static void ir_number_dominator_tree(IrFunction* function);
+
+static void ir_free_block(IrBlock* block);
+
+static void ir_clear_def_use(IrFunction* function);
+
+static void ir_verify_error(CompileProcess* process, IrFunction* function, IrBlock* block, const char* message, ...);
+
+static void ir_verify_use(CompileProcess* process, IrFunction* function, IrInstruction* instruction, int vreg, IrBlock* use_block, int use_index);
+
+static void ir_verify_types(CompileProcess* process, IrFunction* function, IrInstruction* instruction);
+
+static int ir_instruction_index(IrInstruction* instruction);
+
+static void ir_dump_instruction(IrInstruction* instruction, FILE* file);
+
+static const char* ir_type_name(int type);
+
+static const char* ir_opcode_name(int opcode);
+
+static const char* ir_condition_name(int condition);
+
+
+
+IrBlock* ir_new_block(IrFunction* function){
+    IrBlock* block = calloc(1, sizeof(IrBlock));
+    block->id = function->next_block_id++;
+    block->instructions = create_vector(sizeof(IrInstruction*));
+    block->predecessors = create_vector(sizeof(IrBlock*));
+    block->successors = create_vector(sizeof(IrBlock*));
+    block->dominated = create_vector(sizeof(IrBlock*));
+    block->dominance_frontier = create_vector(sizeof(IrBlock*));
+    vector_IrBlockPtr_push(function->blocks, block);
+    return block;
+}
+
+int ir_new_vreg(IrFunction* function, int type){
+    vector_Int_push(function->vreg_types, type);
+    return get_element_count(function->vreg_types) - 1;
+}
+
+int ir_get_vreg_type(IrFunction* function, int vreg){
+    return vector_Int_at(function->vreg_types, vreg);
+}
+
+int ir_get_vreg_count(IrFunction* function){
+    return get_element_count(function->vreg_types);
+}
+
+IrInstruction* ir_new_instruction(int opcode, int type, int result){
+    IrInstruction* instruction = calloc(1, sizeof(IrInstruction));
+    instruction->opcode = opcode;
+    instruction->type = type;
+    instruction->result = result;
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        instruction->operands[i] = IR_VREG_NONE;
+    }
+    instruction->slot = -1;
+    if(opcode == IR_OP_PHI){
+        instruction->arguments = create_vector(sizeof(IrPhiIncoming));
+    }
+    else if(opcode == IR_OP_CALL){
+        instruction->arguments = create_vector(sizeof(int));
+    }
+    return instruction;
+}
+
+void ir_append_instruction(IrBlock* block, IrInstruction* instruction){
+    instruction->block = block;
+    vector_IrInstructionPtr_push(block->instructions, instruction);
+}
+
+void ir_insert_instruction(IrBlock* block, int index, IrInstruction* instruction){
+    instruction->block = block;
+    insert_element_at(block->instructions, index, &instruction);
+}
+
+void ir_free_instruction(IrInstruction* instruction){
+    if(instruction->arguments){
+        destroy_vector(instruction->arguments);
+    }
+    free(instruction);
+}
+
+IrInstruction* ir_get_terminator(IrBlock* block){
+    IrInstruction* last = vector_IrInstructionPtr_last_or(block->instructions, NULL);
+    return last && is_ir_terminator(last) ? last : NULL;
+}
+
+bool is_ir_terminator(IrInstruction* instruction){
+    return instruction->opcode == IR_OP_JUMP || instruction->opcode == IR_OP_BRANCH || instruction->opcode == IR_OP_RETURN;
+}
+
+bool is_ir_rematerializable(IrInstruction* instruction){
+    return instruction->opcode == IR_OP_CONST || instruction->opcode == IR_OP_SLOT_ADDRESS || instruction->opcode == IR_OP_GLOBAL_ADDRESS || instruction->opcode == IR_OP_UNDEF;
+}
+
+int ir_type_size(int type){
+    switch(type){
+        case IR_TYPE_I8:
+            return 1;
+        case IR_TYPE_I16:
+            return 2;
+        case IR_TYPE_I32:
+            return 4;
+        case IR_TYPE_I64:
+            return 8;
+    }
+    return 0;
+}
+
+int ir_type_for_size(size_t size){
+    switch(size){
+        case 1:
+            return IR_TYPE_I8;
+        case 2:
+            return IR_TYPE_I16;
+        case 4:
+            return IR_TYPE_I32;
+        case 8:
+            return IR_TYPE_I64;
+    }
+    return IR_TYPE_VOID;
+}
+
+long long ir_truncate_constant(int type, long long value){
+    switch(type){
+        case IR_TYPE_I8:
+            return (signed char)value;
+        case IR_TYPE_I16:
+            return (short)value;
+        case IR_TYPE_I32:
+            return (int)value;
+    }
+    return value;
+}
+
+bool ir_fold_instruction(IrFunction* function, IrInstruction* instruction, long long left, long long right, long long* value_out){
+    int type = instruction->type;
+    //x86 masks shift counts to 5 bits below 64 bit operands
+    int shift_mask = type == IR_TYPE_I64 ? 63 : 31;
+    long long value = 0;
+    switch(instruction->opcode){
+        case IR_OP_CONST:
+            value = instruction->immediate;
+            break;
+        case IR_OP_COPY:
+        case IR_OP_SEXT:
+        case IR_OP_TRUNC:
+            //constants are kept sign extended, so extending them is a no-op
+            value = left;
+            break;
+        case IR_OP_ZEXT:
+            value = ir_unsigned_constant(ir_get_vreg_type(function, instruction->operands[0]), left);
+            break;
+        case IR_OP_ADD:
+            value = (unsigned long long)left + (unsigned long long)right;
+            break;
+        case IR_OP_SUB:
+            value = (unsigned long long)left - (unsigned long long)right;
+            break;
+        case IR_OP_MUL:
+            value = (unsigned long long)left * (unsigned long long)right;
+            break;
+        case IR_OP_SDIV:
+        case IR_OP_SREM:
+            //these trap at run time, which folding must not hide
+            if(right == 0 || (right == -1 && left == ir_truncate_constant(type, 1ULL << (ir_type_size(type) * 8 - 1)))){
+                return false;
+            }
+            value = instruction->opcode == IR_OP_SDIV ? left / right : left % right;
+            break;
+        case IR_OP_UDIV:
+        case IR_OP_UREM:
+            if(ir_unsigned_constant(type, right) == 0){
+                return false;
+            }
+            value = instruction->opcode == IR_OP_UDIV ? ir_unsigned_constant(type, left) / ir_unsigned_constant(type, right) : ir_unsigned_constant(type, left) % ir_unsigned_constant(type, right);
+            break;
+        case IR_OP_AND:
+            value = left & right;
+            break;
+        case IR_OP_OR:
+            value = left | right;
+            break;
+        case IR_OP_XOR:
+            value = left ^ right;
+            break;
+        case IR_OP_SHL:
+            value = (unsigned long long)left << (right & shift_mask);
+            break;
+        case IR_OP_SAR:
+        case IR_OP_SHR:
+            //narrower shifts are done 32 bits wide on registers whose upper bits are unspecified
+            if(ir_type_size(type) < 4){
+                return false;
+            }
+            value = instruction->opcode == IR_OP_SAR ? left >> (right & shift_mask) : (long long)(ir_unsigned_constant(type, left) >> (right & shift_mask));
+            break;
+        case IR_OP_NEG:
+            value = 0ULL - (unsigned long long)left;
+            break;
+        case IR_OP_NOT:
+            value = ~left;
+            break;
+        case IR_OP_CMP:
+            value = ir_compare_constants(instruction->condition, ir_get_vreg_type(function, instruction->operands[0]), left, right);
+            break;
+        default:
+            return false;
+    }
+    *value_out = ir_truncate_constant(type, value);
+    return true;
+}
+
+void ir_make_constant(IrInstruction* instruction, long long value){
+    assert(instruction->result != IR_VREG_NONE && instruction->opcode != IR_OP_CALL);
+    if(instruction->arguments){
+        destroy_vector(instruction->arguments);
+        instruction->arguments = NULL;
+    }
+    instruction->opcode = IR_OP_CONST;
+    instruction->immediate = ir_truncate_constant(instruction->type, value);
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        instruction->operands[i] = IR_VREG_NONE;
+    }
+}
+
+// The bits of a constant of the type read as an unsigned number.
+static unsigned long long ir_unsigned_constant(int type, long long value){
+    int size = ir_type_size(type);
+    return size >= 8 ? (unsigned long long)value : (unsigned long long)value & ((1ULL << (size * 8)) - 1);
+}
+
+static bool ir_compare_constants(int condition, int type, long long left, long long right){
+    unsigned long long unsigned_left = ir_unsigned_constant(type, left);
+    unsigned long long unsigned_right = ir_unsigned_constant(type, right);
+    switch(condition){
+        case IR_CONDITION_EQ:
+            return left == right;
+        case IR_CONDITION_NE:
+            return left != right;
+        case IR_CONDITION_SLT:
+            return left < right;
+        case IR_CONDITION_SLE:
+            return left <= right;
+        case IR_CONDITION_SGT:
+            return left > right;
+        case IR_CONDITION_SGE:
+            return left >= right;
+        case IR_CONDITION_ULT:
+            return unsigned_left < unsigned_right;
+        case IR_CONDITION_ULE:
+            return unsigned_left <= unsigned_right;
+        case IR_CONDITION_UGT:
+            return unsigned_left > unsigned_right;
+        case IR_CONDITION_UGE:
+            return unsigned_left >= unsigned_right;
+    }
+    return false;
+}
+
+void ir_compute_cfg(IrFunction* function){
+    vector_for_each(IrBlock*, block, function->blocks){
+        clear_vector((*block)->predecessors);
+        clear_vector((*block)->successors);
+    }
+    vector_for_each(IrBlock*, block, function->blocks){
+        IrInstruction* terminator = ir_get_terminator(*block);
+        if(!terminator || terminator->opcode == IR_OP_RETURN){
+            continue;
+        }
+        int target_count = terminator->opcode == IR_OP_BRANCH ? 2 : 1;
+        for(int i = 0; i < target_count; i++){
+            IrBlock* target = terminator->targets[i];
+            //a branch with both targets equal is still one edge, a phi has one incoming for it
+            if(i == 1 && target == terminator->targets[0]){
+                continue;
+            }
+            vector_IrBlockPtr_push((*block)->successors, target);
+            vector_IrBlockPtr_push(target->predecessors, *block);
+        }
+    }
+    int block_count = function->next_block_id;
+    bool* visited = calloc(block_count, sizeof(bool));
+    DynamicVector* postorder = create_vector(sizeof(IrBlock*));
+    ir_postorder_visit(vector_IrBlockPtr_at(function->blocks, 0), visited, postorder);
+    clear_vector(function->reverse_postorder);
+    for(int i = get_element_count(postorder) - 1; i >= 0; i--){
+        IrBlock* block = vector_IrBlockPtr_at(postorder, i);
+        block->order = get_element_count(function->reverse_postorder);
+        vector_IrBlockPtr_push(function->reverse_postorder, block);
+    }
+    vector_for_each(IrBlock*, block, function->blocks){
+        if(!visited[(*block)->id]){
+            (*block)->order = -1;
+        }
+    }
+    destroy_vector(postorder);
+    free(visited);
+}
+
+// Depth first walk over the successors, recursion depth is bounded by the longest acyclic path of the function.
+static void ir_postorder_visit(IrBlock* block, bool* visited, DynamicVector* postorder){
+    visited[block->id] = true;
+    vector_for_each(IrBlock*, successor, block->successors){
+        if(!visited[(*successor)->id]){
+            ir_postorder_visit(*successor, visited, postorder);
+        }
+    }
+    vector_IrBlockPtr_push(postorder, block);
+}
+
+void ir_remove_unreachable_blocks(IrFunction* function){
+    ir_compute_cfg(function);
+    if(get_element_count(function->reverse_postorder) == get_element_count(function->blocks)){
+        return;
+    }
+    DynamicVector* reachable = create_vector(sizeof(IrBlock*));
+    vector_for_each(IrBlock*, block, function->blocks){
+        if((*block)->order >= 0){
+            vector_IrBlockPtr_push(reachable, *block);
+            continue;
+        }
+        //the phis of the successors lose the incoming of this block
+        vector_for_each(IrBlock*, successor, (*block)->successors){
+            vector_for_each(IrInstruction*, instruction, (*successor)->instructions){
+                if((*instruction)->opcode != IR_OP_PHI){
+                    break;
+                }
+                DynamicVector* incomings = (*instruction)->arguments;
+                for(int i = get_element_count(incomings) - 1; i >= 0; i--){
+                    if(((IrPhiIncoming*)get_element_at(incomings, i))->block == *block){
+                        remove_element_at(incomings, i);
+                    }
+                }
+            }
+        }
+    }
+    vector_for_each(IrBlock*, block, function->blocks){
+        if((*block)->order < 0){
+            ir_free_block(*block);
+        }
+    }
+    destroy_vector(function->blocks);
+    function->blocks = reachable;
+    ir_compute_cfg(function);
+}
+
+void ir_compute_dominators(IrFunction* function){
+    DynamicVector* order = function->reverse_postorder;
+    vector_for_each(IrBlock*, block, function->blocks){
+        (*block)->immediate_dominator = NULL;
+        clear_vector((*block)->dominated);
+        clear_vector((*block)->dominance_frontier);
+    }
+    IrBlock* entry = vector_IrBlockPtr_at(order, 0);
+    entry->immediate_dominator = entry;
+    bool changed = true;
+    while(changed){
+        changed = false;
+        vector_for_each_from(IrBlock*, block, order, 1){
+            IrBlock* new_dominator = NULL;
+            vector_for_each(IrBlock*, predecessor, (*block)->predecessors){
+                if(!(*predecessor)->immediate_dominator){
+                    continue;
+                }
+                new_dominator = new_dominator ? ir_intersect_dominators(*predecessor, new_dominator) : *predecessor;
+            }
+            if(new_dominator != (*block)->immediate_dominator){
+                (*block)->immediate_dominator = new_dominator;
+                changed = true;
+            }
+        }
+    }
+    entry->immediate_dominator = NULL;
+    vector_for_each_from(IrBlock*, block, order, 1){
+        vector_IrBlockPtr_push((*block)->immediate_dominator->dominated, *block);
+    }
+    ir_number_dominator_tree(function);
+    //a join point is in the frontier of every block between its predecessors and its immediate dominator
+    vector_for_each(IrBlock*, block, order){
+        if(get_element_count((*block)->predecessors) < 2){
+            continue;
+        }
+        vector_for_each(IrBlock*, predecessor, (*block)->predecessors){
+            IrBlock* runner = *predecessor;
+            while(runner && runner != (*block)->immediate_dominator){
+                if(vector_IrBlockPtr_last_or(runner->dominance_frontier, NULL) != *block){
+                    vector_IrBlockPtr_push(runner->dominance_frontier, *block);
+                }
+                runner = runner->immediate_dominator;
+            }
+        }
+    }
+}
+
+// Walks both blocks up the partially built dominator tree until they meet, order is the reverse postorder number.
+static IrBlock* ir_intersect_dominators(IrBlock* first, IrBlock* second){
+    while(first != second){
+        while(first->order > second->order){
+            first = first->immediate_dominator;
+        }
+        while(second->order > first->order){
+            second = second->immediate_dominator;
+        }
+    }
+    return first;
+}
+
+// Numbers the dominator tree in preorder, the blocks a block dominates are the ones numbered from its own number up to its last_dominated_number.
+static void ir_number_dominator_tree(IrFunction* function){
+    vector_for_each(IrBlock*, block, function->blocks){
+        (*block)->dominator_tree_number = -1;
+        (*block)->last_dominated_number = -1;
+    }
+    DynamicVector* preorder = create_vector(sizeof(IrBlock*));
+    DynamicVector* stack = create_vector(sizeof(IrBlock*));
+    vector_IrBlockPtr_push(stack, vector_IrBlockPtr_at(function->reverse_postorder, 0));
+    while(!is_vector_empty(stack)){
+        IrBlock* block = vector_IrBlockPtr_pop(stack);
+        block->dominator_tree_number = get_element_count(preorder);
+        vector_IrBlockPtr_push(preorder, block);
+        vector_for_each(IrBlock*, child, block->dominated){
+            vector_IrBlockPtr_push(stack, *child);
+        }
+    }
+    for(int i = get_element_count(preorder) - 1; i >= 0; i--){
+        IrBlock* block = vector_IrBlockPtr_at(preorder, i);
+        block->last_dominated_number = block->dominator_tree_number;
+        vector_for_each(IrBlock*, child, block->dominated){
+            if((*child)->last_dominated_number > block->last_dominated_number){
+                block->last_dominated_number = (*child)->last_dominated_number;
+            }
+        }
+    }
+    destroy_vector(stack);
+    destroy_vector(preorder);
+}
+
+bool ir_block_dominates(IrBlock* dominator, IrBlock* block){
+    if(dominator == block){
+        return true;
+    }
+    if(dominator->dominator_tree_number < 0 || block->dominator_tree_number < 0){
+        return false;
+    }
+    return dominator->dominator_tree_number <= block->dominator_tree_number && block->dominator_tree_number <= dominator->last_dominated_number;
+}
+
+void ir_compute_def_use(IrFunction* function){
+    ir_clear_def_use(function);
+    int vreg_count = ir_get_vreg_count(function);
+    function->definitions = create_vector(sizeof(IrInstruction*));
+    function->uses = create_vector(sizeof(DynamicVector*));
+    for(int i = 0; i < vreg_count; i++){
+        vector_IrInstructionPtr_push(function->definitions, NULL);
+        vector_VoidPtr_push(function->uses, NULL);
+    }
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction_pointer, (*block)->instructions){
+            IrInstruction* instruction = *instruction_pointer;
+            if(instruction->result != IR_VREG_NONE){
+                *vector_IrInstructionPtr_at_pointer(function->definitions, instruction->result) = instruction;
+            }
+            int used[IR_MAX_OPERANDS + 1];
+            int used_count = 0;
+            for(int i = 0; i < IR_MAX_OPERANDS; i++){
+                if(instruction->operands[i] != IR_VREG_NONE){
+                    used[used_count++] = instruction->operands[i];
+                }
+            }
+            for(int i = 0; i < used_count + (instruction->arguments ? get_element_count(instruction->arguments) : 0); i++){
+                int vreg = 0;
+                if(i < used_count){
+                    vreg = used[i];
+                }
+                else if(instruction->opcode == IR_OP_PHI){
+                    vreg = ((IrPhiIncoming*)get_element_at(instruction->arguments, i - used_count))->vreg;
+                }
+                else{
+                    vreg = vector_Int_at(instruction->arguments, i - used_count);
+                }
+                DynamicVector** users = (DynamicVector**)vector_VoidPtr_at_pointer(function->uses, vreg);
+                if(!*users){
+                    *users = create_vector(sizeof(IrInstruction*));
+                }
+                //an instruction reading a register twice is listed once
+                if(vector_IrInstructionPtr_last_or(*users, NULL) != instruction){
+                    vector_IrInstructionPtr_push(*users, instruction);
+                }
+            }
+        }
+    }
+}
+
+static void ir_clear_def_use(IrFunction* function){
+    if(function->uses){
+        vector_for_each(DynamicVector*, users, function->uses){
+            if(*users){
+                destroy_vector(*users);
+            }
+        }
+        destroy_vector(function->uses);
+        function->uses = NULL;
+    }
+    if(function->definitions){
+        destroy_vector(function->definitions);
+        function->definitions = NULL;
+    }
+}
+
+void ir_replace_vreg_uses(IrFunction* function, int vreg, int replacement){
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction_pointer, (*block)->instructions){
+            IrInstruction* instruction = *instruction_pointer;
+            for(int i = 0; i < IR_MAX_OPERANDS; i++){
+                if(instruction->operands[i] == vreg){
+                    instruction->operands[i] = replacement;
+                }
+            }
+            if(instruction->opcode == IR_OP_PHI){
+                vector_for_each(IrPhiIncoming, incoming, instruction->arguments){
+                    if(incoming->vreg == vreg){
+                        incoming->vreg = replacement;
+                    }
+                }
+            }
+            else if(instruction->opcode == IR_OP_CALL){
+                vector_for_each(int, argument, instruction->arguments){
+                    if(*argument == vreg){
+                        *argument = replacement;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void ir_free_block(IrBlock* block){
+    vector_for_each(IrInstruction*, instruction, block->instructions){
+        ir_free_instruction(*instruction);
+    }
+    destroy_vector(block->instructions);
+    destroy_vector(block->predecessors);
+    destroy_vector(block->successors);
+    destroy_vector(block->dominated);
+    destroy_vector(block->dominance_frontier);
+    free(block);
+}
+
+void ir_free_function(IrFunction* function){
+    vector_for_each(IrBlock*, block, function->blocks){
+        ir_free_block(*block);
+    }
+    ir_clear_def_use(function);
+    destroy_vector(function->blocks);
+    destroy_vector(function->reverse_postorder);
+    destroy_vector(function->vreg_types);
+    destroy_vector(function->slots);
+    destroy_vector(function->static_locals);
+    free(function);
+}
+
+void ir_optimize_function(IrFunction* function){
+    ir_propagate_constants(function);
+    ir_reduce_strength(function);
+    ir_number_values(function);
+    ir_hoist_loop_invariants(function);
+    ir_reduce_induction_variables(function);
+    ir_eliminate_dead_code(function);
+}
+
+void ir_verify_function(CompileProcess* process, IrFunction* function){
+    ir_compute_cfg(function);
+    if(get_element_count(function->reverse_postorder) != get_element_count(function->blocks)){
+        ir_verify_error(process, function, NULL, "unreachable blocks were left in the function");
+    }
+    ir_compute_dominators(function);
+    ir_compute_def_use(function);
+    int vreg_count = ir_get_vreg_count(function);
+    int* definition_counts = calloc(vreg_count, sizeof(int));
+    vector_for_each(IrBlock*, block_pointer, function->blocks){
+        IrBlock* block = *block_pointer;
+        int instruction_count = get_element_count(block->instructions);
+        if(!ir_get_terminator(block)){
+            ir_verify_error(process, function, block, "the block does not end with a terminator");
+        }
+        bool phis_allowed = true;
+        for(int i = 0; i < instruction_count; i++){
+            IrInstruction* instruction = vector_IrInstructionPtr_at(block->instructions, i);
+            if(instruction->block != block){
+                ir_verify_error(process, function, block, "instruction %i does not point back to its block", i);
+            }
+            if(is_ir_terminator(instruction) && i != instruction_count - 1){
+                ir_verify_error(process, function, block, "a terminator is followed by more instructions");
+            }
+            if(instruction->opcode == IR_OP_PHI){
+                if(!phis_allowed){
+                    ir_verify_error(process, function, block, "a phi follows a non-phi instruction");
+                }
+                if(get_element_count(instruction->arguments) != get_element_count(block->predecessors)){
+                    ir_verify_error(process, function, block, "the phi of %%%i has %i incomings for %i predecessors", instruction->result, get_element_count(instruction->arguments), get_element_count(block->predecessors));
+                }
+                vector_for_each(IrBlock*, predecessor, block->predecessors){
+                    int found = 0;
+                    vector_for_each(IrPhiIncoming, incoming, instruction->arguments){
+                        found += incoming->block == *predecessor;
+                    }
+                    if(found != 1){
+                        ir_verify_error(process, function, block, "the phi of %%%i has %i incomings for predecessor block%i", instruction->result, found, (*predecessor)->id);
+                    }
+                }
+            }
+            else{
+                phis_allowed = false;
+            }
+            if(instruction->result != IR_VREG_NONE){
+                if(instruction->result < 0 || instruction->result >= vreg_count){
+                    ir_verify_error(process, function, block, "register %%%i does not exist", instruction->result);
+                }
+                if(++definition_counts[instruction->result] > 1){
+                    ir_verify_error(process, function, block, "register %%%i is defined more than once", instruction->result);
+                }
+                if(ir_get_vreg_type(function, instruction->result) != instruction->type){
+                    ir_verify_error(process, function, block, "register %%%i is defined with a different type than it was created with", instruction->result);
+                }
+            }
+            for(int j = 0; j < IR_MAX_OPERANDS; j++){
+                if(instruction->operands[j] != IR_VREG_NONE){
+                    ir_verify_use(process, function, instruction, instruction->operands[j], block, i);
+                }
+            }
+            if(instruction->opcode == IR_OP_CALL){
+                vector_for_each(int, argument, instruction->arguments){
+                    ir_verify_use(process, function, instruction, *argument, block, i);
+                }
+            }
+            else if(instruction->opcode == IR_OP_PHI){
+                //the incoming value has to be available at the end of the predecessor
+                vector_for_each(IrPhiIncoming, incoming, instruction->arguments){
+                    ir_verify_use(process, function, instruction, incoming->vreg, incoming->block, INT_MAX);
+                }
+            }
+            ir_verify_types(process, function, instruction);
+        }
+    }
+    free(definition_counts);
+}
+
+// Raises the error, prefixed with the function and block it was found in.
+static void ir_verify_error(CompileProcess* process, IrFunction* function, IrBlock* block, const char* message, ...){
+    char details[256];
+    va_list arguments;
+    va_start(arguments, message);
+    vsnprintf(details, sizeof(details), message, arguments);
+    va_end(arguments);
+    if(block){
+        compiler_error(process, "BUG: invalid IR in function %s, block%i: %s", function->name, block->id, details);
+    }
+    compiler_error(process, "BUG: invalid IR in function %s: %s", function->name, details);
+}
+
+// A use at use_index of use_block has to be dominated by the single definition of the register.
+static void ir_verify_use(CompileProcess* process, IrFunction* function, IrInstruction* instruction, int vreg, IrBlock* use_block, int use_index){
+    if(vreg < 0 || vreg >= ir_get_vreg_count(function)){
+        ir_verify_error(process, function, instruction->block, "register %%%i does not exist", vreg);
+    }
+    IrInstruction* definition = vector_IrInstructionPtr_at(function->definitions, vreg);
+    if(!definition){
+        ir_verify_error(process, function, instruction->block, "register %%%i is used but never defined", vreg);
+    }
+    if(definition->block == use_block){
+        if(ir_instruction_index(definition) >= use_index){
+            ir_verify_error(process, function, instruction->block, "register %%%i is used before it is defined", vreg);
+        }
+        return;
+    }
+    if(!ir_block_dominates(definition->block, use_block)){
+        ir_verify_error(process, function, instruction->block, "the definition of %%%i in block%i does not dominate its use in block%i", vreg, definition->block->id, use_block->id);
+    }
+}
+
+static void ir_verify_types(CompileProcess* process, IrFunction* function, IrInstruction* instruction){
+    int operand_types[IR_MAX_OPERANDS];
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        operand_types[i] = instruction->operands[i] != IR_VREG_NONE ? ir_get_vreg_type(function, instruction->operands[i]) : IR_TYPE_VOID;
+    }
+    bool is_valid = true;
+    switch(instruction->opcode){
+        case IR_OP_LOAD:
+        case IR_OP_STORE:
+            is_valid = operand_types[0] == IR_TYPE_I64 && (instruction->opcode == IR_OP_LOAD || operand_types[1] == instruction->type);
+            break;
+        case IR_OP_MEMCOPY:
+            is_valid = operand_types[0] == IR_TYPE_I64 && operand_types[1] == IR_TYPE_I64;
+            break;
+        case IR_OP_COPY:
+        case IR_OP_NEG:
+        case IR_OP_NOT:
+            is_valid = operand_types[0] == instruction->type;
+            break;
+        case IR_OP_ADD:
+        case IR_OP_SUB:
+        case IR_OP_MUL:
+        case IR_OP_SDIV:
+        case IR_OP_UDIV:
+        case IR_OP_SREM:
+        case IR_OP_UREM:
+        case IR_OP_AND:
+        case IR_OP_OR:
+        case IR_OP_XOR:
+        case IR_OP_SHL:
+        case IR_OP_SAR:
+        case IR_OP_SHR:
+            is_valid = operand_types[0] == instruction->type && operand_types[1] == instruction->type;
+            break;
+        case IR_OP_CMP:
+            is_valid = operand_types[0] != IR_TYPE_VOID && operand_types[0] == operand_types[1] && instruction->type == IR_TYPE_I32;
+            break;
+        case IR_OP_SEXT:
+        case IR_OP_ZEXT:
+            is_valid = ir_type_size(operand_types[0]) < ir_type_size(instruction->type);
+            break;
+        case IR_OP_TRUNC:
+            is_valid = ir_type_size(operand_types[0]) > ir_type_size(instruction->type);
+            break;
+        case IR_OP_BRANCH:
+            is_valid = operand_types[0] != IR_TYPE_VOID;
+            break;
+        case IR_OP_PHI:
+            vector_for_each(IrPhiIncoming, incoming, instruction->arguments){
+                is_valid = is_valid && ir_get_vreg_type(function, incoming->vreg) == instruction->type;
+            }
+            break;
+    }
+    if(!is_valid){
+        ir_verify_error(process, function, instruction->block, "the operand types of %s don't match", ir_opcode_name(instruction->opcode));
+    }
+}
+
+static int ir_instruction_index(IrInstruction* instruction){
+    DynamicVector* instructions = instruction->block->instructions;
+    for(int i = 0; i < get_element_count(instructions); i++){
+        if(vector_IrInstructionPtr_at(instructions, i) == instruction){
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ir_dump_function(IrFunction* function, FILE* file){
+    fprintf(file, "function %s, %i parameters\n", function->name, function->parameter_count);
+    for(int i = 0; i < get_element_count(function->slots); i++){
+        IrStackSlot* slot = get_element_at(function->slots, i);
+        fprintf(file, "    slot%i: %zu bytes, align %zu%s%s%s%s\n", i, slot->size, slot->alignment, slot->variable_node ? ", " : "", slot->variable_node ? slot->variable_node->data.var.name : "", slot->flags & IR_STACK_SLOT_FLAG_PROMOTED ? ", promoted" : "", slot->flags & IR_STACK_SLOT_FLAG_UNUSED ? ", unused" : "");
+    }
+    vector_for_each(IrBlock*, block, function->blocks){
+        fprintf(file, "block%i:", (*block)->id);
+        if(!is_vector_empty((*block)->predecessors)){
+            fprintf(file, "    ; preds:");
+            vector_for_each(IrBlock*, predecessor, (*block)->predecessors){
+                fprintf(file, " block%i", (*predecessor)->id);
+            }
+        }
+        fprintf(file, "\n");
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            ir_dump_instruction(*instruction, file);
+        }
+    }
+}
+
+static void ir_dump_instruction(IrInstruction* instruction, FILE* file){
+    fprintf(file, "    ");
+    if(instruction->result != IR_VREG_NONE){
+        fprintf(file, "%%%i:%s = ", instruction->result, ir_type_name(instruction->type));
+    }
+    fprintf(file, "%s", ir_opcode_name(instruction->opcode));
+    switch(instruction->opcode){
+        case IR_OP_CONST:
+        case IR_OP_PARAM:
+            fprintf(file, " %lld", instruction->immediate);
+            break;
+        case IR_OP_SLOT_ADDRESS:
+            fprintf(file, " slot%i", instruction->slot);
+            break;
+        case IR_OP_GLOBAL_ADDRESS:
+            if(instruction->flags & IR_INSTRUCTION_FLAG_STRING_LITERAL){
+                fprintf(file, " string");
+            }
+            else{
+                fprintf(file, " @%s", instruction->symbol);
+            }
+            if(instruction->immediate){
+                fprintf(file, "%+lld", instruction->immediate);
+            }
+            break;
+        case IR_OP_STORE:
+            fprintf(file, " %s", ir_type_name(instruction->type));
+            break;
+        case IR_OP_MEMCOPY:
+            fprintf(file, " %lld bytes", instruction->immediate);
+            break;
+        case IR_OP_CMP:
+            fprintf(file, " %s", ir_condition_name(instruction->condition));
+            break;
+        case IR_OP_CALL:
+            fprintf(file, " @%s", instruction->symbol);
+            break;
+    }
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        if(instruction->operands[i] != IR_VREG_NONE){
+            fprintf(file, "%s %%%i", i == 0 ? "" : ",", instruction->operands[i]);
+        }
+    }
+    if(instruction->opcode == IR_OP_CALL){
+        fprintf(file, "(");
+        for(int i = 0; i < get_element_count(instruction->arguments); i++){
+            fprintf(file, "%s%%%i", i ? ", " : "", vector_Int_at(instruction->arguments, i));
+        }
+        fprintf(file, ")");
+    }
+    else if(instruction->opcode == IR_OP_PHI){
+        for(int i = 0; i < get_element_count(instruction->arguments); i++){
+            IrPhiIncoming* incoming = get_element_at(instruction->arguments, i);
+            fprintf(file, "%s [block%i: %%%i]", i ? "," : "", incoming->block->id, incoming->vreg);
+        }
+    }
+    else if(instruction->opcode == IR_OP_JUMP){
+        fprintf(file, " block%i", instruction->targets[0]->id);
+    }
+    else if(instruction->opcode == IR_OP_BRANCH){
+        fprintf(file, ", block%i, block%i", instruction->targets[0]->id, instruction->targets[1]->id);
+    }
+    fprintf(file, "\n");
+}
+
+static const char* ir_type_name(int type){
+    static const char* names[] = {"void", "i8", "i16", "i32", "i64"};
+    return names[type];
+}
+
+static const char* ir_opcode_name(int opcode){
+    static const char* names[IR_OP_COUNT] = {
+        [IR_OP_CONST] = "const", [IR_OP_UNDEF] = "undef", [IR_OP_COPY] = "copy", [IR_OP_PARAM] = "param",
+        [IR_OP_SLOT_ADDRESS] = "slot_address", [IR_OP_GLOBAL_ADDRESS] = "global_address", [IR_OP_LOAD] = "load", [IR_OP_STORE] = "store",
+        [IR_OP_MEMCOPY] = "memcopy", [IR_OP_ADD] = "add", [IR_OP_SUB] = "sub", [IR_OP_MUL] = "mul",
+        [IR_OP_SDIV] = "sdiv", [IR_OP_UDIV] = "udiv", [IR_OP_SREM] = "srem", [IR_OP_UREM] = "urem",
+        [IR_OP_AND] = "and", [IR_OP_OR] = "or", [IR_OP_XOR] = "xor", [IR_OP_SHL] = "shl",
+        [IR_OP_SAR] = "sar", [IR_OP_SHR] = "shr", [IR_OP_NEG] = "neg", [IR_OP_NOT] = "not",
+        [IR_OP_CMP] = "cmp", [IR_OP_SEXT] = "sext", [IR_OP_ZEXT] = "zext", [IR_OP_TRUNC] = "trunc",
+        [IR_OP_CALL] = "call", [IR_OP_PHI] = "phi", [IR_OP_JUMP] = "jump", [IR_OP_BRANCH] = "branch",
+        [IR_OP_RETURN] = "return"
+    };
+    return names[opcode];
+}
+
+static const char* ir_condition_name(int condition){
+    static const char* names[] = {"eq", "ne", "slt", "sle", "sgt", "sge", "ult", "ule", "ugt", "uge"};
+    return names[condition];
+}
@@ -0,0 +1,1482 @@
+/*
+* @file irBuilder.c
+* @brief Lowering of the AST to the intermediate representation
+* @details Walks the body of a function and emits IrInstructions into basic blocks. The C typing rules, integer promotions, the usual arithmetic conversions and pointer scaling, become explicit instructions here, so the later stages only see typed virtual registers. Every local lives in a stack slot and is accessed with loads and stores, ssa.c promotes them to registers afterwards.
+*/
+
+#include "compiler.h"
+#include <assert.h>
+#include <limits.h>
+
+typedef bool (*IR_BUILDER_STATEMENT_VISITOR)(Node* node, void* private_data);
+
+typedef struct IrValue{
+    int vreg; //IR_VREG_NONE for void expressions
+    DataType* datatype; //arrays, structs and unions are represented by their address
+} IrValue;
+
+typedef struct IrBuilderSwitch{
+    DynamicVector* case_nodes; //the case nodes of the switch body in order, nested switches excluded
+    DynamicVector* case_blocks; //the block of the i-th case node
+    IrBlock* default_block;
+} IrBuilderSwitch;
+
+
+static CompileProcess* current_process;
+static IrFunction* current_function;
+static IrBlock* current_block;
+static DynamicVector* ir_builder_layout; //the blocks in the order they were started, becomes the block order of the function
+static HashTable* ir_builder_labels; //maps a goto label name to its block
+static HashTable* ir_builder_variable_slots; //maps a variable name to the int indices of the slots of the variables with that name
+static DynamicVector* ir_builder_break_blocks;
+static DynamicVector* ir_builder_continue_blocks;
+static DynamicVector* ir_builder_switches;
+static DynamicVector* ir_builder_constants; //indexed by register, the IR_OP_CONST defining it or NULL
+
+IrFunction* ir_build_function(CompileProcess* process, Node* function_node);
+
+static void ir_builder_parameters(Node* function_node);
+
+static void ir_builder_finish_layout();
+
+static void ir_builder_destroy_slot_vector(const char* name, void* slots, void* private_data);
+
+static void ir_builder_statement(Node* node);
+
+static void ir_builder_body(Node* body_node);
+
+static void ir_builder_local_variable(Node* variable_node);
+
+static void ir_builder_return(Node* node);
+
+static void ir_builder_if(Node* node);
+
+static void ir_builder_while(Node* node);
+
+static void ir_builder_do_while(Node* node);
+
+static void ir_builder_for(Node* node);
+
+static void ir_builder_switch(Node* node);
+
+static void ir_builder_switch_label(Node* node);
+
+static void ir_builder_jump_statement(DynamicVector* targets, const char* message);
+
+static IrBlock* ir_builder_user_label(const char* name);
+
+static IrValue ir_builder_expression(Node* node);
+
+static IrValue ir_builder_identifier(Node* node);
+
+static IrValue ir_builder_unary(Node* node);
+
+static IrValue ir_builder_increment(Node* node);
+
+static IrValue ir_builder_cast(Node* node);
+
+static IrValue ir_builder_sizeof(Node* node);
+
+static IrValue ir_builder_binary_expression(Node* node);
+
+static IrValue ir_builder_assignment(Node* node);
+
+static IrValue ir_builder_compound_assignment(Node* node, const char* operator);
+
+static IrValue ir_builder_logical(Node* node);
+
+static IrValue ir_builder_ternary(Node* node);
+
+static IrValue ir_builder_call(Node* node);
+
+static IrValue ir_builder_apply_operator(const char* operator, IrValue left, IrValue right);
+
+static IrValue ir_builder_compare(const char* operator, IrValue left, IrValue right);
+
+static IrValue ir_builder_pointer_offset(int opcode, IrValue pointer, IrValue index);
+
+static IrValue ir_builder_address(Node* node);
+
+static IrValue ir_builder_index_address(Node* node);
+
+static IrValue ir_builder_member_address(Node* node);
+
+static void ir_builder_condition(Node* node, IrBlock* true_block, IrBlock* false_block);
+
+static int ir_builder_variable_address(Node* variable_node);
+
+static int ir_builder_variable_slot(Node* variable_node);
+
+static int ir_builder_declare_slot(Node* variable_node);
+
+static int ir_builder_new_slot(Node* variable_node, size_t size, size_t alignment, int type);
+
+static const char* ir_builder_static_local_symbol(Node* variable_node);
+
+static IrValue ir_builder_load(IrValue address);
+
+static int ir_builder_convert(IrValue value, DataType* datatype);
+
+static IrInstruction* ir_builder_emit(int opcode, int type, bool has_result);
+
+static int ir_builder_constant(int type, long long value);
+
+static int ir_builder_unary_operation(int opcode, int type, int operand);
+
+static int ir_builder_binary_operation(int opcode, int type, int left, int right);
+
+static int ir_builder_fold(IrInstruction* instruction);
+
+static bool ir_builder_constant_value(int vreg, long long* value_out);
+
+static void ir_builder_remember_constant(IrInstruction* constant);
+
+static int ir_builder_slot_address(int slot);
+
+static int ir_builder_global_address(const char* symbol);
+
+static void ir_builder_store(int address, int value);
+
+static void ir_builder_jump(IrBlock* target);
+
+static void ir_builder_branch(int condition, IrBlock* true_block, IrBlock* false_block);
+
+static IrBlock* ir_builder_new_block();
+
+static void ir_builder_set_block(IrBlock* block);
+
+static void ir_builder_start_block(IrBlock* block);
+
+static void ir_builder_start_unreachable_block();
+
+static int ir_builder_type(DataType* datatype);
+
+static DataType* ir_builder_primitive_datatype(int type, size_t size, bool is_signed);
+
+static DataType* ir_builder_int_datatype();
+
+static DataType* ir_builder_long_datatype();
+
+static DataType* ir_builder_char_pointer_datatype();
+
+static DataType* ir_builder_promote(DataType* datatype);
+
+static DataType* ir_builder_usual_arithmetic_type(DataType* left_type, DataType* right_type);
+
+static bool is_ir_builder_pointer(DataType* datatype);
+
+static bool is_ir_builder_aggregate(DataType* datatype);
+
+static bool is_ir_builder_unsigned(DataType* datatype);
+
+static bool is_ir_builder_void(DataType* datatype);
+
+static size_t ir_builder_value_size(DataType* datatype);
+
+static size_t ir_builder_element_size(DataType* datatype);
+
+static void ir_builder_reject_floating_point(DataType* datatype);
+
+static void ir_builder_visit_statements(Node* node, IR_BUILDER_STATEMENT_VISITOR visitor, void* private_data);
+
+static bool ir_builder_collect_case(Node* node, void* private_data);
+
+static void ir_builder_flatten_arguments(Node* node, DynamicVector* arguments);
+
+
+
+IrFunction* ir_build_function(CompileProcess* process, Node* function_node){
+    DataType* return_type = function_node->data.function.return_type;
+    current_process = process;
+    if(is_ir_builder_aggregate(return_type)){
+        compiler_error(current_process, "function %s returns a struct or union by value, which is not supported", function_node->data.function.name);
+    }
+    ir_builder_reject_floating_point(return_type);
+    IrFunction* function = calloc(1, sizeof(IrFunction));
+    function->function_node = function_node;
+    function->name = function_node->data.function.name;
+    function->blocks = create_vector(sizeof(IrBlock*));
+    function->reverse_postorder = create_vector(sizeof(IrBlock*));
+    function->vreg_types = create_vector(sizeof(int));
+    function->slots = create_vector(sizeof(IrStackSlot));
+    function->static_locals = create_vector(sizeof(IrStaticLocal));
+    current_function = function;
+    ir_builder_layout = create_vector(sizeof(IrBlock*));
+    ir_builder_labels = create_hash_table(0);
+    ir_builder_variable_slots = create_hash_table(0);
+    ir_builder_break_blocks = create_vector(sizeof(IrBlock*));
+    ir_builder_continue_blocks = create_vector(sizeof(IrBlock*));
+    ir_builder_switches = create_vector(sizeof(IrBuilderSwitch*));
+    ir_builder_constants = create_vector(sizeof(IrInstruction*));
+
+    ir_builder_set_block(ir_builder_new_block());
+    ir_builder_parameters(function_node);
+    ir_builder_body(function_node->data.function.body_node);
+    if(!ir_get_terminator(current_block)){
+        IrInstruction* return_instruction = NULL;
+        if(ARE_STRINGS_EQUAL(function->name, "main")){
+            //reaching the end of main returns 0
+            int value = ir_builder_constant(IR_TYPE_I32, 0);
+            return_instruction = ir_builder_emit(IR_OP_RETURN, IR_TYPE_VOID, false);
+            return_instruction->operands[0] = value;
+        }
+        else if(is_ir_builder_void(return_type)){
+            ir_builder_emit(IR_OP_RETURN, IR_TYPE_VOID, false);
+        }
+        else{
+            //falling off a function returning a value leaves the result unspecified
+            int value = ir_builder_emit(IR_OP_UNDEF, ir_builder_type(return_type), true)->result;
+            return_instruction = ir_builder_emit(IR_OP_RETURN, IR_TYPE_VOID, false);
+            return_instruction->operands[0] = value;
+        }
+    }
+    ir_builder_finish_layout();
+    ir_remove_unreachable_blocks(function);
+
+    destroy_vector(ir_builder_layout);
+    destroy_hash_table(ir_builder_labels);
+    hash_table_for_each(ir_builder_variable_slots, ir_builder_destroy_slot_vector, NULL);
+    destroy_hash_table(ir_builder_variable_slots);
+    destroy_vector(ir_builder_break_blocks);
+    destroy_vector(ir_builder_continue_blocks);
+    destroy_vector(ir_builder_switches);
+    destroy_vector(ir_builder_constants);
+    current_function = NULL;
+    current_block = NULL;
+    return function;
+}
+
+// Every argument gets a slot like any other local, its incoming value is stored there on entry. All parameters are read before the first store so no argument register is overwritten while others are still live.
+static void ir_builder_parameters(Node* function_node){
+    DynamicVector* arguments = function_node->data.function.function_args.args;
+    if(!arguments){
+        return;
+    }
+    current_function->parameter_count = get_element_count(arguments);
+    DynamicVector* parameters = create_vector(sizeof(int));
+    for(int i = 0; i < get_element_count(arguments); i++){
+        DataType* datatype = vector_NodePtr_at(arguments, i)->data.var.data_type;
+        ir_builder_reject_floating_point(datatype);
+        if(is_ir_builder_aggregate(datatype)){
+            compiler_error(current_process, "passing structs or unions by value is not supported");
+        }
+        IrInstruction* parameter = ir_builder_emit(IR_OP_PARAM, ir_builder_type(datatype), true);
+        parameter->immediate = i;
+        vector_Int_push(parameters, parameter->result);
+    }
+    for(int i = 0; i < get_element_count(arguments); i++){
+        int slot = ir_builder_declare_slot(vector_NodePtr_at(arguments, i));
+        ((IrStackSlot*)get_element_at(current_function->slots, slot))->flags |= IR_STACK_SLOT_FLAG_IS_ARGUMENT;
+        ir_builder_store(ir_builder_slot_address(slot), vector_Int_at(parameters, i));
+    }
+    destroy_vector(parameters);
+}
+
+// Frees the vector of slot indices kept for a variable name.
+static void ir_builder_destroy_slot_vector(const char* name, void* slots, void* private_data){
+    (void)name;
+    (void)private_data;
+    destroy_vector(slots);
+}
+
+// Orders the blocks as they were started and numbers them in that order, a block that was never started is the target of a goto without its label.
+static void ir_builder_finish_layout(){
+    //only labels start a block that was already started or never start one, the layout has one entry per block otherwise
+    if(get_element_count(ir_builder_layout) != get_element_count(current_function->blocks)){
+        compiler_error(current_process, "a label in function %s is used by a goto but not defined, or defined twice", current_function->name);
+    }
+    destroy_vector(current_function->blocks);
+    current_function->blocks = ir_builder_layout;
+    ir_builder_layout = create_vector(sizeof(IrBlock*));
+    for(int i = 0; i < get_element_count(current_function->blocks); i++){
+        vector_IrBlockPtr_at(current_function->blocks, i)->id = i;
+    }
+}
+
+static void ir_builder_statement(Node* node){
+    switch(node->type){
+        case NODE_TYPE_BODY:
+            ir_builder_body(node);
+            break;
+        case NODE_TYPE_VARIABLE:
+            ir_builder_local_variable(node);
+            break;
+        case NODE_TYPE_VARIABLE_LIST:
+            vector_for_each(Node*, variable_node, node->data.variable_list.variables){
+                ir_builder_local_variable(*variable_node);
+            }
+            break;
+        case NODE_TYPE_STATEMENT_RETURN:
+            ir_builder_return(node);
+            break;
+        case NODE_TYPE_STATEMENT_IF:
+            ir_builder_if(node);
+            break;
+        case NODE_TYPE_STATEMENT_WHILE:
+            ir_builder_while(node);
+            break;
+        case NODE_TYPE_STATEMENT_DO_WHILE:
+            ir_builder_do_while(node);
+            break;
+        case NODE_TYPE_STATEMENT_FOR:
+            ir_builder_for(node);
+            break;
+        case NODE_TYPE_STATEMENT_SWITCH:
+            ir_builder_switch(node);
+            break;
+        case NODE_TYPE_STATEMENT_CASE:
+        case NODE_TYPE_STATEMENT_DEFAULT:
+            ir_builder_switch_label(node);
+            break;
+        case NODE_TYPE_STATEMENT_BREAK:
+            ir_builder_jump_statement(ir_builder_break_blocks, "break statement not within a loop or switch");
+            break;
+        case NODE_TYPE_STATEMENT_CONTINUE:
+            ir_builder_jump_statement(ir_builder_continue_blocks, "continue statement not within a loop");
+            break;
+        case NODE_TYPE_STATEMENT_GOTO:
+            ir_builder_jump(ir_builder_user_label(node->data.statement.statement_goto.label_node->literal_value.string_val));
+            ir_builder_start_unreachable_block();
+            break;
+        case NODE_TYPE_LABEL:
+            ir_builder_start_block(ir_builder_user_label(node->data.label.name_node->literal_value.string_val));
+            break;
+        case NODE_TYPE_STRUCT:
+        case NODE_TYPE_UNION:
+            if(node->flags & NODE_FLAG_HAS_VARIABLE_COMBINED){
+                compiler_error(current_process, "declaring a local variable together with its struct or union is not supported");
+            }
+            break;
+        case NODE_TYPE_BLANK:
+            break;
+        default:
+            ir_builder_expression(node);
+    }
+}
+
+static void ir_builder_body(Node* body_node){
+    if(!body_node){
+        return;
+    }
+    vector_for_each(Node*, statement_node, body_node->data.body.statements){
+        if(*statement_node){
+            ir_builder_statement(*statement_node);
+        }
+    }
+}
+
+// Stores the initializer of a local, static locals are emitted with the globals instead.
+static void ir_builder_local_variable(Node* variable_node){
+    DataType* datatype = variable_node->data.var.data_type;
+    ir_builder_reject_floating_point(datatype);
+    if(datatype->flags & DATATYPE_FLAG_IS_STATIC){
+        ir_builder_static_local_symbol(variable_node);
+        return;
+    }
+    int slot = ir_builder_declare_slot(variable_node);
+    Node* value_node = variable_node->data.var.value;
+    if(!value_node){
+        return;
+    }
+    size_t size = get_datatype_size(current_process, datatype);
+    if(datatype->flags & DATATYPE_FLAG_IS_ARRAY){
+        if(value_node->type != NODE_TYPE_STRING || ir_builder_element_size(datatype) != 1){
+            compiler_error(current_process, "array initializers other than string literals are not supported");
+        }
+        //the literal is copied with its terminator, whatever the array has beyond that is zeroed
+        const char* string = value_node->literal_value.string_val;
+        size_t copied = strlen(string) + 1 < size ? strlen(string) + 1 : size;
+        int destination = ir_builder_slot_address(slot);
+        int source = ir_builder_expression(value_node).vreg;
+        IrInstruction* copy = ir_builder_emit(IR_OP_MEMCOPY, IR_TYPE_VOID, false);
+        copy->operands[0] = destination;
+        copy->operands[1] = source;
+        copy->immediate = copied;
+        for(size_t i = copied; i < size; i++){
+            int address = ir_builder_binary_operation(IR_OP_ADD, IR_TYPE_I64, ir_builder_slot_address(slot), ir_builder_constant(IR_TYPE_I64, i));
+            ir_builder_store(address, ir_builder_constant(IR_TYPE_I8, 0));
+        }
+        return;
+    }
+    IrValue value = ir_builder_expression(value_node);
+    if(is_ir_builder_aggregate(datatype)){
+        if(!is_ir_builder_aggregate(value.datatype)){
+            compiler_error(current_process, "initializing a struct or union from a scalar");
+        }
+        int destination = ir_builder_slot_address(slot);
+        IrInstruction* copy = ir_builder_emit(IR_OP_MEMCOPY, IR_TYPE_VOID, false);
+        copy->operands[0] = destination;
+        copy->operands[1] = value.vreg;
+        copy->immediate = size;
+        return;
+    }
+    ir_builder_store(ir_builder_slot_address(slot), ir_builder_convert(value, datatype));
+}
+
+static void ir_builder_return(Node* node){
+    Node* expression_node = node->data.statement.return_statement.expression;
+    DataType* return_type = current_function->function_node->data.function.return_type;
+    int value = IR_VREG_NONE;
+    if(expression_node){
+        IrValue result = ir_builder_expression(expression_node);
+        if(!is_ir_builder_void(return_type)){
+            value = ir_builder_convert(result, return_type);
+        }
+    }
+    IrInstruction* return_instruction = ir_builder_emit(IR_OP_RETURN, IR_TYPE_VOID, false);
+    return_instruction->operands[0] = value;
+    ir_builder_start_unreachable_block();
+}
+
+static void ir_builder_if(Node* node){
+    IrBlock* then_block = ir_builder_new_block();
+    IrBlock* else_block = ir_builder_new_block();
+    Node* else_node = node->data.statement.statement_if.else_body_node;
+    IrBlock* end_block = else_node ? ir_builder_new_block() : else_block;
+    ir_builder_condition(node->data.statement.statement_if.condition_node, then_block, else_block);
+    ir_builder_set_block(then_block);
+    ir_builder_body(node->data.statement.statement_if.body_node);
+    if(!else_node){
+        ir_builder_start_block(end_block);
+        return;
+    }
+    ir_builder_jump(end_block);
+    ir_builder_set_block(else_block);
+    if(else_node->type == NODE_TYPE_STATEMENT_ELSE){
+        ir_builder_body(else_node->data.statement.statement_else.body_node);
+    }
+    else{
+        ir_builder_statement(else_node);
+    }
+    ir_builder_start_block(end_block);
+}
+
+static void ir_builder_while(Node* node){
+    IrBlock* condition_block = ir_builder_new_block();
+    IrBlock* body_block = ir_builder_new_block();
+    IrBlock* end_block = ir_builder_new_block();
+    ir_builder_start_block(condition_block);
+    ir_builder_condition(node->data.statement.statement_while.condition_node, body_block, end_block);
+    ir_builder_set_block(body_block);
+    vector_IrBlockPtr_push(ir_builder_break_blocks, end_block);
+    vector_IrBlockPtr_push(ir_builder_continue_blocks, condition_block);
+    ir_builder_body(node->data.statement.statement_while.body_node);
+    vector_IrBlockPtr_pop(ir_builder_break_blocks);
+    vector_IrBlockPtr_pop(ir_builder_continue_blocks);
+    ir_builder_jump(condition_block);
+    ir_builder_set_block(end_block);
+}
+
+static void ir_builder_do_while(Node* node){
+    IrBlock* body_block = ir_builder_new_block();
+    IrBlock* condition_block = ir_builder_new_block();
+    IrBlock* end_block = ir_builder_new_block();
+    ir_builder_start_block(body_block);
+    vector_IrBlockPtr_push(ir_builder_break_blocks, end_block);
+    vector_IrBlockPtr_push(ir_builder_continue_blocks, condition_block);
+    ir_builder_body(node->data.statement.statement_do_while.body_node);
+    vector_IrBlockPtr_pop(ir_builder_break_blocks);
+    vector_IrBlockPtr_pop(ir_builder_continue_blocks);
+    ir_builder_start_block(condition_block);
+    ir_builder_condition(node->data.statement.statement_do_while.condition_node, body_block, end_block);
+    ir_builder_set_block(end_block);
+}
+
+static void ir_builder_for(Node* node){
+    Node* init_node = node->data.statement.statement_for.init_node;
+    Node* condition_node = node->data.statement.statement_for.condition_node;
+    Node* increment_node = node->data.statement.statement_for.increment_node;
+    IrBlock* condition_block = ir_builder_new_block();
+    IrBlock* body_block = ir_builder_new_block();
+    IrBlock* continue_block = ir_builder_new_block();
+    IrBlock* end_block = ir_builder_new_block();
+    if(init_node){
+        ir_builder_statement(init_node);
+    }
+    ir_builder_start_block(condition_block);
+    if(condition_node){
+        ir_builder_condition(condition_node, body_block, end_block);
+    }
+    ir_builder_start_block(body_block);
+    vector_IrBlockPtr_push(ir_builder_break_blocks, end_block);
+    vector_IrBlockPtr_push(ir_builder_continue_blocks, continue_block);
+    ir_builder_body(node->data.statement.statement_for.body_node);
+    vector_IrBlockPtr_pop(ir_builder_break_blocks);
+    vector_IrBlockPtr_pop(ir_builder_continue_blocks);
+    ir_builder_start_block(continue_block);
+    if(increment_node){
+        ir_builder_expression(increment_node);
+    }
+    ir_builder_jump(condition_block);
+    ir_builder_set_block(end_block);
+}
+
+// Compares the value against every case label in turn, the case bodies follow as one block the comparisons branch into.
+static void ir_builder_switch(Node* node){
+    IrBuilderSwitch switch_data = {};
+    switch_data.case_nodes = create_vector(sizeof(Node*));
+    switch_data.case_blocks = create_vector(sizeof(IrBlock*));
+    ir_builder_visit_statements(node->data.statement.statement_switch.body_node, ir_builder_collect_case, switch_data.case_nodes);
+    for(int i = 0; i < get_element_count(switch_data.case_nodes); i++){
+        vector_IrBlockPtr_push(switch_data.case_blocks, ir_builder_new_block());
+    }
+    switch_data.default_block = node->data.statement.statement_switch.has_default_case ? ir_builder_new_block() : NULL;
+    IrBlock* end_block = ir_builder_new_block();
+
+    IrValue value = ir_builder_expression(node->data.statement.statement_switch.expression_node);
+    DataType* datatype = ir_builder_promote(value.datatype);
+    int type = ir_builder_type(datatype);
+    int compared = ir_builder_convert(value, datatype);
+    for(int i = 0; i < get_element_count(switch_data.case_nodes); i++){
+        Node* case_node = vector_NodePtr_at(switch_data.case_nodes, i);
+        int case_value = ir_builder_constant(type, get_node_constant_value(case_node->data.statement.statement_switch_case.expression_node));
+        IrInstruction* compare = ir_builder_emit(IR_OP_CMP, IR_TYPE_I32, true);
+        compare->condition = IR_CONDITION_EQ;
+        compare->operands[0] = compared;
+        compare->operands[1] = case_value;
+        IrBlock* next_block = ir_builder_new_block();
+        ir_builder_branch(ir_builder_fold(compare), vector_IrBlockPtr_at(switch_data.case_blocks, i), next_block);
+        ir_builder_set_block(next_block);
+    }
+    ir_builder_jump(switch_data.default_block ? switch_data.default_block : end_block);
+
+    IrBuilderSwitch* switch_pointer = &switch_data;
+    push_element(ir_builder_switches, &switch_pointer);
+    vector_IrBlockPtr_push(ir_builder_break_blocks, end_block);
+    ir_builder_start_unreachable_block();
+    ir_builder_body(node->data.statement.statement_switch.body_node);
+    vector_IrBlockPtr_pop(ir_builder_break_blocks);
+    remove_last_element(ir_builder_switches);
+    ir_builder_start_block(end_block);
+    destroy_vector(switch_data.case_nodes);
+    destroy_vector(switch_data.case_blocks);
+}
+
+// A case or default label starts its block, the statements before fall through into it.
+static void ir_builder_switch_label(Node* node){
+    bool is_case = node->type == NODE_TYPE_STATEMENT_CASE;
+    if(is_vector_empty(ir_builder_switches)){
+        compiler_error(current_process, is_case ? "case label not within a switch statement" : "default label not within a switch statement");
+    }
+    IrBuilderSwitch* switch_data = get_last_element_pointer(ir_builder_switches);
+    if(!is_case){
+        ir_builder_start_block(switch_data->default_block);
+        return;
+    }
+    for(int i = 0; i < get_element_count(switch_data->case_nodes); i++){
+        if(vector_NodePtr_at(switch_data->case_nodes, i) == node){
+            ir_builder_start_block(vector_IrBlockPtr_at(switch_data->case_blocks, i));
+            return;
+        }
+    }
+    compiler_error(current_process, "BUG: case label was not collected for its switch");
+}
+
+// Jumps to the innermost break or continue target.
+static void ir_builder_jump_statement(DynamicVector* targets, const char* message){
+    if(is_vector_empty(targets)){
+        compiler_error(current_process, message);
+    }
+    ir_builder_jump(vector_IrBlockPtr_last(targets));
+    ir_builder_start_unreachable_block();
+}
+
+static IrBlock* ir_builder_user_label(const char* name){
+    IrBlock* block = hash_table_get(ir_builder_labels, name);
+    if(!block){
+        block = ir_builder_new_block();
+        hash_table_put(ir_builder_labels, name, block);
+    }
+    return block;
+}
+
+// Lowers an expression and returns the register holding its value, structs, unions and arrays give their address.
+static IrValue ir_builder_expression(Node* node){
+    switch(node->type){
+        case NODE_TYPE_NUMBER:{
+            DataType* datatype = get_number_literal_datatype(current_process, node);
+            return (IrValue){ir_builder_constant(ir_builder_type(datatype), node->literal_value.long_long_num), datatype};
+        }
+        case NODE_TYPE_STRING:{
+            IrInstruction* address = ir_builder_emit(IR_OP_GLOBAL_ADDRESS, IR_TYPE_I64, true);
+            address->symbol = node->literal_value.string_val;
+            address->flags |= IR_INSTRUCTION_FLAG_STRING_LITERAL;
+            return (IrValue){address->result, ir_builder_char_pointer_datatype()};
+        }
+        case NODE_TYPE_IDENTIFIER:
+            return ir_builder_identifier(node);
+        case NODE_TYPE_EXPRESSION_PARENTHESES:
+            if(node->data.parentheses.expression->type == NODE_TYPE_BLANK){
+                compiler_error(current_process, "expected an expression inside the parentheses");
+            }
+            return ir_builder_expression(node->data.parentheses.expression);
+        case NODE_TYPE_UNARY:
+            return ir_builder_unary(node);
+        case NODE_TYPE_CAST:
+            return ir_builder_cast(node);
+        case NODE_TYPE_SIZEOF:
+            return ir_builder_sizeof(node);
+        case NODE_TYPE_EXPRESSION:
+            return ir_builder_binary_expression(node);
+    }
+    compiler_error(current_process, "this node can't be used as an expression");
+    return (IrValue){};
+}
+
+static IrValue ir_builder_identifier(Node* node){
+    Node* declaration = node->data.identifier.declaration;
+    if(!declaration){
+        compiler_error(current_process, "undeclared identifier %s", node->literal_value.string_val);
+    }
+    if(declaration->type == NODE_TYPE_FUNCTION){
+        return (IrValue){ir_builder_global_address(declaration->data.function.name), ir_builder_long_datatype()};
+    }
+    return ir_builder_load((IrValue){ir_builder_variable_address(declaration), declaration->data.var.data_type});
+}
+
+static IrValue ir_builder_unary(Node* node){
+    const char* operator = node->data.unary.operator;
+    Node* operand_node = node->data.unary.operand;
+    if(ARE_STRINGS_EQUAL(operator, "++") || ARE_STRINGS_EQUAL(operator, "--")){
+        return ir_builder_increment(node);
+    }
+    if(ARE_STRINGS_EQUAL(operator, "&")){
+        IrValue address = ir_builder_address(operand_node);
+        return (IrValue){address.vreg, get_datatype_pointer_to(current_process, address.datatype)};
+    }
+    if(ARE_STRINGS_EQUAL(operator, "*")){
+        return ir_builder_load(ir_builder_address(node));
+    }
+    IrValue operand = ir_builder_expression(operand_node);
+    if(ARE_STRINGS_EQUAL(operator, "!")){
+        if(operand.vreg == IR_VREG_NONE){
+            compiler_error(current_process, "invalid operand to unary !");
+        }
+        int zero = ir_builder_constant(ir_get_vreg_type(current_function, operand.vreg), 0);
+        IrInstruction* compare = ir_builder_emit(IR_OP_CMP, IR_TYPE_I32, true);
+        compare->condition = IR_CONDITION_EQ;
+        compare->operands[0] = operand.vreg;
+        compare->operands[1] = zero;
+        return (IrValue){ir_builder_fold(compare), ir_builder_int_datatype()};
+    }
+    if(is_ir_builder_pointer(operand.datatype) || is_ir_builder_aggregate(operand.datatype)){
+        compiler_error(current_process, "invalid operand to unary %s", operator);
+    }
+    DataType* result_type = ir_builder_promote(operand.datatype);
+    int value = ir_builder_convert(operand, result_type);
+    if(ARE_STRINGS_EQUAL(operator, "-")){
+        value = ir_builder_unary_operation(IR_OP_NEG, ir_builder_type(result_type), value);
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "~")){
+        value = ir_builder_unary_operation(IR_OP_NOT, ir_builder_type(result_type), value);
+    }
+    return (IrValue){value, result_type};
+}
+
+// Prefix increments give the new value, postfix ones the old value. Pointers step by the size of what they point to.
+static IrValue ir_builder_increment(Node* node){
+    bool is_increment = ARE_STRINGS_EQUAL(node->data.unary.operator, "++");
+    bool is_postfix = node->data.unary.flags & UNARY_FLAG_IS_POSTFIX;
+    IrValue address = ir_builder_address(node->data.unary.operand);
+    DataType* datatype = address.datatype;
+    if(is_ir_builder_aggregate(datatype)){
+        compiler_error(current_process, "invalid operand to %s", node->data.unary.operator);
+    }
+    IrValue old_value = ir_builder_load(address);
+    DataType* arithmetic_type = ir_builder_promote(datatype);
+    int type = ir_builder_type(arithmetic_type);
+    long long step = is_ir_builder_pointer(datatype) ? ir_builder_element_size(datatype) : 1;
+    int new_value = ir_builder_binary_operation(is_increment ? IR_OP_ADD : IR_OP_SUB, type, ir_builder_convert(old_value, arithmetic_type), ir_builder_constant(type, step));
+    new_value = ir_builder_convert((IrValue){new_value, arithmetic_type}, datatype);
+    ir_builder_store(address.vreg, new_value);
+    return (IrValue){is_postfix ? old_value.vreg : new_value, datatype};
+}
+
+static IrValue ir_builder_cast(Node* node){
+    DataType* datatype = node->data.cast.data_type;
+    ir_builder_reject_floating_point(datatype);
+    IrValue operand = ir_builder_expression(node->data.cast.operand_node);
+    if(is_ir_builder_void(datatype)){
+        return (IrValue){IR_VREG_NONE, datatype};
+    }
+    if(is_ir_builder_aggregate(datatype) || (is_ir_builder_aggregate(operand.datatype) && !(operand.datatype->flags & DATATYPE_FLAG_IS_ARRAY))){
+        compiler_error(current_process, "casts between structs, unions and scalars are not supported");
+    }
+    return (IrValue){ir_builder_convert(operand, datatype), datatype};
+}
+
+// sizeof an expression the constant folder can't type is measured by lowering the operand into a block nothing jumps to, so it is never evaluated.
+static IrValue ir_builder_sizeof(Node* node){
+    long long value = 0;
+    if(!evaluate_constant_expression(current_process, node, &value)){
+        IrBlock* block = current_block;
+        ir_builder_set_block(ir_builder_new_block());
+        DataType* datatype = ir_builder_expression(node->data.size_of.expression_node).datatype;
+        current_block = block;
+        value = is_ir_builder_aggregate(datatype) ? get_datatype_size(current_process, datatype) : ir_builder_value_size(datatype);
+    }
+    DataType* datatype = ir_builder_primitive_datatype(DATA_TYPE_LONG, current_process->target->long_size, false);
+    return (IrValue){ir_builder_constant(ir_builder_type(datatype), value), datatype};
+}
+
+static IrValue ir_builder_binary_expression(Node* node){
+    const char* operator = node->data.expression.operator;
+    if(ARE_STRINGS_EQUAL(operator, "=")){
+        return ir_builder_assignment(node);
+    }
+    if(ARE_STRINGS_EQUAL(operator, ",")){
+        ir_builder_expression(node->data.expression.left);
+        return ir_builder_expression(node->data.expression.right);
+    }
+    if(ARE_STRINGS_EQUAL(operator, "&&") || ARE_STRINGS_EQUAL(operator, "||")){
+        return ir_builder_logical(node);
+    }
+    if(ARE_STRINGS_EQUAL(operator, "?")){
+        return ir_builder_ternary(node);
+    }
+    if(ARE_STRINGS_EQUAL(operator, "()")){
+        return ir_builder_call(node);
+    }
+    if(ARE_STRINGS_EQUAL(operator, "[]") || ARE_STRINGS_EQUAL(operator, ".") || ARE_STRINGS_EQUAL(operator, "->")){
+        return ir_builder_load(ir_builder_address(node));
+    }
+    size_t length = strlen(operator);
+    if(length >= 2 && operator[length - 1] == '=' && !ARE_STRINGS_EQUAL(operator, "==") && !ARE_STRINGS_EQUAL(operator, "!=") && !ARE_STRINGS_EQUAL(operator, "<=") && !ARE_STRINGS_EQUAL(operator, ">=")){
+        return ir_builder_compound_assignment(node, operator);
+    }
+    IrValue left = ir_builder_expression(node->data.expression.left);
+    IrValue right = ir_builder_expression(node->data.expression.right);
+    return ir_builder_apply_operator(operator, left, right);
+}
+
+// The address of the target is computed before the value, structs and unions are copied.
+static IrValue ir_builder_assignment(Node* node){
+    IrValue address = ir_builder_address(node->data.expression.left);
+    DataType* datatype = address.datatype;
+    if(datatype->flags & DATATYPE_FLAG_IS_ARRAY){
+        compiler_error(current_process, "arrays can't be assigned to");
+    }
+    IrValue value = ir_builder_expression(node->data.expression.right);
+    if(is_ir_builder_aggregate(datatype)){
+        if(!is_ir_builder_aggregate(value.datatype)){
+            compiler_error(current_process, "assigning a scalar to a struct or union");
+        }
+        IrInstruction* copy = ir_builder_emit(IR_OP_MEMCOPY, IR_TYPE_VOID, false);
+        copy->operands[0] = address.vreg;
+        copy->operands[1] = value.vreg;
+        copy->immediate = get_datatype_size(current_process, datatype);
+        return address;
+    }
+    int converted = ir_builder_convert(value, datatype);
+    ir_builder_store(address.vreg, converted);
+    return (IrValue){converted, datatype};
+}
+
+static IrValue ir_builder_compound_assignment(Node* node, const char* operator){
+    char binary_operator[4] = {};
+    strncpy(binary_operator, operator, strlen(operator) - 1);
+    IrValue address = ir_builder_address(node->data.expression.left);
+    DataType* datatype = address.datatype;
+    if(is_ir_builder_aggregate(datatype)){
+        compiler_error(current_process, "invalid operand to %s", operator);
+    }
+    IrValue left = ir_builder_load(address);
+    IrValue right = ir_builder_expression(node->data.expression.right);
+    int value = ir_builder_convert(ir_builder_apply_operator(binary_operator, left, right), datatype);
+    ir_builder_store(address.vreg, value);
+    return (IrValue){value, datatype};
+}
+
+// && and || give 0 or 1 through a temporary, promoting it to a register turns the two stores into a phi.
+static IrValue ir_builder_logical(Node* node){
+    IrBlock* true_block = ir_builder_new_block();
+    IrBlock* false_block = ir_builder_new_block();
+    IrBlock* end_block = ir_builder_new_block();
+    int slot = ir_builder_new_slot(NULL, 4, 4, IR_TYPE_I32);
+    ir_builder_condition(node, true_block, false_block);
+    ir_builder_set_block(true_block);
+    ir_builder_store(ir_builder_slot_address(slot), ir_builder_constant(IR_TYPE_I32, 1));
+    ir_builder_jump(end_block);
+    ir_builder_set_block(false_block);
+    ir_builder_store(ir_builder_slot_address(slot), ir_builder_constant(IR_TYPE_I32, 0));
+    ir_builder_start_block(end_block);
+    return ir_builder_load((IrValue){ir_builder_slot_address(slot), ir_builder_int_datatype()});
+}
+
+// The ternary operator is stored as EXP(condition ? TERNARY(true, false)). The type of the result is only known once both sides are lowered, so their conversions are added to the end of each side afterwards.
+static IrValue ir_builder_ternary(Node* node){
+    Node* ternary_node = node->data.expression.right;
+    IrBlock* true_block = ir_builder_new_block();
+    IrBlock* false_block = ir_builder_new_block();
+    IrBlock* end_block = ir_builder_new_block();
+    ir_builder_condition(node->data.expression.left, true_block, false_block);
+    ir_builder_set_block(true_block);
+    IrValue true_value = ir_builder_expression(ternary_node->data.tenary.true_expression);
+    IrBlock* true_end_block = current_block;
+    ir_builder_set_block(false_block);
+    IrValue false_value = ir_builder_expression(ternary_node->data.tenary.false_expression);
+    IrBlock* false_end_block = current_block;
+
+    DataType* datatype = NULL;
+    if(true_value.vreg == IR_VREG_NONE || false_value.vreg == IR_VREG_NONE){
+        datatype = true_value.vreg == IR_VREG_NONE ? true_value.datatype : false_value.datatype;
+    }
+    else if(is_ir_builder_pointer(true_value.datatype) || is_ir_builder_aggregate(true_value.datatype)){
+        datatype = true_value.datatype;
+    }
+    else if(is_ir_builder_pointer(false_value.datatype) || is_ir_builder_aggregate(false_value.datatype)){
+        datatype = false_value.datatype;
+    }
+    else{
+        datatype = ir_builder_usual_arithmetic_type(true_value.datatype, false_value.datatype);
+    }
+    bool has_value = true_value.vreg != IR_VREG_NONE && false_value.vreg != IR_VREG_NONE;
+    int type = has_value ? ir_builder_type(datatype) : IR_TYPE_VOID;
+    int slot = has_value ? ir_builder_new_slot(NULL, ir_type_size(type), ir_type_size(type), type) : -1;
+    IrValue values[2] = {true_value, false_value};
+    IrBlock* end_blocks[2] = {true_end_block, false_end_block};
+    for(int i = 0; i < 2; i++){
+        current_block = end_blocks[i];
+        if(has_value){
+            int value = is_ir_builder_aggregate(datatype) ? values[i].vreg : ir_builder_convert(values[i], datatype);
+            ir_builder_store(ir_builder_slot_address(slot), value);
+        }
+        ir_builder_jump(end_block);
+    }
+    ir_builder_set_block(end_block);
+    if(!has_value){
+        return (IrValue){IR_VREG_NONE, datatype};
+    }
+    int address = ir_builder_slot_address(slot);
+    IrInstruction* load = ir_builder_emit(IR_OP_LOAD, type, true);
+    load->operands[0] = address;
+    return (IrValue){load->result, datatype};
+}
+
+// Arguments are evaluated right to left. They are converted to the declared parameter types, arguments without one get the integer promotions.
+static IrValue ir_builder_call(Node* node){
+    Node* callee_node = node->data.expression.left;
+    if(callee_node->type != NODE_TYPE_IDENTIFIER){
+        compiler_error(current_process, "only named functions can be called");
+    }
+    Node* declaration = callee_node->data.identifier.declaration;
+    if(declaration && declaration->type != NODE_TYPE_FUNCTION){
+        compiler_error(current_process, "calling %s through a pointer is not supported", callee_node->literal_value.string_val);
+    }
+    DataType* return_type = declaration ? declaration->data.function.return_type : ir_builder_int_datatype();
+    ir_builder_reject_floating_point(return_type);
+    if(is_ir_builder_aggregate(return_type)){
+        compiler_error(current_process, "calling %s which returns a struct or union by value is not supported", callee_node->literal_value.string_val);
+    }
+    DynamicVector* parameters = declaration ? declaration->data.function.function_args.args : NULL;
+    int parameter_count = parameters ? get_element_count(parameters) : 0;
+    DynamicVector* arguments = create_vector(sizeof(Node*));
+    ir_builder_flatten_arguments(node->data.expression.right->data.parentheses.expression, arguments);
+    int argument_count = get_element_count(arguments);
+    int* values = calloc(argument_count + 1, sizeof(int));
+    for(int i = argument_count - 1; i >= 0; i--){
+        IrValue argument = ir_builder_expression(vector_NodePtr_at(arguments, i));
+        if(argument.vreg == IR_VREG_NONE){
+            compiler_error(current_process, "a void value can't be passed to %s", callee_node->literal_value.string_val);
+        }
+        if(is_ir_builder_aggregate(argument.datatype) && !(argument.datatype->flags & DATATYPE_FLAG_IS_ARRAY)){
+            compiler_error(current_process, "passing structs or unions by value is not supported");
+        }
+        DataType* parameter_type = i < parameter_count ? vector_NodePtr_at(parameters, i)->data.var.data_type : ir_builder_promote(argument.datatype);
+        values[i] = is_ir_builder_aggregate(argument.datatype) ? argument.vreg : ir_builder_convert(argument, parameter_type);
+    }
+    bool has_result = !is_ir_builder_void(return_type);
+    IrInstruction* call = ir_builder_emit(IR_OP_CALL, has_result ? ir_builder_type(return_type) : IR_TYPE_VOID, has_result);
+    call->symbol = callee_node->literal_value.string_val;
+    for(int i = 0; i < argument_count; i++){
+        vector_Int_push(call->arguments, values[i]);
+    }
+    //a callee without a prototype might be variadic too
+    if(!declaration || declaration->flags & FUNCTION_NODE_FLAG_IS_VARIADIC){
+        call->flags |= IR_INSTRUCTION_FLAG_VARIADIC_CALL;
+    }
+    free(values);
+    destroy_vector(arguments);
+    return (IrValue){call->result, return_type};
+}
+
+// Applies a binary arithmetic, bitwise or comparison operator to two lowered operands.
+static IrValue ir_builder_apply_operator(const char* operator, IrValue left, IrValue right){
+    if(left.vreg == IR_VREG_NONE || right.vreg == IR_VREG_NONE || (is_ir_builder_aggregate(left.datatype) && !(left.datatype->flags & DATATYPE_FLAG_IS_ARRAY)) || (is_ir_builder_aggregate(right.datatype) && !(right.datatype->flags & DATATYPE_FLAG_IS_ARRAY))){
+        compiler_error(current_process, "invalid operands to binary %s", operator);
+    }
+    if(ARE_STRINGS_EQUAL(operator, "==") || ARE_STRINGS_EQUAL(operator, "!=") || ARE_STRINGS_EQUAL(operator, "<") || ARE_STRINGS_EQUAL(operator, "<=") || ARE_STRINGS_EQUAL(operator, ">") || ARE_STRINGS_EQUAL(operator, ">=")){
+        return ir_builder_compare(operator, left, right);
+    }
+    bool is_left_pointer = is_ir_builder_pointer(left.datatype);
+    bool is_right_pointer = is_ir_builder_pointer(right.datatype);
+    if(ARE_STRINGS_EQUAL(operator, "+") || ARE_STRINGS_EQUAL(operator, "-")){
+        int opcode = ARE_STRINGS_EQUAL(operator, "+") ? IR_OP_ADD : IR_OP_SUB;
+        if(is_left_pointer && is_right_pointer){
+            if(opcode != IR_OP_SUB){
+                compiler_error(current_process, "invalid operands to binary +");
+            }
+            //the difference of two pointers counts elements
+            int difference = ir_builder_binary_operation(IR_OP_SUB, IR_TYPE_I64, left.vreg, right.vreg);
+            long long element_size = ir_builder_element_size(left.datatype);
+            if(element_size > 1){
+                difference = ir_builder_binary_operation(IR_OP_SDIV, IR_TYPE_I64, difference, ir_builder_constant(IR_TYPE_I64, element_size));
+            }
+            return (IrValue){difference, ir_builder_long_datatype()};
+        }
+        if(is_left_pointer){
+            return ir_builder_pointer_offset(opcode, left, right);
+        }
+        if(is_right_pointer){
+            if(opcode != IR_OP_ADD){
+                compiler_error(current_process, "invalid operands to binary -");
+            }
+            return ir_builder_pointer_offset(opcode, right, left);
+        }
+    }
+    if(is_left_pointer || is_right_pointer){
+        compiler_error(current_process, "invalid operands to binary %s", operator);
+    }
+    if(ARE_STRINGS_EQUAL(operator, "<<") || ARE_STRINGS_EQUAL(operator, ">>")){
+        //the result has the promoted type of the left operand
+        DataType* result_type = ir_builder_promote(left.datatype);
+        int opcode = IR_OP_SHL;
+        if(ARE_STRINGS_EQUAL(operator, ">>")){
+            opcode = is_ir_builder_unsigned(result_type) ? IR_OP_SHR : IR_OP_SAR;
+        }
+        int value = ir_builder_binary_operation(opcode, ir_builder_type(result_type), ir_builder_convert(left, result_type), ir_builder_convert(right, result_type));
+        return (IrValue){value, result_type};
+    }
+    DataType* result_type = ir_builder_usual_arithmetic_type(left.datatype, right.datatype);
+    bool is_unsigned = is_ir_builder_unsigned(result_type);
+    int opcode = 0;
+    if(ARE_STRINGS_EQUAL(operator, "+")){
+        opcode = IR_OP_ADD;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "-")){
+        opcode = IR_OP_SUB;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "*")){
+        opcode = IR_OP_MUL;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "/")){
+        opcode = is_unsigned ? IR_OP_UDIV : IR_OP_SDIV;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "%")){
+        opcode = is_unsigned ? IR_OP_UREM : IR_OP_SREM;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "&")){
+        opcode = IR_OP_AND;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "|")){
+        opcode = IR_OP_OR;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "^")){
+        opcode = IR_OP_XOR;
+    }
+    else{
+        compiler_error(current_process, "operator %s is not supported by the backend", operator);
+    }
+    int value = ir_builder_binary_operation(opcode, ir_builder_type(result_type), ir_builder_convert(left, result_type), ir_builder_convert(right, result_type));
+    return (IrValue){value, result_type};
+}
+
+// Compares in the common type of the operands, pointers and unsigned types compare unsigned.
+static IrValue ir_builder_compare(const char* operator, IrValue left, IrValue right){
+    DataType* datatype = NULL;
+    if(is_ir_builder_pointer(left.datatype)){
+        datatype = left.datatype;
+    }
+    else if(is_ir_builder_pointer(right.datatype)){
+        datatype = right.datatype;
+    }
+    else{
+        datatype = ir_builder_usual_arithmetic_type(left.datatype, right.datatype);
+    }
+    bool is_unsigned = is_ir_builder_unsigned(datatype);
+    int condition = IR_CONDITION_EQ;
+    if(ARE_STRINGS_EQUAL(operator, "!=")){
+        condition = IR_CONDITION_NE;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "<")){
+        condition = is_unsigned ? IR_CONDITION_ULT : IR_CONDITION_SLT;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "<=")){
+        condition = is_unsigned ? IR_CONDITION_ULE : IR_CONDITION_SLE;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, ">")){
+        condition = is_unsigned ? IR_CONDITION_UGT : IR_CONDITION_SGT;
+    }
+    else if(ARE_STRINGS_EQUAL(operator, ">=")){
+        condition = is_unsigned ? IR_CONDITION_UGE : IR_CONDITION_SGE;
+    }
+    int left_value = ir_builder_convert(left, datatype);
+    int right_value = ir_builder_convert(right, datatype);
+    IrInstruction* compare = ir_builder_emit(IR_OP_CMP, IR_TYPE_I32, true);
+    compare->condition = condition;
+    compare->operands[0] = left_value;
+    compare->operands[1] = right_value;
+    return (IrValue){ir_builder_fold(compare), ir_builder_int_datatype()};
+}
+
+// pointer + index and pointer - index, the index is scaled by the size of the element.
+static IrValue ir_builder_pointer_offset(int opcode, IrValue pointer, IrValue index){
+    long long element_size = ir_builder_element_size(pointer.datatype);
+    int offset = ir_builder_convert(index, ir_builder_long_datatype());
+    if(element_size != 1){
+        offset = ir_builder_binary_operation(IR_OP_MUL, IR_TYPE_I64, offset, ir_builder_constant(IR_TYPE_I64, element_size));
+    }
+    int value = ir_builder_binary_operation(opcode, IR_TYPE_I64, pointer.vreg, offset);
+    DataType* datatype = pointer.datatype->flags & DATATYPE_FLAG_IS_ARRAY ? get_datatype_pointer_to(current_process, get_datatype_element(current_process, pointer.datatype)) : pointer.datatype;
+    return (IrValue){value, datatype};
+}
+
+// Computes the address of an lvalue and returns it with the type of the object found there.
+static IrValue ir_builder_address(Node* node){
+    switch(node->type){
+        case NODE_TYPE_IDENTIFIER:{
+            Node* declaration = node->data.identifier.declaration;
+            if(!declaration || declaration->type != NODE_TYPE_VARIABLE){
+                compiler_error(current_process, "%s is not a variable", node->literal_value.string_val);
+            }
+            return (IrValue){ir_builder_variable_address(declaration), declaration->data.var.data_type};
+        }
+        case NODE_TYPE_EXPRESSION_PARENTHESES:
+            return ir_builder_address(node->data.parentheses.expression);
+        case NODE_TYPE_UNARY:
+            if(ARE_STRINGS_EQUAL(node->data.unary.operator, "*")){
+                IrValue pointer = ir_builder_expression(node->data.unary.operand);
+                return (IrValue){pointer.vreg, get_datatype_element(current_process, pointer.datatype)};
+            }
+            break;
+        case NODE_TYPE_EXPRESSION:
+            if(ARE_STRINGS_EQUAL(node->data.expression.operator, "[]")){
+                return ir_builder_index_address(node);
+            }
+            if(ARE_STRINGS_EQUAL(node->data.expression.operator, ".") || ARE_STRINGS_EQUAL(node->data.expression.operator, "->")){
+                return ir_builder_member_address(node);
+            }
+            break;
+    }
+    compiler_error(current_process, "expression is not assignable");
+    return (IrValue){};
+}
+
+// Arrays evaluate to their address and pointers to their value, either way that is the base of the access.
+static IrValue ir_builder_index_address(Node* node){
+    IrValue base = ir_builder_expression(node->data.expression.left);
+    if(!is_ir_builder_pointer(base.datatype)){
+        compiler_error(current_process, "subscripted value is neither array nor pointer");
+    }
+    DataType* element_type = get_datatype_element(current_process, base.datatype);
+    IrValue index = ir_builder_expression(node->data.expression.right->data.bracket.inner);
+    int offset = ir_builder_convert(index, ir_builder_long_datatype());
+    long long element_size = get_datatype_size(current_process, element_type);
+    if(element_size != 1){
+        offset = ir_builder_binary_operation(IR_OP_MUL, IR_TYPE_I64, offset, ir_builder_constant(IR_TYPE_I64, element_size));
+    }
+    return (IrValue){ir_builder_binary_operation(IR_OP_ADD, IR_TYPE_I64, base.vreg, offset), element_type};
+}
+
+static IrValue ir_builder_member_address(Node* node){
+    bool is_arrow = ARE_STRINGS_EQUAL(node->data.expression.operator, "->");
+    IrValue base = {};
+    DataType* struct_type = NULL;
+    if(is_arrow){
+        base = ir_builder_expression(node->data.expression.left);
+        if(!is_ir_builder_pointer(base.datatype)){
+            compiler_error(current_process, "the left operand of -> is not a pointer");
+        }
+        struct_type = get_datatype_element(current_process, base.datatype);
+    }
+    else{
+        base = ir_builder_address(node->data.expression.left);
+        struct_type = base.datatype;
+    }
+    if(!is_datatype_struct_or_union(struct_type) || is_ir_builder_pointer(struct_type)){
+        compiler_error(current_process, "member access on something that is not a struct or union");
+    }
+    StructLayout* layout = get_struct_layout_for_datatype(current_process, struct_type);
+    Node* member_node = node->data.expression.right;
+    StructLayoutMember* member = layout && member_node->type == NODE_TYPE_IDENTIFIER ? struct_layout_get_member(layout, member_node->literal_value.string_val) : NULL;
+    if(!member){
+        compiler_error(current_process, "%s %s has no such member", struct_type->type == DATA_TYPE_UNION ? "union" : "struct", struct_type->name);
+    }
+    int address = base.vreg;
+    if(member->offset){
+        address = ir_builder_binary_operation(IR_OP_ADD, IR_TYPE_I64, address, ir_builder_constant(IR_TYPE_I64, member->offset));
+    }
+    return (IrValue){address, member->data_type};
+}
+
+// Branches on a condition, logical operators and ! become control flow instead of materializing 0 or 1.
+static void ir_builder_condition(Node* node, IrBlock* true_block, IrBlock* false_block){
+    while(node->type == NODE_TYPE_EXPRESSION_PARENTHESES){
+        node = node->data.parentheses.expression;
+    }
+    if(node->type == NODE_TYPE_UNARY && ARE_STRINGS_EQUAL(node->data.unary.operator, "!")){
+        ir_builder_condition(node->data.unary.operand, false_block, true_block);
+        return;
+    }
+    if(node->type == NODE_TYPE_EXPRESSION && (ARE_STRINGS_EQUAL(node->data.expression.operator, "&&") || ARE_STRINGS_EQUAL(node->data.expression.operator, "||"))){
+        bool is_and = ARE_STRINGS_EQUAL(node->data.expression.operator, "&&");
+        IrBlock* right_block = ir_builder_new_block();
+        ir_builder_condition(node->data.expression.left, is_and ? right_block : true_block, is_and ? false_block : right_block);
+        ir_builder_set_block(right_block);
+        ir_builder_condition(node->data.expression.right, true_block, false_block);
+        return;
+    }
+    IrValue value = ir_builder_expression(node);
+    if(value.vreg == IR_VREG_NONE){
+        compiler_error(current_process, "a void value can't be used as a condition");
+    }
+    ir_builder_branch(value.vreg, true_block, false_block);
+}
+
+// Locals and arguments live in their slot, static locals and globals at their symbol.
+static int ir_builder_variable_address(Node* variable_node){
+    if(variable_node->BindedTo.function && variable_node->data.var.data_type->flags & DATATYPE_FLAG_IS_STATIC){
+        return ir_builder_global_address(ir_builder_static_local_symbol(variable_node));
+    }
+    if(variable_node->BindedTo.function){
+        return ir_builder_slot_address(ir_builder_variable_slot(variable_node));
+    }
+    return ir_builder_global_address(variable_node->data.var.name);
+}
+
+// Finds the slot of a variable by name, shadowed variables share the name so the most recent slots are checked first.
+static int ir_builder_variable_slot(Node* variable_node){
+    DynamicVector* slots = hash_table_get(ir_builder_variable_slots, variable_node->data.var.name);
+    for(int i = slots ? get_element_count(slots) - 1 : -1; i >= 0; i--){
+        int slot = vector_Int_at(slots, i);
+        if(((IrStackSlot*)get_element_at(current_function->slots, slot))->variable_node == variable_node){
+            return slot;
+        }
+    }
+    return ir_builder_declare_slot(variable_node);
+}
+
+// Gives a variable its slot where it is declared, without searching the earlier ones of the same name.
+static int ir_builder_declare_slot(Node* variable_node){
+    DynamicVector* slots = hash_table_get(ir_builder_variable_slots, variable_node->data.var.name);
+    if(!slots){
+        slots = create_vector(sizeof(int));
+        hash_table_put(ir_builder_variable_slots, variable_node->data.var.name, slots);
+    }
+    DataType* datatype = variable_node->data.var.data_type;
+    int type = is_ir_builder_aggregate(datatype) ? IR_TYPE_VOID : ir_builder_type(datatype);
+    int slot = ir_builder_new_slot(variable_node, get_datatype_size(current_process, datatype), get_datatype_alignment(current_process, datatype), type);
+    vector_Int_push(slots, slot);
+    return slot;
+}
+
+static int ir_builder_new_slot(Node* variable_node, size_t size, size_t alignment, int type){
+    IrStackSlot slot = {.variable_node = variable_node, .size = size ? size : 1, .alignment = alignment ? alignment : 1, .type = type};
+    push_element(current_function->slots, &slot);
+    return get_element_count(current_function->slots) - 1;
+}
+
+// Static locals are emitted with the globals under a name made unique by the function name and a counter.
+static const char* ir_builder_static_local_symbol(Node* variable_node){
+    vector_for_each(IrStaticLocal, local, current_function->static_locals){
+        if(local->variable_node == variable_node){
+            return local->symbol;
+        }
+    }
+    size_t length = strlen(current_function->name) + strlen(variable_node->data.var.name) + 16;
+    char* symbol = malloc(length);
+    snprintf(symbol, length, "%s.%s.%d", current_function->name, variable_node->data.var.name, get_element_count(current_function->static_locals));
+    IrStaticLocal local = {.variable_node = variable_node, .symbol = symbol};
+    push_element(current_function->static_locals, &local);
+    return symbol;
+}
+
+// Loads the value at the address, arrays, structs and unions stay represented by the address.
+static IrValue ir_builder_load(IrValue address){
+    if(is_ir_builder_aggregate(address.datatype)){
+        return address;
+    }
+    ir_builder_reject_floating_point(address.datatype);
+    IrInstruction* load = ir_builder_emit(IR_OP_LOAD, ir_builder_type(address.datatype), true);
+    load->operands[0] = address.vreg;
+    return (IrValue){load->result, address.datatype};
+}
+
+// Converts the value to the datatype, narrowing truncates and widening extends by the signedness of the source.
+static int ir_builder_convert(IrValue value, DataType* datatype){
+    if(value.vreg == IR_VREG_NONE){
+        compiler_error(current_process, "void value not ignored as it ought to be");
+    }
+    ir_builder_reject_floating_point(datatype);
+    int from = ir_get_vreg_type(current_function, value.vreg);
+    int to = ir_builder_type(datatype);
+    if(from == to || to == IR_TYPE_VOID){
+        return value.vreg;
+    }
+    if(ir_type_size(to) < ir_type_size(from)){
+        return ir_builder_unary_operation(IR_OP_TRUNC, to, value.vreg);
+    }
+    return ir_builder_unary_operation(is_ir_builder_unsigned(value.datatype) ? IR_OP_ZEXT : IR_OP_SEXT, to, value.vreg);
+}
+
+static IrInstruction* ir_builder_emit(int opcode, int type, bool has_result){
+    IrInstruction* instruction = ir_new_instruction(opcode, type, has_result ? ir_new_vreg(current_function, type) : IR_VREG_NONE);
+    ir_append_instruction(current_block, instruction);
+    return instruction;
+}
+
+static int ir_builder_constant(int type, long long value){
+    IrInstruction* constant = ir_builder_emit(IR_OP_CONST, type, true);
+    constant->immediate = ir_truncate_constant(type, value);
+    ir_builder_remember_constant(constant);
+    return constant->result;
+}
+
+static int ir_builder_unary_operation(int opcode, int type, int operand){
+    IrInstruction* instruction = ir_builder_emit(opcode, type, true);
+    instruction->operands[0] = operand;
+    return ir_builder_fold(instruction);
+}
+
+static int ir_builder_binary_operation(int opcode, int type, int left, int right){
+    IrInstruction* instruction = ir_builder_emit(opcode, type, true);
+    instruction->operands[0] = left;
+    instruction->operands[1] = right;
+    return ir_builder_fold(instruction);
+}
+
+// Expression trees whose leaves are constants, eg: 60 * 60 * 24 or sizeof(struct book) * 4, become a single constant while they are lowered. Folding the instructions rather than the nodes applies the C conversions the lowering made explicit.
+static int ir_builder_fold(IrInstruction* instruction){
+    long long left = 0;
+    long long right = 0;
+    long long value = 0;
+    bool is_right_constant = instruction->operands[1] == IR_VREG_NONE || ir_builder_constant_value(instruction->operands[1], &right);
+    if(ir_builder_constant_value(instruction->operands[0], &left) && is_right_constant && ir_fold_instruction(current_function, instruction, left, right, &value)){
+        ir_make_constant(instruction, value);
+        ir_builder_remember_constant(instruction);
+    }
+    return instruction->result;
+}
+
+static bool ir_builder_constant_value(int vreg, long long* value_out){
+    if(vreg == IR_VREG_NONE || vreg >= get_element_count(ir_builder_constants) || !vector_IrInstructionPtr_at(ir_builder_constants, vreg)){
+        return false;
+    }
+    *value_out = vector_IrInstructionPtr_at(ir_builder_constants, vreg)->immediate;
+    return true;
+}
+
+static void ir_builder_remember_constant(IrInstruction* constant){
+    while(get_element_count(ir_builder_constants) <= constant->result){
+        vector_IrInstructionPtr_push(ir_builder_constants, NULL);
+    }
+    *vector_IrInstructionPtr_at_pointer(ir_builder_constants, constant->result) = constant;
+}
+
+// Every access gets its own address instruction, so promoting the slot only has to look at the users of each.
+static int ir_builder_slot_address(int slot){
+    IrInstruction* address = ir_builder_emit(IR_OP_SLOT_ADDRESS, IR_TYPE_I64, true);
+    address->slot = slot;
+    return address->result;
+}
+
+static int ir_builder_global_address(const char* symbol){
+    IrInstruction* address = ir_builder_emit(IR_OP_GLOBAL_ADDRESS, IR_TYPE_I64, true);
+    address->symbol = symbol;
+    return address->result;
+}
+
+static void ir_builder_store(int address, int value){
+    IrInstruction* store = ir_builder_emit(IR_OP_STORE, ir_get_vreg_type(current_function, value), false);
+    store->operands[0] = address;
+    store->operands[1] = value;
+}
+
+// Ends the current block with a jump, unless it already ended.
+static void ir_builder_jump(IrBlock* target){
+    if(ir_get_terminator(current_block)){
+        return;
+    }
+    IrInstruction* jump = ir_builder_emit(IR_OP_JUMP, IR_TYPE_VOID, false);
+    jump->targets[0] = target;
+}
+
+// A branch on a constant is a jump, the block not taken is removed with the other unreachable ones.
+static void ir_builder_branch(int condition, IrBlock* true_block, IrBlock* false_block){
+    long long value = 0;
+    if(ir_builder_constant_value(condition, &value)){
+        ir_builder_jump(value ? true_block : false_block);
+        return;
+    }
+    IrInstruction* branch = ir_builder_emit(IR_OP_BRANCH, IR_TYPE_VOID, false);
+    branch->operands[0] = condition;
+    branch->targets[0] = true_block;
+    branch->targets[1] = false_block;
+}
+
+static IrBlock* ir_builder_new_block(){
+    return ir_new_block(current_function);
+}
+
+// Continues in the block without a jump from the current one.
+static void ir_builder_set_block(IrBlock* block){
+    vector_IrBlockPtr_push(ir_builder_layout, block);
+    current_block = block;
+}
+
+// Continues in the block, the current one falls through into it.
+static void ir_builder_start_block(IrBlock* block){
+    ir_builder_jump(block);
+    ir_builder_set_block(block);
+}
+
+// The statements after a return, break, continue or goto go to a block only a label can make reachable.
+static void ir_builder_start_unreachable_block(){
+    ir_builder_set_block(ir_builder_new_block());
+}
+
+// The IR type of a value of the datatype, arrays, structs and unions are their address.
+static int ir_builder_type(DataType* datatype){
+    if(is_ir_builder_aggregate(datatype)){
+        return IR_TYPE_I64;
+    }
+    if(is_ir_builder_void(datatype)){
+        return IR_TYPE_VOID;
+    }
+    int type = ir_type_for_size(ir_builder_value_size(datatype));
+    if(type == IR_TYPE_VOID){
+        compiler_error(current_process, "values of %zu bytes are not supported", ir_builder_value_size(datatype));
+    }
+    return type;
+}
+
+static DataType* ir_builder_primitive_datatype(int type, size_t size, bool is_signed){
+    DataType datatype = {.type = type, .size = size, .flags = is_signed ? DATATYPE_FLAG_IS_SIGNED : 0};
+    return intern_datatype(current_process, &datatype);
+}
+
+static DataType* ir_builder_int_datatype(){
+    return ir_builder_primitive_datatype(DATA_TYPE_INT, current_process->target->int_size, true);
+}
+
+static DataType* ir_builder_long_datatype(){
+    return ir_builder_primitive_datatype(DATA_TYPE_LONG, current_process->target->long_size, true);
+}
+
+static DataType* ir_builder_char_pointer_datatype(){
+    return get_datatype_pointer_to(current_process, ir_builder_primitive_datatype(DATA_TYPE_CHAR, current_process->target->char_size, true));
+}
+
+// Integer promotion, types narrower than int are widened to int.
+static DataType* ir_builder_promote(DataType* datatype){
+    if(is_ir_builder_pointer(datatype) || ir_builder_value_size(datatype) >= current_process->target->int_size){
+        return datatype;
+    }
+    return ir_builder_int_datatype();
+}
+
+// The common type of a binary operation, the wider of the two promoted types, unsigned if the wider one is.
+static DataType* ir_builder_usual_arithmetic_type(DataType* left_type, DataType* right_type){
+    left_type = ir_builder_promote(left_type);
+    right_type = ir_builder_promote(right_type);
+    size_t left_size = ir_builder_value_size(left_type);
+    size_t right_size = ir_builder_value_size(right_type);
+    size_t size = left_size > right_size ? left_size : right_size;
+    bool is_unsigned = (is_ir_builder_unsigned(left_type) && left_size == size) || (is_ir_builder_unsigned(right_type) && right_size == size);
+    if(size >= 8){
+        return ir_builder_primitive_datatype(DATA_TYPE_LONG, current_process->target->long_size, !is_unsigned);
+    }
+    return ir_builder_primitive_datatype(DATA_TYPE_INT, current_process->target->int_size, !is_unsigned);
+}
+
+static bool is_ir_builder_pointer(DataType* datatype){
+    return datatype->flags & DATATYPE_FLAG_IS_ARRAY || (datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0);
+}
+
+// Values of these types are represented by their address.
+static bool is_ir_builder_aggregate(DataType* datatype){
+    return datatype->flags & DATATYPE_FLAG_IS_ARRAY || (is_datatype_struct_or_union(datatype) && !(datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0));
+}
+
+static bool is_ir_builder_unsigned(DataType* datatype){
+    return is_ir_builder_pointer(datatype) || !(datatype->flags & DATATYPE_FLAG_IS_SIGNED);
+}
+
+static bool is_ir_builder_void(DataType* datatype){
+    return datatype->type == DATA_TYPE_VOID && !is_ir_builder_pointer(datatype);
+}
+
+// The number of bytes a value of the datatype takes in a register, arrays decay to a pointer.
+static size_t ir_builder_value_size(DataType* datatype){
+    if(is_ir_builder_pointer(datatype)){
+        return current_process->target->pointer_size;
+    }
+    return get_datatype_size(current_process, datatype);
+}
+
+// The size of the object a pointer or array points to, void pointers step by one byte.
+static size_t ir_builder_element_size(DataType* datatype){
+    size_t size = get_datatype_size(current_process, get_datatype_element(current_process, datatype));
+    return size ? size : 1;
+}
+
+static void ir_builder_reject_floating_point(DataType* datatype){
+    if((datatype->type == DATA_TYPE_FLOAT || datatype->type == DATA_TYPE_DOUBLE) && !is_ir_builder_pointer(datatype)){
+        compiler_error(current_process, "floating point types are not supported by the x86-64 backend yet");
+    }
+}
+
+// Calls the visitor for the node and, if it returns true, for every statement nested inside it.
+static void ir_builder_visit_statements(Node* node, IR_BUILDER_STATEMENT_VISITOR visitor, void* private_data){
+    if(!node || !visitor(node, private_data)){
+        return;
+    }
+    switch(node->type){
+        case NODE_TYPE_BODY:
+            vector_for_each(Node*, statement_node, node->data.body.statements){
+                ir_builder_visit_statements(*statement_node, visitor, private_data);
+            }
+            break;
+        case NODE_TYPE_STATEMENT_IF:
+            ir_builder_visit_statements(node->data.statement.statement_if.body_node, visitor, private_data);
+            ir_builder_visit_statements(node->data.statement.statement_if.else_body_node, visitor, private_data);
+            break;
+        case NODE_TYPE_STATEMENT_ELSE:
+            ir_builder_visit_statements(node->data.statement.statement_else.body_node, visitor, private_data);
+            break;
+        case NODE_TYPE_STATEMENT_WHILE:
+            ir_builder_visit_statements(node->data.statement.statement_while.body_node, visitor, private_data);
+            break;
+        case NODE_TYPE_STATEMENT_DO_WHILE:
+            ir_builder_visit_statements(node->data.statement.statement_do_while.body_node, visitor, private_data);
+            break;
+        case NODE_TYPE_STATEMENT_FOR:
+            ir_builder_visit_statements(node->data.statement.statement_for.body_node, visitor, private_data);
+            break;
+        case NODE_TYPE_STATEMENT_SWITCH:
+            ir_builder_visit_statements(node->data.statement.statement_switch.body_node, visitor, private_data);
+            break;
+    }
+}
+
+// Collects the case labels belonging to a switch, a nested switch owns its own cases.
+static bool ir_builder_collect_case(Node* node, void* private_data){
+    DynamicVector* case_nodes = private_data;
+    if(node->type == NODE_TYPE_STATEMENT_CASE){
+        vector_NodePtr_push(case_nodes, node);
+    }
+    return node->type != NODE_TYPE_STATEMENT_SWITCH;
+}
+
+// Call arguments are parsed as one comma expression whose shape depends on the reordering, a comma operator inside an argument is always wrapped in parentheses.
+static void ir_builder_flatten_arguments(Node* node, DynamicVector* arguments){
+    if(!node || node->type == NODE_TYPE_BLANK){
+        return;
+    }
+    if(node->type == NODE_TYPE_EXPRESSION && ARE_STRINGS_EQUAL(node->data.expression.operator, ",")){
+        ir_builder_flatten_arguments(node->data.expression.left, arguments);
+        ir_builder_flatten_arguments(node->data.expression.right, arguments);
+        return;
+    }
+    vector_NodePtr_push(arguments, node);
+}
@@ -23,6 +23,8 @@ LexProcess* create_lex_process(CompileProcess* compiler, LexProcessFunctions* fu
     lex_process->token_vector = create_vector(sizeof(Token));
     lex_process->compiler = compiler;
     lex_process->private_data = private_data;
+    lex_process->scratch_buffer = create_buffer_with_capacity(BUFFER_SMALL_INITIAL_SIZE);
+    lex_process->string_pool = create_string_pool();
     lex_process->position.file_name = compiler->input_file.absolute_path;
     lex_process->position.line = 1; 
     lex_process->position.column = 1;
@@ -31,12 +33,14 @@ LexProcess* create_lex_process(CompileProcess* compiler, LexProcessFunctions* fu
 /*
 * @fn void free_lex_process(LexProcess* lex_process)
 * @brief Frees a lex process
-* @details Frees the allocated memory for the lexical analysis process.
+* @details Frees the allocated memory for the lexical analysis process, including the string pool the token text lives in.
 * @param lex_process The lex process
 * @return void
 */
 void free_lex_process(LexProcess* lex_process){
     destroy_vector(lex_process->token_vector);
+    free_buffer(lex_process->scratch_buffer);
+    free_string_pool(lex_process->string_pool);
     free(lex_process);
 }
 /*
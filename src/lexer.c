@@ -48,10 +48,11 @@ static Token* make_token_given_number();
 /*
 * @unsigned long long read_number()
 * @brief Reads a number
-* @details Reads a numeric string representation using read_number_string() and converts it to an unsigned long long using atoll(), which may cause undefined behavior for negative numbers or values exceeding unsigned long long limits.
+* @details Reads a numeric string representation using read_number_string() and converts it to an unsigned long long, a leading 0 makes it octal. Values exceeding unsigned long long saturate.
+* @param number_flags Receives NUMBER_FLAG_IS_NOT_DECIMAL for octal numbers
 * @return The number
 */
-unsigned long long read_number();
+unsigned long long read_number(int* number_flags);
 /*
 * @fn static char next_char()
 * @brief Gets the next character
@@ -77,13 +78,14 @@ static char next_char();
 */
 const char* read_number_string();
 /*
-* @fn Token* make_token_given_number_as_value(unsigned long number)
+* @fn Token* make_token_given_number_as_value(unsigned long long number, int number_flags)
 * @brief Makes a token given a number as a value
-* @details Creates a numeric token with the given number value, determining its type based on the next character in the input stream, and advances the lexer if the number has a special type.
+* @details Creates a numeric token with the given number value, determining its type based on the suffix that follows in the input stream, and advances the lexer past the suffix.
 * @param number The number
+* @param number_flags NUMBER_FLAG_IS_NOT_DECIMAL for hexadecimal, octal and binary numbers, the suffix adds NUMBER_FLAG_IS_UNSIGNED
 * @return The token
 */
-Token* make_token_given_number_as_value(unsigned long number);
+Token* make_token_given_number_as_value(unsigned long long number, int number_flags);
 /*
 * @var static Token temporary_token
 * @brief The temporary token
@@ -376,6 +378,29 @@ void lexer_string_buffer_push_char(LexProcess* lex_process, char character);
 * @return The number type
 */
 int lexer_number_type(char character);
+/*
+* @fn static int lexer_read_integer_suffix(int* number_flags)
+* @brief Reads the suffix of an integer literal
+* @details Consumes u or U and l, L, ll or LL in either order, eg: 10ul and 10LLU.
+* @param number_flags Receives NUMBER_FLAG_IS_UNSIGNED for a u suffix
+* @return NUMBER_TYPE_NORMAL_INT, NUMBER_TYPE_LONG or NUMBER_TYPE_LONG_LONG
+*/
+static int lexer_read_integer_suffix(int* number_flags);
+/*
+* @fn static BufferType* lexer_begin_string()
+* @brief Starts reading the text of a token
+* @details Empties and returns the scratch buffer of the lex process, so reading a token does not allocate.
+* @return The scratch buffer
+*/
+static BufferType* lexer_begin_string();
+/*
+* @fn static char* lexer_finish_string(BufferType* buffer)
+* @brief Finishes reading the text of a token
+* @details Copies the text read into the scratch buffer into the string pool of the lex process at its exact length, so the memory used by a lexed file is proportional to its text.
+* @param buffer The scratch buffer returned by lexer_begin_string()
+* @return The null terminated pooled copy of the text
+*/
+static char* lexer_finish_string(BufferType* buffer);
 
 int lex(LexProcess* lex_process){
     lex_process->current_expression_count = 0;
@@ -385,7 +410,7 @@ int lex(LexProcess* lex_process){
 
     Token* token = read_next_token();
     while(token){
-        push_element(lex_process->token_vector, token);
+        vector_Token_push(lex_process->token_vector, *token);
         token = read_next_token();
     }
     // print_token_vector(lex_process->token_vector);
@@ -446,12 +471,18 @@ static char peek_char(){
 
 static Token* make_token_given_number(){
     //any type of number!
-    return make_token_given_number_as_value(read_number());
+    int number_flags = 0;
+    unsigned long long number = read_number(&number_flags);
+    return make_token_given_number_as_value(number, number_flags);
 }
 
-unsigned long long read_number(){
+unsigned long long read_number(int* number_flags){
     const char* number_string = read_number_string();
-    return atoll(number_string);
+    if(number_string[0] == '0' && number_string[1] != 0x00){
+        *number_flags |= NUMBER_FLAG_IS_NOT_DECIMAL;
+        return strtoull(number_string, NULL, 8);
+    }
+    return strtoull(number_string, NULL, 10);
 }
 
 static char next_char(){
@@ -473,28 +504,63 @@ static char next_char(){
         next_char(); \
     }
 
+static BufferType* lexer_begin_string(){
+    reset_buffer(ptr_to_lex_process->scratch_buffer);
+    return ptr_to_lex_process->scratch_buffer;
+}
+
+static char* lexer_finish_string(BufferType* buffer){
+    return string_pool_copy(ptr_to_lex_process->string_pool, get_buffer_memory_pointer(buffer), buffer->current_length);
+}
+
 const char* read_number_string(){
-    const char* number = NULL;
-    BufferType* buffer = create_buffer();
+    BufferType* buffer = lexer_begin_string();
     char character = peek_char();
     LEX_GETCHAR_IF(buffer, character, (character >= '0' && character <= '9'));
-    append_character_to_buffer(buffer, 0x00); //null terminate the string
+    append_character_to_buffer(buffer, 0x00); //null terminate the string, the number is converted straight away so it stays in the scratch buffer
     return get_buffer_memory_pointer(buffer);    
 }
 
 
-Token* make_token_given_number_as_value(unsigned long number){
+Token* make_token_given_number_as_value(unsigned long long number, int number_flags){
     int number_type = lexer_number_type(peek_char());
-    if(number_type!=NUMBER_TYPE_NORMAL_INT){
+    if(number_type == NUMBER_TYPE_FLOAT || number_type == NUMBER_TYPE_DOUBLE){
         next_char();
     }
+    else{
+        number_type = lexer_read_integer_suffix(&number_flags);
+    }
     return create_token(&(Token){
         .type = TOKEN_TYPE_NUMBER,
         .value.long_long_num = number,
         .Number.type = number_type,
+        .Number.flags = number_flags,
     });
 }
 
+static int lexer_read_integer_suffix(int* number_flags){
+    int number_type = NUMBER_TYPE_NORMAL_INT;
+    char previous_character = 0x00;
+    for(char character = peek_char(); ; character = peek_char()){
+        if((character == 'u' || character == 'U') && !(*number_flags & NUMBER_FLAG_IS_UNSIGNED)){
+            *number_flags |= NUMBER_FLAG_IS_UNSIGNED;
+        }
+        else if((character == 'l' || character == 'L') && number_type == NUMBER_TYPE_NORMAL_INT){
+            number_type = NUMBER_TYPE_LONG;
+        }
+        //ll and LL, the two letters must match and be adjacent
+        else if(character == previous_character && number_type == NUMBER_TYPE_LONG){
+            number_type = NUMBER_TYPE_LONG_LONG;
+        }
+        else{
+            break;
+        }
+        previous_character = character;
+        next_char();
+    }
+    return number_type;
+}
+
 static Token temporary_token;
 
 Token* create_token(Token* token){
@@ -520,7 +586,7 @@ static Token* handle_whitespace() {
 }
 
 static Token* lexer_last_token(){
-    return get_last_element_or_null(ptr_to_lex_process->token_vector);
+    return vector_Token_at_pointer(ptr_to_lex_process->token_vector, get_element_count(ptr_to_lex_process->token_vector) - 1);
 }
 
 static Token* handle_newline(){
@@ -567,21 +633,20 @@ void print_token(Token* token){
 }
 
 static Token* make_token_given_string(char start_delimiter, char end_delimiter){
-    BufferType* buffer = create_buffer();
+    BufferType* buffer = lexer_begin_string();
     assert(next_char() == start_delimiter);
     char character = next_char();
     while(character != end_delimiter && character != EOF){
         if(character == '\\'){
             //handle escape characters
-            continue;
+            character = lex_get_escape_character(next_char());
         }
         append_character_to_buffer(buffer, character);
         character = next_char();
     }
-    append_character_to_buffer(buffer, 0x00); //null terminate the string
     return create_token(&(Token){
         .type = TOKEN_TYPE_STRING,
-        .value.string_val = get_buffer_memory_pointer(buffer),
+        .value.string_val = lexer_finish_string(buffer),
     });
 }
 
@@ -606,7 +671,7 @@ static Token* make_token_given_operator_or_string(){
 
 const char* read_operator() {
     char character = next_char();
-    BufferType* buffer = create_buffer();
+    BufferType* buffer = lexer_begin_string();
     append_character_to_buffer(buffer, character);
 
     // Peek at the next character to check for multi-character operators
@@ -615,6 +680,10 @@ const char* read_operator() {
     if (is_single_operator(next_character)) {  // Check if the next char is also an operator
         append_character_to_buffer(buffer, next_character);
         next_char();  // Consume it
+        // <<= and >>= are the only three character operators read here
+        if ((character == '<' || character == '>') && next_character == character && peek_char() == '=') {
+            append_character_to_buffer(buffer, next_char());
+        }
     }
 
     append_character_to_buffer(buffer, 0x00);  // Null-terminate
@@ -626,7 +695,7 @@ const char* read_operator() {
         operator[1] = 0x00;
     }
 
-    return operator;
+    return string_pool_copy(ptr_to_lex_process->string_pool, operator, strlen(operator));
 }
 
 
@@ -667,6 +736,8 @@ static bool is_operator_valid(const char* op) {
            ARE_STRINGS_EQUAL(op, "+=")  || ARE_STRINGS_EQUAL(op, "-=")  ||
            ARE_STRINGS_EQUAL(op, "*=")  || ARE_STRINGS_EQUAL(op, "/=")  ||
            ARE_STRINGS_EQUAL(op, "%=")  || ARE_STRINGS_EQUAL(op, "==")  ||
+           ARE_STRINGS_EQUAL(op, "&=")  || ARE_STRINGS_EQUAL(op, "|=")  ||
+           ARE_STRINGS_EQUAL(op, "^=")  ||
            ARE_STRINGS_EQUAL(op, "!=")  || ARE_STRINGS_EQUAL(op, "&&")  ||
            ARE_STRINGS_EQUAL(op, "||")  || ARE_STRINGS_EQUAL(op, "++")  ||
            ARE_STRINGS_EQUAL(op, "--")  || ARE_STRINGS_EQUAL(op, "<<")  ||
@@ -725,19 +796,19 @@ static Token* make_token_given_symbol(){
 }
 
 Token* make_token_given_identifier_or_keyword(){
-    BufferType* buffer = create_buffer();
+    BufferType* buffer = lexer_begin_string();
     char character = 0;
     LEX_GETCHAR_IF(buffer, character, (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') || character == '_');
-    append_character_to_buffer(buffer, 0x00); //null terminate the string
-    if(is_keyword(get_buffer_memory_pointer(buffer))){
+    const char* string = lexer_finish_string(buffer);
+    if(is_keyword(string)){
         return create_token(&(Token){
             .type = TOKEN_TYPE_KEYWORD,
-            .value.string_val = get_buffer_memory_pointer(buffer),
+            .value.string_val = string,
         });
     }
     return create_token(&(Token){
         .type = TOKEN_TYPE_IDENTIFIER,
-        .value.string_val = get_buffer_memory_pointer(buffer),
+        .value.string_val = string,
     });
 }
 
@@ -755,17 +826,17 @@ bool is_keyword(const char* keyword){
 }
 
 Token* make_token_given_one_line_comment(){
-    BufferType* buffer = create_buffer();
+    BufferType* buffer = lexer_begin_string();
     char character = 0;
     LEX_GETCHAR_IF(buffer, character, character != '\n' && character != EOF);
     return create_token(&(Token){
         .type = TOKEN_TYPE_COMMENT,
-        .value.string_val = get_buffer_memory_pointer(buffer),
+        .value.string_val = lexer_finish_string(buffer),
     });
 }
 
 Token* make_token_given_multi_line_comment(){
-    BufferType* buffer = create_buffer();
+    BufferType* buffer = lexer_begin_string();
     char character = 0;
     while(true){
         LEX_GETCHAR_IF(buffer, character, character != '*' && character != EOF);
@@ -782,7 +853,7 @@ Token* make_token_given_multi_line_comment(){
     }
     return create_token(&(Token){
         .type = TOKEN_TYPE_COMMENT,
-        .value.string_val = get_buffer_memory_pointer(buffer),
+        .value.string_val = lexer_finish_string(buffer),
     });
 }
 
@@ -839,6 +910,15 @@ const char lex_get_escape_character(char character){
         case '\'':
             co = '\'';
             break;
+        case '"':
+            co = '"';
+            break;
+        case 'r':
+            co = '\r';
+            break;
+        case '0':
+            co = '\0';
+            break;
     }
     return co; 
 }
@@ -852,7 +932,8 @@ static char assert_next_char(char expected){
 Token* make_token_given_special_number(){
     Token* token = NULL;
     Token* last_token = lexer_last_token();
-    if(!last_token || !(last_token->type == TOKEN_TYPE_OPERATOR && last_token->value.long_long_num == 0)){
+    //the 0 of the prefix was already lexed as a number token
+    if(!last_token || !(last_token->type == TOKEN_TYPE_NUMBER && last_token->value.long_long_num == 0)){
         return make_token_given_identifier_or_keyword();
     }
     lexer_pop_last_token();
@@ -863,6 +944,7 @@ Token* make_token_given_special_number(){
     else if(character == 'b'){
         token = make_token_given_special_number_binary();
     }
+    return token;
 }
 
 void lexer_pop_last_token(){
@@ -871,17 +953,13 @@ void lexer_pop_last_token(){
 
 Token* make_token_given_special_number_hexadecimal(){
     next_char();
-    unsigned long number = 0;
     const char* number_string = read_hex_number_string();
-    number = strtol(number_string, NULL, 16);
-    return create_token(&(Token){
-        .type = TOKEN_TYPE_NUMBER,
-        .value.long_long_num = number,
-    });
+    unsigned long long number = strtoull(number_string, NULL, 16);
+    return make_token_given_number_as_value(number, NUMBER_FLAG_IS_NOT_DECIMAL);
 }
 
 const char* read_hex_number_string(){
-    BufferType* buffer = create_buffer();
+    BufferType* buffer = lexer_begin_string();
     char character = peek_char();
     LEX_GETCHAR_IF(buffer, character, is_hex_character(character));
     append_character_to_buffer(buffer, 0x00); //null terminate the string
@@ -894,11 +972,10 @@ bool is_hex_character(char character){
 
 Token* make_token_given_special_number_binary(){
     next_char();
-    unsigned long number = 0;
     const char* number_string = read_number_string();
     validate_binary_number(number_string);
-    number = strtol(number_string, NULL, 2);
-    return make_token_given_number_as_value(number);
+    unsigned long long number = strtoull(number_string, NULL, 2);
+    return make_token_given_number_as_value(number, NUMBER_FLAG_IS_NOT_DECIMAL);
 }
 
 void validate_binary_number(const char* number_string){
@@ -912,7 +989,7 @@ void validate_binary_number(const char* number_string){
 // Converts an input string into tokens for lexical analysis, similar to yy_scan_string in Flex.
 LexProcess* build_tokens_for_string(CompileProcess* compiler, const char* string){ //equivalent to yy_scan_string in flex
     BufferType* buffer = create_buffer();
-    append_formatted_text(buffer, string);
+    append_string_to_buffer(buffer, string);
     LexProcess* lex_process = create_lex_process(compiler, &lexer_string_buffer_functions, buffer);
     if(!lex_process){
         return NULL;
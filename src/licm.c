@@ -0,0 +1,186 @@
+/*
+* @file licm.c
+* @brief Loop invariant code motion
+* @details Every natural loop gets a preheader, see loop.c. Instructions of the loop that compute the same value on every iteration then move to the end of the preheader, innermost loops first so that what leaves an inner loop can leave the outer one as well. Moving an instruction out of a conditional part of the loop runs it even when that part doesn't, so only instructions that can't trap move: pure computations, divisions by constants other than 0 and -1, and loads from within the bounds of a stack slot or at the start of a global which no store, memory copy or call in the loop may write to. Calls are never moved, the IR doesn't know which functions are pure.
+*/
+
+#include "compiler.h"
+
+typedef struct Licm{
+    IrFunction* function;
+    bool* body; //indexed by block id, whether the block belongs to the current loop
+    bool* invariant; //indexed by register, whether its definition was moved to the preheader
+    bool* escaped_slots;
+} Licm;
+
+void ir_hoist_loop_invariants(IrFunction* function);
+
+static void licm_hoist_loop(Licm* licm, IrBlock* header, IrBlock* preheader);
+
+static bool is_licm_invariant(Licm* licm, IrInstruction* instruction);
+
+static bool is_licm_operand_invariant(Licm* licm, int vreg);
+
+static bool is_licm_safe_division(Licm* licm, IrInstruction* instruction);
+
+static bool is_licm_safe_load(Licm* licm, IrInstruction* load);
+
+static bool is_licm_written(Licm* licm, IrInstruction* load, IrAddress address);
+
+
+
+void ir_hoist_loop_invariants(IrFunction* function){
+    DynamicVector* headers = ir_find_loop_headers(function);
+    if(is_vector_empty(headers)){
+        destroy_vector(headers);
+        return;
+    }
+    Licm licm = {.function = function};
+    vector_for_each(IrBlock*, header, headers){
+        //the previous loop may have added a preheader and moved instructions
+        ir_compute_cfg(function);
+        ir_compute_dominators(function);
+        ir_compute_def_use(function);
+        licm.body = calloc(function->next_block_id + 1, sizeof(bool));
+        ir_find_loop_body(*header, licm.body);
+        IrBlock* preheader = ir_make_preheader(function, *header, licm.body);
+        if(preheader){
+            licm.invariant = calloc(ir_get_vreg_count(function) + 1, sizeof(bool));
+            licm.escaped_slots = ir_find_escaped_slots(function);
+            licm_hoist_loop(&licm, *header, preheader);
+            free(licm.invariant);
+            free(licm.escaped_slots);
+        }
+        free(licm.body);
+    }
+    destroy_vector(headers);
+    ir_compute_cfg(function);
+    ir_compute_dominators(function);
+    ir_compute_def_use(function);
+}
+
+// Walks the loop in reverse postorder, so the definitions of the operands are visited before their uses, and moves the invariant instructions to the end of the preheader in that order.
+static void licm_hoist_loop(Licm* licm, IrBlock* header, IrBlock* preheader){
+    DynamicVector* order = licm->function->reverse_postorder;
+    for(int i = header->order; i < get_element_count(order); i++){
+        IrBlock* block = vector_IrBlockPtr_at(order, i);
+        if(!licm->body[block->id]){
+            continue;
+        }
+        DynamicVector* instructions = block->instructions;
+        for(int j = 0; j < get_element_count(instructions); j++){
+            IrInstruction* instruction = vector_IrInstructionPtr_at(instructions, j);
+            if(!is_licm_invariant(licm, instruction)){
+                continue;
+            }
+            remove_element_at(instructions, j);
+            j--;
+            ir_insert_instruction(preheader, get_element_count(preheader->instructions) - 1, instruction);
+            licm->invariant[instruction->result] = true;
+        }
+    }
+}
+
+static bool is_licm_invariant(Licm* licm, IrInstruction* instruction){
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        if(!is_licm_operand_invariant(licm, instruction->operands[i])){
+            return false;
+        }
+    }
+    switch(instruction->opcode){
+        case IR_OP_CONST:
+        case IR_OP_SLOT_ADDRESS:
+        case IR_OP_GLOBAL_ADDRESS:
+        case IR_OP_ADD:
+        case IR_OP_SUB:
+        case IR_OP_MUL:
+        case IR_OP_AND:
+        case IR_OP_OR:
+        case IR_OP_XOR:
+        case IR_OP_SHL:
+        case IR_OP_SAR:
+        case IR_OP_SHR:
+        case IR_OP_NEG:
+        case IR_OP_NOT:
+        case IR_OP_CMP:
+        case IR_OP_SEXT:
+        case IR_OP_ZEXT:
+        case IR_OP_TRUNC:
+            return true;
+        case IR_OP_SDIV:
+        case IR_OP_UDIV:
+        case IR_OP_SREM:
+        case IR_OP_UREM:
+            return is_licm_safe_division(licm, instruction);
+        case IR_OP_LOAD:
+            return is_licm_safe_load(licm, instruction);
+    }
+    return false;
+}
+
+static bool is_licm_operand_invariant(Licm* licm, int vreg){
+    if(vreg == IR_VREG_NONE || licm->invariant[vreg]){
+        return true;
+    }
+    IrInstruction* definition = vector_IrInstructionPtr_at(licm->function->definitions, vreg);
+    return definition && !licm->body[definition->block->id];
+}
+
+// Only a constant divisor rules out the trap, -1 traps on the smallest signed dividend.
+static bool is_licm_safe_division(Licm* licm, IrInstruction* instruction){
+    IrInstruction* divisor = vector_IrInstructionPtr_at(licm->function->definitions, instruction->operands[1]);
+    if(!divisor || divisor->opcode != IR_OP_CONST || !divisor->immediate){
+        return false;
+    }
+    bool is_signed = instruction->opcode == IR_OP_SDIV || instruction->opcode == IR_OP_SREM;
+    return !is_signed || divisor->immediate != -1;
+}
+
+// The address has to be readable wherever the preheader runs, which is known for the inside of a stack slot and the start of a global.
+static bool is_licm_safe_load(Licm* licm, IrInstruction* load){
+    IrAddress address = ir_resolve_address(licm->function, load->operands[0]);
+    if(!address.base || !address.is_offset_known){
+        return false;
+    }
+    if(address.base->opcode == IR_OP_SLOT_ADDRESS){
+        IrStackSlot* slot = get_element_at(licm->function->slots, address.base->slot);
+        if(address.offset < 0 || address.offset + ir_type_size(load->type) > (long long)slot->size){
+            return false;
+        }
+    }
+    else if(address.base->flags & IR_INSTRUCTION_FLAG_STRING_LITERAL || address.offset + address.base->immediate != 0){
+        return false;
+    }
+    return !is_licm_written(licm, load, address);
+}
+
+// Whether an instruction of the loop may change what the load reads. A call may write to everything but the slots whose address never escaped.
+static bool is_licm_written(Licm* licm, IrInstruction* load, IrAddress address){
+    IrFunction* function = licm->function;
+    size_t size = ir_type_size(load->type);
+    vector_for_each(IrBlock*, block, function->blocks){
+        if(!licm->body[(*block)->id]){
+            continue;
+        }
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            switch((*instruction)->opcode){
+                case IR_OP_STORE:
+                    if(ir_may_alias(function, licm->escaped_slots, (*instruction)->operands[0], ir_type_size((*instruction)->type), load->operands[0], size)){
+                        return true;
+                    }
+                    break;
+                case IR_OP_MEMCOPY:
+                    if(ir_may_alias(function, licm->escaped_slots, (*instruction)->operands[0], (*instruction)->immediate, load->operands[0], size)){
+                        return true;
+                    }
+                    break;
+                case IR_OP_CALL:
+                    if(!is_ir_private_slot(licm->escaped_slots, address.base)){
+                        return true;
+                    }
+                    break;
+            }
+        }
+    }
+    return false;
+}
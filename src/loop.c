@@ -0,0 +1,154 @@
+/*
+* @file loop.c
+* @brief Natural loops of the control flow graph
+* @details A back edge goes from a block to a block dominating it, the header of a natural loop. The loop is the header and every block reaching the back edge without passing through the header, several back edges into one header make one loop. The loop passes give every loop a preheader, a block outside it that continues at the header and through which every edge entering the loop from outside goes, so that code can be placed where it runs once before the loop.
+*/
+
+#include "compiler.h"
+
+DynamicVector* ir_find_loop_headers(IrFunction* function);
+
+int ir_find_loop_body(IrBlock* header, bool* body);
+
+IrBlock* ir_make_preheader(IrFunction* function, IrBlock* header, bool* body);
+
+static void loop_merge_outside_incomings(IrFunction* function, IrBlock* header, IrBlock* preheader, DynamicVector* outside);
+
+
+
+DynamicVector* ir_find_loop_headers(IrFunction* function){
+    DynamicVector* headers = create_vector(sizeof(IrBlock*));
+    DynamicVector* sizes = create_vector(sizeof(int));
+    bool* body = calloc(function->next_block_id + 1, sizeof(bool));
+    IrBlock* entry = vector_IrBlockPtr_at(function->blocks, 0);
+    vector_for_each(IrBlock*, block, function->reverse_postorder){
+        bool is_header = false;
+        vector_for_each(IrBlock*, predecessor, (*block)->predecessors){
+            if(ir_block_dominates(*block, *predecessor)){
+                is_header = true;
+            }
+        }
+        if(!is_header || *block == entry){
+            continue;
+        }
+        memset(body, 0, (function->next_block_id + 1) * sizeof(bool));
+        int size = ir_find_loop_body(*block, body);
+        int index = get_element_count(headers);
+        while(index > 0 && vector_Int_at(sizes, index - 1) > size){
+            index--;
+        }
+        insert_element_at(headers, index, block);
+        insert_element_at(sizes, index, &size);
+    }
+    free(body);
+    destroy_vector(sizes);
+    return headers;
+}
+
+int ir_find_loop_body(IrBlock* header, bool* body){
+    DynamicVector* worklist = create_vector(sizeof(IrBlock*));
+    body[header->id] = true;
+    int size = 1;
+    vector_for_each(IrBlock*, predecessor, header->predecessors){
+        if(ir_block_dominates(header, *predecessor)){
+            vector_IrBlockPtr_push(worklist, *predecessor);
+        }
+    }
+    while(!is_vector_empty(worklist)){
+        IrBlock* block = vector_IrBlockPtr_pop(worklist);
+        if(body[block->id]){
+            continue;
+        }
+        body[block->id] = true;
+        size++;
+        vector_for_each(IrBlock*, predecessor, block->predecessors){
+            vector_IrBlockPtr_push(worklist, *predecessor);
+        }
+    }
+    destroy_vector(worklist);
+    return size;
+}
+
+IrBlock* ir_make_preheader(IrFunction* function, IrBlock* header, bool* body){
+    DynamicVector* outside = create_vector(sizeof(IrBlock*));
+    vector_for_each(IrBlock*, predecessor, header->predecessors){
+        if(!body[(*predecessor)->id]){
+            vector_IrBlockPtr_push(outside, *predecessor);
+        }
+    }
+    IrBlock* preheader = NULL;
+    if(get_element_count(outside) == 1 && get_element_count(vector_IrBlockPtr_at(outside, 0)->successors) == 1){
+        preheader = vector_IrBlockPtr_at(outside, 0);
+    }
+    else if(!is_vector_empty(outside)){
+        preheader = ir_new_block(function);
+        remove_last_element(function->blocks);
+        for(int i = 0; i < get_element_count(function->blocks); i++){
+            if(vector_IrBlockPtr_at(function->blocks, i) == header){
+                insert_element_at(function->blocks, i, &preheader);
+                break;
+            }
+        }
+        vector_for_each(IrBlock*, predecessor, outside){
+            IrInstruction* terminator = ir_get_terminator(*predecessor);
+            for(int i = 0; i < 2; i++){
+                if(terminator->targets[i] == header){
+                    terminator->targets[i] = preheader;
+                }
+            }
+        }
+        loop_merge_outside_incomings(function, header, preheader, outside);
+        IrInstruction* jump = ir_new_instruction(IR_OP_JUMP, IR_TYPE_VOID, IR_VREG_NONE);
+        jump->targets[0] = header;
+        ir_append_instruction(preheader, jump);
+        ir_compute_cfg(function);
+        ir_compute_dominators(function);
+        ir_compute_def_use(function);
+    }
+    destroy_vector(outside);
+    return preheader;
+}
+
+// The incomings of the header phis from outside the loop become one incoming from the preheader, through a phi in the preheader when they differ.
+static void loop_merge_outside_incomings(IrFunction* function, IrBlock* header, IrBlock* preheader, DynamicVector* outside){
+    vector_for_each(IrInstruction*, instruction, header->instructions){
+        IrInstruction* phi = *instruction;
+        if(phi->opcode != IR_OP_PHI){
+            break;
+        }
+        IrInstruction* merge = ir_new_instruction(IR_OP_PHI, phi->type, IR_VREG_NONE);
+        DynamicVector* incomings = phi->arguments;
+        for(int i = get_element_count(incomings) - 1; i >= 0; i--){
+            IrPhiIncoming incoming = *(IrPhiIncoming*)get_element_at(incomings, i);
+            bool is_outside = false;
+            vector_for_each(IrBlock*, predecessor, outside){
+                if(*predecessor == incoming.block){
+                    is_outside = true;
+                }
+            }
+            if(is_outside){
+                push_element(merge->arguments, &incoming);
+                remove_element_at(incomings, i);
+            }
+        }
+        if(is_vector_empty(merge->arguments)){
+            ir_free_instruction(merge);
+            continue;
+        }
+        IrPhiIncoming incoming = {.block = preheader, .vreg = ((IrPhiIncoming*)get_element_at(merge->arguments, 0))->vreg};
+        vector_for_each(IrPhiIncoming, merged, merge->arguments){
+            if(merged->vreg != incoming.vreg){
+                incoming.vreg = IR_VREG_NONE;
+            }
+        }
+        if(incoming.vreg == IR_VREG_NONE){
+            merge->result = ir_new_vreg(function, phi->type);
+            incoming.vreg = merge->result;
+            ir_append_instruction(preheader, merge);
+        }
+        else{
+            ir_free_instruction(merge);
+        }
+        push_element(incomings, &incoming);
+    }
+}
@@ -3,7 +3,24 @@
 
 int main(int argc, char** argv){
     printf("entering main\n");
-    int result = compile_file("./test/testMain.c", "./test/testMain", 0);
+    const char* files[2] = {"./test/testMain.c", "./test/testMain"};
+    int file_count = 0;
+    int flags = 0;
+    for(int i = 1; i < argc; i++){
+        if(ARE_STRINGS_EQUAL(argv[i], "--dump-ir")){
+            flags |= COMPILE_PROCESS_FLAG_DUMP_IR;
+        }
+        else if(ARE_STRINGS_EQUAL(argv[i], "--no-inline")){
+            flags |= COMPILE_PROCESS_FLAG_NO_INLINE;
+        }
+        else if(ARE_STRINGS_EQUAL(argv[i], "--dump-peephole")){
+            flags |= COMPILE_PROCESS_FLAG_DUMP_PEEPHOLE;
+        }
+        else if(file_count < 2){
+            files[file_count++] = argv[i];
+        }
+    }
+    int result = compile_file(files[0], files[1], flags);
     if(result==COMPILER_SUCCESS){
         printf("Compilation successful\n");
     }
@@ -21,20 +21,20 @@ void set_node_vectors(DynamicVector* vector, DynamicVector* root) {
 }
 
 void push_node(Node* node) {
-    push_element(node_vector, &node);
+    vector_NodePtr_push(node_vector, node);
 }
 
 Node* peek_node_or_null() {
-    return get_last_element_pointer_or_null(node_vector);
+    return vector_NodePtr_last_or(node_vector, NULL);
 }
 
 Node* peek_node() {
-    return get_last_element_pointer(node_vector);
+    return vector_NodePtr_last_or(node_vector, NULL);
 }
 
 Node* pop_node() {
-    Node* last_node = get_last_element_pointer(node_vector);
-    Node* last_node_root = is_vector_empty(node_vector_root) ? NULL : get_last_element_pointer_or_null(node_vector_root);
+    Node* last_node = vector_NodePtr_last_or(node_vector, NULL);
+    Node* last_node_root = vector_NodePtr_last_or(node_vector_root, NULL);
     remove_last_element(node_vector);
     if(last_node_root == last_node) { //so that we don't leave duplicates on the tree vector
         remove_last_element(node_vector_root);
@@ -76,11 +76,11 @@ void print_node(Node* node, int depth) {
             break;
         case NODE_TYPE_VARIABLE:
             //check if variable is array
-            if(node->data.var.data_type.flags & DATATYPE_FLAG_IS_ARRAY) {
-                printf("Node variable: %s (array) of size %li \n", node->data.var.name, array_brackets_calculate_size(&node->data.var.data_type, node->data.var.data_type.array.array_bracket));
-                for(int i = 0; i < node->data.var.data_type.array.array_bracket->n_brackets->element_count; i++) {
+            if(node->data.var.data_type->flags & DATATYPE_FLAG_IS_ARRAY) {
+                printf("Node variable: %s (array) of size %li \n", node->data.var.name, node->data.var.data_type->array.size);
+                for(int i = 0; i < node->data.var.data_type->array.array_bracket->n_brackets->element_count; i++) {
                     print_tabs(depth + 1);
-                    print_node(*(Node**)get_element_at(node->data.var.data_type.array.array_bracket->n_brackets, i), depth + 2);
+                    print_node(*(Node**)get_element_at(node->data.var.data_type->array.array_bracket->n_brackets, i), depth + 2);
                 }
             } else {
                 printf("Node variable: %s\n", node->data.var.name);
@@ -134,15 +134,16 @@ void print_node(Node* node, int depth) {
             break;
         case NODE_TYPE_STATEMENT_DO_WHILE:
             printf("Node do while\n");
-            print_node(node->data.statement.statement_while.condition_node, depth + 1);
-            print_node(node->data.statement.statement_while.body_node, depth + 1);
+            print_node(node->data.statement.statement_do_while.condition_node, depth + 1);
+            print_node(node->data.statement.statement_do_while.body_node, depth + 1);
             break;
         case NODE_TYPE_STATEMENT_SWITCH:
             printf("Node switch\n");
             print_node(node->data.statement.statement_switch.expression_node, depth + 1);
             print_node(node->data.statement.statement_switch.body_node, depth + 1);
-            for(int i = 0; i < node->data.statement.statement_switch.cases->element_count; i++) {
-                print_node(*(Node**)get_element_at(node->data.statement.statement_switch.cases, i), depth + 1);
+            vector_for_each(ParsedSwitchCase, parsed_case, node->data.statement.statement_switch.cases) {
+                print_tabs(depth + 1);
+                printf("Case value: %lld\n", parsed_case->index);
             }
             break;
         case NODE_TYPE_STATEMENT_CONTINUE:
@@ -163,15 +164,32 @@ void print_node(Node* node, int depth) {
             printf("Node case\n");
             print_node(node->data.statement.statement_switch_case.expression_node, depth + 1);
             break;
+        case NODE_TYPE_STATEMENT_DEFAULT:
+            printf("Node default\n");
+            break;
+        case NODE_TYPE_UNARY:
+            printf("Node unary: %s%s\n", node->data.unary.operator, node->data.unary.flags & UNARY_FLAG_IS_POSTFIX ? " (postfix)" : "");
+            print_node(node->data.unary.operand, depth + 1);
+            break;
         case NODE_TYPE_TERNARY:
             printf("Node ternary\n");
             print_node(node->data.tenary.true_expression, depth + 1);
             print_node(node->data.tenary.false_expression, depth + 1);
             break;
+        case NODE_TYPE_SIZEOF:
+            printf("Node sizeof\n");
+            if(node->data.size_of.data_type){
+                print_tabs(depth+1);
+                printf("Data type: %s\n", node->data.size_of.data_type->name);
+            }
+            else{
+                print_node(node->data.size_of.expression_node, depth + 1);
+            }
+            break;
         case NODE_TYPE_CAST:
             printf("Node cast\n");
             print_tabs(depth+1);
-            printf("Data type: %s\n", node->data.cast.data_type.name);
+            printf("Data type: %s\n", node->data.cast.data_type->name);
             print_node(node->data.cast.operand_node, depth + 1);
             break;
         case NODE_TYPE_STRUCT:
@@ -209,7 +227,7 @@ Node* peek_node_expressionable_or_null() {
 }
 
 bool is_node_expressionable(Node* node) {
-    return node && (node->type == NODE_TYPE_EXPRESSION || node->type == NODE_TYPE_EXPRESSION_PARENTHESES || node->type == NODE_TYPE_UNARY ||node->type == NODE_TYPE_IDENTIFIER || node->type == NODE_TYPE_NUMBER || node->type == NODE_TYPE_STRING);
+    return node && (node->type == NODE_TYPE_EXPRESSION || node->type == NODE_TYPE_EXPRESSION_PARENTHESES || node->type == NODE_TYPE_UNARY ||node->type == NODE_TYPE_IDENTIFIER || node->type == NODE_TYPE_NUMBER || node->type == NODE_TYPE_STRING || node->type == NODE_TYPE_CAST || node->type == NODE_TYPE_SIZEOF);
 }
 
 void make_expression_node(Node* left, Node* right, const char* operator) {
@@ -224,7 +242,7 @@ bool is_node_struct_or_union_variable(Node* node){
     if(node->type != NODE_TYPE_VARIABLE){
         return false;
     }
-    return is_datatype_struct_or_union(&node->data.var.data_type);
+    return is_datatype_struct_or_union(node->data.var.data_type);
 }
 
 Node* get_variable_node(Node* node){
@@ -245,7 +263,7 @@ Node* get_variable_node(Node* node){
 
 bool is_variable_node_primitive(Node* node){
     assert(node->type == NODE_TYPE_VARIABLE);
-    return is_datatype_primitive(&node->data.var.data_type);
+    return is_datatype_primitive(node->data.var.data_type);
 }
 
 Node* get_variable_node_or_list(Node* node){
@@ -289,8 +307,8 @@ Node* get_node_form_a_symbol(Symbol* symbol){
     return symbol->data;
 }
 
-void make_function_node(DataType* return_type, const char* name, DynamicVector* parameters, Node* body_node){
-    Node* function_node = create_node(&((Node){.type = NODE_TYPE_FUNCTION, .data.function.return_type = return_type, .data.function.name = name, .data.function.function_args = parameters, .data.function.body_node = body_node, .data.function.function_args.stack_addition = DATA_SIZE_DDWORD}));
+void make_function_node(CompileProcess* process, DataType* return_type, const char* name, DynamicVector* parameters, Node* body_node){
+    Node* function_node = create_node(&((Node){.type = NODE_TYPE_FUNCTION, .data.function.return_type = return_type, .data.function.name = name, .data.function.function_args = parameters, .data.function.body_node = body_node, .data.function.function_args.stack_addition = 2 * process->target->pointer_size}));
     #warning "don't forget to build frame elements"
 }
 
@@ -302,7 +320,7 @@ size_t get_function_node_argument_stack_addition(Node* function_node){
 }
 
 bool is_node_of_value_type(Node* node){
-    return is_node_expression_or_parenthesis(node) || node->type == NODE_TYPE_NUMBER || node->type == NODE_TYPE_UNARY || node->type == NODE_TYPE_IDENTIFIER || node->type == NODE_TYPE_TERNARY || node->type == NODE_TYPE_STRING;
+    return is_node_expression_or_parenthesis(node) || node->type == NODE_TYPE_NUMBER || node->type == NODE_TYPE_UNARY || node->type == NODE_TYPE_IDENTIFIER || node->type == NODE_TYPE_TERNARY || node->type == NODE_TYPE_STRING || node->type == NODE_TYPE_CAST;
 }
 
 bool is_node_expression_or_parenthesis(Node* node){
@@ -334,7 +352,7 @@ void make_while_node(Node* condition_node, Node* body_node){
 }
 
 void make_do_while_node(Node* body_node, Node* condition_node){
-    create_node(&((Node){.type = NODE_TYPE_STATEMENT_DO_WHILE, .data.statement.statement_while.condition_node = condition_node, .data.statement.statement_while.body_node = body_node}));
+    create_node(&((Node){.type = NODE_TYPE_STATEMENT_DO_WHILE, .data.statement.statement_do_while.condition_node = condition_node, .data.statement.statement_do_while.body_node = body_node}));
 }
 
 void make_switch_node(Node* expression_node, Node* body_node, DynamicVector* cases, bool has_default_case){
@@ -361,12 +379,24 @@ void make_switch_case_node(Node* expression_node){
     create_node(&((Node){.type = NODE_TYPE_STATEMENT_CASE, .data.statement.statement_switch_case.expression_node = expression_node}));
 }
 
+void make_switch_default_node(){
+    create_node(&((Node){.type = NODE_TYPE_STATEMENT_DEFAULT}));
+}
+
 void make_tenary_node(Node* true_expression, Node* false_expression){
     create_node(&((Node){.type = NODE_TYPE_TERNARY, .data.tenary.true_expression = true_expression, .data.tenary.false_expression = false_expression}));
 }
 
 void make_cast_node(DataType* data_type, Node* operand_node){
-    create_node(&((Node){.type = NODE_TYPE_CAST, .data.cast.data_type = data_type, .data.cast.operand_node = operand_node, .data.cast.data_type.name = data_type->name}));
+    create_node(&((Node){.type = NODE_TYPE_CAST, .data.cast.data_type = data_type, .data.cast.operand_node = operand_node}));
+}
+
+void make_unary_node(const char* operator, Node* operand, int flags){
+    create_node(&((Node){.type = NODE_TYPE_UNARY, .data.unary.operator = operator, .data.unary.operand = operand, .data.unary.flags = flags}));
+}
+
+void make_sizeof_node(DataType* data_type, Node* expression_node){
+    create_node(&((Node){.type = NODE_TYPE_SIZEOF, .data.size_of.data_type = data_type, .data.size_of.expression_node = expression_node}));
 }
 
 void make_union_node(const char* name, Node* body_node){
@@ -7,9 +7,10 @@ static CompileProcess* current_process;
 int parse(CompileProcess* compiler);
 int parse_next_token();
 static Token* parser_last_token;
+static Token* parser_last_postfix_token; //the last ++ or -- that was parsed as a postfix operator
+static Token* parser_last_cast_token; //the ')' closing the last cast, an operand follows it
 
 Token* get_next_token();
-static void parser_ignore_nl_or_comment_tokens(Token* token);
 Token* peek_next_token();
 void parse_single_token_to_node();
 Node* create_node(Node* node);
@@ -24,10 +25,21 @@ typedef struct HistoryCases{
 typedef struct History{ //so we'd be able to passs down commands to recursive functions
     int flags;
     struct parser_history_switch{
-        HistoryCases cases_data;
+        HistoryCases* cases_data; //shared by every statement of the switch body, so a default label nested anywhere inside is seen
     } parser_history_switch;
 } History;
 
+enum{
+    HISTORY_FLAG_INSIDE_UNION = 0b00000001,
+    HISTORY_FLAG_IS_UPWARD_STACK = 0b00000010,
+    HISTORY_FLAG_IS_GLOBAL_SCOPE = 0b00000100,
+    HISTORY_FLAG_INSIDE_STRUCTURE = 0b00001000,
+    HISTORY_FLAG_INSIDE_FUNCTION_BODY = 0b00010000,
+    HISTORY_FLAG_INSIDE_SWITCH = 0b00100000,
+    HISTORY_FLAG_PARENTHESES_IS_NOT_A_FUNCTION_CALL = 0b01000000,
+    HISTORY_FLAG_INSIDE_INITIALIZER = 0b10000000, //a ',' ends the expression, int a = 1, b = 2;
+};
+
 
 History* begin_history(int flags);
 
@@ -66,11 +78,11 @@ void parse_variable_or_function_or_struct_or_union(History* history);
 
 void parse_datatype(DataType* datatype);
 
-void parse_datatype_modifier(DataType* data_type);
+bool parse_datatype_modifier(DataType* data_type);
 
-void parse_datatype_type(DataType* data_type);
+void parse_datatype_type(DataType* data_type, bool has_sign_specifier);
 
-void parser_get_datatype_tokens(Token** datatype_token_out, Token** datatype_token_secondary_out);
+bool parser_get_datatype_tokens(Token** datatype_token_out, Token** datatype_token_secondary_out);
 
 int parser_datatype_expected_for_type_string(const char* value);
 
@@ -116,6 +128,8 @@ static void expect_symbol(const char symbol);
 
 ArrayBrackets* parse_array_brackets(History* history);
 
+void parser_complete_unsized_array(DataType* datatype, long long element_count);
+
 static void expect_operator(const char* operator);
 
 void make_bracket_node(Node* expression_node);
@@ -137,11 +151,13 @@ extern Node* parser_current_body_node;
 
 void parse_body_single_statement(size_t* sum_of_var_size, DynamicVector* body_vector, History* history);
 
+int parser_estimate_body_statement_count();
+
 void make_body_node(DynamicVector* body_vector, size_t sum_of_var_size, bool padded, Node* largest_var_node);
 
 void parse_statement(History* history);
 
-void parse_symbol();
+void parse_symbol(History* history);
 
 void parser_apppend_size_for_node(History* history, size_t* variable_size, Node* node);
 
@@ -193,6 +209,10 @@ void parse_function_body(History* history);
 
 DynamicVector* parse_function_arguments(History* history);
 
+static void parser_adjust_function_argument(Node* argument_node);
+
+static bool is_parser_void_argument(Node* argument_node);
+
 void read_token_dots(size_t size);
 
 void parse_full_variable(History* history);
@@ -200,6 +220,12 @@ void parse_full_variable(History* history);
 
 void parse_for_parenthesis(History* history);
 
+bool parser_is_cast_ahead();
+
+void parse_sizeof(History* history);
+
+bool parser_is_parenthesized_datatype_ahead();
+
 void parser_deal_with_additional_parentheses();
 
 
@@ -248,13 +274,29 @@ void parse_goto(History* History);
 
 void parse_switch_case(History* history);
 
+void parse_switch_default(History* history);
+
 void parse_for_tenary(History* history);
 
 void parse_for_comma(History* history);
 
 void parse_for_array(History* history);
 
-void parse_for_cast();
+void parse_for_cast(History* history);
+
+bool is_unary_operator(const char* operator);
+
+bool parser_is_unary_operator_position();
+
+void parse_for_unary(History* history);
+
+void parse_for_postfix_unary(History* history);
+
+void parser_reorder_unary(Node** node_out);
+
+bool is_postfix_operator_group(const char* operator);
+
+bool is_node_atomic_operand(Node* node);
 
 bool is_datatype_struct_node_fixup(Fixup* fixup);
 
@@ -273,8 +315,13 @@ Node* get_union_node_for_name(CompileProcess* process, const char* name);
 
 void parser_move_node_right_left_to_left(Node* node);
 
+void parser_bind_variable(History* history, Node* variable_node);
+
+void parser_bind_combined_variable(Node* struct_or_union_node);
+
+bool is_token_member_access_operator(Token* token);
+
 Node* parser_blank_node;
-FixupSystem* parser_fixup_system;
 
 
 int parse(CompileProcess* compiler){
@@ -282,16 +329,18 @@ int parse(CompileProcess* compiler){
     current_process = compiler;
     set_node_vectors(current_process->node_vector, current_process->node_tree_vector);
     parser_blank_node = create_node(&((Node){.type = NODE_TYPE_BLANK}));
-    parser_fixup_system = create_new_fixup_system();
     parser_last_token = NULL;
     Node* node = NULL;
     set_peek_index(current_process->token_vector, 0);
     while(parse_next_token() == 0){
         //parse the next token
         node = peek_node(); //at this point, the node should be the last node, which is the root of the tree 
-        push_element(current_process->node_tree_vector, &node);
+        vector_NodePtr_push(current_process->node_tree_vector, node);
     }
-    assert(is_fixup_system_resolved(parser_fixup_system));
+    //the final sweep resolves what is left, so it must run in NDEBUG builds too
+    bool is_resolved = is_fixup_system_resolved(current_process->fixup_system);
+    assert(is_resolved);
+    (void)is_resolved;
     return PARSER_SUCCESS;
 }
 
@@ -310,7 +359,7 @@ int parse_next_token(){
             parse_keyword_for_global();
             break;
         case TOKEN_TYPE_SYMBOL:
-            parse_symbol();
+            parse_symbol(begin_history(HISTORY_FLAG_IS_GLOBAL_SCOPE));
             break;
     }
     return 0;
@@ -319,42 +368,38 @@ int parse_next_token(){
 // static Token* parser_last_token;
 
 Token* get_next_token(){
-    Token* next_token = peek_element_without_increment(current_process->token_vector);
+    Token* next_token = peek_next_token();
     if(!next_token){
         return NULL;
     }
-    parser_ignore_nl_or_comment_tokens(next_token);
     current_process->position = next_token->position;
     parser_last_token = next_token;
-    return peek_element(current_process->token_vector);
-}
-
-static void parser_ignore_nl_or_comment_tokens(Token* token){
-    while(token && parser_ignore_nl_or_comment_or_nl_seperator_tokens(token)){
-        //skip the token
-        peek_element(current_process->token_vector);
-        token = peek_element_without_increment(current_process->token_vector);
-    }
+    current_process->token_vector->peek_index++;
+    return next_token;
 }
 
 Token* peek_next_token(){
-    Token* next_token = peek_element_without_increment(current_process->token_vector);
-    parser_ignore_nl_or_comment_tokens(next_token);
-    return peek_element_without_increment(current_process->token_vector);
+    DynamicVector* token_vector = current_process->token_vector;
+    return vector_Token_at_pointer(token_vector, token_vector->peek_index);
 }
 
 void parse_single_token_to_node(){
+    Token* previous_token = parser_last_token;
     Token* token = get_next_token();    
     Node* node = NULL;
     switch(token->type){
         case TOKEN_TYPE_NUMBER:
-            node = create_node(&((Node){.type = NODE_TYPE_NUMBER, .literal_value.long_long_num = token->value.long_long_num}));
+            node = create_node(&((Node){.type = NODE_TYPE_NUMBER, .literal_value.long_long_num = token->value.long_long_num, .data.number.type = token->Number.type, .data.number.flags = token->Number.flags}));
             break;
         case TOKEN_TYPE_STRING:
             node = create_node(&((Node){.type = NODE_TYPE_STRING, .literal_value.string_val = token->value.string_val}));
             break;
         case TOKEN_TYPE_IDENTIFIER:
             node = create_node(&((Node){.type = NODE_TYPE_IDENTIFIER, .literal_value.string_val = token->value.string_val}));
+            //a name after '.' or '->' is a member, not a declaration in scope
+            if(!is_token_member_access_operator(previous_token)){
+                node->data.identifier.declaration = scope_lookup(current_process, token->value.string_val);
+            }
             break;
         default:
             compiler_error(current_process, "this isn't single token, that can be parsed to node");
@@ -364,8 +409,8 @@ void parse_single_token_to_node(){
 Node* create_node(Node* node){
     Node* node_created = malloc(sizeof(Node));
     memcpy(node_created, node, sizeof(Node));
-    node->BindedTo.body = parser_current_body_node;
-    node->BindedTo.function = parser_current_function_node;
+    node_created->BindedTo.body = parser_current_body_node;
+    node_created->BindedTo.function = parser_current_function_node;
     push_node(node_created);
     return node_created;
 }
@@ -407,10 +452,10 @@ int parse_expressionable_single(History* history){
     if(token == NULL){
         return -1;
     }
-    history->flags |= NODE_FLAG_INSIDE_EXPRESSION;
     int result = -1;
     switch(token->type){
         case TOKEN_TYPE_NUMBER:
+        case TOKEN_TYPE_STRING:
             parse_single_token_to_node();
             result = 0;
             break;
@@ -419,6 +464,9 @@ int parse_expressionable_single(History* history){
             result = 0;
             break;
         case TOKEN_TYPE_OPERATOR:
+            if(history->flags & HISTORY_FLAG_INSIDE_INITIALIZER && ARE_STRINGS_EQUAL(token->value.string_val, ",")){
+                break;
+            }
             parse_expression(history);
             result = 0;
             break;
@@ -431,7 +479,14 @@ int parse_expressionable_single(History* history){
 }
 
 int parse_expression(History* history){ //parsing operator & merging w/ correct operands
-    if(ARE_STRINGS_EQUAL(peek_next_token()->value.string_val, "(")){
+    const char* operator = peek_next_token()->value.string_val;
+    if(is_unary_operator(operator) && parser_is_unary_operator_position()){
+        parse_for_unary(history);
+    }
+    else if(ARE_STRINGS_EQUAL(operator, "++") || ARE_STRINGS_EQUAL(operator, "--")){
+        parse_for_postfix_unary(history);
+    }
+    else if(ARE_STRINGS_EQUAL(peek_next_token()->value.string_val, "(")){
         parse_for_parenthesis(history);
     }
     else if(ARE_STRINGS_EQUAL(peek_next_token()->value.string_val, "?")){
@@ -482,14 +537,23 @@ void parser_reorder_expression(Node** node_out){ //node_out refers to the expres
     if(node->type != NODE_TYPE_EXPRESSION){
         return;
     }
-    if(node->data.expression.left->type != NODE_TYPE_EXPRESSION && node->data.expression.right && node->data.expression.right->type != NODE_TYPE_EXPRESSION){
+    //s.x++ parses as s.(x++), the postfix operator applies to the whole member access
+    Node* right_node = node->data.expression.right;
+    if(is_postfix_operator_group(node->data.expression.operator) && right_node && right_node->type == NODE_TYPE_UNARY && right_node->data.unary.flags & UNARY_FLAG_IS_POSTFIX){
+        node->data.expression.right = right_node->data.unary.operand;
+        right_node->data.unary.operand = node;
+        *node_out = right_node;
+        return;
+    }
+    bool is_left_atomic = is_node_atomic_operand(node->data.expression.left);
+    if(is_left_atomic && node->data.expression.right && node->data.expression.right->type != NODE_TYPE_EXPRESSION){
         return;
     }
     //50*EXP
     //EXP(50*EXP(10+20))
     //EXP(EXP(50*10)+20)
     //shift child operator(right) to root operator(left)
-    if(node->data.expression.left->type != NODE_TYPE_EXPRESSION && node->data.expression.right && node->data.expression.right->type == NODE_TYPE_EXPRESSION){
+    if(is_left_atomic && node->data.expression.right && node->data.expression.right->type == NODE_TYPE_EXPRESSION){
         const char* right_operator = node->data.expression.right->data.expression.operator;
         //functions to determine the priority of the operator, is it the root operator(* in eg) or the child operator(+ in eg)
         if(does_left_operator_have_higher_precedence(node->data.expression.operator, right_operator)){
@@ -498,7 +562,7 @@ void parser_reorder_expression(Node** node_out){ //node_out refers to the expres
             parser_reorder_expression(&node->data.expression.right);
         }
     }
-    if((is_array_node(node->data.expression.left) || is_assignment_node(node->data.expression.right)) || ((is_node_expression(node->data.expression.left, "()")) && is_node_expression(node->data.expression.right, ","))){
+    if(is_node_expression(node->data.expression.left, "()") && node->data.expression.right && is_node_expression(node->data.expression.right, ",")){
         parser_move_node_right_left_to_left(node);
     }
 
@@ -508,12 +572,15 @@ static bool does_left_operator_have_higher_precedence(const char* left_operator,
     ExpressionableOperatorPrecedanceGroup* left_group = NULL;
     ExpressionableOperatorPrecedanceGroup* right_group = NULL;
     if(ARE_STRINGS_EQUAL(left_operator, right_operator)){
-        return false;
+        //a-b-c is (a-b)-c, the comma list of a call is kept nested to the right
+        parser_get_precedence_for_operator(left_operator, &left_group);
+        return left_group && left_group->associativity == ASSOCIATIVITY_LEFT_TO_RIGHT && !ARE_STRINGS_EQUAL(left_operator, ",");
     }
     int left_precedence = parser_get_precedence_for_operator(left_operator, &left_group);
     int right_precedence = parser_get_precedence_for_operator(right_operator, &right_group);
+    //a = b = c stays a = (b = c), but a looser operator still takes the assignment as its operand, eg: i = 3, j is (i = 3), j
     if(left_group->associativity == ASSOCIATIVITY_RIGHT_TO_LEFT){
-        return false;
+        return left_precedence < right_precedence;
     }
     return left_precedence <= right_precedence;
 }
@@ -601,6 +668,14 @@ void parse_keyword(History* history){
         parse_switch_case(history);
         return;
     }
+    else if(ARE_STRINGS_EQUAL(token->value.string_val, "default")){
+        parse_switch_default(history);
+        return;
+    }
+    else if(ARE_STRINGS_EQUAL(token->value.string_val, "sizeof")){
+        parse_sizeof(history);
+        return;
+    }
     else{
         compiler_error(current_process, "unknown keyword");
     }
@@ -639,20 +714,20 @@ void parse_variable_or_function_or_struct_or_union(History* history){
         compiler_error(current_process, "expecting a valid name for variable or function\n");
     }
     if(is_next_token_operator("(")){
-        parse_function(&datatype, name_token, history);
+        parse_function(intern_datatype(current_process, &datatype), name_token, history);
         return;
     }
     parse_variable(&datatype, name_token, history);
     if(is_next_token_operator(",")){
         DynamicVector* variable_list = create_vector(sizeof(Node*));
         Node* variable_node = pop_node();
-        push_element(variable_list, &variable_node);
+        vector_NodePtr_push(variable_list, variable_node);
         while(is_next_token_operator(",")){
             get_next_token();
             name_token = get_next_token();
             parse_variable(&datatype, name_token, history);
             variable_node = pop_node();
-            push_element(variable_list, &variable_node);
+            vector_NodePtr_push(variable_list, variable_node);
         }
         make_variable_list_node(variable_list);
     }
@@ -662,12 +737,14 @@ void parse_variable_or_function_or_struct_or_union(History* history){
 void parse_datatype(DataType* datatype){
     memset(datatype, 0, sizeof(DataType));
     datatype->flags |= DATATYPE_FLAG_IS_SIGNED;
-    parse_datatype_modifier(datatype);
-    parse_datatype_type(datatype);
+    bool has_sign_specifier = parse_datatype_modifier(datatype);
+    parse_datatype_type(datatype, has_sign_specifier);
     parse_datatype_modifier(datatype);
 }
 
-void parse_datatype_modifier(DataType* data_type){
+//returns true when signed or unsigned was read
+bool parse_datatype_modifier(DataType* data_type){
+    bool has_sign_specifier = false;
     Token* token = peek_next_token();
     while(token && token->type == TOKEN_TYPE_KEYWORD){
         if(!is_keyword_variable_modifier(token->value.string_val)){
@@ -675,9 +752,11 @@ void parse_datatype_modifier(DataType* data_type){
         }
         if(ARE_STRINGS_EQUAL(token->value.string_val, "unsigned")){
             data_type->flags &= ~DATATYPE_FLAG_IS_SIGNED;
+            has_sign_specifier = true;
         }
         else if(ARE_STRINGS_EQUAL(token->value.string_val, "signed")){
             data_type->flags |= DATATYPE_FLAG_IS_SIGNED;
+            has_sign_specifier = true;
         }
         else if(ARE_STRINGS_EQUAL(token->value.string_val, "static")){
             data_type->flags |= DATATYPE_FLAG_IS_STATIC;
@@ -697,12 +776,20 @@ void parse_datatype_modifier(DataType* data_type){
         get_next_token();
         token = peek_next_token();
     }
+    return has_sign_specifier;
 }
 
-void parse_datatype_type(DataType* data_type){
+void parse_datatype_type(DataType* data_type, bool has_sign_specifier){
+    static Token implicit_int_token = {.type = TOKEN_TYPE_KEYWORD, .value.string_val = "int"};
     Token* datatype_token = NULL;
     Token* datatype_token_secondary = NULL;
-    parser_get_datatype_tokens(&datatype_token, &datatype_token_secondary);
+    if(!parser_get_datatype_tokens(&datatype_token, &datatype_token_secondary)){
+        if(!has_sign_specifier){
+            compiler_error(current_process, "expected a datatype");
+        }
+        //signed and unsigned on their own mean int, eg: (unsigned)x
+        datatype_token = &implicit_int_token;
+    }
     int expected_type = parser_datatype_expected_for_type_string(datatype_token->value.string_val);
     if(is_datatype_struct_or_union_given_name(datatype_token->value.string_val)){
         if(peek_next_token()->type == TOKEN_TYPE_IDENTIFIER){
@@ -719,13 +806,19 @@ void parse_datatype_type(DataType* data_type){
     parser_datatype_init(datatype_token, datatype_token_secondary, data_type, pointer_level, expected_type);
 }
 
-void parser_get_datatype_tokens(Token** datatype_token_out, Token** datatype_token_secondary_out){
+//returns false without reading anything when no datatype keyword is ahead
+bool parser_get_datatype_tokens(Token** datatype_token_out, Token** datatype_token_secondary_out){
+    Token* token = peek_next_token();
+    if(!token || token->type != TOKEN_TYPE_KEYWORD || !keyword_is_datatype(token->value.string_val)){
+        return false;
+    }
     *datatype_token_out = get_next_token();
     Token* next_token = peek_next_token();
     if(is_token_primitive_keyword(next_token)){
         *datatype_token_secondary_out = next_token;
         get_next_token();
     }
+    return true;
 }
 
 int parser_datatype_expected_for_type_string(const char* value){
@@ -772,16 +865,16 @@ bool is_next_token_operator(const char* operator){
 void parser_datatype_init(Token* datatype_token, Token* datatype_secondary_token, DataType* datatype_out, int pointer_depth, int expected_type){
     parser_datatype_init_type_and_size(datatype_token, datatype_secondary_token, datatype_out, pointer_depth, expected_type);
     datatype_out->name = datatype_token->value.string_val;
-    if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "long") && datatype_secondary_token && ARE_STRINGS_EQUAL(datatype_secondary_token->value.string_val, "long")){
-        compiler_warning(current_process, "compiler doesn't suppport 64 bit longs, using 32 bit longs instead");
-        datatype_out->size = DATA_SIZE_DWORD;
-    }
 }
 
 void parser_datatype_init_type_and_size(Token* datatype_token, Token* datatype_secondary_token, DataType* datatype_out, int pointer_depth, int expected_type){
     if(!is_secondary_datatype_allowed(expected_type) && datatype_secondary_token){
         compiler_error(current_process, "secondary datatype not allowed");
     }
+    if(pointer_depth > 0){
+        datatype_out->flags |= DATATYPE_FLAG_IS_POINTER;
+        datatype_out->pointer_level = pointer_depth;
+    }
     switch(expected_type){
         case DATA_TYPE_EXPECT_PRIMITIVE:
             parser_datatype_init_type_and_size_for_primitive(datatype_token, datatype_secondary_token, datatype_out);
@@ -815,31 +908,31 @@ void parser_datatype_init_type_and_size_for_primitive(Token* datatype_token, Tok
     }
     if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "void")){
         datatype_out->type = DATA_TYPE_VOID;
-        datatype_out->size = DATA_SIZE_ZERO;
+        datatype_out->size = get_target_primitive_size(current_process->target, DATA_TYPE_VOID, DATA_TYPE_UNKNOWN);
     }
     else if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "int")){
         datatype_out->type = DATA_TYPE_INT;
-        datatype_out->size = DATA_SIZE_DWORD;
+        datatype_out->size = get_target_primitive_size(current_process->target, DATA_TYPE_INT, DATA_TYPE_UNKNOWN);
     }
     else if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "char")){
         datatype_out->type = DATA_TYPE_CHAR;
-        datatype_out->size = DATA_SIZE_BYTE;
+        datatype_out->size = get_target_primitive_size(current_process->target, DATA_TYPE_CHAR, DATA_TYPE_UNKNOWN);
     }
     else if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "float")){
         datatype_out->type = DATA_TYPE_FLOAT;
-        datatype_out->size = DATA_SIZE_DWORD;
+        datatype_out->size = get_target_primitive_size(current_process->target, DATA_TYPE_FLOAT, DATA_TYPE_UNKNOWN);
     }
     else if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "double")){
         datatype_out->type = DATA_TYPE_DOUBLE;
-        datatype_out->size = DATA_SIZE_DWORD;
+        datatype_out->size = get_target_primitive_size(current_process->target, DATA_TYPE_DOUBLE, DATA_TYPE_UNKNOWN);
     }
     else if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "long")){
         datatype_out->type = DATA_TYPE_LONG;
-        datatype_out->size = DATA_SIZE_DWORD;
+        datatype_out->size = get_target_primitive_size(current_process->target, DATA_TYPE_LONG, DATA_TYPE_UNKNOWN);
     }
     else if(ARE_STRINGS_EQUAL(datatype_token->value.string_val, "short")){
         datatype_out->type = DATA_TYPE_SHORT;
-        datatype_out->size = DATA_SIZE_WORD;
+        datatype_out->size = get_target_primitive_size(current_process->target, DATA_TYPE_SHORT, DATA_TYPE_UNKNOWN);
     }
     else{
         compiler_error(current_process, "unknown primitive datatype");
@@ -851,10 +944,10 @@ void parser_adjust_size_for_secondary_datatype(DataType* datatype, Token* dataty
     if(!datatype_secondary_token){
         return;
     }
-    DataType* secondary_data_type = calloc(1, sizeof(DataType));
-    parser_datatype_init_type_and_size_for_primitive(datatype_secondary_token, NULL, secondary_data_type);
-    datatype->size+= secondary_data_type->size;
-    datatype->secondary_data_type = secondary_data_type;
+    DataType secondary_data_type = {};
+    parser_datatype_init_type_and_size_for_primitive(datatype_secondary_token, NULL, &secondary_data_type);
+    datatype->size = get_target_primitive_size(current_process->target, datatype->type, secondary_data_type.type);
+    datatype->secondary_data_type = intern_datatype(current_process, &secondary_data_type);
     datatype->flags |= DATATYPE_FLAG_IS_SECONDARY;
 }
 
@@ -882,18 +975,24 @@ bool parser_is_init_valid_after_datatype(DataType* datatype){
 void parse_variable(DataType* datatype, Token* name_token, History* history){
     Node* value_node = NULL;
     ArrayBrackets* array_brackets = NULL;
+    //the brackets belong to this variable only, int a[3], b; declares b as a plain int
+    DataType variable_datatype = *datatype;
     if(is_next_token_operator("[")){
         array_brackets = parse_array_brackets(history);
-        datatype->flags |= DATATYPE_FLAG_IS_ARRAY;
-        datatype->array.array_bracket = array_brackets;
-        datatype->array.size = array_brackets_calculate_size(datatype, array_brackets);
+        variable_datatype.flags |= DATATYPE_FLAG_IS_ARRAY;
+        variable_datatype.array.array_bracket = array_brackets;
+        variable_datatype.array.size = array_brackets_calculate_size(current_process, &variable_datatype, array_brackets);
     }
     if(is_next_token_operator("=")){
         get_next_token();
-        parse_expressionable_root(history);
+        parse_expressionable_root(clone_history(history, history->flags | HISTORY_FLAG_INSIDE_INITIALIZER));
         value_node = pop_node();
     }
-    make_variable_node_and_register(history, datatype, name_token, value_node);
+    if(array_brackets && get_element_count(array_brackets->n_brackets) == 0 && value_node && value_node->type == NODE_TYPE_STRING){
+        //char s[] = "abc" takes its size from the string, including the terminator
+        parser_complete_unsized_array(&variable_datatype, strlen(value_node->literal_value.string_val) + 1);
+    }
+    make_variable_node_and_register(history, &variable_datatype, name_token, value_node);
 }
 
 void parse_expressionable_root(History* history){
@@ -908,9 +1007,31 @@ void make_variable_node_and_register(History* history, DataType* datatype, Token
     //calculate scope offset
     parser_scope_offset_calculate(history, variable_node);
     //push variable node to scope
-    push_parser_scope(create_new_parser_scope_entity(variable_node, variable_node->data.var.aligned_offset, 0), variable_node->data.var.data_type.size);
+    push_parser_scope(create_new_parser_scope_entity(variable_node, variable_node->data.var.aligned_offset, 0), variable_node->data.var.data_type->size);
+    parser_bind_variable(history, variable_node);
     push_node(variable_node);
 }
+
+//makes the variable visible to identifiers parsed later in the current scope, struct and union members are only reachable through their parent
+void parser_bind_variable(History* history, Node* variable_node){
+    if(history->flags & (HISTORY_FLAG_INSIDE_STRUCTURE | HISTORY_FLAG_INSIDE_UNION)){
+        return;
+    }
+    symbol_resolver_for_variable_node(current_process, variable_node);
+}
+
+//binds the variable declared together with a struct or union, e.g. struct abc {...} x; in the scope around the struct or union body
+void parser_bind_combined_variable(Node* struct_or_union_node){
+    if(!(struct_or_union_node->flags & NODE_FLAG_HAS_VARIABLE_COMBINED)){
+        return;
+    }
+    Node* variable_node = struct_or_union_node->type == NODE_TYPE_STRUCT ? struct_or_union_node->data.structure.variable : struct_or_union_node->data.Union.variable;
+    symbol_resolver_for_variable_node(current_process, variable_node);
+}
+
+bool is_token_member_access_operator(Token* token){
+    return token && token->type == TOKEN_TYPE_OPERATOR && (ARE_STRINGS_EQUAL(token->value.string_val, ".") || ARE_STRINGS_EQUAL(token->value.string_val, "->"));
+}
 typedef struct DatatypeStructNodeFixPrivate{
     Node* node_to_be_fixed;
 }DatatypeStructNodeFixPrivate;
@@ -920,12 +1041,12 @@ void make_variable_node(DataType* datatype, Token* name_token, Node* value_node)
     if(name_token){
         name_string = name_token->value.string_val;
     }
-    create_node(&((Node){.type = NODE_TYPE_VARIABLE, .data.var.data_type = *datatype, .data.var.name = name_string, .data.var.value = value_node}));
+    create_node(&((Node){.type = NODE_TYPE_VARIABLE, .data.var.data_type = intern_datatype(current_process, datatype), .data.var.name = name_string, .data.var.value = value_node}));
     Node* variable_node = peek_node_or_null();
-    if((variable_node->data.var.data_type.type == DATA_TYPE_STRUCT) && !variable_node->data.var.data_type.data.struct_node){
+    if((variable_node->data.var.data_type->type == DATA_TYPE_STRUCT) && !variable_node->data.var.data_type->data.struct_node){
         DatatypeStructNodeFixPrivate* fix_private = calloc(1, sizeof(DatatypeStructNodeFixPrivate));
         fix_private->node_to_be_fixed = variable_node;
-        register_fixup(parser_fixup_system, &(FixupConfig){.fix = is_datatype_struct_node_fixup, .end = datatype_struct_node_end, .private_data = fix_private});
+        register_fixup_waiting_on(current_process->fixup_system, variable_node->data.var.data_type->name, &(FixupConfig){.fix = is_datatype_struct_node_fixup, .end = datatype_struct_node_end, .private_data = fix_private});
     }
 }
 
@@ -940,6 +1061,15 @@ static void expect_symbol(const char symbol){
     }
 }
 
+void parser_complete_unsized_array(DataType* datatype, long long element_count){
+    Node* size_node = create_node(&((Node){.type = NODE_TYPE_NUMBER, .literal_value.long_long_num = element_count}));
+    pop_node();
+    expect_constant_expression(current_process, size_node, "array size");
+    make_bracket_node(size_node);
+    add_array_bracket(datatype->array.array_bracket, pop_node());
+    datatype->array.size = array_brackets_calculate_size(current_process, datatype, datatype->array.array_bracket);
+}
+
 ArrayBrackets* parse_array_brackets(History* history){
     ArrayBrackets* array_brackets = array_brackets_new(1);
     while(is_next_token_operator("[")){
@@ -951,6 +1081,8 @@ ArrayBrackets* parse_array_brackets(History* history){
         parse_expressionable_root(history);
         expect_symbol(']');
         Node* expression_node = pop_node();
+        //folded once here, the size calculations read the cached value
+        expect_constant_expression(current_process, expression_node, "array size");
         make_bracket_node(expression_node);
         Node* bracket_node = pop_node();
         add_array_bracket(array_brackets, bracket_node);
@@ -996,23 +1128,13 @@ void parse_struct(DataType* datatype){
     if(!is_forward_declaration){
         parser_finish_scope();
     }
+    parser_bind_combined_variable(peek_node());
 }
 
 void parser_new_scope(){
     new_scope(current_process, 0);
 }
 
-enum{
-    HISTORY_FLAG_INSIDE_UNION = 0b00000001,
-    HISTORY_FLAG_IS_UPWARD_STACK = 0b00000010,
-    HISTORY_FLAG_IS_GLOBAL_SCOPE = 0b00000100,
-    HISTORY_FLAG_INSIDE_STRUCTURE = 0b00001000,
-    HISTORY_FLAG_INSIDE_FUNCTION_BODY = 0b00010000,
-    HISTORY_FLAG_INSIDE_SWITCH = 0b00100000,
-    HISTORY_FLAG_PARENTHESES_IS_NOT_A_FUNCTION_CALL = 0b01000000,
-};
-
-
 void parse_struct_no_new_scope(DataType* datatype, bool is_foward_declaration){
     Node* body_node = NULL;
     size_t body_variable_size = 0;
@@ -1023,7 +1145,7 @@ void parse_struct_no_new_scope(DataType* datatype, bool is_foward_declaration){
     make_struct_node(datatype->name, body_node);
     Node* struct_node = pop_node();
     if(body_node){
-        datatype->size = body_node->data.body.size;
+        datatype->size = get_struct_layout(current_process, struct_node)->size;
     }
     datatype->data.struct_node = struct_node;
     if(is_token_identifier(peek_next_token())){
@@ -1052,9 +1174,11 @@ void parse_body(size_t* sum_of_var_size, History* history){
         sum_of_var_size = &temp_size;
     }
     DynamicVector* body_vector = create_vector(sizeof(Node*));
+    reserve_vector(body_vector, parser_estimate_body_statement_count());
     if(!is_next_token_symbol('{')){
         parse_body_single_statement(sum_of_var_size, body_vector, history);
         parser_finish_scope();
+        return;
     }
     parse_body_multiple_statements(sum_of_var_size, body_vector, history);
     parser_finish_scope();
@@ -1067,6 +1191,46 @@ void parse_body(size_t* sum_of_var_size, History* history){
 
 // extern Node* parser_current_body_node;
 
+#define PARSER_BODY_ESTIMATE_MAX_TOKENS 1024
+
+//counts the statements of the upcoming body by looking ahead for ';' and '}' at the body's own nesting level, without moving the token cursor
+int parser_estimate_body_statement_count(){
+    DynamicVector* token_vector = current_process->token_vector;
+    int index = token_vector->peek_index;
+    Token* token = get_element_at(token_vector, index);
+    if(!is_token_symbol(token, '{')){
+        return 1;
+    }
+    int statement_count = 0;
+    int brace_depth = 0;
+    int parenthesis_depth = 0;
+    int last_index = index + PARSER_BODY_ESTIMATE_MAX_TOKENS;
+    for(; index < last_index && (token = get_element_at(token_vector, index)); index++){
+        if(token->type == TOKEN_TYPE_OPERATOR && ARE_STRINGS_EQUAL(token->value.string_val, "(")){
+            parenthesis_depth++;
+        }
+        else if(is_token_symbol(token, ')') && parenthesis_depth > 0){
+            parenthesis_depth--;
+        }
+        else if(is_token_symbol(token, '{')){
+            brace_depth++;
+        }
+        else if(is_token_symbol(token, '}')){
+            brace_depth--;
+            if(brace_depth == 0){
+                break;
+            }
+            if(brace_depth == 1){
+                statement_count++;
+            }
+        }
+        else if(is_token_symbol(token, ';') && brace_depth == 1 && parenthesis_depth == 0){
+            statement_count++;
+        }
+    }
+    return statement_count;
+}
+
 void parse_body_single_statement(size_t* sum_of_var_size, DynamicVector* body_vector, History* history){
     make_body_node(NULL, 0, false, NULL);
     Node* body_node = pop_node();
@@ -1075,7 +1239,7 @@ void parse_body_single_statement(size_t* sum_of_var_size, DynamicVector* body_ve
     Node* statement_node = NULL;
     parse_statement(history);
     statement_node = pop_node();
-    push_element(body_vector, &statement_node);
+    vector_NodePtr_push(body_vector, statement_node);
     parser_apppend_size_for_node(history, sum_of_var_size, statement_node);
     Node* larget_var_node = NULL;
     if(statement_node->type == NODE_TYPE_VARIABLE){
@@ -1097,19 +1261,20 @@ void parse_statement(History* history){
     }
     parse_expressionable_root(history);
     if(peek_next_token()->type == TOKEN_TYPE_SYMBOL && !is_token_symbol(peek_next_token(), ';')){
-        parse_symbol();
+        parse_symbol(history);
         return;
     }
     expect_symbol(';');
 }
 
 
-void parse_symbol(){
+void parse_symbol(History* history){
     if(is_next_token_symbol('{')){
         size_t variable_size = 0;
-        parse_body(&variable_size, begin_history(HISTORY_FLAG_IS_GLOBAL_SCOPE));
+        parse_body(&variable_size, history);
         Node* body_node = pop_node();
         push_node(body_node);
+        return;
     }
     else if(is_next_token_symbol(':')){
         parse_label(begin_history(0));
@@ -1127,7 +1292,7 @@ void parser_apppend_size_for_node(History* history, size_t* variable_size, Node*
             parser_apppend_size_for_node_struct_or_union(history, variable_size, node);
             return;
         }
-        *variable_size+= get_variable_size(node);
+        *variable_size+= get_variable_size(current_process, node);
     }
     else if(node->type == NODE_TYPE_VARIABLE_LIST){
         parser_apppend_size_for_variable_list(history, variable_size, node->data.variable_list.variables);
@@ -1138,13 +1303,13 @@ void parser_finalize_body(History* history, Node* body_node, DynamicVector* body
     if(history->flags & HISTORY_FLAG_INSIDE_UNION){
         //union size is the size of the largest variable
         if(largest_possible_var_node){
-            *sum_of_var_size = get_variable_size(largest_possible_var_node);
+            *sum_of_var_size = get_variable_size(current_process, largest_possible_var_node);
         }
     }
     int padding = get_compute_sum_padding(body_vector);
     *sum_of_var_size+= padding;
     if(largest_align_eligible_var_node){
-        *sum_of_var_size = get_align_value(*sum_of_var_size, largest_align_eligible_var_node->data.var.data_type.size);
+        *sum_of_var_size = get_align_value(*sum_of_var_size, get_datatype_alignment(current_process, largest_align_eligible_var_node->data.var.data_type));
     }
     bool padded = padding != 0;
     body_node->data.body.largest_var_node = largest_align_eligible_var_node;
@@ -1156,22 +1321,19 @@ void parser_finalize_body(History* history, Node* body_node, DynamicVector* body
 }
 
 void parser_apppend_size_for_node_struct_or_union(History* history, size_t* variable_size, Node* node){
-    *variable_size+= get_variable_size(node);
-    if(node->data.var.data_type.flags & DATATYPE_FLAG_IS_POINTER ){
+    *variable_size+= get_variable_size(current_process, node);
+    if(node->data.var.data_type->flags & DATATYPE_FLAG_IS_POINTER ){
         return;
     }
     Node* largest_var_node = get_variable_struct_or_union_body_node(node)->data.body.largest_var_node;
     if(largest_var_node){
-        *variable_size+= get_align_value(*variable_size, largest_var_node->data.var.data_type.size);
+        *variable_size+= get_align_value(*variable_size, get_datatype_alignment(current_process, largest_var_node->data.var.data_type));
     }
 }
 
 void parser_apppend_size_for_variable_list(History* history, size_t* variable_size, DynamicVector* variable_list){
-    set_peek_index(variable_list, 0);
-    Node* variable_node = peek_pointer(variable_list);
-    while(variable_node){
-        parser_apppend_size_for_node(history, variable_size, variable_node);
-        variable_node = peek_pointer(variable_list);
+    vector_for_each(Node*, variable_node, variable_list){
+        parser_apppend_size_for_node(history, variable_size, *variable_node);
     }
 }
 
@@ -1218,20 +1380,20 @@ void parser_scope_offset_calculate(History* history, Node* variable_node){
 void parser_scope_offset_calculate_for_stack(History* history, Node* variable_node){
     ParserScopeEntity* last_entity = get_parser_scope_last_entity_stop_global_scope();
     bool upward_stack = history->flags & HISTORY_FLAG_IS_UPWARD_STACK;
-    int offset = -get_variable_size(variable_node);
+    int offset = -get_variable_size(current_process, variable_node);
     if(upward_stack){
         size_t stack_addition = get_function_node_argument_stack_addition(parser_current_function_node);
         offset = stack_addition;
         if(last_entity){
-            offset = get_datatype_size(&get_variable_node(last_entity->variable_node)->data.var.data_type);
+            offset = get_datatype_size(current_process, get_variable_node(last_entity->variable_node)->data.var.data_type);
         }
     }
     if(last_entity){
         offset+= get_variable_node(last_entity->variable_node)->data.var.aligned_offset;
-        if(is_variable_node_primitive(variable_node)){
-            get_variable_node(variable_node)->data.var.padding = get_padding(upward_stack ? offset : -offset, variable_node->data.var.data_type.size);
-        }
     }
+    //structs and arrays are aligned as well, the frame must honour the alignment their layout was built with
+    get_variable_node(variable_node)->data.var.padding = get_padding(upward_stack ? offset : -offset, get_datatype_alignment(current_process, variable_node->data.var.data_type));
+    get_variable_node(variable_node)->data.var.aligned_offset = offset + (upward_stack ? variable_node->data.var.padding : -variable_node->data.var.padding);
 }
 
 void parser_scope_offset_calculate_for_global(History* history, Node* node){
@@ -1241,9 +1403,9 @@ void parser_scope_offset_calculate_for_struct(History* history, Node* node){
     int offset = 0;
     ParserScopeEntity* last_entity = get_parser_scope_last_entity();
     if(last_entity){
-        offset += last_entity->stack_offset + last_entity->variable_node->data.var.data_type.size;
+        offset += last_entity->stack_offset + get_datatype_size(current_process, last_entity->variable_node->data.var.data_type);
         if(is_variable_node_primitive(node)){
-            node->data.var.padding = get_padding(offset, node->data.var.data_type.size);
+            node->data.var.padding = get_padding(offset, get_datatype_alignment(current_process, node->data.var.data_type));
         }
         node->data.var.aligned_offset = offset + node->data.var.padding;
     }
@@ -1266,16 +1428,16 @@ void parse_body_multiple_statements(size_t* sum_of_var_size, DynamicVector* body
         parse_statement(clone_history(history, history->flags));
         statement_node = pop_node();
         if(statement_node && statement_node->type == NODE_TYPE_VARIABLE){
-            if(largest_possible_var_node == NULL || largest_possible_var_node->data.var.data_type.size <= statement_node->data.var.data_type.size){
+            if(largest_possible_var_node == NULL || largest_possible_var_node->data.var.data_type->size <= statement_node->data.var.data_type->size){
                 largest_possible_var_node = statement_node;
             }
             if(is_variable_node_primitive(statement_node)){
-                if(largest_align_eligible_var_node == NULL || largest_align_eligible_var_node->data.var.data_type.size <= statement_node->data.var.data_type.size){
+                if(largest_align_eligible_var_node == NULL || largest_align_eligible_var_node->data.var.data_type->size <= statement_node->data.var.data_type->size){
                     largest_align_eligible_var_node = statement_node;
                 }
             }
         }
-        push_element(body_vector, &statement_node);
+        vector_NodePtr_push(body_vector, statement_node);
         parser_apppend_size_for_node(history, sum_of_var_size, get_variable_node_or_list(statement_node));
     }
     expect_symbol('}');
@@ -1292,28 +1454,40 @@ size_t get_size_of_struct(const char* name){
     assert(symbol->type == SYMBOL_TYPE_NODE);
     Node* node = symbol->data;
     assert(node->type == NODE_TYPE_STRUCT);
-    return node->data.body.size;
+    StructLayout* layout = get_struct_layout(current_process, node);
+    return layout ? layout->size : 0;
 }
 
 // extern Node* parser_current_function_node;
 
 void parse_function(DataType* return_type, Token* name_token, History* history){
     DynamicVector* arguments_vector = NULL;
-    parser_new_scope();
-    make_function_node(return_type, name_token->value.string_val, NULL, NULL);
+    //the function is bound in the enclosing scope before its own scope opens, so its body can call it
+    make_function_node(current_process, return_type, name_token->value.string_val, NULL, NULL);
     Node* function_node = peek_node();
+    symbol_resolver_for_function_node(current_process, function_node);
+    parser_new_scope();
     parser_current_function_node = function_node;
     if(is_datatype_struct_or_union(return_type)){
-        function_node->data.function.function_args.stack_addition += DATA_SIZE_DWORD;
+        function_node->data.function.function_args.stack_addition += current_process->target->pointer_size;
     }
     expect_operator("(");
     arguments_vector = parse_function_arguments(clone_history(history, 0));
     expect_symbol(')');
     function_node->data.function.function_args.args = arguments_vector;
+    //the argument scope is already finished, so the arguments are bound again in the function scope the body sees
+    vector_for_each(Node*, argument_node, arguments_vector){
+        symbol_resolver_for_variable_node(current_process, *argument_node);
+    }
     if(symbol_resolver_get_symbol_for_native_function(current_process, name_token->value.string_val)){
         function_node->flags |= FUNCTION_NODE_FLAG_IS_NATIVE;
     }
     if(is_next_token_symbol('{')){
+        for(int i = 0; i < get_element_count(arguments_vector); i++){
+            if(!vector_NodePtr_at(arguments_vector, i)->data.var.name){
+                compiler_error(current_process, "parameter %i of function %s has no name", i + 1, name_token->value.string_val);
+            }
+        }
         parse_function_body(begin_history(0));
         Node* body_node = pop_node();
         function_node->data.function.body_node = body_node;
@@ -1335,20 +1509,49 @@ DynamicVector* parse_function_arguments(History* history){
     while(!is_next_token_symbol(')')){
         if(is_next_token_operator(".")){
             read_token_dots(3);
+            parser_current_function_node->flags |= FUNCTION_NODE_FLAG_IS_VARIADIC;
             parser_finish_scope();
+            return arguments_vector;
         }
         parse_full_variable(clone_history(history, history->flags | HISTORY_FLAG_IS_UPWARD_STACK));
         Node* argument_node = pop_node();
-        push_element(arguments_vector, &argument_node);
+        parser_adjust_function_argument(argument_node);
+        vector_NodePtr_push(arguments_vector, argument_node);
         if(!is_next_token_operator(",")){
             break;
         }
         get_next_token();
     }
+    vector_for_each(Node*, argument_node, arguments_vector){
+        if(is_parser_void_argument(*argument_node) && (get_element_count(arguments_vector) > 1 || (*argument_node)->data.var.name)){
+            compiler_error(current_process, "void must be the only parameter and unnamed");
+        }
+    }
+    //f(void) takes no arguments
+    if(get_element_count(arguments_vector) == 1 && is_parser_void_argument(vector_NodePtr_at(arguments_vector, 0))){
+        remove_last_element(arguments_vector);
+    }
     parser_finish_scope();
     return arguments_vector;
 }
 
+// An array parameter is a pointer to its first element, eg: int m[4] is int* m.
+static void parser_adjust_function_argument(Node* argument_node){
+    DataType* datatype = argument_node->data.var.data_type;
+    if(!(datatype->flags & DATATYPE_FLAG_IS_ARRAY)){
+        return;
+    }
+    if(get_element_count(datatype->array.array_bracket->n_brackets) > 1){
+        compiler_error(current_process, "multi-dimensional array parameters are not supported");
+    }
+    argument_node->data.var.data_type = get_datatype_pointer_to(current_process, datatype);
+}
+
+static bool is_parser_void_argument(Node* argument_node){
+    DataType* datatype = argument_node->data.var.data_type;
+    return datatype->type == DATA_TYPE_VOID && !(datatype->flags & (DATATYPE_FLAG_IS_POINTER | DATATYPE_FLAG_IS_ARRAY));
+}
+
 void read_token_dots(size_t size){
     for(int i = 0; i < size; i++){
         expect_operator(".");
@@ -1368,7 +1571,7 @@ void parse_full_variable(History* history){
 
 void parse_for_parenthesis(History* history){
     expect_operator("(");
-    if(peek_next_token()->type == TOKEN_TYPE_KEYWORD){
+    if(parser_is_cast_ahead()){
         parse_for_cast(history);
         return;
     }
@@ -1380,7 +1583,7 @@ void parse_for_parenthesis(History* history){
     }
     Node* expression_node = parser_blank_node;
     if(!is_next_token_symbol(')')){
-        parse_expressionable(history);
+        parse_expressionable(clone_history(history, history->flags & ~HISTORY_FLAG_INSIDE_INITIALIZER));
         expression_node = pop_node();
     }
     expect_symbol(')');
@@ -1392,8 +1595,74 @@ void parse_for_parenthesis(History* history){
     parser_deal_with_additional_parentheses();
 }
 
+void parse_sizeof(History* history){
+    expect_keyword("sizeof");
+    if(parser_is_parenthesized_datatype_ahead()){
+        DataType data_type = {};
+        expect_operator("(");
+        parse_datatype(&data_type);
+        expect_symbol(')');
+        make_sizeof_node(intern_datatype(current_process, &data_type), NULL);
+        return;
+    }
+    Node* expression_node = NULL;
+    if(is_next_token_operator("(")){
+        expect_operator("(");
+        parse_expressionable_root(clone_history(history, HISTORY_FLAG_PARENTHESES_IS_NOT_A_FUNCTION_CALL));
+        expect_symbol(')');
+        expression_node = pop_node();
+    }
+    else{
+        parse_single_token_to_node();
+        expression_node = pop_node();
+    }
+    make_sizeof_node(NULL, expression_node);
+}
+
+//tells sizeof(type) from sizeof(expression), the token cursor is always restored
+bool parser_is_parenthesized_datatype_ahead(){
+    if(!is_next_token_operator("(")){
+        return false;
+    }
+    DynamicVector* token_vector = current_process->token_vector;
+    if(save_vector_state(token_vector) != 0){
+        compiler_error(current_process, "out of memory saving the token cursor");
+    }
+    token_vector->peek_index++;
+    bool is_datatype = parser_is_cast_ahead();
+    restore_vector_state(token_vector);
+    return is_datatype;
+}
+
+//speculatively reads a datatype followed by ')' to tell a cast from a parenthesized expression, the token cursor is always restored
+bool parser_is_cast_ahead(){
+    DynamicVector* token_vector = current_process->token_vector;
+    if(save_vector_state(token_vector) != 0){
+        compiler_error(current_process, "out of memory saving the token cursor");
+    }
+    bool is_struct_or_union = false;
+    bool has_datatype = false;
+    Token* token = peek_next_token();
+    while(token && token->type == TOKEN_TYPE_KEYWORD && (keyword_is_datatype(token->value.string_val) || is_keyword_variable_modifier(token->value.string_val))){
+        //storage classes and qualifiers alone are no type, signed and unsigned alone mean int
+        has_datatype = has_datatype || keyword_is_datatype(token->value.string_val) || ARE_STRINGS_EQUAL(token->value.string_val, "signed") || ARE_STRINGS_EQUAL(token->value.string_val, "unsigned");
+        is_struct_or_union = is_struct_or_union || is_datatype_struct_or_union_given_name(token->value.string_val);
+        token_vector->peek_index++;
+        token = peek_next_token();
+    }
+    if(is_struct_or_union && is_token_identifier(token)){
+        token_vector->peek_index++;
+    }
+    while(has_datatype && is_next_token_operator("*")){
+        token_vector->peek_index++;
+    }
+    bool is_cast = has_datatype && is_next_token_symbol(')');
+    restore_vector_state(token_vector);
+    return is_cast;
+}
+
 void parser_deal_with_additional_parentheses(){
-    if(peek_next_token()->type == TOKEN_TYPE_OPERATOR){
+    if(is_next_token_operator("(")){
         parse_for_parenthesis(begin_history(0));
     }
 }
@@ -1422,11 +1691,11 @@ Node* parse_else_or_else_if(History* history){
     if(is_next_token_keyword("else")){
         get_next_token();
         if(is_next_token_keyword("if")){
-            parse_if_statement(clone_history(history, 0));
+            parse_if_statement(clone_history(history, history->flags));
             node = pop_node();
         }
         else{
-            node = parse_else_statement(clone_history(history, 0));
+            node = parse_else_statement(clone_history(history, history->flags));
         }
     }
     return node;
@@ -1533,13 +1802,13 @@ void parse_switch_statement(History* history){
     size_t variable_size = 0;
     parse_body(&variable_size, history);
     Node* body_node = pop_node();
-    make_switch_node(expression_node, body_node, switch_history.cases_data.cases, switch_history.cases_data.has_default_case);
+    make_switch_node(expression_node, body_node, switch_history.cases_data->cases, switch_history.cases_data->has_default_case);
     parser_end_switch_statement(&switch_history);
 }
 
 struct parser_history_switch parse_new_switch_statement(History* history){
-    memset(&history->parser_history_switch, 0, sizeof(struct parser_history_switch));
-    history->parser_history_switch.cases_data.cases = create_vector(sizeof(ParsedSwitchCase));
+    history->parser_history_switch.cases_data = calloc(1, sizeof(HistoryCases));
+    history->parser_history_switch.cases_data->cases = create_vector(sizeof(ParsedSwitchCase));
     history->flags |= HISTORY_FLAG_INSIDE_SWITCH;
     return history->parser_history_switch;
 }
@@ -1551,9 +1820,14 @@ void parser_end_switch_statement(struct parser_history_switch* switch_history){
 void parser_register_case(History* history, Node* case_node){
     assert(history->flags & HISTORY_FLAG_INSIDE_SWITCH);
     ParsedSwitchCase parsed_case;
-    parsed_case.index = case_node->data.statement.statement_switch_case.expression_node->literal_value.long_long_num;
-    parsed_case.index = 0;
-    push_element(history->parser_history_switch.cases_data.cases, &parsed_case);
+    parsed_case.index = get_node_constant_value(case_node->data.statement.statement_switch_case.expression_node);
+    DynamicVector* cases = history->parser_history_switch.cases_data->cases;
+    vector_for_each(ParsedSwitchCase, registered_case, cases){
+        if(registered_case->index == parsed_case.index){
+            compiler_error(current_process, "duplicate case value %lld", parsed_case.index);
+        }
+    }
+    push_element(cases, &parsed_case);
 }
 
 void parse_continue_statement(History* history){
@@ -1590,25 +1864,46 @@ void parse_switch_case(History* history){
     parse_expressionable_root(history);
     Node* expression_node = pop_node();
     expect_symbol(':');
+    expect_constant_expression(current_process, expression_node, "case label");
     make_switch_case_node(expression_node);
-    if(expression_node->type != NODE_TYPE_NUMBER){
-        compiler_error(current_process, "expecting a number for case");
-    }
     Node* case_node = peek_node();
     parser_register_case(history, case_node);
 }
 
+void parse_switch_default(History* history){
+    expect_keyword("default");
+    expect_symbol(':');
+    if(!(history->flags & HISTORY_FLAG_INSIDE_SWITCH)){
+        compiler_error(current_process, "default label not within a switch statement");
+    }
+    if(history->parser_history_switch.cases_data->has_default_case){
+        compiler_error(current_process, "multiple default labels in one switch");
+    }
+    history->parser_history_switch.cases_data->has_default_case = true;
+    make_switch_default_node();
+}
+
 void parse_for_tenary(History* history){
     Node* condition_node = pop_node();
     expect_operator("?");
     parse_expressionable_root(clone_history(history, HISTORY_FLAG_PARENTHESES_IS_NOT_A_FUNCTION_CALL));
     Node* true_node = pop_node();
     expect_symbol(':');
-    parse_expressionable_root(clone_history(history, HISTORY_FLAG_PARENTHESES_IS_NOT_A_FUNCTION_CALL));
+    parse_expressionable_root(clone_history(history, HISTORY_FLAG_PARENTHESES_IS_NOT_A_FUNCTION_CALL | (history->flags & HISTORY_FLAG_INSIDE_INITIALIZER)));
     Node* false_node = pop_node();
+    //the comma operator binds looser than ?:, eg: c ? a : b, d is (c ? a : b), d
+    Node* comma_right_node = NULL;
+    if(is_node_expression(false_node, ",")){
+        comma_right_node = false_node->data.expression.right;
+        false_node = false_node->data.expression.left;
+    }
     make_tenary_node(true_node, false_node);
     Node* tenary_node = pop_node();
     make_expression_node(condition_node, tenary_node, "?");
+    if(comma_right_node){
+        Node* conditional_node = pop_node();
+        make_expression_node(conditional_node, comma_right_node, ",");
+    }
 }
 
 void parse_for_comma(History* history){
@@ -1621,11 +1916,14 @@ void parse_for_comma(History* history){
 
 void parse_for_array(History* history){
     Node* left_node = peek_node_or_null();
-    if(left_node && left_node->type == NODE_TYPE_VARIABLE){
+    if(left_node && (left_node->type == NODE_TYPE_VARIABLE || is_node_of_value_type(left_node))){
         left_node = pop_node();
     }
+    else{
+        left_node = NULL;
+    }
     expect_operator("[");
-    parse_expressionable_root(history);
+    parse_expressionable_root(clone_history(history, history->flags & ~HISTORY_FLAG_INSIDE_INITIALIZER));
     expect_symbol(']');
     Node* expression_node = pop_node();
     make_bracket_node(expression_node);
@@ -1635,24 +1933,98 @@ void parse_for_array(History* history){
     }
 }
 
-void parse_for_cast(){
+void parse_for_cast(History* history){
     DataType data_type = {};
     parse_datatype(&data_type);
     expect_symbol(')');
-    parse_expressionable_root(begin_history(0));
+    parser_last_cast_token = parser_last_token;
+    parse_expressionable_root(begin_history(history->flags & HISTORY_FLAG_INSIDE_INITIALIZER));
+    Node* operand_node = pop_node();
+    make_cast_node(intern_datatype(current_process, &data_type), operand_node);
+    Node* cast_node = pop_node();
+    parser_reorder_unary(&cast_node);
+    push_node(cast_node);
+}
+
+bool is_unary_operator(const char* operator){
+    return ARE_STRINGS_EQUAL(operator, "-") || ARE_STRINGS_EQUAL(operator, "+") || ARE_STRINGS_EQUAL(operator, "!") || ARE_STRINGS_EQUAL(operator, "~") || ARE_STRINGS_EQUAL(operator, "*") || ARE_STRINGS_EQUAL(operator, "&") || ARE_STRINGS_EQUAL(operator, "++") || ARE_STRINGS_EQUAL(operator, "--");
+}
+
+//an operator is unary when no operand precedes it, eg: at the start of an expression, after another operator or after a cast
+bool parser_is_unary_operator_position(){
+    Token* last_token = parser_last_token;
+    if(!last_token){
+        return true;
+    }
+    switch(last_token->type){
+        case TOKEN_TYPE_IDENTIFIER:
+        case TOKEN_TYPE_NUMBER:
+        case TOKEN_TYPE_STRING:
+            return false;
+        case TOKEN_TYPE_SYMBOL:
+            if(last_token == parser_last_cast_token){
+                return true;
+            }
+            return last_token->value.char_val != ')' && last_token->value.char_val != ']';
+        case TOKEN_TYPE_OPERATOR:
+            return last_token != parser_last_postfix_token;
+    }
+    return true;
+}
+
+void parse_for_unary(History* history){
+    const char* unary_operator = get_next_token()->value.string_val;
+    parse_expressionable(history);
+    Node* operand_node = pop_node();
+    make_unary_node(unary_operator, operand_node, 0);
+    Node* unary_node = pop_node();
+    parser_reorder_unary(&unary_node);
+    push_node(unary_node);
+}
+
+void parse_for_postfix_unary(History* history){
+    Token* operator_token = get_next_token();
+    parser_last_postfix_token = operator_token;
     Node* operand_node = pop_node();
-    make_cast_node(&data_type, operand_node);
+    make_unary_node(operator_token->value.string_val, operand_node, UNARY_FLAG_IS_POSTFIX);
+}
+
+//the operand of a prefix unary operator or cast is parsed as a whole expression, -a+b gives UNARY(a+b) which is rotated into EXP(UNARY(a)+b)
+void parser_reorder_unary(Node** node_out){
+    Node* node = *node_out;
+    Node** operand_out = node->type == NODE_TYPE_CAST ? &node->data.cast.operand_node : &node->data.unary.operand;
+    Node* operand_node = *operand_out;
+    if(!operand_node || operand_node->type != NODE_TYPE_EXPRESSION || is_postfix_operator_group(operand_node->data.expression.operator)){
+        return;
+    }
+    *operand_out = operand_node->data.expression.left;
+    operand_node->data.expression.left = node;
+    parser_reorder_unary(&operand_node->data.expression.left);
+    *node_out = operand_node;
+}
+
+//operators binding tighter than any unary operator: calls, array access and member access
+bool is_postfix_operator_group(const char* operator){
+    ExpressionableOperatorPrecedanceGroup* group = NULL;
+    return parser_get_precedence_for_operator(operator, &group) == 0;
+}
+
+//an operand no binary operator can reach into, a[i]*b+c must not be reordered as if a[i] were a*b
+bool is_node_atomic_operand(Node* node){
+    return node->type != NODE_TYPE_EXPRESSION || is_postfix_operator_group(node->data.expression.operator);
 }
 
 bool is_datatype_struct_node_fixup(Fixup* fixup){
     DatatypeStructNodeFixPrivate* fix_private = return_fixup_private_data(fixup);
-    DataType* datatype = &fix_private->node_to_be_fixed->data.var.data_type;
-    datatype->type = DATA_TYPE_STRUCT;
-    datatype->size = get_size_of_struct(datatype->name);
-    datatype->data.struct_node = get_struct_node_for_name(current_process, datatype->name);
-    if(!datatype->data.struct_node){
+    //the canonical datatype is shared, so the resolved type is interned separately and swapped in
+    DataType datatype = *fix_private->node_to_be_fixed->data.var.data_type;
+    datatype.type = DATA_TYPE_STRUCT;
+    datatype.size = get_size_of_struct(datatype.name);
+    datatype.data.struct_node = get_struct_node_for_name(current_process, datatype.name);
+    if(!datatype.data.struct_node){
         return false;
     }
+    fix_private->node_to_be_fixed->data.var.data_type = intern_datatype(current_process, &datatype);
     return true;
 }
 
@@ -1674,7 +2046,7 @@ void parse_union_no_scope(DataType* datatype, bool is_forward_declaration){
     make_union_node(datatype->name, body_node);
     Node* union_node = pop_node();
     if(body_node){
-        datatype->size = body_node->data.body.size;
+        datatype->size = get_struct_layout(current_process, union_node)->size;
     }
     if(peek_next_token()->type == TOKEN_TYPE_IDENTIFIER){
         Token* variable_name = get_next_token();
@@ -1700,6 +2072,7 @@ void parse_union(DataType* datatype){
     if(!is_forward_declaration){
         parser_finish_scope();
     }
+    parser_bind_combined_variable(peek_node());
 }
 
 size_t get_size_of_union(const char* name){
@@ -1710,7 +2083,8 @@ size_t get_size_of_union(const char* name){
     assert(symbol->type == SYMBOL_TYPE_NODE);
     Node* node = symbol->data;
     assert(node->type == NODE_TYPE_UNION);
-    return node->data.body.size;
+    StructLayout* layout = get_struct_layout(current_process, node);
+    return layout ? layout->size : 0;
 }
 
 Node* get_union_node_for_name(CompileProcess* process, const char* name){
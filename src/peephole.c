@@ -0,0 +1,524 @@
+/*
+* @file peephole.c
+* @brief Peephole optimizer of the backend's instruction list
+* @details Instruction selection works one IR instruction at a time, so the seams between them leave moves to the register they came from, values stored to their home and read right back, constant address arithmetic after a lea and jumps to jumps. A table of rules looks at a small window of consecutive instructions at every position of a function and rewrites or deletes them, until no rule fires anymore. The flags are never live across a label or jump, instruction selection sets them in the same block as the branch or setcc reading them, and rax, rcx and rdx are only live within the instructions selected for one IR instruction, other registers are assumed live wherever the window doesn't show otherwise.
+*/
+
+#include "compiler.h"
+#include <limits.h>
+
+typedef struct Peephole{
+    DynamicVector* instructions;
+    int* labels; //the index of every label placed in the function, by label id - first_label
+    int first_label;
+    int label_count;
+} Peephole;
+
+typedef struct PeepholeRule{
+    const char* name;
+    bool (*apply)(Peephole* peephole, int index); //rewrites the window starting at index, returns whether it did
+} PeepholeRule;
+
+void asm_optimize_peephole(DynamicVector* instructions, int* fire_counts);
+
+void asm_dump_peephole_counts(int* fire_counts, FILE* file);
+
+static bool peephole_move_to_self(Peephole* peephole, int index);
+
+static bool peephole_push_pop(Peephole* peephole, int index);
+
+static bool peephole_store_load(Peephole* peephole, int index);
+
+static bool peephole_load_store(Peephole* peephole, int index);
+
+static bool peephole_identity_arithmetic(Peephole* peephole, int index);
+
+static bool peephole_lea_offset(Peephole* peephole, int index);
+
+static bool peephole_lea_move(Peephole* peephole, int index);
+
+static bool peephole_lea_address(Peephole* peephole, int index);
+
+static bool peephole_compare_zero(Peephole* peephole, int index);
+
+static bool peephole_jump_threading(Peephole* peephole, int index);
+
+static bool peephole_jump_to_next(Peephole* peephole, int index);
+
+static bool peephole_unreachable(Peephole* peephole, int index);
+
+static void peephole_index_labels(Peephole* peephole);
+
+static int peephole_label_index(Peephole* peephole, int label);
+
+static void peephole_remove(Peephole* peephole, int index);
+
+static AsmInstruction* peephole_at(Peephole* peephole, int index);
+
+static bool is_peephole_flags_dead(Peephole* peephole, int index);
+
+static bool is_peephole_register_dead(Peephole* peephole, int index, int reg);
+
+static bool is_peephole_register_read(AsmInstruction* instruction, int reg);
+
+static bool is_peephole_register_written(AsmInstruction* instruction, int reg);
+
+static bool is_peephole_operand_using(AsmOperand* operand, int reg);
+
+static bool is_peephole_register(AsmOperand* operand, int reg);
+
+static bool is_peephole_same_memory(AsmOperand* first, AsmOperand* second);
+
+static bool is_peephole_immediate_32(long long value);
+
+static const PeepholeRule peephole_rules[ASM_PEEPHOLE_RULE_COUNT] = {
+    [ASM_PEEPHOLE_MOVE_TO_SELF] = {"move to self", peephole_move_to_self},
+    [ASM_PEEPHOLE_PUSH_POP] = {"push pop", peephole_push_pop},
+    [ASM_PEEPHOLE_STORE_LOAD] = {"store load", peephole_store_load},
+    [ASM_PEEPHOLE_LOAD_STORE] = {"load store", peephole_load_store},
+    [ASM_PEEPHOLE_IDENTITY_ARITHMETIC] = {"identity arithmetic", peephole_identity_arithmetic},
+    [ASM_PEEPHOLE_LEA_OFFSET] = {"lea offset", peephole_lea_offset},
+    [ASM_PEEPHOLE_LEA_MOVE] = {"lea move", peephole_lea_move},
+    [ASM_PEEPHOLE_LEA_ADDRESS] = {"lea address", peephole_lea_address},
+    [ASM_PEEPHOLE_COMPARE_ZERO] = {"compare zero", peephole_compare_zero},
+    [ASM_PEEPHOLE_JUMP_THREADING] = {"jump threading", peephole_jump_threading},
+    [ASM_PEEPHOLE_JUMP_TO_NEXT] = {"jump to next", peephole_jump_to_next},
+    [ASM_PEEPHOLE_UNREACHABLE] = {"unreachable", peephole_unreachable}
+};
+
+
+
+void asm_optimize_peephole(DynamicVector* instructions, int* fire_counts){
+    Peephole peephole = {.instructions = instructions};
+    peephole_index_labels(&peephole);
+    bool is_changed = true;
+    while(is_changed){
+        is_changed = false;
+        for(int i = 0; i < get_element_count(instructions); i++){
+            for(int rule = 0; rule < ASM_PEEPHOLE_RULE_COUNT; rule++){
+                if(peephole_rules[rule].apply(&peephole, i)){
+                    fire_counts[rule]++;
+                    is_changed = true;
+                }
+            }
+        }
+    }
+    free(peephole.labels);
+}
+
+void asm_dump_peephole_counts(int* fire_counts, FILE* file){
+    fprintf(file, "peephole rules\n");
+    for(int rule = 0; rule < ASM_PEEPHOLE_RULE_COUNT; rule++){
+        fprintf(file, "    %s: %i\n", peephole_rules[rule].name, fire_counts[rule]);
+    }
+}
+
+// A move of a register to itself does nothing, except for the 32 bit one, which clears the upper half.
+static bool peephole_move_to_self(Peephole* peephole, int index){
+    AsmInstruction* move = peephole_at(peephole, index);
+    if(!move || move->opcode != ASM_OPCODE_MOV || move->size == 4 || move->source.type != ASM_OPERAND_REGISTER || !is_peephole_register(&move->destination, move->source.reg)){
+        return false;
+    }
+    peephole_remove(peephole, index);
+    return true;
+}
+
+// A value pushed and popped right away is a move, or nothing when it goes back to the same register.
+static bool peephole_push_pop(Peephole* peephole, int index){
+    AsmInstruction* push = peephole_at(peephole, index);
+    AsmInstruction* pop = peephole_at(peephole, index + 1);
+    if(!push || !pop || push->opcode != ASM_OPCODE_PUSH || pop->opcode != ASM_OPCODE_POP || push->destination.type != ASM_OPERAND_REGISTER || pop->destination.type != ASM_OPERAND_REGISTER){
+        return false;
+    }
+    if(push->destination.reg == pop->destination.reg){
+        peephole_remove(peephole, index + 1);
+        peephole_remove(peephole, index);
+        return true;
+    }
+    pop->opcode = ASM_OPCODE_MOV;
+    pop->source = push->destination;
+    peephole_remove(peephole, index);
+    return true;
+}
+
+// Reading back what was just stored takes the register that was stored instead.
+static bool peephole_store_load(Peephole* peephole, int index){
+    AsmInstruction* store = peephole_at(peephole, index);
+    AsmInstruction* load = peephole_at(peephole, index + 1);
+    if(!store || !load || store->opcode != ASM_OPCODE_MOV || load->opcode != ASM_OPCODE_MOV || store->size != load->size){
+        return false;
+    }
+    if(store->source.type != ASM_OPERAND_REGISTER || load->destination.type != ASM_OPERAND_REGISTER || !is_peephole_same_memory(&store->destination, &load->source)){
+        return false;
+    }
+    if(load->destination.reg == store->source.reg){
+        peephole_remove(peephole, index + 1);
+        return true;
+    }
+    load->source = store->source;
+    return true;
+}
+
+// Storing a value back where it was just loaded from changes nothing.
+static bool peephole_load_store(Peephole* peephole, int index){
+    AsmInstruction* load = peephole_at(peephole, index);
+    AsmInstruction* store = peephole_at(peephole, index + 1);
+    if(!load || !store || load->opcode != ASM_OPCODE_MOV || store->opcode != ASM_OPCODE_MOV || load->size != store->size){
+        return false;
+    }
+    if(load->destination.type != ASM_OPERAND_REGISTER || !is_peephole_register(&store->source, load->destination.reg) || !is_peephole_same_memory(&load->source, &store->destination)){
+        return false;
+    }
+    //the load must not have overwritten the register its address is based on
+    if(is_peephole_operand_using(&load->source, load->destination.reg)){
+        return false;
+    }
+    peephole_remove(peephole, index + 1);
+    return true;
+}
+
+// Adding, subtracting, or-ing, xor-ing or shifting by 0 only changes the flags. The upper half of a 32 bit register it would clear is unspecified in the backend.
+static bool peephole_identity_arithmetic(Peephole* peephole, int index){
+    AsmInstruction* instruction = peephole_at(peephole, index);
+    if(!instruction || instruction->source.type != ASM_OPERAND_IMMEDIATE || instruction->source.value != 0 || instruction->destination.type != ASM_OPERAND_REGISTER){
+        return false;
+    }
+    switch(instruction->opcode){
+        case ASM_OPCODE_ADD:
+        case ASM_OPCODE_SUB:
+        case ASM_OPCODE_OR:
+        case ASM_OPCODE_XOR:
+        case ASM_OPCODE_SHL:
+        case ASM_OPCODE_SAR:
+        case ASM_OPCODE_SHR:
+            break;
+        default:
+            return false;
+    }
+    if(!is_peephole_flags_dead(peephole, index + 1)){
+        return false;
+    }
+    peephole_remove(peephole, index);
+    return true;
+}
+
+// A constant added to or subtracted from an address computed by lea goes into its displacement.
+static bool peephole_lea_offset(Peephole* peephole, int index){
+    AsmInstruction* lea = peephole_at(peephole, index);
+    AsmInstruction* arithmetic = peephole_at(peephole, index + 1);
+    if(!lea || !arithmetic || lea->opcode != ASM_OPCODE_LEA || (arithmetic->opcode != ASM_OPCODE_ADD && arithmetic->opcode != ASM_OPCODE_SUB)){
+        return false;
+    }
+    if(arithmetic->size != 8 || arithmetic->source.type != ASM_OPERAND_IMMEDIATE || !is_peephole_register(&arithmetic->destination, lea->destination.reg)){
+        return false;
+    }
+    long long displacement = lea->source.value + (arithmetic->opcode == ASM_OPCODE_ADD ? arithmetic->source.value : -arithmetic->source.value);
+    if(!is_peephole_immediate_32(displacement) || !is_peephole_flags_dead(peephole, index + 2)){
+        return false;
+    }
+    lea->source.value = displacement;
+    peephole_remove(peephole, index + 1);
+    return true;
+}
+
+// An address computed into a scratch register only to be moved on is computed where it is moved to.
+static bool peephole_lea_move(Peephole* peephole, int index){
+    AsmInstruction* lea = peephole_at(peephole, index);
+    AsmInstruction* move = peephole_at(peephole, index + 1);
+    if(!lea || !move || lea->opcode != ASM_OPCODE_LEA || move->opcode != ASM_OPCODE_MOV || move->size != 8){
+        return false;
+    }
+    int reg = lea->destination.reg;
+    if(!is_peephole_register(&move->source, reg) || move->destination.type != ASM_OPERAND_REGISTER || move->destination.reg == reg || !is_peephole_register_dead(peephole, index + 2, reg)){
+        return false;
+    }
+    lea->destination.reg = move->destination.reg;
+    peephole_remove(peephole, index + 1);
+    return true;
+}
+
+// A load or store through an address lea just computed into a register that dies with it addresses the memory of the lea directly.
+static bool peephole_lea_address(Peephole* peephole, int index){
+    AsmInstruction* lea = peephole_at(peephole, index);
+    AsmInstruction* access = peephole_at(peephole, index + 1);
+    if(!lea || !access || lea->opcode != ASM_OPCODE_LEA){
+        return false;
+    }
+    if(access->opcode != ASM_OPCODE_MOV && access->opcode != ASM_OPCODE_MOVSX && access->opcode != ASM_OPCODE_MOVZX){
+        return false;
+    }
+    int reg = lea->destination.reg;
+    AsmOperand* memory = &access->source;
+    AsmOperand* other = &access->destination;
+    if(memory->type != ASM_OPERAND_MEMORY){
+        memory = &access->destination;
+        other = &access->source;
+    }
+    bool is_plain_base = memory->type == ASM_OPERAND_MEMORY && memory->reg == reg && (memory->index == ASM_REGISTER_NONE || !memory->scale);
+    if(!is_plain_base || !is_peephole_immediate_32(lea->source.value + memory->value)){
+        return false;
+    }
+    //the loaded register may be the address itself, which it overwrites
+    bool is_overwritten = other == &access->destination && is_peephole_register_written(access, reg);
+    if(!is_overwritten && (is_peephole_operand_using(other, reg) || !is_peephole_register_dead(peephole, index + 2, reg))){
+        return false;
+    }
+    AsmOperand address = lea->source;
+    address.size = memory->size;
+    address.value += memory->value;
+    *memory = address;
+    peephole_remove(peephole, index);
+    return true;
+}
+
+// test sets the flags of a compare with 0 the same way and needs no immediate.
+static bool peephole_compare_zero(Peephole* peephole, int index){
+    AsmInstruction* compare = peephole_at(peephole, index);
+    if(!compare || compare->opcode != ASM_OPCODE_CMP || compare->source.type != ASM_OPERAND_IMMEDIATE || compare->source.value != 0 || compare->destination.type != ASM_OPERAND_REGISTER){
+        return false;
+    }
+    compare->opcode = ASM_OPCODE_TEST;
+    compare->source = compare->destination;
+    return true;
+}
+
+// A jump to a label followed by a jump goes to where that one jumps, chains are followed to their end and cycles left alone.
+static bool peephole_jump_threading(Peephole* peephole, int index){
+    AsmInstruction* jump = peephole_at(peephole, index);
+    if(!jump || (jump->opcode != ASM_OPCODE_JMP && jump->opcode != ASM_OPCODE_JCC) || jump->destination.type != ASM_OPERAND_LABEL){
+        return false;
+    }
+    int target = jump->destination.label;
+    for(int hops = 0; hops <= peephole->label_count; hops++){
+        int label_index = peephole_label_index(peephole, target);
+        if(label_index < 0){
+            break;
+        }
+        AsmInstruction* next = peephole_at(peephole, label_index + 1);
+        while(next && next->opcode == ASM_OPCODE_LABEL){
+            next = peephole_at(peephole, ++label_index + 1);
+        }
+        if(!next || next->opcode != ASM_OPCODE_JMP || next->destination.type != ASM_OPERAND_LABEL){
+            break;
+        }
+        target = next->destination.label;
+        if(target == jump->destination.label){
+            return false;
+        }
+    }
+    if(target == jump->destination.label || peephole_label_index(peephole, target) < 0){
+        return false;
+    }
+    jump->destination.label = target;
+    return true;
+}
+
+// A jump to one of the labels right after it falls through instead.
+static bool peephole_jump_to_next(Peephole* peephole, int index){
+    AsmInstruction* jump = peephole_at(peephole, index);
+    if(!jump || (jump->opcode != ASM_OPCODE_JMP && jump->opcode != ASM_OPCODE_JCC) || jump->destination.type != ASM_OPERAND_LABEL){
+        return false;
+    }
+    int next_index = index + 1;
+    for(AsmInstruction* next = peephole_at(peephole, next_index); next && next->opcode == ASM_OPCODE_LABEL; next = peephole_at(peephole, ++next_index)){
+        if(next->destination.label == jump->destination.label){
+            peephole_remove(peephole, index);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Nothing reaches an instruction after a jump or return other than through a label.
+static bool peephole_unreachable(Peephole* peephole, int index){
+    AsmInstruction* jump = peephole_at(peephole, index);
+    AsmInstruction* next = peephole_at(peephole, index + 1);
+    if(!jump || !next || (jump->opcode != ASM_OPCODE_JMP && jump->opcode != ASM_OPCODE_RET) || next->opcode == ASM_OPCODE_LABEL){
+        return false;
+    }
+    peephole_remove(peephole, index + 1);
+    return true;
+}
+
+static void peephole_index_labels(Peephole* peephole){
+    int first_label = INT_MAX;
+    int last_label = -1;
+    vector_for_each(AsmInstruction, instruction, peephole->instructions){
+        if(instruction->opcode == ASM_OPCODE_LABEL){
+            first_label = instruction->destination.label < first_label ? instruction->destination.label : first_label;
+            last_label = instruction->destination.label > last_label ? instruction->destination.label : last_label;
+        }
+    }
+    peephole->first_label = first_label;
+    peephole->label_count = last_label < 0 ? 0 : last_label - first_label + 1;
+    peephole->labels = malloc((peephole->label_count + 1) * sizeof(int));
+    for(int i = 0; i < peephole->label_count; i++){
+        peephole->labels[i] = -1;
+    }
+    for(int i = 0; i < get_element_count(peephole->instructions); i++){
+        AsmInstruction* instruction = peephole_at(peephole, i);
+        if(instruction->opcode == ASM_OPCODE_LABEL){
+            peephole->labels[instruction->destination.label - first_label] = i;
+        }
+    }
+}
+
+// The index of the label in the instruction list, -1 if it is not placed in the function.
+static int peephole_label_index(Peephole* peephole, int label){
+    if(label < peephole->first_label || label - peephole->first_label >= peephole->label_count){
+        return -1;
+    }
+    return peephole->labels[label - peephole->first_label];
+}
+
+// Removes an instruction that is not a label and moves the labels after it along.
+static void peephole_remove(Peephole* peephole, int index){
+    remove_element_at(peephole->instructions, index);
+    for(int i = 0; i < peephole->label_count; i++){
+        if(peephole->labels[i] > index){
+            peephole->labels[i]--;
+        }
+    }
+}
+
+static AsmInstruction* peephole_at(Peephole* peephole, int index){
+    return vector_AsmInstruction_at_pointer(peephole->instructions, index);
+}
+
+// Whether the flags are set again before anything from index on reads them.
+static bool is_peephole_flags_dead(Peephole* peephole, int index){
+    for(AsmInstruction* instruction = peephole_at(peephole, index); instruction; instruction = peephole_at(peephole, ++index)){
+        switch(instruction->opcode){
+            case ASM_OPCODE_JCC:
+            case ASM_OPCODE_SETCC:
+                return false;
+            case ASM_OPCODE_LABEL:
+            case ASM_OPCODE_JMP:
+            case ASM_OPCODE_RET:
+            case ASM_OPCODE_CALL:
+            case ASM_OPCODE_ADD:
+            case ASM_OPCODE_SUB:
+            case ASM_OPCODE_IMUL:
+            case ASM_OPCODE_IDIV:
+            case ASM_OPCODE_DIV:
+            case ASM_OPCODE_NEG:
+            case ASM_OPCODE_AND:
+            case ASM_OPCODE_OR:
+            case ASM_OPCODE_XOR:
+            case ASM_OPCODE_CMP:
+            case ASM_OPCODE_TEST:
+                return true;
+            case ASM_OPCODE_SHL:
+            case ASM_OPCODE_SAR:
+            case ASM_OPCODE_SHR:
+                //a shift by 0, which a count in cl may be, leaves the flags alone
+                if(instruction->source.type == ASM_OPERAND_IMMEDIATE && instruction->source.value){
+                    return true;
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+// Whether reg is overwritten before anything from index on reads it. What happens past a label, jump or call is not known.
+static bool is_peephole_register_dead(Peephole* peephole, int index, int reg){
+    for(AsmInstruction* instruction = peephole_at(peephole, index); instruction; instruction = peephole_at(peephole, ++index)){
+        switch(instruction->opcode){
+            case ASM_OPCODE_LABEL:
+            case ASM_OPCODE_JMP:
+            case ASM_OPCODE_JCC:
+            case ASM_OPCODE_CALL:
+            case ASM_OPCODE_RET:
+                return false;
+        }
+        if(is_peephole_register_read(instruction, reg)){
+            return false;
+        }
+        if(is_peephole_register_written(instruction, reg)){
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_peephole_register_read(AsmInstruction* instruction, int reg){
+    switch(instruction->opcode){
+        case ASM_OPCODE_CQO:
+            return reg == ASM_REGISTER_RAX;
+        case ASM_OPCODE_IDIV:
+        case ASM_OPCODE_DIV:
+            if(reg == ASM_REGISTER_RAX || reg == ASM_REGISTER_RDX){
+                return true;
+            }
+            break;
+        case ASM_OPCODE_REP_MOVSB:
+            return reg == ASM_REGISTER_RDI || reg == ASM_REGISTER_RSI || reg == ASM_REGISTER_RCX;
+        case ASM_OPCODE_PUSH:
+        case ASM_OPCODE_POP:
+        case ASM_OPCODE_LEAVE:
+            if(reg == ASM_REGISTER_RSP || reg == ASM_REGISTER_RBP){
+                return true;
+            }
+            break;
+    }
+    if(is_peephole_operand_using(&instruction->source, reg)){
+        return true;
+    }
+    if(instruction->destination.type == ASM_OPERAND_MEMORY){
+        return is_peephole_operand_using(&instruction->destination, reg);
+    }
+    return is_peephole_register(&instruction->destination, reg) && !is_peephole_register_written(instruction, reg);
+}
+
+// Whether the instruction replaces all of reg with a value that doesn't depend on it. Writing the 32 bit register clears the upper half.
+static bool is_peephole_register_written(AsmInstruction* instruction, int reg){
+    if(instruction->opcode == ASM_OPCODE_CQO){
+        return reg == ASM_REGISTER_RDX;
+    }
+    if(!is_peephole_register(&instruction->destination, reg) || instruction->destination.size < 4 || is_peephole_operand_using(&instruction->source, reg)){
+        return false;
+    }
+    switch(instruction->opcode){
+        case ASM_OPCODE_MOV:
+        case ASM_OPCODE_MOVSX:
+        case ASM_OPCODE_MOVZX:
+        case ASM_OPCODE_LEA:
+        case ASM_OPCODE_POP:
+            return true;
+    }
+    return false;
+}
+
+static bool is_peephole_operand_using(AsmOperand* operand, int reg){
+    if(operand->type == ASM_OPERAND_REGISTER){
+        return operand->reg == reg;
+    }
+    if(operand->type == ASM_OPERAND_MEMORY){
+        return operand->reg == reg || (operand->index == reg && operand->scale);
+    }
+    return false;
+}
+
+static bool is_peephole_register(AsmOperand* operand, int reg){
+    return operand->type == ASM_OPERAND_REGISTER && operand->reg == reg;
+}
+
+static bool is_peephole_same_memory(AsmOperand* first, AsmOperand* second){
+    if(first->type != ASM_OPERAND_MEMORY || second->type != ASM_OPERAND_MEMORY || first->size != second->size){
+        return false;
+    }
+    if(first->reg != second->reg || first->value != second->value || first->label != second->label){
+        return false;
+    }
+    if((first->index != ASM_REGISTER_NONE && first->scale) || (second->index != ASM_REGISTER_NONE && second->scale)){
+        if(first->index != second->index || first->scale != second->scale){
+            return false;
+        }
+    }
+    return first->symbol == second->symbol || ARE_STRINGS_EQUAL(first->symbol, second->symbol);
+}
+
+static bool is_peephole_immediate_32(long long value){
+    return value >= INT_MIN && value <= INT_MAX;
+}
@@ -0,0 +1,369 @@
+/*
+* @file registerAllocator.c
+* @brief Register allocation for the x86-64 backend
+* @details A linear scan in the style of Poletto and Sarkar over the virtual registers of a function after SSA destruction. Instructions are numbered in block layout order, every virtual register gets one interval from its first to its last live position, computed from the uses that are live into a block and propagated backwards to the definitions. Spilled intervals are not split, instruction selection reloads them into a scratch register at each use.
+*/
+
+#include "compiler.h"
+#include <limits.h>
+
+#define REGISTER_ALLOCATOR_LOOP_WEIGHT 8
+#define REGISTER_ALLOCATOR_MAX_LOOP_DEPTH 6
+
+typedef struct LiveInterval{
+    int vreg;
+    int start;
+    int end;
+    double weight; //the uses and definitions, each weighted by the loop depth it is in
+    double spill_weight; //weight per position covered, the interval with the lowest one is spilled first
+    bool crosses_call;
+    bool crosses_memcopy;
+    int reg;
+} LiveInterval;
+
+typedef struct RegisterAllocatorOccurrence{
+    int vreg;
+    int block;
+} RegisterAllocatorOccurrence;
+
+typedef struct RegisterAllocator{
+    IrFunction* function;
+    LiveInterval* intervals; //indexed by virtual register
+    int* block_first_positions; //indexed by block id
+    int* block_last_positions;
+    DynamicVector* live_in_uses; //the RegisterAllocatorOccurrence of uses not preceded by a definition in their block
+    DynamicVector* definitions; //the RegisterAllocatorOccurrence of every definition
+    DynamicVector* call_positions;
+    DynamicVector* memcopy_positions;
+} RegisterAllocator;
+
+//caller saved registers first, they don't have to be preserved by the prologue
+static const int register_allocator_order[] = {
+    ASM_REGISTER_R10, ASM_REGISTER_R11, ASM_REGISTER_R8, ASM_REGISTER_R9, ASM_REGISTER_RSI, ASM_REGISTER_RDI,
+    ASM_REGISTER_RBX, ASM_REGISTER_R12, ASM_REGISTER_R13, ASM_REGISTER_R14, ASM_REGISTER_R15
+};
+
+RegisterAllocation* allocate_registers(IrFunction* function);
+
+void free_register_allocation(RegisterAllocation* allocation);
+
+static void register_allocator_number(RegisterAllocator* allocator);
+
+static int* register_allocator_loop_depths(IrFunction* function);
+
+static void register_allocator_occurrence(RegisterAllocator* allocator, int vreg, int position, double weight);
+
+static void register_allocator_propagate_liveness(RegisterAllocator* allocator);
+
+static bool register_allocator_crosses(DynamicVector* positions, LiveInterval* interval);
+
+static void register_allocator_scan(RegisterAllocator* allocator, RegisterAllocation* allocation);
+
+static bool is_register_allocator_candidate(IrFunction* function, int vreg);
+
+static bool is_register_allocator_allowed(LiveInterval* interval, int reg);
+
+static bool is_register_allocator_caller_saved(int reg);
+
+static int register_allocator_compare_occurrences(const void* first, const void* second);
+
+static int register_allocator_compare_starts(const void* first, const void* second);
+
+
+
+RegisterAllocation* allocate_registers(IrFunction* function){
+    int vreg_count = ir_get_vreg_count(function);
+    RegisterAllocator allocator = {.function = function};
+    allocator.intervals = calloc(vreg_count + 1, sizeof(LiveInterval));
+    for(int i = 0; i < vreg_count; i++){
+        allocator.intervals[i] = (LiveInterval){.vreg = i, .start = INT_MAX, .end = -1, .reg = ASM_REGISTER_NONE};
+    }
+    allocator.block_first_positions = calloc(function->next_block_id + 1, sizeof(int));
+    allocator.block_last_positions = calloc(function->next_block_id + 1, sizeof(int));
+    allocator.live_in_uses = create_vector(sizeof(RegisterAllocatorOccurrence));
+    allocator.definitions = create_vector(sizeof(RegisterAllocatorOccurrence));
+    allocator.call_positions = create_vector(sizeof(int));
+    allocator.memcopy_positions = create_vector(sizeof(int));
+
+    register_allocator_number(&allocator);
+    register_allocator_propagate_liveness(&allocator);
+    RegisterAllocation* allocation = calloc(1, sizeof(RegisterAllocation));
+    allocation->registers = malloc((vreg_count + 1) * sizeof(int));
+    register_allocator_scan(&allocator, allocation);
+
+    free(allocator.intervals);
+    free(allocator.block_first_positions);
+    free(allocator.block_last_positions);
+    destroy_vector(allocator.live_in_uses);
+    destroy_vector(allocator.definitions);
+    destroy_vector(allocator.call_positions);
+    destroy_vector(allocator.memcopy_positions);
+    return allocation;
+}
+
+void free_register_allocation(RegisterAllocation* allocation){
+    free(allocation->registers);
+    free(allocation);
+}
+
+// Gives instruction k the positions 2k, where it reads its operands, and 2k + 1, where it writes its result. Parameters are all read on entry, before the first of them.
+static void register_allocator_number(RegisterAllocator* allocator){
+    IrFunction* function = allocator->function;
+    int* loop_depths = register_allocator_loop_depths(function);
+    int* defining_block = malloc((ir_get_vreg_count(function) + 1) * sizeof(int));
+    for(int i = 0; i < ir_get_vreg_count(function); i++){
+        defining_block[i] = -1;
+    }
+    int position = 0;
+    int parameter_position = -1;
+    for(int i = 0; i < get_element_count(function->blocks); i++){
+        IrBlock* block = vector_IrBlockPtr_at(function->blocks, i);
+        double weight = 1;
+        for(int depth = 0; depth < loop_depths[i] && depth < REGISTER_ALLOCATOR_MAX_LOOP_DEPTH; depth++){
+            weight *= REGISTER_ALLOCATOR_LOOP_WEIGHT;
+        }
+        allocator->block_first_positions[block->id] = position;
+        vector_for_each(IrInstruction*, instruction_pointer, block->instructions){
+            IrInstruction* instruction = *instruction_pointer;
+            int uses[IR_MAX_OPERANDS] = {instruction->operands[0], instruction->operands[1]};
+            for(int j = 0; j < IR_MAX_OPERANDS + (instruction->opcode == IR_OP_CALL ? get_element_count(instruction->arguments) : 0); j++){
+                int vreg = j < IR_MAX_OPERANDS ? uses[j] : vector_Int_at(instruction->arguments, j - IR_MAX_OPERANDS);
+                if(vreg == IR_VREG_NONE || !is_register_allocator_candidate(function, vreg)){
+                    continue;
+                }
+                register_allocator_occurrence(allocator, vreg, position, weight);
+                if(defining_block[vreg] != block->id){
+                    RegisterAllocatorOccurrence use = {.vreg = vreg, .block = block->id};
+                    push_element(allocator->live_in_uses, &use);
+                }
+            }
+            if(instruction->opcode == IR_OP_CALL){
+                vector_Int_push(allocator->call_positions, position);
+            }
+            else if(instruction->opcode == IR_OP_MEMCOPY){
+                vector_Int_push(allocator->memcopy_positions, position);
+            }
+            if(instruction->result != IR_VREG_NONE && is_register_allocator_candidate(function, instruction->result)){
+                if(instruction->opcode == IR_OP_PARAM && parameter_position < 0){
+                    parameter_position = position;
+                }
+                register_allocator_occurrence(allocator, instruction->result, (instruction->opcode == IR_OP_PARAM ? parameter_position : position) + 1, weight);
+                defining_block[instruction->result] = block->id;
+                RegisterAllocatorOccurrence definition = {.vreg = instruction->result, .block = block->id};
+                push_element(allocator->definitions, &definition);
+            }
+            position += 2;
+        }
+        allocator->block_last_positions[block->id] = position - 1;
+    }
+    free(defining_block);
+    free(loop_depths);
+}
+
+// The number of loops around every block, indexed by layout position. A loop is an edge back to a block earlier in reverse postorder and spans the layout from its header to the block jumping back.
+static int* register_allocator_loop_depths(IrFunction* function){
+    int block_count = get_element_count(function->blocks);
+    int* layout_positions = calloc(function->next_block_id + 1, sizeof(int));
+    int* depth_changes = calloc(block_count + 1, sizeof(int));
+    for(int i = 0; i < block_count; i++){
+        layout_positions[vector_IrBlockPtr_at(function->blocks, i)->id] = i;
+    }
+    for(int i = 0; i < block_count; i++){
+        IrBlock* block = vector_IrBlockPtr_at(function->blocks, i);
+        vector_for_each(IrBlock*, successor, block->successors){
+            int header = layout_positions[(*successor)->id];
+            if((*successor)->order <= block->order && header <= i){
+                depth_changes[header]++;
+                depth_changes[i + 1]--;
+            }
+        }
+    }
+    int depth = 0;
+    for(int i = 0; i < block_count; i++){
+        depth += depth_changes[i];
+        depth_changes[i] = depth;
+    }
+    free(layout_positions);
+    return depth_changes;
+}
+
+static void register_allocator_occurrence(RegisterAllocator* allocator, int vreg, int position, double weight){
+    LiveInterval* interval = &allocator->intervals[vreg];
+    interval->start = position < interval->start ? position : interval->start;
+    interval->end = position > interval->end ? position : interval->end;
+    interval->weight += weight;
+}
+
+// A register read before it is written in a block is live into it, and out of every predecessor. Liveness flows backwards until it reaches the blocks defining the register.
+static void register_allocator_propagate_liveness(RegisterAllocator* allocator){
+    IrFunction* function = allocator->function;
+    int* defined_in = malloc((function->next_block_id + 1) * sizeof(int)); //indexed by block id, the register last marked as defined there
+    int* live_in = malloc((function->next_block_id + 1) * sizeof(int));
+    for(int i = 0; i < function->next_block_id; i++){
+        defined_in[i] = -1;
+        live_in[i] = -1;
+    }
+    IrBlock** blocks = calloc(function->next_block_id + 1, sizeof(IrBlock*));
+    vector_for_each(IrBlock*, block, function->blocks){
+        blocks[(*block)->id] = *block;
+    }
+    qsort(get_vector_data_pointer(allocator->live_in_uses), get_element_count(allocator->live_in_uses), sizeof(RegisterAllocatorOccurrence), register_allocator_compare_occurrences);
+    qsort(get_vector_data_pointer(allocator->definitions), get_element_count(allocator->definitions), sizeof(RegisterAllocatorOccurrence), register_allocator_compare_occurrences);
+    DynamicVector* worklist = create_vector(sizeof(IrBlock*));
+    int definition_index = 0;
+    int use_count = get_element_count(allocator->live_in_uses);
+    for(int use_index = 0; use_index < use_count;){
+        int vreg = ((RegisterAllocatorOccurrence*)get_element_at(allocator->live_in_uses, use_index))->vreg;
+        LiveInterval* interval = &allocator->intervals[vreg];
+        while(definition_index < get_element_count(allocator->definitions) && ((RegisterAllocatorOccurrence*)get_element_at(allocator->definitions, definition_index))->vreg <= vreg){
+            RegisterAllocatorOccurrence* definition = get_element_at(allocator->definitions, definition_index++);
+            if(definition->vreg == vreg){
+                defined_in[definition->block] = vreg;
+            }
+        }
+        for(; use_index < use_count && ((RegisterAllocatorOccurrence*)get_element_at(allocator->live_in_uses, use_index))->vreg == vreg; use_index++){
+            int block_id = ((RegisterAllocatorOccurrence*)get_element_at(allocator->live_in_uses, use_index))->block;
+            if(live_in[block_id] != vreg){
+                live_in[block_id] = vreg;
+                vector_IrBlockPtr_push(worklist, blocks[block_id]);
+            }
+        }
+        while(!is_vector_empty(worklist)){
+            IrBlock* block = vector_IrBlockPtr_pop(worklist);
+            interval->start = allocator->block_first_positions[block->id] < interval->start ? allocator->block_first_positions[block->id] : interval->start;
+            vector_for_each(IrBlock*, predecessor, block->predecessors){
+                int last_position = allocator->block_last_positions[(*predecessor)->id];
+                interval->end = last_position > interval->end ? last_position : interval->end;
+                if(defined_in[(*predecessor)->id] != vreg && live_in[(*predecessor)->id] != vreg){
+                    live_in[(*predecessor)->id] = vreg;
+                    vector_IrBlockPtr_push(worklist, *predecessor);
+                }
+            }
+        }
+    }
+    destroy_vector(worklist);
+    free(blocks);
+    free(defined_in);
+    free(live_in);
+}
+
+// Whether one of the sorted positions lies strictly inside the interval, a call reading or defining the register itself doesn't count.
+static bool register_allocator_crosses(DynamicVector* positions, LiveInterval* interval){
+    int low = 0;
+    int high = get_element_count(positions);
+    while(low < high){
+        int middle = (low + high) / 2;
+        if(vector_Int_at(positions, middle) <= interval->start){
+            low = middle + 1;
+        }
+        else{
+            high = middle;
+        }
+    }
+    return low < get_element_count(positions) && vector_Int_at(positions, low) < interval->end;
+}
+
+// Walks the intervals by start, the active ones are kept sorted by end so the expired ones come first.
+static void register_allocator_scan(RegisterAllocator* allocator, RegisterAllocation* allocation){
+    IrFunction* function = allocator->function;
+    int vreg_count = ir_get_vreg_count(function);
+    DynamicVector* intervals = create_vector(sizeof(LiveInterval*));
+    for(int i = 0; i < vreg_count; i++){
+        LiveInterval* interval = &allocator->intervals[i];
+        allocation->registers[i] = ASM_REGISTER_NONE;
+        if(interval->end < 0){
+            continue;
+        }
+        interval->spill_weight = interval->weight / (interval->end - interval->start + 1);
+        interval->crosses_call = register_allocator_crosses(allocator->call_positions, interval);
+        interval->crosses_memcopy = register_allocator_crosses(allocator->memcopy_positions, interval);
+        push_element(intervals, &interval);
+    }
+    qsort(get_vector_data_pointer(intervals), get_element_count(intervals), sizeof(LiveInterval*), register_allocator_compare_starts);
+
+    LiveInterval* owners[ASM_REGISTER_COUNT] = {};
+    DynamicVector* active = create_vector(sizeof(LiveInterval*));
+    vector_for_each(LiveInterval*, current_pointer, intervals){
+        LiveInterval* current = *current_pointer;
+        while(!is_vector_empty(active) && (*(LiveInterval**)get_element_at(active, 0))->end < current->start){
+            owners[(*(LiveInterval**)get_element_at(active, 0))->reg] = NULL;
+            remove_element_at(active, 0);
+        }
+        for(int i = 0; i < (int)(sizeof(register_allocator_order) / sizeof(int)); i++){
+            int reg = register_allocator_order[i];
+            if(!owners[reg] && is_register_allocator_allowed(current, reg)){
+                current->reg = reg;
+                break;
+            }
+        }
+        if(current->reg == ASM_REGISTER_NONE){
+            LiveInterval* victim = NULL;
+            int victim_index = -1;
+            for(int i = 0; i < get_element_count(active); i++){
+                LiveInterval* candidate = *(LiveInterval**)get_element_at(active, i);
+                if(is_register_allocator_allowed(current, candidate->reg) && (!victim || candidate->spill_weight < victim->spill_weight)){
+                    victim = candidate;
+                    victim_index = i;
+                }
+            }
+            if(!victim || victim->spill_weight >= current->spill_weight){
+                allocation->spill_count++;
+                continue;
+            }
+            current->reg = victim->reg;
+            victim->reg = ASM_REGISTER_NONE;
+            remove_element_at(active, victim_index);
+            allocation->spill_count++;
+        }
+        owners[current->reg] = current;
+        int index = get_element_count(active);
+        while(index > 0 && (*(LiveInterval**)get_element_at(active, index - 1))->end > current->end){
+            index--;
+        }
+        insert_element_at(active, index, &current);
+    }
+    vector_for_each(LiveInterval*, interval, intervals){
+        allocation->registers[(*interval)->vreg] = (*interval)->reg;
+        if((*interval)->reg != ASM_REGISTER_NONE){
+            allocation->used_registers |= 1 << (*interval)->reg;
+        }
+    }
+    destroy_vector(active);
+    destroy_vector(intervals);
+}
+
+// Registers without a definition and rematerialized ones need neither a register nor an interval.
+static bool is_register_allocator_candidate(IrFunction* function, int vreg){
+    IrInstruction* definition = vector_IrInstructionPtr_at(function->definitions, vreg);
+    return definition && !is_ir_rematerializable(definition);
+}
+
+// Calls clobber the caller saved registers and the string copy of IR_OP_MEMCOPY clobbers rsi and rdi.
+static bool is_register_allocator_allowed(LiveInterval* interval, int reg){
+    if(interval->crosses_call && is_register_allocator_caller_saved(reg)){
+        return false;
+    }
+    return !interval->crosses_memcopy || (reg != ASM_REGISTER_RSI && reg != ASM_REGISTER_RDI);
+}
+
+static bool is_register_allocator_caller_saved(int reg){
+    return reg != ASM_REGISTER_RBX && reg != ASM_REGISTER_RBP && reg != ASM_REGISTER_RSP && (reg < ASM_REGISTER_R12 || reg > ASM_REGISTER_R15);
+}
+
+static int register_allocator_compare_occurrences(const void* first, const void* second){
+    const RegisterAllocatorOccurrence* first_occurrence = first;
+    const RegisterAllocatorOccurrence* second_occurrence = second;
+    if(first_occurrence->vreg != second_occurrence->vreg){
+        return first_occurrence->vreg < second_occurrence->vreg ? -1 : 1;
+    }
+    return first_occurrence->block - second_occurrence->block;
+}
+
+static int register_allocator_compare_starts(const void* first, const void* second){
+    const LiveInterval* first_interval = *(LiveInterval* const*)first;
+    const LiveInterval* second_interval = *(LiveInterval* const*)second;
+    if(first_interval->start != second_interval->start){
+        return first_interval->start < second_interval->start ? -1 : 1;
+    }
+    return first_interval->vreg - second_interval->vreg;
+}
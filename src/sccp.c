@@ -0,0 +1,281 @@
+/*
+* @file sccp.c
+* @brief Sparse conditional constant propagation
+* @details The algorithm of Wegman and Zadeck over the SSA form. Every register starts out unknown and is only ever lowered to a constant and then to overdefined, blocks are only evaluated once an edge into them is known to be taken. Registers that stay constant are turned into IR_OP_CONST, branches on constants into jumps, and the blocks no taken edge reaches are deleted.
+*/
+
+#include "compiler.h"
+
+enum{
+    SCCP_UNKNOWN,
+    SCCP_CONSTANT,
+    SCCP_OVERDEFINED
+};
+
+typedef struct SccpValue{
+    int state;
+    long long value; //valid when state is SCCP_CONSTANT
+} SccpValue;
+
+typedef struct SccpEdge{
+    IrBlock* from; //NULL for the edge into the entry block
+    IrBlock* to;
+} SccpEdge;
+
+typedef struct Sccp{
+    IrFunction* function;
+    SccpValue* values; //indexed by register
+    DynamicVector** executable_predecessors; //indexed by block id, the blocks whose edge into it is taken, NULL while the block is not executable
+    DynamicVector* edge_worklist;
+    DynamicVector* register_worklist;
+} Sccp;
+
+void ir_propagate_constants(IrFunction* function);
+
+static void sccp_take_edge(Sccp* sccp, SccpEdge* edge);
+
+static void sccp_visit(Sccp* sccp, IrInstruction* instruction);
+
+static void sccp_visit_phi(Sccp* sccp, IrInstruction* phi);
+
+static void sccp_visit_branch(Sccp* sccp, IrInstruction* branch);
+
+static void sccp_lower(Sccp* sccp, int vreg, SccpValue value);
+
+static bool is_sccp_edge_executable(Sccp* sccp, IrBlock* from, IrBlock* to);
+
+static void sccp_push_edge(Sccp* sccp, IrBlock* from, IrBlock* to);
+
+static void sccp_rewrite_block(Sccp* sccp, IrBlock* block);
+
+static void sccp_drop_phi_incomings(IrBlock* block, IrBlock* predecessor);
+
+
+
+void ir_propagate_constants(IrFunction* function){
+    int vreg_count = ir_get_vreg_count(function);
+    Sccp sccp = {.function = function};
+    sccp.values = calloc(vreg_count + 1, sizeof(SccpValue));
+    sccp.executable_predecessors = calloc(function->next_block_id + 1, sizeof(DynamicVector*));
+    sccp.edge_worklist = create_vector(sizeof(SccpEdge));
+    sccp.register_worklist = create_vector(sizeof(int));
+
+    sccp_push_edge(&sccp, NULL, vector_IrBlockPtr_at(function->blocks, 0));
+    while(!is_vector_empty(sccp.edge_worklist) || !is_vector_empty(sccp.register_worklist)){
+        if(!is_vector_empty(sccp.edge_worklist)){
+            SccpEdge edge = *(SccpEdge*)get_element_at(sccp.edge_worklist, get_element_count(sccp.edge_worklist) - 1);
+            remove_last_element(sccp.edge_worklist);
+            sccp_take_edge(&sccp, &edge);
+            continue;
+        }
+        DynamicVector* users = vector_VoidPtr_at(function->uses, vector_Int_pop(sccp.register_worklist));
+        if(!users){
+            continue;
+        }
+        vector_for_each(IrInstruction*, user, users){
+            if(sccp.executable_predecessors[(*user)->block->id]){
+                sccp_visit(&sccp, *user);
+            }
+        }
+    }
+
+    vector_for_each(IrBlock*, block, function->blocks){
+        if(sccp.executable_predecessors[(*block)->id]){
+            sccp_rewrite_block(&sccp, *block);
+        }
+    }
+    for(int i = 0; i < function->next_block_id; i++){
+        if(sccp.executable_predecessors[i]){
+            destroy_vector(sccp.executable_predecessors[i]);
+        }
+    }
+    free(sccp.executable_predecessors);
+    free(sccp.values);
+    destroy_vector(sccp.edge_worklist);
+    destroy_vector(sccp.register_worklist);
+    ir_remove_unreachable_blocks(function);
+    ir_compute_dominators(function);
+    ir_compute_def_use(function);
+}
+
+// The first edge into a block evaluates all of it, later ones only change what its phis see.
+static void sccp_take_edge(Sccp* sccp, SccpEdge* edge){
+    DynamicVector* predecessors = sccp->executable_predecessors[edge->to->id];
+    bool is_first_edge = !predecessors;
+    if(is_first_edge){
+        predecessors = create_vector(sizeof(IrBlock*));
+        sccp->executable_predecessors[edge->to->id] = predecessors;
+    }
+    else if(is_sccp_edge_executable(sccp, edge->from, edge->to)){
+        return;
+    }
+    if(edge->from){
+        vector_IrBlockPtr_push(predecessors, edge->from);
+    }
+    vector_for_each(IrInstruction*, instruction, edge->to->instructions){
+        if(!is_first_edge && (*instruction)->opcode != IR_OP_PHI){
+            break;
+        }
+        sccp_visit(sccp, *instruction);
+    }
+}
+
+// Computes the lattice value of the result from the values of the operands, an operand that is still unknown postpones the instruction until it is known.
+static void sccp_visit(Sccp* sccp, IrInstruction* instruction){
+    switch(instruction->opcode){
+        case IR_OP_PHI:
+            sccp_visit_phi(sccp, instruction);
+            return;
+        case IR_OP_BRANCH:
+            sccp_visit_branch(sccp, instruction);
+            return;
+        case IR_OP_JUMP:
+            sccp_push_edge(sccp, instruction->block, instruction->targets[0]);
+            return;
+    }
+    if(instruction->result == IR_VREG_NONE){
+        return;
+    }
+    long long operands[IR_MAX_OPERANDS] = {};
+    for(int i = 0; i < IR_MAX_OPERANDS; i++){
+        if(instruction->operands[i] == IR_VREG_NONE){
+            continue;
+        }
+        SccpValue operand = sccp->values[instruction->operands[i]];
+        if(operand.state == SCCP_OVERDEFINED){
+            sccp_lower(sccp, instruction->result, (SccpValue){.state = SCCP_OVERDEFINED});
+            return;
+        }
+        if(operand.state == SCCP_UNKNOWN){
+            return;
+        }
+        operands[i] = operand.value;
+    }
+    long long value = 0;
+    //loads, calls, parameters and undefined values are never constant
+    if(instruction->opcode == IR_OP_CALL || !ir_fold_instruction(sccp->function, instruction, operands[0], operands[1], &value)){
+        sccp_lower(sccp, instruction->result, (SccpValue){.state = SCCP_OVERDEFINED});
+        return;
+    }
+    sccp_lower(sccp, instruction->result, (SccpValue){.state = SCCP_CONSTANT, .value = value});
+}
+
+// Meets the values coming in over the taken edges, the others can't reach the phi.
+static void sccp_visit_phi(Sccp* sccp, IrInstruction* phi){
+    SccpValue result = {.state = SCCP_UNKNOWN};
+    vector_for_each(IrPhiIncoming, incoming, phi->arguments){
+        if(!is_sccp_edge_executable(sccp, incoming->block, phi->block)){
+            continue;
+        }
+        SccpValue value = sccp->values[incoming->vreg];
+        if(value.state == SCCP_OVERDEFINED || (value.state == SCCP_CONSTANT && result.state == SCCP_CONSTANT && value.value != result.value)){
+            result.state = SCCP_OVERDEFINED;
+            break;
+        }
+        if(value.state == SCCP_CONSTANT){
+            result = value;
+        }
+    }
+    sccp_lower(sccp, phi->result, result);
+}
+
+static void sccp_visit_branch(Sccp* sccp, IrInstruction* branch){
+    SccpValue condition = sccp->values[branch->operands[0]];
+    if(condition.state == SCCP_UNKNOWN){
+        return;
+    }
+    if(condition.state == SCCP_OVERDEFINED || condition.value){
+        sccp_push_edge(sccp, branch->block, branch->targets[0]);
+    }
+    if(condition.state == SCCP_OVERDEFINED || !condition.value){
+        sccp_push_edge(sccp, branch->block, branch->targets[1]);
+    }
+}
+
+// Values only move down the lattice, so every register is queued at most twice.
+static void sccp_lower(Sccp* sccp, int vreg, SccpValue value){
+    SccpValue* current = &sccp->values[vreg];
+    if(current->state == SCCP_OVERDEFINED || value.state == SCCP_UNKNOWN){
+        return;
+    }
+    if(current->state == SCCP_CONSTANT && (value.state == SCCP_CONSTANT && value.value == current->value)){
+        return;
+    }
+    current->state = current->state == SCCP_CONSTANT ? SCCP_OVERDEFINED : value.state;
+    current->value = value.value;
+    vector_Int_push(sccp->register_worklist, vreg);
+}
+
+static bool is_sccp_edge_executable(Sccp* sccp, IrBlock* from, IrBlock* to){
+    DynamicVector* predecessors = sccp->executable_predecessors[to->id];
+    if(!predecessors){
+        return false;
+    }
+    vector_for_each(IrBlock*, predecessor, predecessors){
+        if(*predecessor == from){
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sccp_push_edge(Sccp* sccp, IrBlock* from, IrBlock* to){
+    SccpEdge edge = {.from = from, .to = to};
+    push_element(sccp->edge_worklist, &edge);
+}
+
+// Turns the constant registers of an executable block into constants and a branch on a constant into a jump. Phis that became constants move behind the remaining phis.
+static void sccp_rewrite_block(Sccp* sccp, IrBlock* block){
+    DynamicVector* phis = create_vector(sizeof(IrInstruction*));
+    DynamicVector* constants = create_vector(sizeof(IrInstruction*));
+    DynamicVector* others = create_vector(sizeof(IrInstruction*));
+    vector_for_each(IrInstruction*, instruction_pointer, block->instructions){
+        IrInstruction* instruction = *instruction_pointer;
+        bool is_constant = instruction->result != IR_VREG_NONE && sccp->values[instruction->result].state == SCCP_CONSTANT;
+        if(is_constant && instruction->opcode != IR_OP_CONST){
+            bool was_phi = instruction->opcode == IR_OP_PHI;
+            ir_make_constant(instruction, sccp->values[instruction->result].value);
+            vector_IrInstructionPtr_push(was_phi ? constants : others, instruction);
+            continue;
+        }
+        if(instruction->opcode == IR_OP_BRANCH && sccp->values[instruction->operands[0]].state == SCCP_CONSTANT){
+            IrBlock* taken = instruction->targets[sccp->values[instruction->operands[0]].value ? 0 : 1];
+            IrBlock* not_taken = instruction->targets[sccp->values[instruction->operands[0]].value ? 1 : 0];
+            if(not_taken != taken){
+                sccp_drop_phi_incomings(not_taken, block);
+            }
+            instruction->opcode = IR_OP_JUMP;
+            instruction->operands[0] = IR_VREG_NONE;
+            instruction->targets[0] = taken;
+            instruction->targets[1] = NULL;
+        }
+        vector_IrInstructionPtr_push(instruction->opcode == IR_OP_PHI ? phis : others, instruction);
+    }
+    clear_vector(block->instructions);
+    vector_for_each(IrInstruction*, phi, phis){
+        vector_IrInstructionPtr_push(block->instructions, *phi);
+    }
+    vector_for_each(IrInstruction*, constant, constants){
+        vector_IrInstructionPtr_push(block->instructions, *constant);
+    }
+    vector_for_each(IrInstruction*, other, others){
+        vector_IrInstructionPtr_push(block->instructions, *other);
+    }
+    destroy_vector(phis);
+    destroy_vector(constants);
+    destroy_vector(others);
+}
+
+static void sccp_drop_phi_incomings(IrBlock* block, IrBlock* predecessor){
+    vector_for_each(IrInstruction*, instruction, block->instructions){
+        if((*instruction)->opcode != IR_OP_PHI){
+            break;
+        }
+        DynamicVector* incomings = (*instruction)->arguments;
+        for(int i = get_element_count(incomings) - 1; i >= 0; i--){
+            if(((IrPhiIncoming*)get_element_at(incomings, i))->block == predecessor){
+                remove_element_at(incomings, i);
+            }
+        }
+    }
+}
@@ -3,25 +3,27 @@
 #include <stdlib.h>
 #include <assert.h>
 
-Scope* allocate_scope();
+Scope* allocate_scope(CompileProcess* process);
 
 Scope* create_root_scope(CompileProcess* process);
 
-Scope* deallocate_scope(Scope* scope);
+void deallocate_scope(CompileProcess* process, Scope* scope);
+
+static int get_scope_entity_end(CompileProcess* process, Scope* scope);
 
 void free_root_scope(CompileProcess* process);
 
 Scope* new_scope(CompileProcess* process, int flags);
 
-void scope_iteration_start(Scope* scope);
+void scope_iteration_start(CompileProcess* process, Scope* scope);
 
 void scope_iteration_end(Scope* scope);
 
-void* scope_iterate_back(Scope* scope);
+void* scope_iterate_back(CompileProcess* process, Scope* scope);
 
-void* get_last_entity_of_scope(Scope* scope);
+void* get_last_entity_of_scope(CompileProcess* process, Scope* scope);
 
-void* get_last_entity_from_scope_stop_at(Scope* scope, Scope* stop_scope);
+void* get_last_entity_from_scope_stop_at(CompileProcess* process, Scope* scope, Scope* stop_scope);
 
 void* get_scope_last_entity_stop_at(CompileProcess *process, Scope* stop_scope);
 
@@ -33,34 +35,56 @@ void finish_scope(CompileProcess* process);
 
 Scope* get_current_scope(CompileProcess* process);
 
+static void scope_unbind_to_mark(CompileProcess* process, int mark);
+
+ScopeBinding* scope_bind(CompileProcess* process, const char* name, Node* node);
+
+ScopeBinding* scope_lookup_binding(CompileProcess* process, const char* name);
+
+Node* scope_lookup(CompileProcess* process, const char* name);
+
+ScopeBinding* scope_lookup_binding_in_current_scope(CompileProcess* process, const char* name);
 
 
 
 
 
-Scope* allocate_scope(){
-    Scope* scope = calloc(1, sizeof(Scope));
-    scope->entities = create_vector(sizeof(void*));
-    set_peek_index_to_end(scope->entities);
-    set_vector_flag(scope->entities, VECTOR_FLAG_DECREMENT_PEEK);
+
+Scope* allocate_scope(CompileProcess* process){
+    Scope* scope = NULL;
+    if(process->scope.free_scopes && !is_vector_empty(process->scope.free_scopes)){
+        scope = vector_VoidPtr_pop(process->scope.free_scopes);
+        memset(scope, 0, sizeof(Scope));
+    }
+    else{
+        scope = calloc(1, sizeof(Scope));
+    }
+    scope->entity_start = get_element_count(process->scope.entities);
+    scope->binding_mark = get_element_count(process->scope.binding_log);
     return scope;
 }
 
 Scope* create_root_scope(CompileProcess* process){ //the global scope
     assert(!process->scope.root);
     assert(!process->scope.current);
-    Scope* root_scope = allocate_scope();
+    if(!process->scope.entities){
+        process->scope.entities = create_vector(sizeof(void*));
+        process->scope.free_scopes = create_vector(sizeof(Scope*));
+        process->scope.bindings = create_hash_table(0);
+        process->scope.binding_log = create_vector(sizeof(ScopeBinding*));
+    }
+    Scope* root_scope = allocate_scope(process);
     process->scope.root = root_scope;
     process->scope.current = root_scope;
     return root_scope;
 }
 
-Scope* deallocate_scope(Scope* scope){
-
+void deallocate_scope(CompileProcess* process, Scope* scope){
+    vector_VoidPtr_push(process->scope.free_scopes, scope);
 }
 
 void free_root_scope(CompileProcess* process){
-    deallocate_scope(process->scope.root);
+    deallocate_scope(process, process->scope.root);
     process->scope.root = NULL;
     process->scope.current = NULL;
 }
@@ -68,69 +92,76 @@ void free_root_scope(CompileProcess* process){
 Scope* new_scope(CompileProcess* process, int flags){
     assert(process->scope.root);
     assert(process->scope.current);
-    Scope* new_scope = allocate_scope();
+    Scope* new_scope = allocate_scope(process);
     new_scope->flags = flags;
     new_scope->parent = process->scope.current;
+    process->scope.current->active_child = new_scope;
     process->scope.current = new_scope;
     return new_scope;
 }
 
-void scope_iteration_start(Scope* scope){
-    set_peek_index(scope->entities, 0);
-    if(scope->entities->flag_settings & VECTOR_FLAG_DECREMENT_PEEK){
-        set_peek_index_to_end(scope->entities);
+// Returns the index one past the scope's last entity, entities of open child scopes come after it.
+static int get_scope_entity_end(CompileProcess* process, Scope* scope){
+    if(scope->active_child){
+        return scope->active_child->entity_start;
     }
+    return get_element_count(process->scope.entities);
+}
+
+void scope_iteration_start(CompileProcess* process, Scope* scope){
+    scope->iterate_index = get_scope_entity_end(process, scope) - 1;
 }
 
 void scope_iteration_end(Scope* scope){
 }
 
-void* scope_iterate_back(Scope* scope){
-    if(get_element_count(scope->entities) == 0){
+void* scope_iterate_back(CompileProcess* process, Scope* scope){
+    if(scope->iterate_index < scope->entity_start){
         return NULL;
     }
-    return peek_pointer(scope->entities);
+    return vector_VoidPtr_at(process->scope.entities, scope->iterate_index--);
 }
 
-void* get_last_entity_of_scope(Scope* scope){
-    if(get_element_count(scope->entities) == 0){
-        return NULL;
-    }
-    return get_last_element_pointer(scope->entities);
+void* get_last_entity_of_scope(CompileProcess* process, Scope* scope){
+    return get_last_entity_from_scope_stop_at(process, scope, scope->parent);
 }
 
-void* get_last_entity_from_scope_stop_at(Scope* scope, Scope* stop_scope){
+void* get_last_entity_from_scope_stop_at(CompileProcess* process, Scope* scope, Scope* stop_scope){
+    //entities of scope and its ancestors below stop_scope form one run of the entity stack
     if(scope == stop_scope){
         return NULL;
     }
-    void* last_entity = get_last_entity_of_scope(scope);
-    if(last_entity){
-        return last_entity;
-    }
-    Scope* parent_scope = scope->parent;
-    if(parent_scope){
-        return get_last_entity_from_scope_stop_at(parent_scope, stop_scope);
+    int end = get_scope_entity_end(process, scope);
+    int start = stop_scope ? get_scope_entity_end(process, stop_scope) : 0;
+    if(end <= start){
+        return NULL;
     }
-    return NULL;
+    return vector_VoidPtr_at(process->scope.entities, end - 1);
 }
 
 void* get_scope_last_entity_stop_at(CompileProcess *process, Scope* stop_scope){
-    return get_last_entity_from_scope_stop_at(process->scope.current, stop_scope);
+    return get_last_entity_from_scope_stop_at(process, process->scope.current, stop_scope);
 }
 
 void* get_scope_last_entity(CompileProcess* process){
-    return get_last_entity_from_scope_stop_at(process->scope.current, NULL);
+    return get_last_entity_from_scope_stop_at(process, process->scope.current, NULL);
 }
 
 void push_scope(CompileProcess* process, void* pointer, size_t element_size){
-    push_element(process->scope.current->entities, &pointer);
+    vector_VoidPtr_push(process->scope.entities, pointer);
     process->scope.current->size+=element_size;
 }
 
 void finish_scope(CompileProcess* process){
-    Scope* new_currnet_scope = process->scope.current->parent;
-    deallocate_scope(process->scope.current);
+    Scope* finished_scope = process->scope.current;
+    scope_unbind_to_mark(process, finished_scope->binding_mark);
+    remove_vector_range(process->scope.entities, finished_scope->entity_start, get_element_count(process->scope.entities) - finished_scope->entity_start);
+    Scope* new_currnet_scope = finished_scope->parent;
+    deallocate_scope(process, finished_scope);
     process->scope.current = new_currnet_scope;
+    if(new_currnet_scope){
+        new_currnet_scope->active_child = NULL;
+    }
     if(process->scope.root && !process->scope.current){
         process->scope.root = NULL;
     }
@@ -140,3 +171,52 @@ Scope* get_current_scope(CompileProcess* process){
     return process->scope.current;
 }
 
+// Undoes every binding made after the given point of the binding log, uncovering the bindings they shadowed.
+static void scope_unbind_to_mark(CompileProcess* process, int mark){
+    DynamicVector* binding_log = process->scope.binding_log;
+    while(get_element_count(binding_log) > mark){
+        ScopeBinding* binding = vector_VoidPtr_pop(binding_log);
+        if(binding->shadowed){
+            hash_table_put(process->scope.bindings, binding->name, binding->shadowed);
+        }
+        else{
+            hash_table_remove(process->scope.bindings, binding->name);
+        }
+        free(binding);
+    }
+}
+
+ScopeBinding* scope_bind(CompileProcess* process, const char* name, Node* node){
+    ScopeBinding* shadowed = hash_table_get(process->scope.bindings, name);
+    if(shadowed && shadowed->node == node){
+        return shadowed;
+    }
+    ScopeBinding* binding = calloc(1, sizeof(ScopeBinding));
+    binding->name = name;
+    binding->node = node;
+    binding->scope = process->scope.current;
+    binding->shadowed = shadowed;
+    hash_table_put(process->scope.bindings, name, binding);
+    vector_VoidPtr_push(process->scope.binding_log, binding);
+    return binding;
+}
+
+ScopeBinding* scope_lookup_binding(CompileProcess* process, const char* name){
+    if(!process->scope.bindings){
+        return NULL;
+    }
+    return hash_table_get(process->scope.bindings, name);
+}
+
+Node* scope_lookup(CompileProcess* process, const char* name){
+    ScopeBinding* binding = scope_lookup_binding(process, name);
+    return binding ? binding->node : NULL;
+}
+
+ScopeBinding* scope_lookup_binding_in_current_scope(CompileProcess* process, const char* name){
+    ScopeBinding* binding = scope_lookup_binding(process, name);
+    if(binding && binding->scope == process->scope.current){
+        return binding;
+    }
+    return NULL;
+}
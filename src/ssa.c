@@ -0,0 +1,304 @@
+/*
+* @file ssa.c
+* @brief Conversion of the intermediate representation to and out of SSA form
+* @details ir_construct_ssa promotes stack slots to virtual registers the way Cytron et al. describe it, phis go on the iterated dominance frontier of the blocks storing to a slot and a walk over the dominator tree renames the loads to the value reaching them. ir_destruct_ssa lowers the phis back to copies for the code generator.
+*/
+
+#include "compiler.h"
+
+typedef struct SsaRenamer{
+    IrFunction* function;
+    bool* promoted; //indexed by slot
+    DynamicVector** values; //indexed by slot, the stack of values reaching the current block
+    int* undefined_values; //indexed by slot, the UNDEF read before the first store, IR_VREG_NONE until needed
+    int* replacements; //indexed by register, the value a promoted load was replaced with
+} SsaRenamer;
+
+void ir_construct_ssa(IrFunction* function);
+
+void ir_destruct_ssa(IrFunction* function);
+
+static void ssa_find_promotable_slots(IrFunction* function, bool* promoted);
+
+static int ssa_promoted_slot(IrFunction* function, bool* promoted, int address);
+
+static void ssa_place_phis(IrFunction* function, bool* promoted);
+
+static void ssa_rename_block(SsaRenamer* renamer, IrBlock* block);
+
+static int ssa_current_value(SsaRenamer* renamer, int slot);
+
+static int ssa_replacement(SsaRenamer* renamer, int vreg);
+
+static void ssa_remove_promoted_accesses(IrFunction* function, bool* promoted);
+
+
+
+void ir_construct_ssa(IrFunction* function){
+    ir_compute_cfg(function);
+    ir_compute_dominators(function);
+    ir_compute_def_use(function);
+    int slot_count = get_element_count(function->slots);
+    bool* promoted = calloc(slot_count + 1, sizeof(bool));
+    ssa_find_promotable_slots(function, promoted);
+    ssa_place_phis(function, promoted);
+
+    SsaRenamer renamer = {.function = function, .promoted = promoted};
+    renamer.values = calloc(slot_count + 1, sizeof(DynamicVector*));
+    renamer.undefined_values = calloc(slot_count + 1, sizeof(int));
+    for(int i = 0; i < slot_count; i++){
+        renamer.values[i] = promoted[i] ? create_vector(sizeof(int)) : NULL;
+        renamer.undefined_values[i] = IR_VREG_NONE;
+    }
+    int vreg_count = ir_get_vreg_count(function);
+    renamer.replacements = malloc((vreg_count + 1) * sizeof(int));
+    for(int i = 0; i < vreg_count; i++){
+        renamer.replacements[i] = i;
+    }
+    //the definitions map is only read for registers that existed before renaming started
+    ssa_rename_block(&renamer, vector_IrBlockPtr_at(function->blocks, 0));
+    ssa_remove_promoted_accesses(function, promoted);
+    for(int i = 0; i < slot_count; i++){
+        if(promoted[i]){
+            ((IrStackSlot*)get_element_at(function->slots, i))->flags |= IR_STACK_SLOT_FLAG_PROMOTED;
+            destroy_vector(renamer.values[i]);
+        }
+    }
+    free(renamer.values);
+    free(renamer.undefined_values);
+    free(renamer.replacements);
+    free(promoted);
+    ir_compute_def_use(function);
+}
+
+void ir_destruct_ssa(IrFunction* function){
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction_pointer, (*block)->instructions){
+            IrInstruction* phi = *instruction_pointer;
+            if(phi->opcode != IR_OP_PHI){
+                break;
+            }
+            int temporary = ir_new_vreg(function, phi->type);
+            vector_for_each(IrPhiIncoming, incoming, phi->arguments){
+                IrInstruction* copy = ir_new_instruction(IR_OP_COPY, phi->type, temporary);
+                copy->operands[0] = incoming->vreg;
+                ir_insert_instruction(incoming->block, get_element_count(incoming->block->instructions) - 1, copy);
+            }
+            destroy_vector(phi->arguments);
+            phi->arguments = NULL;
+            phi->opcode = IR_OP_COPY;
+            phi->operands[0] = temporary;
+        }
+    }
+    ir_compute_def_use(function);
+}
+
+// A scalar slot can be promoted when each of its addresses is only used to load or store a value of the slot's own type.
+static void ssa_find_promotable_slots(IrFunction* function, bool* promoted){
+    for(int i = 0; i < get_element_count(function->slots); i++){
+        promoted[i] = ((IrStackSlot*)get_element_at(function->slots, i))->type != IR_TYPE_VOID;
+    }
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            if((*instruction)->opcode != IR_OP_SLOT_ADDRESS || !promoted[(*instruction)->slot]){
+                continue;
+            }
+            int address = (*instruction)->result;
+            int slot_type = ((IrStackSlot*)get_element_at(function->slots, (*instruction)->slot))->type;
+            DynamicVector* users = vector_VoidPtr_at(function->uses, address);
+            if(!users){
+                continue;
+            }
+            vector_for_each(IrInstruction*, user, users){
+                bool is_load = (*user)->opcode == IR_OP_LOAD && (*user)->type == slot_type;
+                bool is_store = (*user)->opcode == IR_OP_STORE && (*user)->type == slot_type && (*user)->operands[1] != address;
+                if(!is_load && !is_store){
+                    promoted[(*instruction)->slot] = false;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Returns the slot the address points to if that slot is being promoted, -1 otherwise.
+static int ssa_promoted_slot(IrFunction* function, bool* promoted, int address){
+    if(address == IR_VREG_NONE || address >= get_element_count(function->definitions)){
+        return -1;
+    }
+    IrInstruction* definition = vector_IrInstructionPtr_at(function->definitions, address);
+    if(!definition || definition->opcode != IR_OP_SLOT_ADDRESS || !promoted[definition->slot]){
+        return -1;
+    }
+    return definition->slot;
+}
+
+// Places a phi for every promoted slot on the iterated dominance frontier of the blocks storing to it. The phi remembers its slot until renaming fills it.
+static void ssa_place_phis(IrFunction* function, bool* promoted){
+    int block_count = function->next_block_id;
+    int* has_phi = malloc(block_count * sizeof(int));
+    int* in_worklist = malloc(block_count * sizeof(int));
+    for(int i = 0; i < block_count; i++){
+        has_phi[i] = -1;
+        in_worklist[i] = -1;
+    }
+    int slot_count = get_element_count(function->slots);
+    DynamicVector** store_blocks = calloc(slot_count + 1, sizeof(DynamicVector*));
+    vector_for_each(IrBlock*, block, function->blocks){
+        vector_for_each(IrInstruction*, instruction, (*block)->instructions){
+            int slot = (*instruction)->opcode == IR_OP_STORE ? ssa_promoted_slot(function, promoted, (*instruction)->operands[0]) : -1;
+            if(slot < 0){
+                continue;
+            }
+            if(!store_blocks[slot]){
+                store_blocks[slot] = create_vector(sizeof(IrBlock*));
+            }
+            if(vector_IrBlockPtr_last_or(store_blocks[slot], NULL) != *block){
+                vector_IrBlockPtr_push(store_blocks[slot], *block);
+            }
+        }
+    }
+    DynamicVector* worklist = create_vector(sizeof(IrBlock*));
+    for(int slot = 0; slot < slot_count; slot++){
+        if(!store_blocks[slot]){
+            continue;
+        }
+        int type = ((IrStackSlot*)get_element_at(function->slots, slot))->type;
+        vector_for_each(IrBlock*, block, store_blocks[slot]){
+            vector_IrBlockPtr_push(worklist, *block);
+            in_worklist[(*block)->id] = slot;
+        }
+        destroy_vector(store_blocks[slot]);
+        while(!is_vector_empty(worklist)){
+            IrBlock* block = vector_IrBlockPtr_pop(worklist);
+            vector_for_each(IrBlock*, frontier_block, block->dominance_frontier){
+                if(has_phi[(*frontier_block)->id] == slot){
+                    continue;
+                }
+                IrInstruction* phi = ir_new_instruction(IR_OP_PHI, type, ir_new_vreg(function, type));
+                phi->slot = slot;
+                ir_insert_instruction(*frontier_block, 0, phi);
+                has_phi[(*frontier_block)->id] = slot;
+                //the phi is a new store of the slot
+                if(in_worklist[(*frontier_block)->id] != slot){
+                    in_worklist[(*frontier_block)->id] = slot;
+                    vector_IrBlockPtr_push(worklist, *frontier_block);
+                }
+            }
+        }
+    }
+    destroy_vector(worklist);
+    free(store_blocks);
+    free(in_worklist);
+    free(has_phi);
+}
+
+// Renames the block and then its children in the dominator tree, the values it pushed are popped again on the way back.
+static void ssa_rename_block(SsaRenamer* renamer, IrBlock* block){
+    IrFunction* function = renamer->function;
+    DynamicVector* pushed_slots = create_vector(sizeof(int));
+    vector_for_each(IrInstruction*, instruction_pointer, block->instructions){
+        IrInstruction* instruction = *instruction_pointer;
+        if(instruction->opcode == IR_OP_PHI){
+            if(instruction->slot >= 0){
+                vector_Int_push(renamer->values[instruction->slot], instruction->result);
+                vector_Int_push(pushed_slots, instruction->slot);
+            }
+            continue;
+        }
+        for(int i = 0; i < IR_MAX_OPERANDS; i++){
+            if(instruction->operands[i] != IR_VREG_NONE){
+                instruction->operands[i] = ssa_replacement(renamer, instruction->operands[i]);
+            }
+        }
+        if(instruction->opcode == IR_OP_CALL){
+            vector_for_each(int, argument, instruction->arguments){
+                *argument = ssa_replacement(renamer, *argument);
+            }
+        }
+        if(instruction->opcode == IR_OP_LOAD){
+            int slot = ssa_promoted_slot(function, renamer->promoted, instruction->operands[0]);
+            if(slot >= 0){
+                renamer->replacements[instruction->result] = ssa_current_value(renamer, slot);
+            }
+        }
+        else if(instruction->opcode == IR_OP_STORE){
+            int slot = ssa_promoted_slot(function, renamer->promoted, instruction->operands[0]);
+            if(slot >= 0){
+                vector_Int_push(renamer->values[slot], instruction->operands[1]);
+                vector_Int_push(pushed_slots, slot);
+            }
+        }
+    }
+    vector_for_each(IrBlock*, successor, block->successors){
+        vector_for_each(IrInstruction*, instruction, (*successor)->instructions){
+            if((*instruction)->opcode != IR_OP_PHI){
+                break;
+            }
+            if((*instruction)->slot >= 0){
+                IrPhiIncoming incoming = {.block = block, .vreg = ssa_current_value(renamer, (*instruction)->slot)};
+                push_element((*instruction)->arguments, &incoming);
+            }
+        }
+    }
+    vector_for_each(IrBlock*, child, block->dominated){
+        ssa_rename_block(renamer, *child);
+    }
+    vector_for_each(int, slot, pushed_slots){
+        vector_Int_pop(renamer->values[*slot]);
+    }
+    destroy_vector(pushed_slots);
+}
+
+// The value of the slot reaching the current point, reading it before any store gives an UNDEF placed at the start of the function.
+static int ssa_current_value(SsaRenamer* renamer, int slot){
+    if(!is_vector_empty(renamer->values[slot])){
+        return vector_Int_last(renamer->values[slot]);
+    }
+    if(renamer->undefined_values[slot] == IR_VREG_NONE){
+        int type = ((IrStackSlot*)get_element_at(renamer->function->slots, slot))->type;
+        IrInstruction* undefined = ir_new_instruction(IR_OP_UNDEF, type, ir_new_vreg(renamer->function, type));
+        ir_insert_instruction(vector_IrBlockPtr_at(renamer->function->blocks, 0), 0, undefined);
+        renamer->undefined_values[slot] = undefined->result;
+    }
+    return renamer->undefined_values[slot];
+}
+
+// Registers created during renaming are never replaced.
+static int ssa_replacement(SsaRenamer* renamer, int vreg){
+    if(vreg >= get_element_count(renamer->function->definitions)){
+        return vreg;
+    }
+    return renamer->replacements[vreg];
+}
+
+// Deletes the address computations, loads and stores of the promoted slots and hands the remaining phis back from slot to register. The deleted instructions are freed last, the definitions map still points at them.
+static void ssa_remove_promoted_accesses(IrFunction* function, bool* promoted){
+    DynamicVector* removed = create_vector(sizeof(IrInstruction*));
+    vector_for_each(IrBlock*, block, function->blocks){
+        DynamicVector* kept = create_vector(sizeof(IrInstruction*));
+        vector_for_each(IrInstruction*, instruction_pointer, (*block)->instructions){
+            IrInstruction* instruction = *instruction_pointer;
+            bool is_removed = false;
+            switch(instruction->opcode){
+                case IR_OP_SLOT_ADDRESS:
+                    is_removed = promoted[instruction->slot];
+                    break;
+                case IR_OP_LOAD:
+                case IR_OP_STORE:
+                    is_removed = ssa_promoted_slot(function, promoted, instruction->operands[0]) >= 0;
+                    break;
+                case IR_OP_PHI:
+                    instruction->slot = -1;
+                    break;
+            }
+            vector_IrInstructionPtr_push(is_removed ? removed : kept, instruction);
+        }
+        destroy_vector((*block)->instructions);
+        (*block)->instructions = kept;
+    }
+    vector_for_each(IrInstruction*, instruction, removed){
+        ir_free_instruction(*instruction);
+    }
+    destroy_vector(removed);
+}
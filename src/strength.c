@@ -0,0 +1,285 @@
+/*
+* @file strength.c
+* @brief Strength reduction of arithmetic by constants
+* @details Multiplications by powers of two become shifts. Unsigned divisions and remainders by powers of two become shifts and masks, signed ones the same after adding divisor - 1 to negative dividends so that the quotient is rounded toward zero. 32 bit divisions by any other constant become a multiplication by a fixed point reciprocal of the divisor, done 64 bits wide so that the quotient is the upper half of the product, following Granlund and Montgomery, and the remainder is taken off the dividend with the quotient times the divisor. 64 bit divisions by such constants keep the division, the IR has no multiplication yielding the upper half of a 128 bit product. Multiplications by 0, 1 and -1 and divisions by 1 need no arithmetic at all. The reduced instruction keeps its result register and becomes the last step of its replacement, the steps before it are inserted in front of it.
+*/
+
+#include "compiler.h"
+
+typedef struct Strength{
+    IrFunction* function;
+    IrBlock* block;
+    int index; //the position of the instruction being reduced, the steps before it are inserted there
+} Strength;
+
+void ir_reduce_strength(IrFunction* function);
+
+static void strength_reduce_instruction(Strength* strength, IrInstruction* instruction);
+
+static void strength_reduce_multiplication(Strength* strength, IrInstruction* instruction, long long factor);
+
+static void strength_reduce_unsigned_division(Strength* strength, IrInstruction* instruction, unsigned long long divisor);
+
+static void strength_reduce_signed_division(Strength* strength, IrInstruction* instruction, long long divisor);
+
+static int strength_unsigned_quotient(Strength* strength, int dividend, unsigned long long divisor);
+
+static int strength_signed_quotient(Strength* strength, int dividend, long long divisor);
+
+static int strength_emit(Strength* strength, int opcode, int type, int first, int second);
+
+static int strength_constant(Strength* strength, int type, long long value);
+
+static void strength_rewrite(IrInstruction* instruction, int opcode, int first, int second);
+
+static IrInstruction* strength_constant_operand(Strength* strength, int vreg);
+
+static int strength_log2(unsigned long long value);
+
+static int strength_ceil_log2(unsigned long long value);
+
+
+
+void ir_reduce_strength(IrFunction* function){
+    Strength strength = {.function = function};
+    vector_for_each(IrBlock*, block, function->blocks){
+        strength.block = *block;
+        for(int i = 0; i < get_element_count((*block)->instructions); i++){
+            strength.index = i;
+            strength_reduce_instruction(&strength, vector_IrInstructionPtr_at((*block)->instructions, i));
+            i = strength.index;
+        }
+    }
+    ir_compute_def_use(function);
+}
+
+// Narrower arithmetic is done in wider registers whose upper bits are unspecified, only 32 and 64 bit instructions are reduced.
+static void strength_reduce_instruction(Strength* strength, IrInstruction* instruction){
+    if(instruction->type != IR_TYPE_I32 && instruction->type != IR_TYPE_I64){
+        return;
+    }
+    IrInstruction* constant = NULL;
+    switch(instruction->opcode){
+        case IR_OP_MUL:
+            constant = strength_constant_operand(strength, instruction->operands[1]);
+            if(!constant){
+                constant = strength_constant_operand(strength, instruction->operands[0]);
+                if(!constant){
+                    return;
+                }
+                instruction->operands[0] = instruction->operands[1];
+                instruction->operands[1] = constant->result;
+            }
+            strength_reduce_multiplication(strength, instruction, constant->immediate);
+            break;
+        case IR_OP_UDIV:
+        case IR_OP_UREM:
+            constant = strength_constant_operand(strength, instruction->operands[1]);
+            if(constant){
+                unsigned long long divisor = constant->immediate;
+                strength_reduce_unsigned_division(strength, instruction, instruction->type == IR_TYPE_I32 ? (unsigned int)divisor : divisor);
+            }
+            break;
+        case IR_OP_SDIV:
+        case IR_OP_SREM:
+            constant = strength_constant_operand(strength, instruction->operands[1]);
+            if(constant){
+                strength_reduce_signed_division(strength, instruction, constant->immediate);
+            }
+            break;
+    }
+}
+
+static void strength_reduce_multiplication(Strength* strength, IrInstruction* instruction, long long factor){
+    int type = instruction->type;
+    int value = instruction->operands[0];
+    unsigned long long magnitude = type == IR_TYPE_I32 ? (unsigned int)factor : (unsigned long long)factor;
+    int shift = strength_log2(magnitude);
+    if(factor == 0){
+        ir_make_constant(instruction, 0);
+    }
+    else if(factor == 1){
+        strength_rewrite(instruction, IR_OP_COPY, value, IR_VREG_NONE);
+    }
+    else if(factor == -1){
+        strength_rewrite(instruction, IR_OP_NEG, value, IR_VREG_NONE);
+    }
+    else if(shift > 0){
+        strength_rewrite(instruction, IR_OP_SHL, value, strength_constant(strength, type, shift));
+    }
+}
+
+// A division by 0 is left to trap.
+static void strength_reduce_unsigned_division(Strength* strength, IrInstruction* instruction, unsigned long long divisor){
+    int type = instruction->type;
+    int dividend = instruction->operands[0];
+    bool is_remainder = instruction->opcode == IR_OP_UREM;
+    int shift = strength_log2(divisor);
+    if(divisor == 0){
+        return;
+    }
+    if(divisor == 1){
+        if(is_remainder){
+            ir_make_constant(instruction, 0);
+        }
+        else{
+            strength_rewrite(instruction, IR_OP_COPY, dividend, IR_VREG_NONE);
+        }
+        return;
+    }
+    if(shift > 0){
+        if(is_remainder){
+            strength_rewrite(instruction, IR_OP_AND, dividend, strength_constant(strength, type, divisor - 1));
+        }
+        else{
+            strength_rewrite(instruction, IR_OP_SHR, dividend, strength_constant(strength, type, shift));
+        }
+        return;
+    }
+    if(type != IR_TYPE_I32){
+        return;
+    }
+    int quotient = strength_unsigned_quotient(strength, dividend, divisor);
+    if(!is_remainder){
+        strength_rewrite(instruction, IR_OP_TRUNC, quotient, IR_VREG_NONE);
+        return;
+    }
+    quotient = strength_emit(strength, IR_OP_TRUNC, IR_TYPE_I32, quotient, IR_VREG_NONE);
+    int product = strength_emit(strength, IR_OP_MUL, IR_TYPE_I32, quotient, strength_constant(strength, IR_TYPE_I32, divisor));
+    strength_rewrite(instruction, IR_OP_SUB, dividend, product);
+}
+
+// Divisions by 0 and -1 are left to trap.
+static void strength_reduce_signed_division(Strength* strength, IrInstruction* instruction, long long divisor){
+    int type = instruction->type;
+    int width = ir_type_size(type) * 8;
+    int dividend = instruction->operands[0];
+    bool is_remainder = instruction->opcode == IR_OP_SREM;
+    unsigned long long magnitude = divisor < 0 ? 0ULL - (unsigned long long)divisor : (unsigned long long)divisor;
+    int shift = strength_log2(magnitude);
+    if(divisor == 0 || divisor == -1){
+        return;
+    }
+    if(divisor == 1){
+        if(is_remainder){
+            ir_make_constant(instruction, 0);
+        }
+        else{
+            strength_rewrite(instruction, IR_OP_COPY, dividend, IR_VREG_NONE);
+        }
+        return;
+    }
+    if(shift > 0){
+        //magnitude - 1 when the dividend is negative, 0 otherwise
+        int sign = strength_emit(strength, IR_OP_SAR, type, dividend, strength_constant(strength, type, width - 1));
+        int bias = strength_emit(strength, IR_OP_SHR, type, sign, strength_constant(strength, type, width - shift));
+        int biased = strength_emit(strength, IR_OP_ADD, type, dividend, bias);
+        if(is_remainder){
+            int multiple = strength_emit(strength, IR_OP_AND, type, biased, strength_constant(strength, type, (long long)(0ULL - magnitude)));
+            strength_rewrite(instruction, IR_OP_SUB, dividend, multiple);
+        }
+        else if(divisor > 0){
+            strength_rewrite(instruction, IR_OP_SAR, biased, strength_constant(strength, type, shift));
+        }
+        else{
+            int quotient = strength_emit(strength, IR_OP_SAR, type, biased, strength_constant(strength, type, shift));
+            strength_rewrite(instruction, IR_OP_NEG, quotient, IR_VREG_NONE);
+        }
+        return;
+    }
+    if(type != IR_TYPE_I32){
+        return;
+    }
+    int quotient = strength_signed_quotient(strength, dividend, divisor);
+    if(!is_remainder){
+        strength_rewrite(instruction, IR_OP_TRUNC, quotient, IR_VREG_NONE);
+        return;
+    }
+    quotient = strength_emit(strength, IR_OP_TRUNC, IR_TYPE_I32, quotient, IR_VREG_NONE);
+    int product = strength_emit(strength, IR_OP_MUL, IR_TYPE_I32, quotient, strength_constant(strength, IR_TYPE_I32, divisor));
+    strength_rewrite(instruction, IR_OP_SUB, dividend, product);
+}
+
+// The 64 bit quotient of a 32 bit dividend by a divisor that isn't a power of two. A reciprocal of 32 bits that is exact for every dividend is used when one exists, otherwise the 33 bit one whose top bit is added separately.
+static int strength_unsigned_quotient(Strength* strength, int dividend, unsigned long long divisor){
+    int wide = strength_emit(strength, IR_OP_ZEXT, IR_TYPE_I64, dividend, IR_VREG_NONE);
+    int bits = strength_ceil_log2(divisor);
+    for(int shift = 0; shift < bits && bits < 32; shift++){
+        unsigned long long power = 1ULL << (32 + shift);
+        unsigned long long reciprocal = power / divisor + 1;
+        if(reciprocal < (1ULL << 32) && reciprocal * divisor - power <= (1ULL << shift)){
+            int product = strength_emit(strength, IR_OP_MUL, IR_TYPE_I64, wide, strength_constant(strength, IR_TYPE_I64, reciprocal));
+            return strength_emit(strength, IR_OP_SHR, IR_TYPE_I64, product, strength_constant(strength, IR_TYPE_I64, 32 + shift));
+        }
+    }
+    //2^32 + reciprocal is 2^(32 + bits) / divisor rounded up
+    unsigned long long reciprocal = (1ULL << 32) * ((1ULL << bits) - divisor) / divisor + 1;
+    int product = strength_emit(strength, IR_OP_MUL, IR_TYPE_I64, wide, strength_constant(strength, IR_TYPE_I64, reciprocal));
+    int high = strength_emit(strength, IR_OP_SHR, IR_TYPE_I64, product, strength_constant(strength, IR_TYPE_I64, 32));
+    int sum = strength_emit(strength, IR_OP_ADD, IR_TYPE_I64, high, wide);
+    return strength_emit(strength, IR_OP_SHR, IR_TYPE_I64, sum, strength_constant(strength, IR_TYPE_I64, bits));
+}
+
+// The 64 bit quotient of a 32 bit dividend by a divisor whose magnitude isn't a power of two. The product with the reciprocal rounds down, adding one for negative dividends rounds toward zero.
+static int strength_signed_quotient(Strength* strength, int dividend, long long divisor){
+    unsigned long long magnitude = divisor < 0 ? 0ULL - (unsigned long long)divisor : (unsigned long long)divisor;
+    int bits = strength_ceil_log2(magnitude);
+    unsigned long long reciprocal = (1ULL << (31 + bits)) / magnitude + 1;
+    int wide = strength_emit(strength, IR_OP_SEXT, IR_TYPE_I64, dividend, IR_VREG_NONE);
+    int product = strength_emit(strength, IR_OP_MUL, IR_TYPE_I64, wide, strength_constant(strength, IR_TYPE_I64, reciprocal));
+    int high = strength_emit(strength, IR_OP_SAR, IR_TYPE_I64, product, strength_constant(strength, IR_TYPE_I64, 31 + bits));
+    int sign = strength_emit(strength, IR_OP_SAR, IR_TYPE_I64, wide, strength_constant(strength, IR_TYPE_I64, 63));
+    int quotient = strength_emit(strength, IR_OP_SUB, IR_TYPE_I64, high, sign);
+    if(divisor < 0){
+        quotient = strength_emit(strength, IR_OP_NEG, IR_TYPE_I64, quotient, IR_VREG_NONE);
+    }
+    return quotient;
+}
+
+static int strength_emit(Strength* strength, int opcode, int type, int first, int second){
+    IrInstruction* instruction = ir_new_instruction(opcode, type, ir_new_vreg(strength->function, type));
+    instruction->operands[0] = first;
+    instruction->operands[1] = second;
+    ir_insert_instruction(strength->block, strength->index++, instruction);
+    return instruction->result;
+}
+
+static int strength_constant(Strength* strength, int type, long long value){
+    IrInstruction* instruction = ir_new_instruction(IR_OP_CONST, type, ir_new_vreg(strength->function, type));
+    instruction->immediate = ir_truncate_constant(type, value);
+    ir_insert_instruction(strength->block, strength->index++, instruction);
+    return instruction->result;
+}
+
+static void strength_rewrite(IrInstruction* instruction, int opcode, int first, int second){
+    instruction->opcode = opcode;
+    instruction->operands[0] = first;
+    instruction->operands[1] = second;
+}
+
+static IrInstruction* strength_constant_operand(Strength* strength, int vreg){
+    IrInstruction* definition = vector_IrInstructionPtr_at(strength->function->definitions, vreg);
+    return definition && definition->opcode == IR_OP_CONST ? definition : NULL;
+}
+
+// The exponent of a power of two, -1 for other values.
+static int strength_log2(unsigned long long value){
+    if(!value || (value & (value - 1))){
+        return -1;
+    }
+    int exponent = 0;
+    while(value > 1){
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+// The smallest exponent whose power of two is at least value.
+static int strength_ceil_log2(unsigned long long value){
+    int exponent = 0;
+    while(exponent < 64 && (1ULL << exponent) < value){
+        exponent++;
+    }
+    return exponent;
+}
@@ -0,0 +1,190 @@
+#include "compiler.h"
+#include <assert.h>
+#include <stdlib.h>
+#include "helpers/vector.h"
+
+StructLayout* build_struct_layout(CompileProcess* process, Node* struct_or_union_node);
+
+static Node* get_struct_or_union_body_node(Node* struct_or_union_node);
+
+static void struct_layout_collect_members(Node* body_node, DynamicVector* members_out);
+
+static size_t get_member_size(CompileProcess* process, DataType* datatype);
+
+static size_t get_member_alignment(CompileProcess* process, DataType* datatype);
+
+StructLayout* get_struct_layout(CompileProcess* process, Node* struct_or_union_node);
+
+StructLayout* get_struct_layout_for_name(CompileProcess* process, const char* name);
+
+StructLayout* get_struct_layout_for_datatype(CompileProcess* process, DataType* datatype);
+
+StructLayoutMember* struct_layout_get_member(StructLayout* layout, const char* member_name);
+
+long struct_layout_offset_of(StructLayout* layout, const char* member_name);
+
+size_t get_datatype_alignment(CompileProcess* process, DataType* datatype);
+
+
+
+
+StructLayout* build_struct_layout(CompileProcess* process, Node* struct_or_union_node){
+    Node* body_node = get_struct_or_union_body_node(struct_or_union_node);
+    if(!body_node){
+        return NULL;
+    }
+    DynamicVector* member_nodes = create_vector(sizeof(Node*));
+    struct_layout_collect_members(body_node, member_nodes);
+
+    StructLayout* layout = calloc(1, sizeof(StructLayout));
+    layout->is_union = struct_or_union_node->type == NODE_TYPE_UNION;
+    layout->alignment = 1;
+    layout->member_count = get_element_count(member_nodes);
+    layout->members = calloc(layout->member_count > 0 ? layout->member_count : 1, sizeof(StructLayoutMember));
+    layout->member_index = create_hash_table(layout->member_count);
+
+    size_t offset = 0;
+    int index = 0;
+    vector_for_each(Node*, variable_node, member_nodes){
+        StructLayoutMember* member = &layout->members[index++];
+        member->variable_node = *variable_node;
+        member->name = (*variable_node)->data.var.name;
+        member->data_type = (*variable_node)->data.var.data_type;
+        member->size = get_member_size(process, member->data_type);
+        size_t alignment = get_member_alignment(process, member->data_type);
+        if(alignment > layout->alignment){
+            layout->alignment = alignment;
+        }
+        if(layout->is_union){
+            member->offset = 0;
+            if(member->size > offset){
+                offset = member->size;
+            }
+        }
+        else{
+            member->offset = get_align_value(offset, alignment);
+            offset = member->offset + member->size;
+        }
+        if(member->name){
+            hash_table_put(layout->member_index, member->name, member);
+        }
+    }
+    layout->size = get_align_value(offset, layout->alignment);
+    destroy_vector(member_nodes);
+    return layout;
+}
+
+// Returns the body of a struct or union node, NULL for forward declarations.
+static Node* get_struct_or_union_body_node(Node* struct_or_union_node){
+    if(struct_or_union_node->type == NODE_TYPE_STRUCT){
+        return struct_or_union_node->data.structure.body_node;
+    }
+    if(struct_or_union_node->type == NODE_TYPE_UNION){
+        return struct_or_union_node->data.Union.body_node;
+    }
+    return NULL;
+}
+
+// Collects the variable nodes declared directly in the body, including lists and variables combined with a nested struct or union.
+static void struct_layout_collect_members(Node* body_node, DynamicVector* members_out){
+    vector_for_each(Node*, statement_pointer, body_node->data.body.statements){
+        Node* statement = *statement_pointer;
+        if(!statement){
+            continue;
+        }
+        switch(statement->type){
+            case NODE_TYPE_VARIABLE:
+                vector_NodePtr_push(members_out, statement);
+                break;
+            case NODE_TYPE_VARIABLE_LIST:
+                vector_for_each(Node*, variable_node, statement->data.variable_list.variables){
+                    vector_NodePtr_push(members_out, *variable_node);
+                }
+                break;
+            case NODE_TYPE_STRUCT:
+            case NODE_TYPE_UNION:
+                if(statement->flags & NODE_FLAG_HAS_VARIABLE_COMBINED){
+                    vector_NodePtr_push(members_out, statement->type == NODE_TYPE_STRUCT ? statement->data.structure.variable : statement->data.Union.variable);
+                }
+                break;
+        }
+    }
+}
+
+// Returns the size of a member, nested structs and unions use their own layout.
+static size_t get_member_size(CompileProcess* process, DataType* datatype){
+    bool is_pointer = datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0;
+    if(is_datatype_struct_or_union(datatype) && !is_pointer && !(datatype->flags & DATATYPE_FLAG_IS_ARRAY)){
+        StructLayout* layout = get_struct_layout(process, datatype->data.struct_node);
+        if(layout){
+            return layout->size;
+        }
+    }
+    return get_datatype_size(process, datatype);
+}
+
+// Returns the alignment of a member, arrays align like their elements.
+static size_t get_member_alignment(CompileProcess* process, DataType* datatype){
+    const TargetDataModel* target = process->target;
+    if(datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0){
+        return target->pointer_size;
+    }
+    if(is_datatype_struct_or_union(datatype)){
+        StructLayout* layout = get_struct_layout(process, datatype->data.struct_node);
+        return layout ? layout->alignment : 1;
+    }
+    return get_target_scalar_alignment(target, datatype->size);
+}
+
+StructLayout* get_struct_layout(CompileProcess* process, Node* struct_or_union_node){
+    if(!struct_or_union_node){
+        return NULL;
+    }
+    StructLayout** layout = NULL;
+    if(struct_or_union_node->type == NODE_TYPE_STRUCT){
+        layout = &struct_or_union_node->data.structure.layout;
+    }
+    else if(struct_or_union_node->type == NODE_TYPE_UNION){
+        layout = &struct_or_union_node->data.Union.layout;
+    }
+    else{
+        return NULL;
+    }
+    if(!*layout){
+        *layout = build_struct_layout(process, struct_or_union_node);
+    }
+    return *layout;
+}
+
+StructLayout* get_struct_layout_for_name(CompileProcess* process, const char* name){
+    return get_struct_layout(process, get_node_from_symbol(process, name));
+}
+
+StructLayout* get_struct_layout_for_datatype(CompileProcess* process, DataType* datatype){
+    if(!is_datatype_struct_or_union(datatype)){
+        return NULL;
+    }
+    StructLayout* layout = get_struct_layout(process, datatype->data.struct_node);
+    if(!layout){
+        //the datatype may still point at a forward declaration
+        layout = get_struct_layout_for_name(process, datatype->name);
+    }
+    return layout;
+}
+
+StructLayoutMember* struct_layout_get_member(StructLayout* layout, const char* member_name){
+    return hash_table_get(layout->member_index, member_name);
+}
+
+long struct_layout_offset_of(StructLayout* layout, const char* member_name){
+    StructLayoutMember* member = struct_layout_get_member(layout, member_name);
+    return member ? (long)member->offset : -1;
+}
+
+size_t get_datatype_alignment(CompileProcess* process, DataType* datatype){
+    if(is_datatype_struct_or_union(datatype) && !(datatype->flags & DATATYPE_FLAG_IS_POINTER && datatype->pointer_level > 0)){
+        StructLayout* layout = get_struct_layout_for_datatype(process, datatype);
+        return layout ? layout->alignment : 1;
+    }
+    return get_member_alignment(process, datatype);
+}
@@ -32,36 +32,27 @@ void symbol_resolver_build_for_node(CompileProcess* process, Node* node);
 
 
 void initialize_symbol_resolver(CompileProcess* process){
-    process->symbols.tables = create_vector(sizeof(DynamicVector*));
+    process->symbols.tables = create_vector(sizeof(HashTable*));
 }
 
 static void symbol_resolver_push_symbol(CompileProcess* process, Symbol* symbol){
-    push_element(process->symbols.current_active_symbol_table, &symbol);
+    hash_table_put(process->symbols.current_active_symbol_table, symbol->name, symbol);
 }
 
 void symbol_resolver_new_table(CompileProcess* process){
     //save current table
-    push_element(process->symbols.tables, &process->symbols.current_active_symbol_table);
+    vector_VoidPtr_push(process->symbols.tables, process->symbols.current_active_symbol_table);
     //overwrite current table
-    process->symbols.current_active_symbol_table = create_vector(sizeof(Symbol*));
+    process->symbols.current_active_symbol_table = create_hash_table(0);
 }
 
 void symbol_resolver_pop_table(CompileProcess* process){
-    DynamicVector* last_table = get_last_element_pointer(process->symbols.tables);
-    process->symbols.current_active_symbol_table = last_table;
-    remove_last_element(process->symbols.tables);
+    destroy_hash_table(process->symbols.current_active_symbol_table);
+    process->symbols.current_active_symbol_table = vector_VoidPtr_pop(process->symbols.tables);
 }
 
 Symbol* symbol_resolver_get_symbol(CompileProcess* process, const char* name){
-    set_peek_index(process->symbols.current_active_symbol_table, 0);
-    Symbol* symbol = peek_pointer(process->symbols.current_active_symbol_table);
-    while(symbol){
-        if(ARE_STRINGS_EQUAL(symbol->name, name)){
-            break;
-        }
-        symbol = peek_pointer(process->symbols.current_active_symbol_table);
-    }
-    return symbol;
+    return hash_table_get(process->symbols.current_active_symbol_table, name);
 }
 
 Symbol* symbol_resolver_get_symbol_for_native_function(CompileProcess* process, const char* name){
@@ -95,11 +86,14 @@ Node* symbol_resolver_get_node(Symbol* symbol){
 }
 
 void symbol_resolver_for_variable_node(CompileProcess* process, Node* node){
-    compiler_error(process, "Variable nodes are not supported yet");
+    if(!node->data.var.name){
+        return;
+    }
+    scope_bind(process, node->data.var.name, node);
 }
 
 void symbol_resolver_for_function_node(CompileProcess* process, Node* node){
-    compiler_error(process, "Function nodes are not supported yet");
+    scope_bind(process, node->data.function.name, node);
 }
 
 void symbol_resolver_for_struct_node(CompileProcess* process, Node* node){
@@ -107,6 +101,7 @@ void symbol_resolver_for_struct_node(CompileProcess* process, Node* node){
         return;
     }
     symbol_resolver_register_symbol(process, node->data.structure.name, SYMBOL_TYPE_NODE, node);
+    resolve_fixups_waiting_on(process->fixup_system, node->data.structure.name);
 }
 
 void symbol_resolver_for_union_node(CompileProcess* process, Node* node){
@@ -114,6 +109,7 @@ void symbol_resolver_for_union_node(CompileProcess* process, Node* node){
         return;
     }
     symbol_resolver_register_symbol(process, node->data.Union.name, SYMBOL_TYPE_NODE, node);
+    resolve_fixups_waiting_on(process->fixup_system, node->data.Union.name);
 }
 
 void symbol_resolver_build_for_node(CompileProcess* process, Node* node){
@@ -0,0 +1,59 @@
+/*
+* @file target.c
+* @brief The data models the compiler can target
+* @details Contains the size and alignment tables of the supported data models, ILP32 for i386 and LP64 for x86-64
+*/
+
+#include "compiler.h"
+#include <assert.h>
+
+const TargetDataModel* get_target_data_model(int data_model);
+
+size_t get_target_primitive_size(const TargetDataModel* target, int type, int secondary_type);
+
+size_t get_target_scalar_alignment(const TargetDataModel* target, size_t size);
+
+
+
+static const TargetDataModel target_data_models[TARGET_DATA_MODEL_COUNT] = {
+    [TARGET_DATA_MODEL_ILP32] = {.name = "ILP32", .char_size = 1, .short_size = 2, .int_size = 4, .long_size = 4, .long_long_size = 8, .float_size = 4, .double_size = 8, .long_double_size = 12, .pointer_size = 4, .max_scalar_alignment = 4},
+    [TARGET_DATA_MODEL_LP64] = {.name = "LP64", .char_size = 1, .short_size = 2, .int_size = 4, .long_size = 8, .long_long_size = 8, .float_size = 4, .double_size = 8, .long_double_size = 16, .pointer_size = 8, .max_scalar_alignment = 16},
+};
+
+const TargetDataModel* get_target_data_model(int data_model){
+    assert(data_model >= 0 && data_model < TARGET_DATA_MODEL_COUNT);
+    return &target_data_models[data_model];
+}
+
+size_t get_target_primitive_size(const TargetDataModel* target, int type, int secondary_type){
+    switch(type){
+        case DATA_TYPE_VOID:
+            return DATA_SIZE_ZERO;
+        case DATA_TYPE_CHAR:
+            return target->char_size;
+        case DATA_TYPE_SHORT:
+            return target->short_size;
+        case DATA_TYPE_INT:
+            return target->int_size;
+        case DATA_TYPE_LONG:
+            if(secondary_type == DATA_TYPE_LONG){
+                return target->long_long_size;
+            }
+            if(secondary_type == DATA_TYPE_DOUBLE){
+                return target->long_double_size;
+            }
+            return target->long_size;
+        case DATA_TYPE_FLOAT:
+            return target->float_size;
+        case DATA_TYPE_DOUBLE:
+            return target->double_size;
+    }
+    return DATA_SIZE_ZERO;
+}
+
+size_t get_target_scalar_alignment(const TargetDataModel* target, size_t size){
+    if(size == 0){
+        return 1;
+    }
+    return size < target->max_scalar_alignment ? size : target->max_scalar_alignment;
+}
@@ -0,0 +1,241 @@
+/*
+* @file unreachableCode.c
+* @brief Removal of unreachable statements from the tree
+* @details Runs between parsing and code generation. The statements following a return, break, continue or goto in the same body are deleted up to the next label or case, and ifs and whiles whose condition is a constant are replaced by the branch that runs. The size of the variables declared by a deleted statement is taken off the size of its body and the stack size of the function, so the tree describes the frame the remaining code needs.
+*/
+
+#include "compiler.h"
+
+static CompileProcess* current_process;
+static Node* current_function_node;
+
+void prune_unreachable_code(CompileProcess* process);
+
+static void unreachable_code_prune_body(Node* body_node);
+
+static Node* unreachable_code_prune_statement(Node* node);
+
+static void unreachable_code_remove_dead_statements(Node* body_node, int start);
+
+static void unreachable_code_release(Node* node);
+
+static size_t unreachable_code_body_sizes(Node* node);
+
+static void unreachable_code_shrink(size_t* size, size_t amount);
+
+static bool unreachable_code_constant_condition(Node* node, long long* value_out);
+
+static bool is_unreachable_code_jump(Node* node);
+
+static bool is_unreachable_code_declaration(Node* node);
+
+static bool contains_unreachable_code_jump_target(Node* node);
+
+
+
+void prune_unreachable_code(CompileProcess* process){
+    current_process = process;
+    vector_for_each(Node*, node, process->node_tree_vector){
+        if((*node)->type != NODE_TYPE_FUNCTION || !(*node)->data.function.body_node){
+            continue;
+        }
+        current_function_node = *node;
+        unreachable_code_prune_body((*node)->data.function.body_node);
+    }
+    current_function_node = NULL;
+}
+
+// Prunes the statements of a body in order, everything after a jump up to the next jump target is gone.
+static void unreachable_code_prune_body(Node* body_node){
+    DynamicVector* statements = body_node->data.body.statements;
+    for(int i = 0; i < get_element_count(statements); i++){
+        Node* statement = unreachable_code_prune_statement(vector_NodePtr_at(statements, i));
+        if(!statement){
+            remove_element_at(statements, i);
+            i--;
+            continue;
+        }
+        *vector_NodePtr_at_pointer(statements, i) = statement;
+        if(is_unreachable_code_jump(statement)){
+            unreachable_code_remove_dead_statements(body_node, i + 1);
+        }
+    }
+}
+
+// Returns what replaces the statement, NULL when nothing does. A constant condition is only acted on when no label or case inside the statement can be jumped to from outside.
+static Node* unreachable_code_prune_statement(Node* node){
+    long long value = 0;
+    switch(node->type){
+        case NODE_TYPE_BODY:
+            unreachable_code_prune_body(node);
+            break;
+        case NODE_TYPE_STATEMENT_IF:
+            if(unreachable_code_constant_condition(node->data.statement.statement_if.condition_node, &value) && !contains_unreachable_code_jump_target(node)){
+                Node* taken = node->data.statement.statement_if.else_body_node;
+                Node* not_taken = node->data.statement.statement_if.body_node;
+                if(value){
+                    taken = node->data.statement.statement_if.body_node;
+                    not_taken = node->data.statement.statement_if.else_body_node;
+                }
+                if(not_taken){
+                    unreachable_code_release(not_taken);
+                }
+                if(taken && taken->type == NODE_TYPE_STATEMENT_ELSE){
+                    taken = taken->data.statement.statement_else.body_node;
+                }
+                return taken ? unreachable_code_prune_statement(taken) : NULL;
+            }
+            unreachable_code_prune_statement(node->data.statement.statement_if.body_node);
+            if(node->data.statement.statement_if.else_body_node){
+                node->data.statement.statement_if.else_body_node = unreachable_code_prune_statement(node->data.statement.statement_if.else_body_node);
+            }
+            break;
+        case NODE_TYPE_STATEMENT_ELSE:
+            unreachable_code_prune_statement(node->data.statement.statement_else.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_WHILE:
+            if(unreachable_code_constant_condition(node->data.statement.statement_while.condition_node, &value) && !value && !contains_unreachable_code_jump_target(node)){
+                unreachable_code_release(node);
+                return NULL;
+            }
+            unreachable_code_prune_statement(node->data.statement.statement_while.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_DO_WHILE:
+            unreachable_code_prune_statement(node->data.statement.statement_do_while.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_FOR:
+            unreachable_code_prune_statement(node->data.statement.statement_for.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_SWITCH:
+            unreachable_code_prune_statement(node->data.statement.statement_switch.body_node);
+            break;
+    }
+    return node;
+}
+
+// Deletes the statements from start up to the first one control can reach again. Declarations are kept when code follows, it may still use the variables.
+static void unreachable_code_remove_dead_statements(Node* body_node, int start){
+    DynamicVector* statements = body_node->data.body.statements;
+    int end = start;
+    while(end < get_element_count(statements) && !contains_unreachable_code_jump_target(vector_NodePtr_at(statements, end))){
+        end++;
+    }
+    bool is_reached_again = end < get_element_count(statements);
+    for(int i = end - 1; i >= start; i--){
+        Node* statement = vector_NodePtr_at(statements, i);
+        if(is_unreachable_code_declaration(statement) && is_reached_again){
+            continue;
+        }
+        if(statement->type == NODE_TYPE_STRUCT || statement->type == NODE_TYPE_UNION){
+            continue;
+        }
+        size_t size = 0;
+        if(statement->type == NODE_TYPE_VARIABLE){
+            size = get_variable_size(current_process, statement);
+        }
+        else if(statement->type == NODE_TYPE_VARIABLE_LIST){
+            size = get_variable_size_for_list(current_process, statement);
+        }
+        unreachable_code_shrink(&body_node->data.body.size, size);
+        unreachable_code_shrink(&current_function_node->data.function.stack_size, size);
+        unreachable_code_release(statement);
+        remove_element_at(statements, i);
+    }
+}
+
+// Takes the bodies of a deleted statement off the stack size of the function.
+static void unreachable_code_release(Node* node){
+    unreachable_code_shrink(&current_function_node->data.function.stack_size, unreachable_code_body_sizes(node));
+}
+
+static size_t unreachable_code_body_sizes(Node* node){
+    if(!node){
+        return 0;
+    }
+    size_t size = 0;
+    switch(node->type){
+        case NODE_TYPE_BODY:
+            size = node->data.body.size;
+            vector_for_each(Node*, statement, node->data.body.statements){
+                size += unreachable_code_body_sizes(*statement);
+            }
+            break;
+        case NODE_TYPE_STATEMENT_IF:
+            size = unreachable_code_body_sizes(node->data.statement.statement_if.body_node) + unreachable_code_body_sizes(node->data.statement.statement_if.else_body_node);
+            break;
+        case NODE_TYPE_STATEMENT_ELSE:
+            size = unreachable_code_body_sizes(node->data.statement.statement_else.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_WHILE:
+            size = unreachable_code_body_sizes(node->data.statement.statement_while.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_DO_WHILE:
+            size = unreachable_code_body_sizes(node->data.statement.statement_do_while.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_FOR:
+            size = unreachable_code_body_sizes(node->data.statement.statement_for.body_node);
+            break;
+        case NODE_TYPE_STATEMENT_SWITCH:
+            size = unreachable_code_body_sizes(node->data.statement.statement_switch.body_node);
+            break;
+    }
+    return size;
+}
+
+// The padding of a body isn't recomputed, so what is taken off never exceeds what is left.
+static void unreachable_code_shrink(size_t* size, size_t amount){
+    *size -= amount < *size ? amount : *size;
+}
+
+// The evaluator promotes and converts operands the way the generated code does, so its value decides the branch.
+static bool unreachable_code_constant_condition(Node* node, long long* value_out){
+    return evaluate_constant_expression(current_process, node, value_out);
+}
+
+static bool is_unreachable_code_jump(Node* node){
+    switch(node->type){
+        case NODE_TYPE_STATEMENT_RETURN:
+        case NODE_TYPE_STATEMENT_BREAK:
+        case NODE_TYPE_STATEMENT_CONTINUE:
+        case NODE_TYPE_STATEMENT_GOTO:
+            return true;
+    }
+    return false;
+}
+
+static bool is_unreachable_code_declaration(Node* node){
+    return node->type == NODE_TYPE_VARIABLE || node->type == NODE_TYPE_VARIABLE_LIST;
+}
+
+// Whether a goto or switch can enter the statement somewhere other than at its start.
+static bool contains_unreachable_code_jump_target(Node* node){
+    if(!node){
+        return false;
+    }
+    switch(node->type){
+        case NODE_TYPE_LABEL:
+        case NODE_TYPE_STATEMENT_CASE:
+        case NODE_TYPE_STATEMENT_DEFAULT:
+            return true;
+        case NODE_TYPE_BODY:
+            vector_for_each(Node*, statement, node->data.body.statements){
+                if(contains_unreachable_code_jump_target(*statement)){
+                    return true;
+                }
+            }
+            return false;
+        case NODE_TYPE_STATEMENT_IF:
+            return contains_unreachable_code_jump_target(node->data.statement.statement_if.body_node) || contains_unreachable_code_jump_target(node->data.statement.statement_if.else_body_node);
+        case NODE_TYPE_STATEMENT_ELSE:
+            return contains_unreachable_code_jump_target(node->data.statement.statement_else.body_node);
+        case NODE_TYPE_STATEMENT_WHILE:
+            return contains_unreachable_code_jump_target(node->data.statement.statement_while.body_node);
+        case NODE_TYPE_STATEMENT_DO_WHILE:
+            return contains_unreachable_code_jump_target(node->data.statement.statement_do_while.body_node);
+        case NODE_TYPE_STATEMENT_FOR:
+            return contains_unreachable_code_jump_target(node->data.statement.statement_for.body_node);
+        case NODE_TYPE_STATEMENT_SWITCH:
+            return contains_unreachable_code_jump_target(node->data.statement.statement_switch.body_node);
+    }
+    return false;
+}
@@ -0,0 +1,31 @@
+int printf(const char* format, ...);
+
+int sum(int values[4], int count){
+    int total;
+    int i;
+    total = 0;
+    for(i = 0; i < count; i++){
+        total = total + values[i];
+    }
+    return total;
+}
+
+void fill(char text[8], char character){
+    int i;
+    for(i = 0; i < 7; i++){
+        text[i] = character;
+    }
+    text[7] = 0;
+}
+
+int main(){
+    int numbers[4];
+    char text[8];
+    numbers[0] = 1;
+    numbers[1] = 2;
+    numbers[2] = 3;
+    numbers[3] = 4;
+    fill(text, 'z');
+    printf("%d %s\n", sum(numbers, 4), text);
+    return 0;
+}
@@ -0,0 +1,73 @@
+int printf(const char* format, ...);
+
+int counter;
+
+int square(int x){
+    return x * x;
+}
+
+int clamp(int x, int low, int high){
+    if(x < low){
+        return low;
+    }
+    if(x > high){
+        return high;
+    }
+    return x;
+}
+
+void count(int amount){
+    counter = counter + amount;
+}
+
+int weighted(int a, int b, int c, int d, int e, int f, int g, int h){
+    return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6 + g * 7 + h * 8;
+}
+
+long long widen(int x, unsigned int u, long long l){
+    return x + u + l;
+}
+
+unsigned char narrow(int x){
+    return x;
+}
+
+signed char narrow_signed(int x){
+    return x;
+}
+
+void swap(int* a, int* b){
+    int t;
+    t = *a;
+    *a = *b;
+    *b = t;
+}
+
+int nested(int x){
+    return clamp(square(x) - 10, 0, square(4));
+}
+
+int main(){
+    int a;
+    int b;
+    int i;
+    int total;
+    a = 3;
+    b = 8;
+    total = 0;
+    for(i = -2; i < 14; i = i + 3){
+        total = total + clamp(i, 0, 10) * square(i);
+    }
+    printf("%d\n", total);
+    count(2);
+    count(5);
+    printf("%d\n", counter);
+    printf("%d\n", weighted(1, 2, 3, 4, 5, 6, 7, 8));
+    printf("%d\n", weighted(square(2), a, b, -1, -2, clamp(99, 0, 9), a * b, 1));
+    printf("%lld\n", widen(-1, 4000000000u, 5000000000LL));
+    printf("%d %d %d\n", narrow(300), narrow_signed(200), narrow(-1) + 1);
+    swap(&a, &b);
+    printf("%d %d\n", a, b);
+    printf("%d %d %d\n", nested(2), nested(4), nested(9));
+    return 0;
+}
@@ -0,0 +1,32 @@
+int printf(const char* format, ...);
+
+int add(int a, int b){
+    return a + b;
+}
+
+int pick(int c);
+
+int main(){
+    int r;
+    int i;
+    int j;
+    int k;
+    r = (i = 3, i + 4);
+    printf("%d %d\n", r, i);
+    for(i = 0, j = 10; i < j; i++, j--){
+        k = i;
+    }
+    printf("%d %d %d\n", i, j, k);
+    printf("%d\n", add(i = 5, j = 6));
+    i = j = 2;
+    r = i ? j : 9, k = 1;
+    printf("%d %d %d %d\n", i, j, r, k);
+    pick(0);
+    pick(1);
+    return 0;
+}
+
+int pick(int c){
+    printf("%d %d %d\n", c ? 1 : 2, add(c ? 3 : 4, 5), c);
+    return 0;
+}
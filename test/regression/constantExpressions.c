@@ -0,0 +1,38 @@
+int printf(const char* format, ...);
+
+int unselected;
+int c[1 ? 2 : 1/0];
+int d[0 ? 1/0 : 3];
+
+int classify(int x){
+    switch(x){
+        case -1 < (unsigned int)0:
+            return 10;
+        case (-1 < 0) + 1:
+            return 20;
+        case 7 / 2:
+            return 30;
+        case (unsigned int)-8 >> 28:
+            return 40;
+        case -8 >> 1:
+            return 50;
+        case (unsigned char)300:
+            return 60;
+        case 2 + ((1 ? -1 : 0u) > 0) + 100:
+            return 70;
+    }
+    return 0;
+}
+
+int main(){
+    int a[(unsigned int)-1 / 1000000000];
+    int b[-1 < (unsigned int)1 ? 1 : 9];
+    printf("%d %d %d %d %d %d %d %d\n", classify(0), classify(2), classify(3), classify(15), classify(-4), classify(44), classify(103), classify(1));
+    printf("%d %d\n", (int)sizeof(a), (int)sizeof(b));
+    int e[(0 ? unselected : -1) < 0 ? 5 : 1];
+    int f[(1 ? (char)-1 : 0u) < 0 ? 1 : 6];
+    printf("%d %d %d %d\n", (int)sizeof(c), (int)sizeof(d), (int)sizeof(e), (int)sizeof(f));
+    printf("%d %d %d %d %d\n", (int)sizeof(1), (int)sizeof(1L), (int)sizeof(0xFFFFFFFF), (int)sizeof(4294967295), (int)sizeof(1ULL));
+    printf("%d %d %d\n", 010, 0x10, 0b101);
+    return 0;
+}
@@ -0,0 +1,98 @@
+int printf(const char* format, ...);
+
+int calls;
+
+int effect(int x){
+    calls++;
+    return x;
+}
+
+static int never_called(int x){
+    printf("never_called ran\n");
+    return x;
+}
+
+int after_return(int x){
+    return x + 1;
+    printf("after return ran\n");
+    x = effect(x);
+}
+
+int dead_stores(int x){
+    int unused;
+    int buffer[4];
+    unused = x * 7;
+    unused = effect(x) + 1;
+    buffer[0] = x;
+    buffer[1] = x + 1;
+    return x;
+}
+
+int constant_conditions(int x){
+    if(0){
+        printf("if(0) ran\n");
+        x = 100;
+    }
+    else{
+        x = x + 2;
+    }
+    while(0){
+        printf("while(0) ran\n");
+    }
+    if(1){
+        x = x * 3;
+    }
+    else{
+        int hidden;
+        hidden = effect(5);
+        x = hidden;
+    }
+    return x;
+}
+
+int jumps(int n){
+    int i;
+    int total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        if(i == 3){
+            continue;
+            total = total + 1000;
+        }
+        if(i == 5){
+            break;
+            total = total + 2000;
+        }
+        total = total + i;
+    }
+    goto done;
+    total = -1;
+done:
+    return total;
+}
+
+int case_after_return(int x){
+    switch(x){
+        case 1:
+            return 10;
+            printf("after case return ran\n");
+        case 2:
+            x = 20;
+            break;
+        default:
+            x = 30;
+    }
+    return x;
+}
+
+int main(){
+    int value;
+    printf("%d\n", after_return(4));
+    value = dead_stores(6);
+    printf("%d %d\n", value, calls);
+    printf("%d\n", constant_conditions(5));
+    printf("%d %d\n", jumps(4), jumps(10));
+    printf("%d %d %d\n", case_after_return(1), case_after_return(2), case_after_return(3));
+    printf("%d\n", calls);
+    return 0;
+}
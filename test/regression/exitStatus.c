@@ -0,0 +1,6 @@
+int printf(const char* format, ...);
+
+int main(){
+    printf("exiting with 3\n");
+    return 3;
+}
@@ -0,0 +1,98 @@
+int printf(const char* format, ...);
+
+int counter;
+
+int square(int x){
+    return x * x;
+}
+
+int clamp(int x, int low, int high){
+    if(x < low){
+        return low;
+    }
+    if(x > high){
+        return high;
+    }
+    return x;
+}
+
+void count(int amount){
+    counter = counter + amount;
+}
+
+int sum_of_squares(int a, int b){
+    return square(a) + square(b);
+}
+
+int fill_and_sum(int n){
+    int values[8];
+    int i;
+    int total;
+    total = 0;
+    for(i = 0; i < 8; i++){
+        values[i] = i * n;
+    }
+    for(i = 0; i < 8; i++){
+        total = total + values[i];
+    }
+    return total;
+}
+
+void swap(int* a, int* b){
+    int t;
+    t = *a;
+    *a = *b;
+    *b = t;
+}
+
+int factorial(int n){
+    if(n <= 1){
+        return 1;
+    }
+    return n * factorial(n - 1);
+}
+
+int is_odd(int n);
+
+int is_even(int n){
+    if(n == 0){
+        return 1;
+    }
+    return is_odd(n - 1);
+}
+
+int is_odd(int n){
+    if(n == 0){
+        return 0;
+    }
+    return is_even(n - 1);
+}
+
+unsigned char narrow(int x){
+    return x;
+}
+
+int main(){
+    int a;
+    int b;
+    int i;
+    int total;
+    a = 3;
+    b = 8;
+    printf("%d %d\n", square(a), sum_of_squares(a, b));
+    printf("%d %d %d\n", clamp(-5, 0, 10), clamp(5, 0, 10), clamp(50, 0, 10));
+    total = 0;
+    for(i = -2; i < 14; i = i + 3){
+        total = total + clamp(i, 0, 10) * square(i);
+    }
+    printf("%d\n", total);
+    count(2);
+    count(5);
+    printf("%d\n", counter);
+    printf("%d %d\n", fill_and_sum(1), fill_and_sum(3) + fill_and_sum(2));
+    swap(&a, &b);
+    printf("%d %d\n", a, b);
+    printf("%d %d %d\n", factorial(6), is_even(10), is_odd(7));
+    printf("%d %d\n", narrow(300), narrow(-1) + 1);
+    return 0;
+}
@@ -0,0 +1,135 @@
+int printf(const char* format, ...);
+
+int limit;
+int calls;
+
+// recursive, so the inliner keeps the call inside the loop
+void add_to(int* p, int n){
+    if(n > 0){
+        *p = *p + 1;
+        add_to(p, n - 1);
+    }
+}
+
+void raise_limit(int n){
+    if(n > 0){
+        limit = limit + 1;
+        raise_limit(n - 1);
+    }
+}
+
+int invariant_expression(int a, int b, int n){
+    int i;
+    int total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        total = total + (a * b + 3) + i;
+    }
+    return total;
+}
+
+int division_not_run(int a, int b, int n){
+    int i;
+    int total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        total = total + a / b;
+    }
+    return total;
+}
+
+int conditional_division(int a, int b, int n){
+    int i;
+    int total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        if(b != 0){
+            total = total + a % b;
+        }
+    }
+    return total;
+}
+
+int invariant_local_load(int n){
+    int scale;
+    int* p;
+    int i;
+    int total;
+    scale = 7;
+    p = &scale;
+    total = 0;
+    for(i = 0; i < n; i++){
+        total = total + *p * i;
+    }
+    return total;
+}
+
+int local_written_by_call_in_loop(int n){
+    int step;
+    int i;
+    int total;
+    step = 1;
+    total = 0;
+    for(i = 0; i < n; i++){
+        total = total + step;
+        add_to(&step, 2);
+    }
+    return total * 100 + step;
+}
+
+int global_written_by_call_in_loop(){
+    int i;
+    int total;
+    limit = 3;
+    total = 0;
+    for(i = 0; i < limit; i++){
+        total = total + limit;
+        if(i == 1){
+            raise_limit(2);
+        }
+    }
+    return total * 100 + limit;
+}
+
+int local_stored_in_loop(int n){
+    int last;
+    int i;
+    int total;
+    last = 0;
+    total = 0;
+    for(i = 0; i < n; i++){
+        total = total + last;
+        last = i * 2;
+    }
+    return total;
+}
+
+int nested(int n, int m){
+    int i;
+    int j;
+    int total;
+    int a[4];
+    a[0] = 1;
+    a[1] = 2;
+    a[2] = 3;
+    a[3] = 4;
+    total = 0;
+    for(i = 0; i < n; i++){
+        for(j = 0; j < m; j++){
+            total = total + a[2] * n + (i << 2) + j;
+        }
+    }
+    return total;
+}
+
+int main(){
+    printf("%d %d\n", invariant_expression(4, 5, 0), invariant_expression(4, 5, 6));
+    printf("%d %d\n", division_not_run(7, 0, 0), division_not_run(-7, 2, 3));
+    printf("%d %d\n", conditional_division(9, 0, 5), conditional_division(9, 4, 5));
+    printf("%d\n", invariant_local_load(5));
+    printf("%d\n", local_written_by_call_in_loop(4));
+    printf("%d\n", global_written_by_call_in_loop());
+    printf("%d\n", local_stored_in_loop(5));
+    printf("%d %d\n", nested(3, 4), nested(0, 4));
+    return 0;
+}
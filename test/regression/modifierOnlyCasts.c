@@ -0,0 +1,15 @@
+int printf(const char* format, ...);
+
+int main(){
+    unsigned a;
+    signed b;
+    unsigned long c;
+    int x;
+    a = (unsigned)-1;
+    b = (signed)3;
+    c = (unsigned long)a + 1;
+    x = -1;
+    printf("%u %d %lu %d\n", a, b, c, (int)sizeof(unsigned));
+    printf("%d %d\n", x < (unsigned)0, (unsigned)x > 5);
+    return 0;
+}
@@ -0,0 +1,196 @@
+int printf(const char* format, ...);
+
+struct point{
+    int x;
+    int y;
+    long long weight;
+};
+
+struct point points[4];
+
+// recursive, so the call stays and the values live across it need the stack
+int keep_call(int x){
+    if(x > 1000){
+        return keep_call(x - 1);
+    }
+    return x;
+}
+
+// more values live at once than there are registers, so some are spilled and read back
+int many_live_values(int a, int b){
+    int c;
+    int d;
+    int e;
+    int f;
+    int g;
+    int h;
+    int i;
+    int j;
+    int k;
+    int l;
+    int m;
+    int n;
+    int o;
+    int p;
+    int q;
+    int r;
+    c = a * 3;
+    d = b ^ c;
+    e = d - a;
+    f = e * 7;
+    g = f | b;
+    h = g + c;
+    i = h - d;
+    j = i * e;
+    k = j + f;
+    l = k ^ g;
+    m = l + h;
+    n = m - i;
+    o = n + j;
+    p = o * 3;
+    q = p - k;
+    r = q + l;
+    keep_call(a);
+    return a + b + c + d + e + f + g + h + i + j + k + l + m + n + o + p + q + r;
+}
+
+int identity_arithmetic(int x, unsigned int u){
+    int zero;
+    zero = 0;
+    return (x + zero) + (x - zero) + (x | zero) + (x ^ zero) + (x << zero) + (int)((u >> zero) & 7);
+}
+
+int select_mode(int x){
+    int mode;
+    mode = 2;
+    switch(mode){
+        case 1:
+            return x + 1;
+        case 2:
+            return x + 2;
+        default:
+            return x + 3;
+    }
+}
+
+int empty_arms(int x){
+    int v;
+    if(x){
+        v = 7;
+    }
+    else{
+        v = 3 + 4;
+    }
+    return v * 6;
+}
+
+int sign_of(int x){
+    if(x == 0){
+        return 0;
+    }
+    else if(x < 0){
+        return -1;
+    }
+    return 1;
+}
+
+long long local_struct(int x){
+    struct point local;
+    struct point* p;
+    local.x = x;
+    local.y = x * 2;
+    local.weight = 1000000000000LL;
+    p = &local;
+    p->y = p->y + 1;
+    return p->x + p->y + p->weight;
+}
+
+long long global_structs(){
+    int i;
+    long long total;
+    for(i = 0; i < 4; i++){
+        points[i].x = i;
+        points[i].y = i * i;
+        points[i].weight = i * 10000000000LL;
+    }
+    total = 0;
+    for(i = 0; i < 4; i++){
+        total = total + points[i].x + points[i].y + points[i].weight;
+    }
+    return total + points[2].y;
+}
+
+int sum_points(struct point* values, int n){
+    int i;
+    int total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        total = total + values[i].y - values[i].x;
+    }
+    return total;
+}
+
+int nested_jumps(int n){
+    int i;
+    int j;
+    int total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        j = 0;
+        while(1){
+            if(j >= i){
+                break;
+            }
+            if((i + j) % 3 == 0){
+                j++;
+                continue;
+            }
+            total = total + i * j;
+            j++;
+        }
+        if(total > 100){
+            goto done;
+        }
+    }
+done:
+    return total;
+}
+
+int classify(int x){
+    switch(x){
+        case 0:
+            return 10;
+        case 1:
+        case 2:
+            return 20;
+        case 3:
+            if(x){
+                return 30;
+            }
+        default:
+            break;
+    }
+    return 40;
+}
+
+unsigned char narrow_moves(int x){
+    unsigned char c;
+    short s;
+    c = x;
+    s = c;
+    s = s + x;
+    return s;
+}
+
+int main(){
+    printf("%d %d\n", many_live_values(3, 5), many_live_values(-7, 2));
+    printf("%d %d\n", identity_arithmetic(6, 13), identity_arithmetic(-6, 4294967295u));
+    printf("%d %d %d\n", select_mode(5), empty_arms(0), empty_arms(3));
+    printf("%d %d %d\n", sign_of(-9), sign_of(0), sign_of(9));
+    printf("%lld %lld\n", local_struct(4), global_structs());
+    printf("%d\n", sum_points(points, 4));
+    printf("%d %d\n", nested_jumps(5), nested_jumps(40));
+    printf("%d %d %d %d %d\n", classify(0), classify(1), classify(2), classify(3), classify(9));
+    printf("%d %d\n", narrow_moves(300), narrow_moves(-1));
+    return 0;
+}
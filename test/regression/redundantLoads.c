@@ -0,0 +1,103 @@
+int printf(const char* format, ...);
+
+int shared;
+
+// recursive, so the inliner keeps the call and the store it makes stays hidden behind it
+void bump(int* p, int n){
+    if(n > 0){
+        *p = *p + 1;
+        bump(p, n - 1);
+    }
+}
+
+void bump_shared(int n){
+    if(n > 0){
+        shared = shared + 1;
+        bump_shared(n - 1);
+    }
+}
+
+int common_subexpressions(int a, int b){
+    int x;
+    int y;
+    x = (a + b) * (a - b);
+    y = (a + b) * (a - b);
+    return x + y + (a + b);
+}
+
+int repeated_loads(int* p){
+    int first;
+    int second;
+    first = *p;
+    second = *p;
+    return first * 10 + second;
+}
+
+int store_forwarding(int* p, int v){
+    *p = v;
+    return *p + 1;
+}
+
+int aliasing_store(int* p, int* q){
+    int before;
+    before = *p;
+    *q = 9;
+    return before * 100 + *p;
+}
+
+int local_escapes_across_call(){
+    int local;
+    int before;
+    local = 5;
+    before = local;
+    bump(&local, 3);
+    return before * 100 + local;
+}
+
+int local_escapes_through_pointer(){
+    int local;
+    int* alias;
+    int before;
+    local = 1;
+    alias = &local;
+    before = local;
+    *alias = 4;
+    return before * 10 + local;
+}
+
+int global_across_call(){
+    int before;
+    shared = 2;
+    before = shared;
+    bump_shared(4);
+    return before * 100 + shared;
+}
+
+int array_elements(int i, int j){
+    int a[4];
+    a[0] = 1;
+    a[1] = 2;
+    a[2] = 3;
+    a[3] = 4;
+    a[i] = 50;
+    return a[j] + a[j];
+}
+
+int main(){
+    int x;
+    int y;
+    x = 3;
+    y = 3;
+    printf("%d\n", common_subexpressions(7, 2));
+    printf("%d\n", repeated_loads(&x));
+    y = store_forwarding(&x, 11);
+    printf("%d %d\n", y, x);
+    x = 3;
+    printf("%d\n", aliasing_store(&x, &y));
+    printf("%d\n", aliasing_store(&x, &x));
+    printf("%d\n", local_escapes_across_call());
+    printf("%d\n", local_escapes_through_pointer());
+    printf("%d\n", global_across_call());
+    printf("%d %d\n", array_elements(1, 1), array_elements(2, 1));
+    return 0;
+}
@@ -0,0 +1,93 @@
+int printf(const char* format, ...);
+
+int flag_of(int x){
+    int k;
+    k = 4;
+    if(k > 3){
+        k = k * 2;
+    }
+    else{
+        k = x;
+    }
+    return k + x;
+}
+
+int same_on_both_paths(int x){
+    int v;
+    if(x){
+        v = 7;
+    }
+    else{
+        v = 3 + 4;
+    }
+    return v * 6;
+}
+
+int stays_constant_in_loop(int n){
+    int c;
+    int total;
+    int i;
+    c = 5;
+    total = 0;
+    for(i = 0; i < n; i++){
+        if(c != 5){
+            c = i;
+        }
+        total = total + c;
+    }
+    return total + c;
+}
+
+int changes_in_loop(int n){
+    int c;
+    int i;
+    c = 1;
+    for(i = 0; i < n; i++){
+        c = c * 3;
+    }
+    return c;
+}
+
+int arithmetic(){
+    int a;
+    int b;
+    unsigned int u;
+    a = -7;
+    b = 2;
+    u = 0xF0000000u;
+    return (a / b) * 1000 + (a % b) * 100 + (int)(u >> 28) + (-8 >> 1) * 10000;
+}
+
+int unsigned_wrap(){
+    unsigned int u;
+    unsigned char c;
+    u = 0;
+    u = u - 1;
+    c = 250;
+    c = c + 10;
+    return (u > 5) * 100 + c;
+}
+
+int select(int x){
+    int mode;
+    mode = 2;
+    switch(mode){
+        case 1:
+            return x + 1;
+        case 2:
+            return x + 2;
+        default:
+            return x + 3;
+    }
+}
+
+int main(){
+    printf("%d %d\n", flag_of(1), flag_of(-3));
+    printf("%d %d\n", same_on_both_paths(0), same_on_both_paths(1));
+    printf("%d %d\n", stays_constant_in_loop(0), stays_constant_in_loop(4));
+    printf("%d %d\n", changes_in_loop(0), changes_in_loop(5));
+    printf("%d\n", arithmetic());
+    printf("%d\n", unsigned_wrap());
+    printf("%d\n", select(10));
+    return 0;
+}
@@ -0,0 +1,550 @@
+int printf(const char* format, ...);
+
+int signed_div_2(int x){
+    return x / 2;
+}
+
+int signed_rem_2(int x){
+    return x % 2;
+}
+
+int signed_div_3(int x){
+    return x / 3;
+}
+
+int signed_rem_3(int x){
+    return x % 3;
+}
+
+int signed_div_5(int x){
+    return x / 5;
+}
+
+int signed_rem_5(int x){
+    return x % 5;
+}
+
+int signed_div_6(int x){
+    return x / 6;
+}
+
+int signed_rem_6(int x){
+    return x % 6;
+}
+
+int signed_div_7(int x){
+    return x / 7;
+}
+
+int signed_rem_7(int x){
+    return x % 7;
+}
+
+int signed_div_8(int x){
+    return x / 8;
+}
+
+int signed_rem_8(int x){
+    return x % 8;
+}
+
+int signed_div_10(int x){
+    return x / 10;
+}
+
+int signed_rem_10(int x){
+    return x % 10;
+}
+
+int signed_div_12(int x){
+    return x / 12;
+}
+
+int signed_rem_12(int x){
+    return x % 12;
+}
+
+int signed_div_25(int x){
+    return x / 25;
+}
+
+int signed_rem_25(int x){
+    return x % 25;
+}
+
+int signed_div_100(int x){
+    return x / 100;
+}
+
+int signed_rem_100(int x){
+    return x % 100;
+}
+
+int signed_div_641(int x){
+    return x / 641;
+}
+
+int signed_rem_641(int x){
+    return x % 641;
+}
+
+int signed_div_1000(int x){
+    return x / 1000;
+}
+
+int signed_rem_1000(int x){
+    return x % 1000;
+}
+
+int signed_div_1024(int x){
+    return x / 1024;
+}
+
+int signed_rem_1024(int x){
+    return x % 1024;
+}
+
+int signed_div_65536(int x){
+    return x / 65536;
+}
+
+int signed_rem_65536(int x){
+    return x % 65536;
+}
+
+int signed_div_2147483647(int x){
+    return x / 2147483647;
+}
+
+int signed_rem_2147483647(int x){
+    return x % 2147483647;
+}
+
+int signed_div_m2(int x){
+    return x / (-2);
+}
+
+int signed_rem_m2(int x){
+    return x % (-2);
+}
+
+int signed_div_m3(int x){
+    return x / (-3);
+}
+
+int signed_rem_m3(int x){
+    return x % (-3);
+}
+
+int signed_div_m7(int x){
+    return x / (-7);
+}
+
+int signed_rem_m7(int x){
+    return x % (-7);
+}
+
+int signed_div_m8(int x){
+    return x / (-8);
+}
+
+int signed_rem_m8(int x){
+    return x % (-8);
+}
+
+int signed_div_m100(int x){
+    return x / (-100);
+}
+
+int signed_rem_m100(int x){
+    return x % (-100);
+}
+
+unsigned int unsigned_div_2(unsigned int x){
+    return x / 2u;
+}
+
+unsigned int unsigned_rem_2(unsigned int x){
+    return x % 2u;
+}
+
+unsigned int unsigned_div_3(unsigned int x){
+    return x / 3u;
+}
+
+unsigned int unsigned_rem_3(unsigned int x){
+    return x % 3u;
+}
+
+unsigned int unsigned_div_5(unsigned int x){
+    return x / 5u;
+}
+
+unsigned int unsigned_rem_5(unsigned int x){
+    return x % 5u;
+}
+
+unsigned int unsigned_div_7(unsigned int x){
+    return x / 7u;
+}
+
+unsigned int unsigned_rem_7(unsigned int x){
+    return x % 7u;
+}
+
+unsigned int unsigned_div_10(unsigned int x){
+    return x / 10u;
+}
+
+unsigned int unsigned_rem_10(unsigned int x){
+    return x % 10u;
+}
+
+unsigned int unsigned_div_12(unsigned int x){
+    return x / 12u;
+}
+
+unsigned int unsigned_rem_12(unsigned int x){
+    return x % 12u;
+}
+
+unsigned int unsigned_div_25(unsigned int x){
+    return x / 25u;
+}
+
+unsigned int unsigned_rem_25(unsigned int x){
+    return x % 25u;
+}
+
+unsigned int unsigned_div_100(unsigned int x){
+    return x / 100u;
+}
+
+unsigned int unsigned_rem_100(unsigned int x){
+    return x % 100u;
+}
+
+unsigned int unsigned_div_641(unsigned int x){
+    return x / 641u;
+}
+
+unsigned int unsigned_rem_641(unsigned int x){
+    return x % 641u;
+}
+
+unsigned int unsigned_div_1000(unsigned int x){
+    return x / 1000u;
+}
+
+unsigned int unsigned_rem_1000(unsigned int x){
+    return x % 1000u;
+}
+
+unsigned int unsigned_div_1024(unsigned int x){
+    return x / 1024u;
+}
+
+unsigned int unsigned_rem_1024(unsigned int x){
+    return x % 1024u;
+}
+
+unsigned int unsigned_div_2147483647(unsigned int x){
+    return x / 2147483647u;
+}
+
+unsigned int unsigned_rem_2147483647(unsigned int x){
+    return x % 2147483647u;
+}
+
+unsigned int unsigned_div_2147483648(unsigned int x){
+    return x / 0x80000000u;
+}
+
+unsigned int unsigned_rem_2147483648(unsigned int x){
+    return x % 0x80000000u;
+}
+
+unsigned int unsigned_div_4294967294(unsigned int x){
+    return x / 0xFFFFFFFEu;
+}
+
+unsigned int unsigned_rem_4294967294(unsigned int x){
+    return x % 0xFFFFFFFEu;
+}
+
+unsigned int unsigned_div_4294967295(unsigned int x){
+    return x / 0xFFFFFFFFu;
+}
+
+unsigned int unsigned_rem_4294967295(unsigned int x){
+    return x % 0xFFFFFFFFu;
+}
+
+// folds quotient and remainder into the hash, so one line covers every dividend
+unsigned int mix(unsigned int hash, unsigned int value){
+    return (hash ^ value) * 16777619u;
+}
+
+long long multiply_wide(long long x){
+    return x * 8 + x * 1 - x * 0 + (x * -1) * 2 + x * 1024 + x / 7 + x % 10;
+}
+
+int multiply_small(int x){
+    return x * 4 + x * 16 - x * 2 + x * 1 + x * 0 + x * -1 + x * 3 + x * 10;
+}
+
+unsigned int narrow_dividends(unsigned char c, unsigned short s, signed char n){
+    return c / 3 + s / 7 + n / 5 + c % 3 + s % 7 + n % 5;
+}
+
+int index_sum(int* values, int n){
+    int i;
+    int total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        total = total + values[i];
+    }
+    return total;
+}
+
+int strided_sum(int* values, int n){
+    int i;
+    int total;
+    total = 0;
+    for(i = 1; i < n; i = i + 3){
+        total = total + values[i] * i;
+    }
+    for(i = n - 1; i >= 0; i--){
+        total = total - values[i] / 2;
+    }
+    return total;
+}
+
+long long long_index_sum(long long* values, int n){
+    int i;
+    long long total;
+    total = 0;
+    for(i = 0; i < n; i++){
+        values[i] = values[i] * 4 + i;
+        total = total + values[i];
+    }
+    return total;
+}
+
+int main(){
+    int dividends[24];
+    unsigned int hash;
+    int i;
+    int count;
+    long long wide[10];
+    dividends[0] = 0;
+    dividends[1] = 1;
+    dividends[2] = -1;
+    dividends[3] = 2;
+    dividends[4] = -2;
+    dividends[5] = 7;
+    dividends[6] = -7;
+    dividends[7] = 99;
+    dividends[8] = -100;
+    dividends[9] = 641;
+    dividends[10] = 1000;
+    dividends[11] = -1001;
+    dividends[12] = 65535;
+    dividends[13] = -65536;
+    dividends[14] = 123456789;
+    dividends[15] = -987654321;
+    dividends[16] = 2147483647;
+    dividends[17] = -2147483647 - 1;
+    dividends[18] = 2147483646;
+    dividends[19] = -2147483647;
+    dividends[20] = 1073741824;
+    dividends[21] = -1073741825;
+    dividends[22] = 715827883;
+    dividends[23] = -715827883;
+    count = 24;
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_2(dividends[i])), signed_rem_2(dividends[i]));
+    }
+    printf("signed 2: %d %d %u\n", signed_div_2(-1000), signed_rem_2(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_3(dividends[i])), signed_rem_3(dividends[i]));
+    }
+    printf("signed 3: %d %d %u\n", signed_div_3(-1000), signed_rem_3(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_5(dividends[i])), signed_rem_5(dividends[i]));
+    }
+    printf("signed 5: %d %d %u\n", signed_div_5(-1000), signed_rem_5(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_6(dividends[i])), signed_rem_6(dividends[i]));
+    }
+    printf("signed 6: %d %d %u\n", signed_div_6(-1000), signed_rem_6(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_7(dividends[i])), signed_rem_7(dividends[i]));
+    }
+    printf("signed 7: %d %d %u\n", signed_div_7(-1000), signed_rem_7(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_8(dividends[i])), signed_rem_8(dividends[i]));
+    }
+    printf("signed 8: %d %d %u\n", signed_div_8(-1000), signed_rem_8(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_10(dividends[i])), signed_rem_10(dividends[i]));
+    }
+    printf("signed 10: %d %d %u\n", signed_div_10(-1000), signed_rem_10(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_12(dividends[i])), signed_rem_12(dividends[i]));
+    }
+    printf("signed 12: %d %d %u\n", signed_div_12(-1000), signed_rem_12(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_25(dividends[i])), signed_rem_25(dividends[i]));
+    }
+    printf("signed 25: %d %d %u\n", signed_div_25(-1000), signed_rem_25(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_100(dividends[i])), signed_rem_100(dividends[i]));
+    }
+    printf("signed 100: %d %d %u\n", signed_div_100(-1000), signed_rem_100(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_641(dividends[i])), signed_rem_641(dividends[i]));
+    }
+    printf("signed 641: %d %d %u\n", signed_div_641(-1000), signed_rem_641(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_1000(dividends[i])), signed_rem_1000(dividends[i]));
+    }
+    printf("signed 1000: %d %d %u\n", signed_div_1000(-1000), signed_rem_1000(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_1024(dividends[i])), signed_rem_1024(dividends[i]));
+    }
+    printf("signed 1024: %d %d %u\n", signed_div_1024(-1000), signed_rem_1024(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_65536(dividends[i])), signed_rem_65536(dividends[i]));
+    }
+    printf("signed 65536: %d %d %u\n", signed_div_65536(-1000), signed_rem_65536(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_2147483647(dividends[i])), signed_rem_2147483647(dividends[i]));
+    }
+    printf("signed 2147483647: %d %d %u\n", signed_div_2147483647(-1000), signed_rem_2147483647(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_m2(dividends[i])), signed_rem_m2(dividends[i]));
+    }
+    printf("signed -2: %d %d %u\n", signed_div_m2(-1000), signed_rem_m2(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_m3(dividends[i])), signed_rem_m3(dividends[i]));
+    }
+    printf("signed -3: %d %d %u\n", signed_div_m3(-1000), signed_rem_m3(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_m7(dividends[i])), signed_rem_m7(dividends[i]));
+    }
+    printf("signed -7: %d %d %u\n", signed_div_m7(-1000), signed_rem_m7(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_m8(dividends[i])), signed_rem_m8(dividends[i]));
+    }
+    printf("signed -8: %d %d %u\n", signed_div_m8(-1000), signed_rem_m8(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, signed_div_m100(dividends[i])), signed_rem_m100(dividends[i]));
+    }
+    printf("signed -100: %d %d %u\n", signed_div_m100(-1000), signed_rem_m100(-1000), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_2(dividends[i])), unsigned_rem_2(dividends[i]));
+    }
+    printf("unsigned 2: %u %u %u\n", unsigned_div_2(4000000000u), unsigned_rem_2(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_3(dividends[i])), unsigned_rem_3(dividends[i]));
+    }
+    printf("unsigned 3: %u %u %u\n", unsigned_div_3(4000000000u), unsigned_rem_3(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_5(dividends[i])), unsigned_rem_5(dividends[i]));
+    }
+    printf("unsigned 5: %u %u %u\n", unsigned_div_5(4000000000u), unsigned_rem_5(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_7(dividends[i])), unsigned_rem_7(dividends[i]));
+    }
+    printf("unsigned 7: %u %u %u\n", unsigned_div_7(4000000000u), unsigned_rem_7(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_10(dividends[i])), unsigned_rem_10(dividends[i]));
+    }
+    printf("unsigned 10: %u %u %u\n", unsigned_div_10(4000000000u), unsigned_rem_10(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_12(dividends[i])), unsigned_rem_12(dividends[i]));
+    }
+    printf("unsigned 12: %u %u %u\n", unsigned_div_12(4000000000u), unsigned_rem_12(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_25(dividends[i])), unsigned_rem_25(dividends[i]));
+    }
+    printf("unsigned 25: %u %u %u\n", unsigned_div_25(4000000000u), unsigned_rem_25(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_100(dividends[i])), unsigned_rem_100(dividends[i]));
+    }
+    printf("unsigned 100: %u %u %u\n", unsigned_div_100(4000000000u), unsigned_rem_100(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_641(dividends[i])), unsigned_rem_641(dividends[i]));
+    }
+    printf("unsigned 641: %u %u %u\n", unsigned_div_641(4000000000u), unsigned_rem_641(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_1000(dividends[i])), unsigned_rem_1000(dividends[i]));
+    }
+    printf("unsigned 1000: %u %u %u\n", unsigned_div_1000(4000000000u), unsigned_rem_1000(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_1024(dividends[i])), unsigned_rem_1024(dividends[i]));
+    }
+    printf("unsigned 1024: %u %u %u\n", unsigned_div_1024(4000000000u), unsigned_rem_1024(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_2147483647(dividends[i])), unsigned_rem_2147483647(dividends[i]));
+    }
+    printf("unsigned 2147483647: %u %u %u\n", unsigned_div_2147483647(4000000000u), unsigned_rem_2147483647(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_2147483648(dividends[i])), unsigned_rem_2147483648(dividends[i]));
+    }
+    printf("unsigned 2147483648: %u %u %u\n", unsigned_div_2147483648(4000000000u), unsigned_rem_2147483648(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_4294967294(dividends[i])), unsigned_rem_4294967294(dividends[i]));
+    }
+    printf("unsigned 4294967294: %u %u %u\n", unsigned_div_4294967294(4000000000u), unsigned_rem_4294967294(4000000000u), hash);
+    hash = 2166136261u;
+    for(i = 0; i < count; i++){
+        hash = mix(mix(hash, unsigned_div_4294967295(dividends[i])), unsigned_rem_4294967295(dividends[i]));
+    }
+    printf("unsigned 4294967295: %u %u %u\n", unsigned_div_4294967295(4000000000u), unsigned_rem_4294967295(4000000000u), hash);
+    printf("%lld %lld %lld\n", multiply_wide(5), multiply_wide(-123456789012LL), multiply_wide(0));
+    printf("%d %d %d\n", multiply_small(7), multiply_small(-13), multiply_small(100000));
+    printf("%u %u\n", narrow_dividends(250, 65000, -128), narrow_dividends(7, 13, 127));
+    printf("%d %d\n", index_sum(dividends, 16), strided_sum(dividends, 16));
+    for(i = 0; i < 10; i++){
+        wide[i] = i * 1000000000LL - 3;
+    }
+    printf("%lld\n", long_index_sum(wide, 10));
+    printf("%lld %lld\n", wide[0], wide[9]);
+    return 0;
+}
@@ -0,0 +1,31 @@
+int printf(const char* format, ...);
+
+int main(){
+    int x;
+    unsigned int u;
+    x = -1;
+    u = 0xFFFFFFFFu;
+    if(-1 < 0xFFFFFFFF){
+        printf("-1 < 0xFFFFFFFF\n");
+    }
+    else{
+        printf("-1 >= 0xFFFFFFFF\n");
+    }
+    if(-1 < (unsigned int)0){
+        printf("-1 < (unsigned int)0\n");
+    }
+    else{
+        printf("-1 >= (unsigned int)0\n");
+    }
+    if(-1 < 4294967295){
+        printf("-1 < 4294967295\n");
+    }
+    if(x < 10u){
+        printf("x < 10u\n");
+    }
+    else{
+        printf("x >= 10u\n");
+    }
+    printf("%d %d %u\n", x < u, u > 0, u);
+    return 0;
+}
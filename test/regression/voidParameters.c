@@ -0,0 +1,20 @@
+int printf(const char* format, ...);
+int twice(int);
+int add(int, int);
+
+int answer(void){
+    return 42;
+}
+
+int twice(int x){
+    return x * 2;
+}
+
+int add(int a, int b){
+    return a + b;
+}
+
+int main(void){
+    printf("%d %d %d\n", answer(), twice(5), add(answer(), 1));
+    return 0;
+}